@@ -87,6 +87,19 @@ class UIConstants {
   /// Font size for drag overlay subtitle
   static const double dragOverlaySubtitleSize = 14.0;
 
+  // === RENDERING ===
+
+  /// Render grid tiles from shared native atlas textures instead of one
+  /// texture per device. Pays off at large device counts.
+  static const bool gridUsesTextureAtlas = false;
+
+  /// Lower or raise the device encoder settings of a stream from native
+  /// decoder load. Every change restarts the stream, so it is opt-in.
+  static const bool adaptiveStreamQuality = false;
+
+  /// How often native decoder health is sampled for stream adaptation.
+  static const Duration streamHealthPollInterval = Duration(seconds: 2);
+
   // === LOADING & PROGRESS ===
 
   /// Size of progress indicators
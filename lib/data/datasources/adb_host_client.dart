@@ -0,0 +1,434 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'package:ffi/ffi.dart';
+import 'package:process_run/shell.dart';
+import '../../core/error/exceptions.dart';
+import '../../core/utils/logger.dart';
+
+typedef _CreateNative = Pointer<Void> Function(Pointer<Utf8>, Int32);
+typedef _Create = Pointer<Void> Function(Pointer<Utf8>, int);
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _Free = void Function(Pointer<Void>);
+typedef _HostNative = Int32 Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _Host = int Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _ShellNative = Int32 Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _Shell = int Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _TunnelNative = Int32 Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _Tunnel = int Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _RemoveNative = Int32 Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _Remove = int Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _PushNative = Int32 Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Int32,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _Push = int Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  int,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _DeployNative = Int32 Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Int32,
+  Int32,
+  Int32,
+  Int32,
+  Pointer<Pointer<Utf8>>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _Deploy = int Function(
+  Pointer<Void>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  Pointer<Utf8>,
+  int,
+  int,
+  int,
+  int,
+  Pointer<Pointer<Utf8>>,
+  Pointer<Pointer<Utf8>>,
+);
+typedef _DevicesCallback = Void Function(Pointer<Void>, Pointer<Utf8>);
+typedef _TrackNative = Pointer<Void> Function(
+  Pointer<Void>,
+  Pointer<NativeFunction<_DevicesCallback>>,
+  Pointer<Void>,
+);
+typedef _Track = Pointer<Void> Function(
+  Pointer<Void>,
+  Pointer<NativeFunction<_DevicesCallback>>,
+  Pointer<Void>,
+);
+
+/// Lookups into scraki_adb.dll. DynamicLibrary handles are per isolate, so
+/// each worker isolate resolves its own (the library loads only once).
+class _AdbBindings {
+  static _AdbBindings? _current;
+  static _AdbBindings get current => _current ??= _AdbBindings(
+    DynamicLibrary.open(AdbHostClient.libraryName),
+  );
+
+  final _Create create;
+  final _Free free;
+  final _Host host;
+  final _Shell shell;
+  final _Tunnel forward;
+  final _Tunnel reverse;
+  final _Remove reverseRemove;
+  final _Push push;
+  final _Deploy deploy;
+  final _Track trackDevices;
+  final _Free trackStop;
+
+  _AdbBindings(DynamicLibrary lib)
+    : create = lib.lookupFunction<_CreateNative, _Create>(
+        'scraki_adb_create',
+      ),
+      free = lib.lookupFunction<_FreeNative, _Free>('scraki_adb_free'),
+      host = lib.lookupFunction<_HostNative, _Host>('scraki_adb_host'),
+      shell = lib.lookupFunction<_ShellNative, _Shell>('scraki_adb_shell'),
+      forward = lib.lookupFunction<_TunnelNative, _Tunnel>(
+        'scraki_adb_forward',
+      ),
+      reverse = lib.lookupFunction<_TunnelNative, _Tunnel>(
+        'scraki_adb_reverse',
+      ),
+      reverseRemove = lib.lookupFunction<_RemoveNative, _Remove>(
+        'scraki_adb_reverse_remove',
+      ),
+      push = lib.lookupFunction<_PushNative, _Push>('scraki_adb_push'),
+      deploy = lib.lookupFunction<_DeployNative, _Deploy>(
+        'scraki_adb_deploy',
+      ),
+      trackDevices = lib.lookupFunction<_TrackNative, _Track>(
+        'scraki_adb_track_devices',
+      ),
+      trackStop = lib.lookupFunction<_FreeNative, _Free>(
+        'scraki_adb_track_stop',
+      );
+
+  /// Runs a native call with UTF-8 copies of [args], returning its output
+  /// string (empty if it has none) or throwing its error message.
+  String call(
+    List<String> args,
+    int Function(
+      List<Pointer<Utf8>> args,
+      Pointer<Pointer<Utf8>> output,
+      Pointer<Pointer<Utf8>> error,
+    )
+    invoke,
+  ) {
+    final native = [for (final arg in args) arg.toNativeUtf8()];
+    final output = calloc<Pointer<Utf8>>();
+    final error = calloc<Pointer<Utf8>>();
+    try {
+      final status = invoke(native, output, error);
+      if (status != 0) {
+        throw ServerException(_take(error.value) ?? 'adb request failed');
+      }
+      return _take(output.value) ?? '';
+    } finally {
+      for (final arg in native) {
+        malloc.free(arg);
+      }
+      calloc.free(output);
+      calloc.free(error);
+    }
+  }
+
+  String? _take(Pointer<Utf8> string) {
+    if (string == nullptr) return null;
+    final value = string.toDartString();
+    free(string.cast());
+    return value;
+  }
+}
+
+/// Client for the adb server's own protocol (localhost:5037), replacing an
+/// `adb` process per command. Requests run on short-lived isolates, so many
+/// can be in flight at once; the native client reuses sync connections for
+/// pushes to the same device.
+///
+/// [instance] is null when the library is missing (e.g. off Windows);
+/// callers then fall back to the adb executable. The adb server must already
+/// be running, which any earlier `adb` invocation ensures.
+class AdbHostClient {
+  static const libraryName = 'scraki_adb.dll';
+
+  static AdbHostClient? _instance;
+  static bool _loadAttempted = false;
+
+  static AdbHostClient? get instance {
+    if (_loadAttempted) return _instance;
+    _loadAttempted = true;
+    if (!Platform.isWindows) return null;
+    try {
+      final bindings = _AdbBindings.current;
+      _instance = AdbHostClient._(bindings.create(nullptr, 0).address);
+    } catch (e) {
+      logger.w(
+        '[AdbHostClient] Native adb client unavailable, using adb CLI',
+        error: e,
+      );
+    }
+    return _instance;
+  }
+
+  /// Runs [native] when the native client is available. Without it, or if
+  /// it fails (e.g. the adb server is not running yet), runs [cmd] through
+  /// [shell] instead; the adb CLI starts the server as needed.
+  static Future<String> runOrShell(
+    Shell shell,
+    String cmd,
+    Future<String> Function(AdbHostClient adb) native,
+  ) async {
+    final adb = instance;
+    if (adb != null) {
+      try {
+        return await native(adb);
+      } catch (e) {
+        logger.w('[AdbHostClient] Falling back to adb CLI: $cmd', error: e);
+      }
+    }
+    final result = await shell.run(cmd);
+    return result.outText;
+  }
+
+  /// Address of the native client, shared with worker isolates.
+  final int _handle;
+
+  AdbHostClient._(this._handle);
+
+  /// A host service answering with a string, e.g. `host:devices-l`,
+  /// `host:connect:<ip>:<port>` or `host-serial:<serial>:get-state`.
+  Future<String> host(String request) {
+    final handle = _handle;
+    return Isolate.run(
+      () => _AdbBindings.current.call(
+        [request],
+        (args, output, error) => _AdbBindings.current.host(
+          Pointer.fromAddress(handle),
+          args[0],
+          output,
+          error,
+        ),
+      ),
+    );
+  }
+
+  /// Output of `shell:<command>`, stdout and stderr combined.
+  Future<String> shell(String serial, String command) {
+    final handle = _handle;
+    return Isolate.run(
+      () => _AdbBindings.current.call(
+        [serial, command],
+        (args, output, error) => _AdbBindings.current.shell(
+          Pointer.fromAddress(handle),
+          args[0],
+          args[1],
+          output,
+          error,
+        ),
+      ),
+    );
+  }
+
+  Future<void> forward(String serial, String local, String remote) {
+    final handle = _handle;
+    return Isolate.run(
+      () => _AdbBindings.current.call(
+        [serial, local, remote],
+        (args, output, error) => _AdbBindings.current.forward(
+          Pointer.fromAddress(handle),
+          args[0],
+          args[1],
+          args[2],
+          error,
+        ),
+      ),
+    );
+  }
+
+  Future<void> reverse(String serial, String remote, String local) {
+    final handle = _handle;
+    return Isolate.run(
+      () => _AdbBindings.current.call(
+        [serial, remote, local],
+        (args, output, error) => _AdbBindings.current.reverse(
+          Pointer.fromAddress(handle),
+          args[0],
+          args[1],
+          args[2],
+          error,
+        ),
+      ),
+    );
+  }
+
+  Future<void> removeReverse(String serial, String remote) {
+    final handle = _handle;
+    return Isolate.run(
+      () => _AdbBindings.current.call(
+        [serial, remote],
+        (args, output, error) => _AdbBindings.current.reverseRemove(
+          Pointer.fromAddress(handle),
+          args[0],
+          args[1],
+          error,
+        ),
+      ),
+    );
+  }
+
+  /// Uploads [localPath] to [remotePath] (a full file path, not a folder).
+  Future<void> push(
+    String serial,
+    String localPath,
+    String remotePath, {
+    int mode = 420, // 0644
+  }) {
+    final handle = _handle;
+    return Isolate.run(
+      () => _AdbBindings.current.call(
+        [serial, localPath, remotePath],
+        (args, output, error) => _AdbBindings.current.push(
+          Pointer.fromAddress(handle),
+          args[0],
+          args[1],
+          args[2],
+          mode,
+          error,
+        ),
+      ),
+    );
+  }
+
+  /// Pushes [localPath] to [remotePath] on every device in [serials],
+  /// skipping devices that already hold an identical copy (same size and
+  /// SHA-256 marker). At most [maxParallel] pushes run at once, [perHub] on
+  /// one USB hub, shared with other deploys in flight; each device gets
+  /// [maxAttempts] tries with backoff.
+  ///
+  /// Failed devices do not throw. Returns
+  /// `{sha256, size, elapsedMs, pushed, skipped, failed, devices: [{serial,
+  /// hub, outcome: pushed|skipped|failed, attempts, elapsedMs, error?}]}`.
+  Future<Map<String, dynamic>> deploy(
+    List<String> serials,
+    String localPath,
+    String remotePath, {
+    int mode = 420, // 0644
+    int maxParallel = 8,
+    int perHub = 2,
+    int maxAttempts = 3,
+  }) async {
+    final handle = _handle;
+    final report = await Isolate.run(
+      () => _AdbBindings.current.call(
+        [serials.join('\n'), localPath, remotePath],
+        (args, output, error) => _AdbBindings.current.deploy(
+          Pointer.fromAddress(handle),
+          args[0],
+          args[1],
+          args[2],
+          mode,
+          maxParallel,
+          perHub,
+          maxAttempts,
+          output,
+          error,
+        ),
+      ),
+    );
+    return jsonDecode(report) as Map<String, dynamic>;
+  }
+
+  /// Device lists in `host:devices-l` format, the current one first and
+  /// then one per change, until the subscription is cancelled.
+  Stream<String> trackDevices() {
+    final bindings = _AdbBindings.current;
+    late StreamController<String> controller;
+    NativeCallable<_DevicesCallback>? callback;
+    Pointer<Void> tracker = nullptr;
+
+    controller = StreamController<String>(
+      onListen: () {
+        callback = NativeCallable<_DevicesCallback>.listener((
+          Pointer<Void> context,
+          Pointer<Utf8> devices,
+        ) {
+          final list = bindings._take(devices);
+          if (list != null && !controller.isClosed) controller.add(list);
+        });
+        tracker = bindings.trackDevices(
+          Pointer.fromAddress(_handle),
+          callback!.nativeFunction,
+          nullptr,
+        );
+      },
+      onCancel: () {
+        // Joins the tracker thread, so no callback follows
+        if (tracker != nullptr) bindings.trackStop(tracker);
+        tracker = nullptr;
+        callback?.close();
+        callback = null;
+      },
+    );
+    return controller.stream;
+  }
+}
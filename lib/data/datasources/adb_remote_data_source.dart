@@ -1,6 +1,7 @@
 import 'package:injectable/injectable.dart';
 import 'package:process_run/shell.dart';
 import '../../core/error/exceptions.dart';
+import 'adb_host_client.dart';
 
 abstract class IAdbRemoteDataSource {
   Future<String> getConnectedDevicesOutput();
@@ -41,11 +42,16 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
 
   AdbRemoteDataSourceImpl() : _shell = Shell();
 
+  Future<String> _run(
+    String cmd,
+    Future<String> Function(AdbHostClient adb) native,
+  ) => AdbHostClient.runOrShell(_shell, cmd, native);
+
   @override
   Future<String> getConnectedDevicesOutput() async {
     try {
-      final result = await _shell.run(_cmdListDevices);
-      return result.outText;
+      // host:devices-l không có dòng "List of devices attached"
+      return await _run(_cmdListDevices, (adb) => adb.host('host:devices-l'));
     } catch (e) {
       throw ServerException('Failed to execute $_cmdListDevices: $e');
     }
@@ -55,8 +61,10 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
   Future<void> connectTcp(String ip, int port) async {
     final cmd = 'adb connect $ip:$port';
     try {
-      final result = await _shell.run(cmd);
-      final output = result.outText;
+      final output = await _run(
+        cmd,
+        (adb) => adb.host('host:connect:$ip:$port'),
+      );
       if (output.runes.contains("unable") || output.contains("failed")) {
         throw ServerException(output);
       }
@@ -70,7 +78,7 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
   Future<void> disconnect(String serial) async {
     final cmd = 'adb disconnect $serial';
     try {
-      await _shell.run(cmd);
+      await _run(cmd, (adb) => adb.host('host:disconnect:$serial'));
     } catch (e) {
       throw ServerException('Failed to execute $cmd: $e');
     }
@@ -87,8 +95,10 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
     final cmd = 'adb -s $serial shell pm list packages $flag';
 
     try {
-      final result = await _shell.run(cmd);
-      final output = result.outText.trim();
+      final output = (await _run(
+        cmd,
+        (adb) => adb.shell(serial, 'pm list packages $flag'),
+      )).trim();
 
       if (output.isEmpty) {
         return [];
@@ -113,8 +123,11 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
         'adb -s $serial shell dumpsys package $packageName | grep -i "applicationLabel"';
 
     try {
-      final result = await _shell.run(cmd);
-      final output = result.outText.trim();
+      // Native client trả về toàn bộ dumpsys, regex bên dưới tự tìm dòng
+      final output = (await _run(
+        cmd,
+        (adb) => adb.shell(serial, 'dumpsys package $packageName'),
+      )).trim();
 
       if (output.isEmpty) {
         // Fallback: return package name nếu không tìm được label
@@ -143,8 +156,10 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
     final cmd = 'adb -s $serial shell monkey -p $packageName 1';
 
     try {
-      final result = await _shell.run(cmd);
-      final output = result.outText;
+      final output = await _run(
+        cmd,
+        (adb) => adb.shell(serial, 'monkey -p $packageName 1'),
+      );
 
       // Kiểm tra lỗi thường gặp
       if (output.contains('monkey: not found') ||
@@ -164,7 +179,7 @@ class AdbRemoteDataSourceImpl implements IAdbRemoteDataSource {
     final cmd = 'adb -s $serial shell input keyevent 26';
 
     try {
-      await _shell.run(cmd);
+      await _run(cmd, (adb) => adb.shell(serial, 'input keyevent 26'));
     } catch (e) {
       throw ServerException('Failed to send power key: $e');
     }
@@ -7,6 +7,7 @@ import '../../core/utils/logger.dart';
 import '../../core/error/exceptions.dart';
 import '../../data/protocol/scrcpy_header.dart';
 import '../../data/protocol/scrcpy_protocol_parser.dart';
+import 'adb_host_client.dart';
 
 class ScrcpySession {
   final ScrcpyHeader header;
@@ -30,13 +31,9 @@ class ScrcpyClient {
   Future<void> setupTunnel(String serial, int localPort, String scid) async {
     try {
       // With tunnel_forward=true, server connects to 'scrcpy_<scid>'
-      await _shell.run(
-        'adb -s $serial reverse localabstract:scrcpy_$scid tcp:$localPort',
-      );
+      await _reverse(serial, 'localabstract:scrcpy_$scid', 'tcp:$localPort');
       // Also setup 'scrcpy' as fallback name just in case
-      await _shell.run(
-        'adb -s $serial reverse localabstract:scrcpy tcp:$localPort',
-      );
+      await _reverse(serial, 'localabstract:scrcpy', 'tcp:$localPort');
       logger.i(
         '[ScrcpyClient] Reverse tunnel setup for scrcpy_$scid on port $localPort',
       );
@@ -45,11 +42,27 @@ class ScrcpyClient {
     }
   }
 
+  Future<void> _reverse(String serial, String remote, String local) {
+    return AdbHostClient.runOrShell(
+      _shell,
+      'adb -s $serial reverse $remote $local',
+      (adb) async {
+        await adb.reverse(serial, remote, local);
+        return '';
+      },
+    );
+  }
+
   /// Removes ADB reverse tunnel for a specific scid
   Future<void> removeTunnel(String serial, String scid) async {
     try {
-      await _shell.run(
+      await AdbHostClient.runOrShell(
+        _shell,
         'adb -s $serial reverse --remove localabstract:scrcpy_$scid',
+        (adb) async {
+          await adb.removeReverse(serial, 'localabstract:scrcpy_$scid');
+          return '';
+        },
       );
     } catch (_) {
       // Ignore cleanup errors
@@ -7,6 +7,7 @@ import 'package:process_run/shell.dart';
 import '../../core/di/injection.dart';
 import '../../core/error/exceptions.dart';
 import '../../domain/entities/scrcpy_options.dart';
+import '../datasources/adb_host_client.dart';
 import '../datasources/scrcpy_client.dart';
 import '../../core/utils/logger.dart';
 
@@ -37,17 +38,58 @@ class ScrcpyService {
     }
   }
 
+  /// Pushes the server jar unless the device already has this exact copy.
+  /// Pushes from concurrent session starts share the native deploy limits.
   Future<void> pushServer(String deviceSerial) async {
     try {
       final localPath = await _getServerPath();
-      await _shell.run(
+      await AdbHostClient.runOrShell(
+        _shell,
         'adb -s $deviceSerial push $localPath $_remoteServerPath',
+        (adb) async {
+          final report = await adb.deploy(
+            [deviceSerial],
+            localPath,
+            _remoteServerPath,
+          );
+          final device = (report['devices'] as List).first as Map;
+          if (device['outcome'] == 'failed') {
+            throw ServerException('${device['error']}');
+          }
+          return '';
+        },
       );
     } catch (e) {
       throw ServerException('Failed to push server to $deviceSerial: $e');
     }
   }
 
+  /// Deploys the server jar to a whole fleet ahead of session starts, in
+  /// parallel and skipping up-to-date devices. Returns the deploy report
+  /// (see [AdbHostClient.deploy]), or null without the native client, in
+  /// which case each session pushes on start.
+  Future<Map<String, dynamic>?> deployServer(List<String> serials) async {
+    final adb = AdbHostClient.instance;
+    if (adb == null || serials.isEmpty) return null;
+    try {
+      final report = await adb.deploy(
+        serials,
+        await _getServerPath(),
+        _remoteServerPath,
+      );
+      logger.i(
+        '[ScrcpyService] Deployed server to ${serials.length} devices in '
+        '${(report['elapsedMs'] as num).round()} ms: '
+        '${report['pushed']} pushed, ${report['skipped']} up to date, '
+        '${report['failed']} failed',
+      );
+      return report;
+    } catch (e) {
+      logger.e('[ScrcpyService] Failed to deploy server', error: e);
+      return null;
+    }
+  }
+
   Future<({int port, String scid})> initServer(
     String deviceSerial,
     ScrcpyOptions options,
@@ -64,6 +106,8 @@ class ScrcpyService {
 
       final args = options.toArgs(_serverVersion, scid);
 
+      // The server runs for the whole session and its output goes to the
+      // log, so it stays an adb process rather than a native shell request
       final command =
           'adb -s $deviceSerial shell CLASSPATH=$_remoteServerPath app_process / com.genymobile.scrcpy.Server ${args.join(' ')}';
       final parts = command.split(' ');
@@ -86,8 +130,13 @@ class ScrcpyService {
 
   Future<void> killServer(String serial) async {
     try {
-      await _shell.run(
-        'adb -s $serial shell "ps -en | grep app_process | awk \'{print \$2}\' | xargs kill -9 || true"',
+      const kill =
+          'ps -en | grep app_process | '
+          "awk '{print \$2}' | xargs kill -9 || true";
+      await AdbHostClient.runOrShell(
+        _shell,
+        'adb -s $serial shell "$kill"',
+        (adb) => adb.shell(serial, kill),
       );
     } catch (e) {
       logger.w(
@@ -102,15 +151,25 @@ class ScrcpyService {
       for (final path in filePaths) {
         logger.i('[ScrcpyService] Pushing file to $serial: $path');
         // Push to /sdcard/Download/ which is a standard location
-        await _shell.run('adb -s $serial push "$path" /sdcard/Download/');
+        final fileName = path.split(Platform.isWindows ? r'\' : '/').last;
+        await AdbHostClient.runOrShell(
+          _shell,
+          'adb -s $serial push "$path" /sdcard/Download/',
+          (adb) async {
+            await adb.push(serial, path, '/sdcard/Download/$fileName');
+            return '';
+          },
+        );
 
         // Notify MediaScanner to scan the pushed file
-        final fileName = path.split(Platform.isWindows ? r'\' : '/').last;
         final uri = 'file:///sdcard/Download/$fileName';
-        await _shell.run(
-          'adb -s $serial shell am broadcast '
-          '-a android.intent.action.MEDIA_SCANNER_SCAN_FILE '
-          '-d $uri',
+        final broadcast =
+            'am broadcast -a android.intent.action.MEDIA_SCANNER_SCAN_FILE '
+            '-d $uri';
+        await AdbHostClient.runOrShell(
+          _shell,
+          'adb -s $serial shell $broadcast',
+          (adb) => adb.shell(serial, broadcast),
         );
       }
     } catch (e) {
@@ -121,8 +180,12 @@ class ScrcpyService {
 
   Future<bool> isDeviceConnected(String serial) async {
     try {
-      final result = await _shell.run('adb -s $serial get-state');
-      return result.outText.trim() == 'device';
+      final state = await AdbHostClient.runOrShell(
+        _shell,
+        'adb -s $serial get-state',
+        (adb) => adb.host('host-serial:$serial:get-state'),
+      );
+      return state.trim() == 'device';
     } catch (_) {
       return false;
     }
@@ -0,0 +1,183 @@
+import '../../domain/entities/scrcpy_options.dart';
+
+/// One `health` entry of [NativeVideoDecoderService.getStats] for a session.
+class StreamHealthSample {
+  final bool overloaded;
+  final bool underused;
+  final int recommendedMaxFps;
+  final int recommendedMaxSize;
+  final int recommendedBitRate;
+
+  /// Longer side of the decoded frames, 0 before the first one.
+  final int maxDimension;
+
+  const StreamHealthSample({
+    this.overloaded = false,
+    this.underused = false,
+    this.recommendedMaxFps = 0,
+    this.recommendedMaxSize = 0,
+    this.recommendedBitRate = 0,
+    this.maxDimension = 0,
+  });
+
+  factory StreamHealthSample.fromMap(Map<dynamic, dynamic> map) {
+    return StreamHealthSample(
+      overloaded: map['overloaded'] == true,
+      underused: map['underused'] == true,
+      recommendedMaxFps: (map['recommendedMaxFps'] as num?)?.toInt() ?? 0,
+      recommendedMaxSize: (map['recommendedMaxSize'] as num?)?.toInt() ?? 0,
+      recommendedBitRate: (map['recommendedBitRate'] as num?)?.toInt() ?? 0,
+      maxDimension: (map['maxDimension'] as num?)?.toInt() ?? 0,
+    );
+  }
+}
+
+/// Turns native load feedback into scrcpy encoder settings.
+///
+/// Every change restarts the device stream, so the controller only moves
+/// after a sustained signal: [downgradeAfter] overloaded samples in a row to
+/// step down, [upgradeAfter] underused samples in a row to step back up, at
+/// most once per [cooldown], and only when some setting moves by at least
+/// [minChange]. Settings stay between [floor] and the profile [ceiling]; an
+/// unlimited profile size is limited only while overloaded and goes back to
+/// unlimited once stepping up reaches the stream's own size.
+class StreamAdaptationController {
+  final ScrcpyOptions ceiling;
+  final ScrcpyOptions floor;
+  final int downgradeAfter;
+  final int upgradeAfter;
+  final Duration cooldown;
+  final double minChange;
+  final DateTime Function() _now;
+
+  ScrcpyOptions _current;
+  int _overloadedStreak = 0;
+  int _underusedStreak = 0;
+  DateTime? _lastChange;
+  // Stream size when an unlimited size was first limited
+  int _unlimitedSize = 0;
+
+  StreamAdaptationController({
+    required this.ceiling,
+    this.floor = const ScrcpyOptions(
+      maxFps: 5,
+      maxSize: 360,
+      bitRate: 250000,
+    ),
+    this.downgradeAfter = 3,
+    this.upgradeAfter = 10,
+    this.cooldown = const Duration(seconds: 20),
+    this.minChange = 0.2,
+    DateTime Function()? clock,
+  }) : _current = ceiling,
+       _now = clock ?? DateTime.now;
+
+  /// Settings the stream currently runs with.
+  ScrcpyOptions get current => _current;
+
+  /// Feeds one sample and returns the settings to restart the stream with,
+  /// or null to keep the current ones.
+  ScrcpyOptions? addSample(StreamHealthSample sample) {
+    _overloadedStreak = sample.overloaded ? _overloadedStreak + 1 : 0;
+    _underusedStreak = sample.underused ? _underusedStreak + 1 : 0;
+
+    final now = _now();
+    if (_lastChange != null && now.difference(_lastChange!) < cooldown) {
+      return null;
+    }
+
+    ScrcpyOptions? next;
+    if (_overloadedStreak >= downgradeAfter) {
+      next = _stepDown(sample);
+    } else if (_underusedStreak >= upgradeAfter) {
+      next = _stepUp();
+    }
+    if (next == null || !_isSignificant(next)) return null;
+
+    _current = next;
+    _lastChange = now;
+    _overloadedStreak = 0;
+    _underusedStreak = 0;
+    return next;
+  }
+
+  ScrcpyOptions _stepDown(StreamHealthSample sample) {
+    int lower(int current, int recommended) =>
+        recommended > 0 && recommended < current ? recommended : current;
+
+    if (_current.maxSize == 0 && sample.recommendedMaxSize > 0) {
+      _unlimitedSize = sample.maxDimension > 0
+          ? sample.maxDimension
+          : sample.recommendedMaxSize;
+    }
+    return _clamp(
+      _current.copyWith(
+        maxFps: lower(_current.maxFps, sample.recommendedMaxFps),
+        maxSize: _current.maxSize == 0
+            ? sample.recommendedMaxSize
+            : lower(_current.maxSize, sample.recommendedMaxSize),
+        bitRate: lower(_current.bitRate, sample.recommendedBitRate),
+      ),
+    );
+  }
+
+  ScrcpyOptions _stepUp() {
+    int raise(int value) => (value * 1.25).round();
+
+    // 0 is unlimited and cannot grow further; a limit that only stood in
+    // for it is lifted again at the stream's own size
+    var maxSize = _current.maxSize == 0 ? 0 : raise(_current.maxSize);
+    if (ceiling.maxSize == 0 && maxSize >= _unlimitedSize) maxSize = 0;
+
+    return _clamp(
+      _current.copyWith(
+        maxFps: raise(_current.maxFps),
+        maxSize: maxSize,
+        bitRate: raise(_current.bitRate),
+      ),
+    );
+  }
+
+  ScrcpyOptions _clamp(ScrcpyOptions options) {
+    int clampTo(int value, int low, int high) =>
+        value < low ? low : (high > 0 && value > high ? high : value);
+
+    return options.copyWith(
+      maxFps: clampTo(options.maxFps, floor.maxFps, ceiling.maxFps),
+      maxSize: options.maxSize == 0
+          ? 0
+          : clampTo(options.maxSize, floor.maxSize, ceiling.maxSize),
+      bitRate: clampTo(options.bitRate, floor.bitRate, ceiling.bitRate),
+    );
+  }
+
+  bool _isSignificant(ScrcpyOptions next) {
+    // Reaching a bound always counts, otherwise the last small step up to
+    // the profile would never be taken
+    bool moved(int from, int to, int low, int high) {
+      if (from == to) return false;
+      if (from == 0 || to == 0 || to == low || to == high) return true;
+      return (to - from).abs() / from >= minChange;
+    }
+
+    final fps = moved(
+      _current.maxFps,
+      next.maxFps,
+      floor.maxFps,
+      ceiling.maxFps,
+    );
+    final size = moved(
+      _current.maxSize,
+      next.maxSize,
+      floor.maxSize,
+      ceiling.maxSize,
+    );
+    final bitRate = moved(
+      _current.bitRate,
+      next.bitRate,
+      floor.bitRate,
+      ceiling.bitRate,
+    );
+    return fps || size || bitRate;
+  }
+}
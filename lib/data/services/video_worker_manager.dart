@@ -6,6 +6,9 @@ import 'dart:typed_data';
 import 'package:flutter/services.dart';
 import 'package:injectable/injectable.dart';
 import '../../../core/utils/logger.dart';
+import '../../core/constants/ui_constants.dart';
+import '../../presentation/widgets/device/native_video_decoder/native_video_decoder_service.dart';
+import '../utils/scrcpy_input_serializer.dart';
 
 /// Tin nhắn gửi tới Worker Isolate
 class VideoWorkerCommand {
@@ -38,10 +41,23 @@ typedef VideoWorkerListener = void Function(VideoWorkerEvent);
 @lazySingleton
 class VideoWorkerManager {
   static const int _numWorkers = 4; // Số lượng Isolate trong pool
+
+  /// Control message types a tap sees: user input, not the app's own
+  /// requests such as resetting the video stream.
+  static const Set<int> _tappedTypes = {
+    TouchControlMessage.typeInjectTouchEvent,
+    ScrollControlMessage.typeInjectScrollEvent,
+    KeyControlMessage.typeInjectKeyEvent,
+    InjectTextControlMessage.typeInjectTextEvent,
+  };
   final List<_WorkerHandle> _workers = [];
   int _nextWorkerIndex = 0;
 
   final Map<String, VideoWorkerListener> _listeners = {};
+  final Map<String, void Function(List<int> data)> _controlTaps = {};
+  final Map<String, void Function(Map<dynamic, dynamic> sessions)>
+  _healthListeners = {};
+  Timer? _healthTimer;
 
   Future<void> init() async {
     if (_workers.isNotEmpty) return;
@@ -137,6 +153,7 @@ class VideoWorkerManager {
 
   void stopMirroring(String sessionId) {
     _listeners.remove(sessionId);
+    _controlTaps.remove(sessionId);
     for (final worker in _workers) {
       worker.sendPort.send(
         VideoWorkerCommand(
@@ -148,7 +165,52 @@ class VideoWorkerManager {
     }
   }
 
+  /// Calls [tap] with every input message (touch, scroll, key, text) sent to
+  /// [sessionId], for input recording; null removes it.
+  void setControlTap(String sessionId, void Function(List<int> data)? tap) {
+    if (tap == null) {
+      _controlTaps.remove(sessionId);
+    } else {
+      _controlTaps[sessionId] = tap;
+    }
+  }
+
+  /// Calls [listener] with the per-texture `sessions` map of the native
+  /// decoder stats every [UIConstants.streamHealthPollInterval]. One stats
+  /// call serves all listeners; null removes the one of [sessionId].
+  void setHealthListener(
+    String sessionId,
+    void Function(Map<dynamic, dynamic> sessions)? listener,
+  ) {
+    if (listener == null) {
+      _healthListeners.remove(sessionId);
+    } else {
+      _healthListeners[sessionId] = listener;
+    }
+    if (_healthListeners.isEmpty) {
+      _healthTimer?.cancel();
+      _healthTimer = null;
+    } else {
+      _healthTimer ??= Timer.periodic(
+        UIConstants.streamHealthPollInterval,
+        (_) => _sampleHealth(),
+      );
+    }
+  }
+
+  Future<void> _sampleHealth() async {
+    final stats = await NativeVideoDecoderService.getStats();
+    final sessions = stats?['sessions'];
+    if (sessions is! Map) return;
+    for (final listener in List.of(_healthListeners.values)) {
+      listener(sessions);
+    }
+  }
+
   void sendControl(String sessionId, List<int> data) {
+    if (data.isNotEmpty && _tappedTypes.contains(data[0])) {
+      _controlTaps[sessionId]?.call(data);
+    }
     for (final worker in _workers) {
       worker.sendPort.send(
         VideoWorkerCommand(
@@ -178,6 +240,9 @@ class VideoWorkerManager {
   }
 
   void dispose() {
+    _healthTimer?.cancel();
+    _healthTimer = null;
+    _healthListeners.clear();
     for (final worker in _workers) {
       worker.isolate.kill();
     }
@@ -248,6 +313,7 @@ class _IsolateVideoSession {
 
   ServerSocket? _adbServerSocket;
   ServerSocket? _proxyServerSocket;
+  ServerSocket? _controlProxyServerSocket;
   Socket? _adbSocket;
   Socket? _controlSocket;
   Socket? _playerSocket;
@@ -277,15 +343,32 @@ class _IsolateVideoSession {
       _proxyServerSocket = await ServerSocket.bind(InternetAddress.anyIPv4, 0);
       final proxyPort = _proxyServerSocket!.port;
 
+      // 3. Control input from native code (input replay), loopback only
+      _controlProxyServerSocket = await ServerSocket.bind(
+        InternetAddress.loopbackIPv4,
+        0,
+      );
+      final controlPort = _controlProxyServerSocket!.port;
+
       // Báo cáo port về Main Isolate
       eventPort?.send(
         VideoWorkerEvent(
           sessionId: sessionId,
           type: 'ports_ready',
-          data: {'adbPort': adbPort, 'proxyPort': proxyPort},
+          data: {
+            'adbPort': adbPort,
+            'proxyPort': proxyPort,
+            'controlPort': controlPort,
+          },
         ),
       );
 
+      // Bytes written here go to the device as they are
+      _controlProxyServerSocket!.listen((socket) {
+        socket.setOption(SocketOption.tcpNoDelay, true);
+        socket.listen(sendControl, onError: (_) {}, cancelOnError: true);
+      });
+
       // Lắng nghe kết nối từ ADB
       _adbServerSocket!.listen((socket) {
         _connectionCount++;
@@ -525,5 +608,6 @@ class _IsolateVideoSession {
     _playerSocket?.destroy();
     _adbServerSocket?.close();
     _proxyServerSocket?.close();
+    _controlProxyServerSocket?.close();
   }
 }
@@ -203,6 +203,15 @@ class InjectTextControlMessage extends ControlMessage {
   }
 }
 
+/// Asks the server to restart the video encoder, so the stream resumes with
+/// config and a keyframe (scrcpy 3.0+).
+class ResetVideoControlMessage extends ControlMessage {
+  static const int typeResetVideo = 17; // 0x11
+
+  @override
+  Uint8List serialize() => Uint8List.fromList([typeResetVideo]);
+}
+
 class SetClipboardControlMessage extends ControlMessage {
   static const int typeSetClipboard = 9; // 0x09
 
@@ -8,6 +8,10 @@ class MirrorSession {
   final String scid;
   final NativeVideoDecoderService decoderService;
 
+  /// Loopback port whose bytes are forwarded to the device's control socket,
+  /// used to replay input scripts.
+  final int? controlPort;
+
   MirrorSession({
     required this.videoUrl,
     required this.width,
@@ -15,5 +19,6 @@ class MirrorSession {
     required this.port,
     required this.scid,
     required this.decoderService,
+    this.controlPort,
   });
 }
@@ -0,0 +1,50 @@
+import 'dart:math' as math;
+import 'package:flutter/material.dart';
+import 'native_video_decoder_service.dart';
+
+/// Renders one tile of a shared atlas texture.
+///
+/// Every tile of a page draws the same [Texture], so the engine uploads the
+/// page once per frame no matter how many devices it holds.
+class NativeAtlasTileView extends StatelessWidget {
+  final NativeAtlasTile tile;
+
+  const NativeAtlasTileView({super.key, required this.tile});
+
+  @override
+  Widget build(BuildContext context) {
+    return LayoutBuilder(
+      builder: (context, constraints) {
+        final scale = math.min(
+          constraints.maxWidth / tile.width,
+          constraints.maxHeight / tile.height,
+        );
+        if (!scale.isFinite || scale <= 0) return const SizedBox.shrink();
+
+        return Center(
+          child: SizedBox(
+            width: tile.width * scale,
+            height: tile.height * scale,
+            child: ClipRect(
+              child: OverflowBox(
+                alignment: Alignment.topLeft,
+                minWidth: 0,
+                minHeight: 0,
+                maxWidth: double.infinity,
+                maxHeight: double.infinity,
+                child: Transform.translate(
+                  offset: Offset(-tile.x * scale, -tile.y * scale),
+                  child: SizedBox(
+                    width: tile.atlasWidth * scale,
+                    height: tile.atlasHeight * scale,
+                    child: Texture(textureId: tile.atlasTextureId),
+                  ),
+                ),
+              ),
+            ),
+          ),
+        );
+      },
+    );
+  }
+}
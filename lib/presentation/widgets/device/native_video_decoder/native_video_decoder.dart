@@ -1,6 +1,7 @@
 import 'package:flutter/material.dart';
 import 'package:flutter_mobx/flutter_mobx.dart';
 import 'package:scraki/presentation/widgets/device/native_video_decoder/store/native_video_decoder_store.dart';
+import 'native_atlas_tile_view.dart';
 import 'native_video_decoder_service.dart';
 
 /// A widget that decodes and displays a native video stream using Texture.
@@ -27,6 +28,21 @@ class NativeVideoDecoder extends StatefulWidget {
   /// When false, texture will be released to save GPU memory.
   final bool isVisible;
 
+  /// Render from a shared atlas page (grid mode) instead of a per-device
+  /// texture.
+  final bool useAtlas;
+
+  /// Native scheduling class of this view's session.
+  final SessionPriority priority;
+
+  /// Render a downscaled output of the session that fits into this size
+  /// (0 = the full-size texture). Views sharing one stream each pick their
+  /// own size without a second decode.
+  final int outputMaxSize;
+
+  /// Frame rate cap of that output (0 = every frame).
+  final int outputMaxFps;
+
   const NativeVideoDecoder({
     super.key,
     required this.streamUrl,
@@ -36,6 +52,10 @@ class NativeVideoDecoder extends StatefulWidget {
     this.fit = BoxFit.contain,
     this.onError,
     this.isVisible = true,
+    this.useAtlas = false,
+    this.priority = SessionPriority.visible,
+    this.outputMaxSize = 0,
+    this.outputMaxFps = 0,
   });
 
   @override
@@ -54,6 +74,10 @@ class _NativeVideoDecoderState extends State<NativeVideoDecoder> {
       service: widget.service,
       isVisible: widget.isVisible,
       onError: widget.onError,
+      useAtlas: widget.useAtlas,
+      priority: widget.priority,
+      outputMaxSize: widget.outputMaxSize,
+      outputMaxFps: widget.outputMaxFps,
     );
     super.initState();
   }
@@ -106,7 +130,14 @@ class _NativeVideoDecoderState extends State<NativeVideoDecoder> {
           );
         }
 
-        return Texture(textureId: _store.textureId!);
+        final atlasTile = _store.atlasTile;
+        if (atlasTile != null) {
+          return NativeAtlasTileView(tile: atlasTile);
+        }
+
+        return Texture(
+          textureId: _store.outputTextureId ?? _store.textureId!,
+        );
       },
     );
   }
@@ -1,28 +1,274 @@
 import 'dart:async';
+import 'dart:typed_data';
 import 'package:flutter/services.dart';
 import '../../../../core/utils/logger.dart';
 
+/// Scheduling class of a native session. Under CPU pressure the native
+/// governor degrades [background] first, then [visible]; [interactive]
+/// (the device being controlled) is never degraded.
+enum SessionPriority { interactive, visible, background }
+
 class _DecoderSession {
   final int textureId;
   int refCount;
   Timer? stopTimer;
+
+  /// Priority requested by each holder; the highest one applies.
+  final List<SessionPriority> priorities = [];
+
+  /// Holders attached to the atlas, and how many of them asked for
+  /// atlas-only.
+  int atlasRefs = 0;
+  int atlasOnlyRefs = 0;
+
   _DecoderSession(this.textureId, {required this.refCount});
+
+  /// The session texture may stop only while no holder renders from it.
+  bool get atlasOnly => atlasRefs > 0 && atlasOnlyRefs >= refCount;
+
+  SessionPriority get effectivePriority => priorities.isEmpty
+      ? SessionPriority.background
+      : priorities.reduce((a, b) => a.index <= b.index ? a : b);
+}
+
+/// Location of a session's tile inside a shared atlas texture.
+class NativeAtlasTile {
+  final int atlasTextureId;
+  final int atlasWidth;
+  final int atlasHeight;
+  final int x;
+  final int y;
+  final int width;
+  final int height;
+
+  const NativeAtlasTile({
+    required this.atlasTextureId,
+    required this.atlasWidth,
+    required this.atlasHeight,
+    required this.x,
+    required this.y,
+    required this.width,
+    required this.height,
+  });
+
+  factory NativeAtlasTile.fromMap(Map<dynamic, dynamic> map) {
+    return NativeAtlasTile(
+      atlasTextureId: map['atlasTextureId'] as int,
+      atlasWidth: map['atlasWidth'] as int,
+      atlasHeight: map['atlasHeight'] as int,
+      x: map['x'] as int,
+      y: map['y'] as int,
+      width: map['width'] as int,
+      height: map['height'] as int,
+    );
+  }
+}
+
+/// A scrub texture over a frozen copy of a session's time-shift window.
+/// Timestamps are device PTS in microseconds.
+class TimeShiftPlayer {
+  final int playerTextureId;
+  final int startPtsUs;
+  final int endPtsUs;
+
+  /// Seeking close after one of these is cheapest.
+  final List<int> keyFramePtsUs;
+
+  const TimeShiftPlayer({
+    required this.playerTextureId,
+    required this.startPtsUs,
+    required this.endPtsUs,
+    required this.keyFramePtsUs,
+  });
+
+  Duration get duration => Duration(microseconds: endPtsUs - startPtsUs);
+
+  factory TimeShiftPlayer.fromMap(Map<dynamic, dynamic> map) {
+    return TimeShiftPlayer(
+      playerTextureId: map['playerTextureId'] as int,
+      startPtsUs: map['startPtsUs'] as int,
+      endPtsUs: map['endPtsUs'] as int,
+      keyFramePtsUs: (map['keyFramePtsUs'] as List).cast<int>(),
+    );
+  }
+}
+
+/// One native frame check, see [NativeVideoDecoderService.configureAnalysis].
+class FrameAnalyzerConfig {
+  final Map<String, Object> _map;
+
+  const FrameAnalyzerConfig._(this._map);
+
+  /// Reports `black` when at most [maxBrightFraction] of the pixels have a
+  /// luma above [threshold].
+  factory FrameAnalyzerConfig.black({
+    String id = 'black',
+    int threshold = 24,
+    double maxBrightFraction = 0.01,
+  }) {
+    return FrameAnalyzerConfig._({
+      'type': 'black',
+      'id': id,
+      'threshold': threshold,
+      'maxBrightFraction': maxBrightFraction,
+    });
+  }
+
+  /// Reports `frozen` once the mean luma difference between analyzed frames
+  /// stays within [tolerance] for [duration]; noise such as a blinking
+  /// cursor does not count as change.
+  factory FrameAnalyzerConfig.frozen({
+    String id = 'frozen',
+    Duration duration = const Duration(seconds: 3),
+    double tolerance = 2.0,
+  }) {
+    return FrameAnalyzerConfig._({
+      'type': 'frozen',
+      'id': id,
+      'durationMs': duration.inMilliseconds,
+      'tolerance': tolerance,
+    });
+  }
+
+  /// Reports `matched` when the grayscale [pixels] ([width] x [height] at
+  /// stream resolution) appear with a normalized correlation of at least
+  /// [threshold], searching only [region] when given.
+  factory FrameAnalyzerConfig.template({
+    required String id,
+    required Uint8List pixels,
+    required int width,
+    required int height,
+    double threshold = 0.85,
+    ({int x, int y, int width, int height})? region,
+  }) {
+    return FrameAnalyzerConfig._({
+      'type': 'template',
+      'id': id,
+      'pixels': pixels,
+      'width': width,
+      'height': height,
+      'threshold': threshold,
+      if (region != null) ...{
+        'regionX': region.x,
+        'regionY': region.y,
+        'regionWidth': region.width,
+        'regionHeight': region.height,
+      },
+    });
+  }
+
+  Map<String, Object> toMap() => _map;
+}
+
+/// A device to replay an input script on, see
+/// [NativeVideoDecoderService.replayInputScript].
+class InputReplayTarget {
+  /// Loopback port forwarding to the device's control socket (the mirror
+  /// session's `controlPort`).
+  final int controlPort;
+
+  /// Positions are rescaled to this session's decoded size, unless [width]
+  /// and [height] are given.
+  final int? textureId;
+  final int? width;
+  final int? height;
+
+  const InputReplayTarget({
+    required this.controlPort,
+    this.textureId,
+    this.width,
+    this.height,
+  });
+
+  Map<String, Object> toMap() => {
+    'controlPort': controlPort,
+    if (textureId != null) 'textureId': textureId!,
+    if (width != null) 'width': width!,
+    if (height != null) 'height': height!,
+  };
 }
 
 class NativeVideoDecoderService {
   static const _channel = MethodChannel('scraki/video_decoder');
 
+  static final _events = StreamController<Map<String, dynamic>>.broadcast();
+  static bool _eventsBound = false;
+
+  /// Events pushed by the native decoder (`onSessionEvent`). Every event has
+  /// `textureId` and `type`:
+  /// - `idle`: carries an `idle` flag that flips when the device screen stops
+  ///   or starts changing.
+  /// - `reconnecting` / `reconnected` (with `elapsedMs`): the stream socket
+  ///   dropped and the native side is reconnecting; the texture stays valid.
+  /// - `disconnected`: reconnecting gave up, the session must be restarted.
+  /// - `keyframeRequested` (with `reason`: overflow, framing, decode,
+  ///   reference or corrupt): the stream was damaged and nothing is shown
+  ///   until the next keyframe; repeated every second until one arrives.
+  /// - `recovered` (with `reason`, `elapsedMs`): a keyframe decoded cleanly
+  ///   after a loss.
+  /// - `analysis`: a configured analyzer changed state; carries `analyzer`
+  ///   (its id), `ptsUs` and the analyzer's fields (`black`, `frozen`,
+  ///   `matched` with `score`, `x`, `y`, ...).
+  static Stream<Map<String, dynamic>> get sessionEvents {
+    _bindEvents();
+    return _events.stream;
+  }
+
+  /// Emits whenever the screen of [textureId] becomes idle or active again.
+  static Stream<bool> idleChanges(int textureId) {
+    return sessionEvents
+        .where((e) => e['type'] == 'idle' && e['textureId'] == textureId)
+        .map((e) => e['idle'] == true);
+  }
+
+  /// Analysis results of [textureId], see [configureAnalysis].
+  static Stream<Map<String, dynamic>> analysisEvents(int textureId) {
+    return sessionEvents.where(
+      (e) => e['type'] == 'analysis' && e['textureId'] == textureId,
+    );
+  }
+
+  /// Loss recovery events of [textureId] (`keyframeRequested`, `recovered`).
+  static Stream<Map<String, dynamic>> recoveryEvents(int textureId) {
+    return sessionEvents.where(
+      (e) =>
+          (e['type'] == 'keyframeRequested' || e['type'] == 'recovered') &&
+          e['textureId'] == textureId,
+    );
+  }
+
+  static void _bindEvents() {
+    if (_eventsBound) return;
+    _eventsBound = true;
+    _channel.setMethodCallHandler((call) async {
+      if (call.method == 'onSessionEvent' && call.arguments is Map) {
+        _events.add(Map<String, dynamic>.from(call.arguments as Map));
+      }
+    });
+  }
+
   // Map of URL -> Session info
   final Map<String, _DecoderSession> _sessions = {};
 
-  Future<int?> start(String url) async {
+  /// Native texture of the running session for [url], if any.
+  int? textureIdFor(String url) => _sessions[url]?.textureId;
+
+  Future<int?> start(
+    String url, {
+    SessionPriority priority = SessionPriority.visible,
+  }) async {
+    _bindEvents();
     try {
       // 1. If session exists for this URL, just increment refCount and return textureId
       if (_sessions.containsKey(url)) {
         final session = _sessions[url]!;
         session.stopTimer?.cancel();
         session.stopTimer = null;
+        final wasAtlasOnly = session.atlasOnly;
         session.refCount++;
+        session.priorities.add(priority);
+        _applyPriority(session);
+        _syncAtlasOnly(session, wasAtlasOnly);
         logger.i(
           '[NativeVideoDecoderService] Reusing texture ${session.textureId} for $url (RefCount: ${session.refCount})',
         );
@@ -33,7 +279,10 @@ class NativeVideoDecoderService {
       logger.i('[NativeVideoDecoderService] Requesting startDecoding for $url');
       final result = await _channel.invokeMethod('startDecoding', {'url': url});
       if (result is int) {
-        _sessions[url] = _DecoderSession(result, refCount: 1);
+        final session = _DecoderSession(result, refCount: 1);
+        session.priorities.add(priority);
+        _sessions[url] = session;
+        _applyPriority(session);
         return result;
       }
       return null;
@@ -43,11 +292,18 @@ class NativeVideoDecoderService {
     }
   }
 
-  Future<void> stop(String url) async {
+  Future<void> stop(
+    String url, {
+    SessionPriority priority = SessionPriority.visible,
+  }) async {
     final session = _sessions[url];
     if (session == null) return;
 
+    final wasAtlasOnly = session.atlasOnly;
     session.refCount--;
+    session.priorities.remove(priority);
+    _applyPriority(session);
+    if (session.refCount > 0) _syncAtlasOnly(session, wasAtlasOnly);
     logger.i(
       '[NativeVideoDecoderService] Decremented RefCount for $url (Remaining: ${session.refCount})',
     );
@@ -77,4 +333,822 @@ class NativeVideoDecoderService {
       );
     }
   }
+
+  _DecoderSession? _sessionFor(int textureId) {
+    for (final session in _sessions.values) {
+      if (session.textureId == textureId) return session;
+    }
+    return null;
+  }
+
+  /// Re-attaches with the new mode when holders changed whether the session
+  /// texture is still needed.
+  void _syncAtlasOnly(_DecoderSession session, bool wasAtlasOnly) {
+    if (session.atlasRefs == 0 || session.atlasOnly == wasAtlasOnly) return;
+    _attachToAtlas(session.textureId, session.atlasOnly);
+  }
+
+  void _applyPriority(_DecoderSession session) {
+    setSessionPriority(session.textureId, session.effectivePriority);
+  }
+
+  /// Sets the native scheduling class of [textureId]. Sessions started
+  /// through [start] are managed automatically from their holders.
+  Future<void> setSessionPriority(
+    int textureId,
+    SessionPriority priority,
+  ) async {
+    try {
+      await _channel.invokeMethod('setSessionPriority', {
+        'textureId': textureId,
+        'priority': priority.name,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error setting session priority',
+        error: e,
+      );
+    }
+  }
+
+  /// Share of all CPU cores (0-100) the decoders may use before lower
+  /// priority sessions are degraded (fewer fps, half-size conversion,
+  /// keyframes only). 0 disables the governor.
+  static Future<void> configureCpuBudget(int percent) async {
+    try {
+      await _channel.invokeMethod('configureCpuBudget', {'percent': percent});
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring CPU budget',
+        error: e,
+      );
+    }
+  }
+
+  /// Pins each decoder thread to a core (performance cores for interactive
+  /// sessions, efficiency cores for background ones on hybrid CPUs) and
+  /// allocates its frame buffers on that core's NUMA node. Running sessions
+  /// move with their next frame.
+  static Future<void> configureCpuPinning(bool enabled) async {
+    try {
+      await _channel.invokeMethod('configureCpuPinning', {'enabled': enabled});
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring CPU pinning',
+        error: e,
+      );
+    }
+  }
+
+  /// Measures YUV to RGBA conversion throughput of [threads] threads (one
+  /// per core by default), free-running and pinned with node-local buffers,
+  /// for [duration] each in alternating halves. Fewer threads run when their
+  /// buffers would exceed 1 GB; one benchmark runs at a time. Returns
+  /// threads, unpinnedFps, pinnedFps and speedup.
+  static Future<Map<String, dynamic>?> runPlacementBenchmark({
+    int? threads,
+    Duration duration = const Duration(seconds: 3),
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('runPlacementBenchmark', {
+        if (threads != null) 'threads': threads,
+        'seconds': duration.inSeconds,
+      });
+      if (result is Map) return Map<String, dynamic>.from(result);
+      return null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error running placement benchmark',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Remuxes the compressed stream of [textureId] into [path] (.mp4/.mkv)
+  /// without decoding or re-encoding. Returns false if it could not start.
+  Future<bool> startRecording(int textureId, String path) async {
+    try {
+      logger.i(
+        '[NativeVideoDecoderService] Start recording texture $textureId to $path',
+      );
+      final result = await _channel.invokeMethod('startRecording', {
+        'textureId': textureId,
+        'path': path,
+      });
+      return result == true;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error starting recording',
+        error: e,
+      );
+      return false;
+    }
+  }
+
+  /// Stops the recording of [textureId] and returns its summary
+  /// (path, packetsWritten, packetsDropped, bytesWritten, durationMs, and
+  /// failed when the file could not be started).
+  Future<Map<String, dynamic>?> stopRecording(int textureId) async {
+    try {
+      final result = await _channel.invokeMethod('stopRecording', {
+        'textureId': textureId,
+      });
+      if (result is Map) {
+        logger.i(
+          '[NativeVideoDecoderService] Stopped recording texture $textureId: $result',
+        );
+        return Map<String, dynamic>.from(result);
+      }
+      return null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error stopping recording',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Re-serves the compressed stream of [textureId] on a TCP port, in the
+  /// scrcpy packet framing, so more viewers can watch the device without
+  /// another encode on it. Viewers join at the latest keyframe; slow ones
+  /// skip to the next one. [port] 0 picks a free port; [address] is the
+  /// interface to listen on (loopback by default). Returns {address, port},
+  /// or null if it could not listen.
+  Future<Map<String, dynamic>?> startRelay(
+    int textureId, {
+    int port = 0,
+    String address = '127.0.0.1',
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('startRelay', {
+        'textureId': textureId,
+        'port': port,
+        'address': address,
+      });
+      if (result is Map) return Map<String, dynamic>.from(result);
+      return null;
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error starting relay', error: e);
+      return null;
+    }
+  }
+
+  /// Stops the relay of [textureId], disconnecting its viewers, and returns
+  /// its counters (port, viewers, viewersTotal, bytesSent, gopsDropped).
+  Future<Map<String, dynamic>?> stopRelay(int textureId) async {
+    try {
+      final result = await _channel.invokeMethod('stopRelay', {
+        'textureId': textureId,
+      });
+      if (result is Map) return Map<String, dynamic>.from(result);
+      return null;
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error stopping relay', error: e);
+      return null;
+    }
+  }
+
+  /// Sets the tile size and grid of atlas pages created from now on.
+  static Future<void> configureAtlas({
+    int tileWidth = 270,
+    int tileHeight = 480,
+    int columns = 8,
+    int rows = 4,
+  }) async {
+    try {
+      await _channel.invokeMethod('configureAtlas', {
+        'tileWidth': tileWidth,
+        'tileHeight': tileHeight,
+        'columns': columns,
+        'rows': rows,
+      });
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error configuring atlas', error: e);
+    }
+  }
+
+  /// Composites [textureId] into a shared atlas page. [atlasOnly] says this
+  /// holder does not render the full-size texture; the session stops
+  /// updating it only while that is true of every holder of the session.
+  /// Each attach must be paired with a [detachFromAtlas] with the same flag.
+  Future<NativeAtlasTile?> attachToAtlas(
+    int textureId, {
+    bool atlasOnly = false,
+  }) async {
+    final session = _sessionFor(textureId);
+    if (session != null) {
+      session.atlasRefs++;
+      if (atlasOnly) session.atlasOnlyRefs++;
+    }
+    return _attachToAtlas(textureId, session?.atlasOnly ?? atlasOnly);
+  }
+
+  Future<NativeAtlasTile?> _attachToAtlas(int textureId, bool atlasOnly) async {
+    try {
+      final result = await _channel.invokeMethod('attachToAtlas', {
+        'textureId': textureId,
+        'atlasOnly': atlasOnly,
+      });
+      if (result is Map) return NativeAtlasTile.fromMap(result);
+      return null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error attaching to atlas',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Ends one [attachToAtlas]; the tile is released with the last holder.
+  Future<void> detachFromAtlas(int textureId, {bool atlasOnly = false}) async {
+    final session = _sessionFor(textureId);
+    if (session != null) {
+      final wasAtlasOnly = session.atlasOnly;
+      session.atlasRefs--;
+      if (atlasOnly) session.atlasOnlyRefs--;
+      if (session.atlasRefs > 0) {
+        _syncAtlasOnly(session, wasAtlasOnly);
+        return;
+      }
+    }
+    try {
+      await _channel.invokeMethod('detachFromAtlas', {'textureId': textureId});
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error detaching from atlas',
+        error: e,
+      );
+    }
+  }
+
+  /// Registers an extra texture fed from the decode of [textureId], fitted
+  /// into [maxWidth] x [maxHeight] (0 = no limit) and capped at [maxFps]
+  /// (0 = every frame). [format] is `rgba` or `gray`. Several views of one
+  /// device can share a single stream this way. Returns the new texture id.
+  ///
+  /// The grid and focus views do not use this yet: each still starts its own
+  /// scrcpy stream, because the grid stream is capped to a size too small
+  /// for the focus view.
+  Future<int?> addOutput(
+    int textureId, {
+    int maxWidth = 0,
+    int maxHeight = 0,
+    String format = 'rgba',
+    int maxFps = 0,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('addOutput', {
+        'textureId': textureId,
+        'maxWidth': maxWidth,
+        'maxHeight': maxHeight,
+        'format': format,
+        'maxFps': maxFps,
+      });
+      return result is int ? result : null;
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error adding output', error: e);
+      return null;
+    }
+  }
+
+  Future<void> removeOutput(int textureId, int outputTextureId) async {
+    try {
+      await _channel.invokeMethod('removeOutput', {
+        'textureId': textureId,
+        'outputTextureId': outputTextureId,
+      });
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error removing output', error: e);
+    }
+  }
+
+  /// Publishes every converted frame of [textureId] into a shared-memory
+  /// ring of [slots] frames for external analysis processes, read with the
+  /// C library in windows/frame_reader. [maxSize] bounds the longer edge the
+  /// ring is sized for (0 = current stream size). Returns the mapping name.
+  Future<String?> startFrameExport(
+    int textureId, {
+    int slots = 3,
+    int maxSize = 0,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('startFrameExport', {
+        'textureId': textureId,
+        'slots': slots,
+        'maxSize': maxSize,
+      });
+      return result is String ? result : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error starting frame export',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  Future<void> stopFrameExport(int textureId) async {
+    try {
+      await _channel.invokeMethod('stopFrameExport', {'textureId': textureId});
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error stopping frame export',
+        error: e,
+      );
+    }
+  }
+
+  /// Keeps the last [window] of compressed video of [textureId] in memory,
+  /// at most [maxMegabytes]; [Duration.zero] turns it off. The window
+  /// restarts empty and fills from the next key frame.
+  Future<bool> configureTimeShift(
+    int textureId, {
+    Duration window = const Duration(seconds: 30),
+    int maxMegabytes = 32,
+  }) async {
+    try {
+      await _channel.invokeMethod('configureTimeShift', {
+        'textureId': textureId,
+        'seconds': window.inSeconds,
+        'maxMegabytes': maxMegabytes,
+      });
+      return true;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring time-shift',
+        error: e,
+      );
+      return false;
+    }
+  }
+
+  /// Bounds the time-shift memory of all sessions together (0 = no bound).
+  /// Above it every session trims its window to an equal share.
+  static Future<void> configureTimeShiftBudget(int megabytes) async {
+    try {
+      await _channel.invokeMethod('configureTimeShiftBudget', {
+        'megabytes': megabytes,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring time-shift budget',
+        error: e,
+      );
+    }
+  }
+
+  /// Remuxes the time-shift window of [textureId] (its last [window] only
+  /// when given) into [path], without re-encoding. Returns the summary
+  /// (path, packetsWritten, bytesWritten, durationMs).
+  Future<Map<String, dynamic>?> dumpTimeShift(
+    int textureId,
+    String path, {
+    Duration? window,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('dumpTimeShift', {
+        'textureId': textureId,
+        'path': path,
+        'seconds': window?.inSeconds ?? 0,
+      });
+      return result is Map ? Map<String, dynamic>.from(result) : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error dumping time-shift',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Opens a scrub texture over the current time-shift window of
+  /// [textureId]. It decodes on its own and stays valid after the session
+  /// stops, until [closeTimeShiftPlayer].
+  Future<TimeShiftPlayer?> openTimeShiftPlayer(
+    int textureId, {
+    Duration? window,
+    int maxSize = 0,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('openTimeShiftPlayer', {
+        'textureId': textureId,
+        'seconds': window?.inSeconds ?? 0,
+        'maxSize': maxSize,
+      });
+      return result is Map ? TimeShiftPlayer.fromMap(result) : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error opening time-shift player',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Shows the last frame at or before [ptsUs]. Returns the PTS shown, or
+  /// null when a later seek replaced this one first.
+  Future<int?> seekTimeShiftPlayer(int playerTextureId, int ptsUs) async {
+    try {
+      final result = await _channel.invokeMethod('seekTimeShiftPlayer', {
+        'playerTextureId': playerTextureId,
+        'ptsUs': ptsUs,
+      });
+      return result is int ? result : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error seeking time-shift player',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  Future<void> closeTimeShiftPlayer(int playerTextureId) async {
+    try {
+      await _channel.invokeMethod('closeTimeShiftPlayer', {
+        'playerTextureId': playerTextureId,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error closing time-shift player',
+        error: e,
+      );
+    }
+  }
+
+  /// Runs [analyzers] on the luma plane of [textureId] off the decoder
+  /// threads, at most every [interval] and on images [downsample] times
+  /// smaller than the stream. Replaces the previous set; an empty list
+  /// stops analysis. Results arrive on [analysisEvents].
+  Future<bool> configureAnalysis(
+    int textureId,
+    List<FrameAnalyzerConfig> analyzers, {
+    Duration interval = const Duration(milliseconds: 200),
+    int downsample = 2,
+  }) async {
+    _bindEvents();
+    try {
+      await _channel.invokeMethod('configureAnalysis', {
+        'textureId': textureId,
+        'intervalMs': interval.inMilliseconds,
+        'downsample': downsample,
+        'analyzers': analyzers.map((a) => a.toMap()).toList(),
+      });
+      return true;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring analysis',
+        error: e,
+      );
+      return false;
+    }
+  }
+
+  /// Holds frames of [textureId] until their capture time plus [delayMs] so
+  /// motion is released on the device cadence. 0 presents immediately (best
+  /// for control), a negative value derives the delay from measured jitter.
+  Future<void> setPresentationDelay(int textureId, int delayMs) async {
+    try {
+      await _channel.invokeMethod('setPresentationDelay', {
+        'textureId': textureId,
+        'delayMs': delayMs,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error setting presentation delay',
+        error: e,
+      );
+    }
+  }
+
+  /// Puts [textureId] in the sync group [group] (created on first use), or
+  /// takes it out with null. Members hold frames until their capture time
+  /// plus a common delay, the slowest member's 95th percentile latency, so
+  /// side-by-side tiles show the same instant. Constant encode and transport
+  /// latency differences between devices are not visible to the clock
+  /// estimate and remain. Replaces [setPresentationDelay] while grouped.
+  /// Only the session's own texture is synchronized: atlas tiles and
+  /// [addOutput] textures update as frames are decoded, so an atlas-only
+  /// session is refused and attaching one with atlasOnly leaves its group.
+  Future<void> setSyncGroup(int textureId, String? group) async {
+    try {
+      await _channel.invokeMethod('setSyncGroup', {
+        'textureId': textureId,
+        'group': group,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error setting sync group',
+        error: e,
+      );
+    }
+  }
+
+  /// Number of pre-opened decoders and parked decoder threads kept ready so
+  /// new sessions skip decoder setup. Stopped sessions refill the pool.
+  static Future<void> configureSessionPool({
+    int decoders = 4,
+    int workers = 4,
+  }) async {
+    try {
+      await _channel.invokeMethod('configureSessionPool', {
+        'decoders': decoders,
+        'workers': workers,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring session pool',
+        error: e,
+      );
+    }
+  }
+
+  /// Decodes sessions started from now on in [count] helper processes
+  /// (scraki_decoder_host.exe), so a decoder crash only restarts the
+  /// sessions of one host. 0 decodes in the app again. Host sessions only
+  /// display and report connection events: per-session calls such as
+  /// recording, relays, outputs, frame export, the atlas, sync groups,
+  /// presentation delay, analysis and time-shift fail on them with
+  /// HOSTED_SESSION, so keep hosts off while those are in use. Fails while
+  /// host sessions run.
+  static Future<bool> configureDecoderHosts(int count) async {
+    try {
+      await _channel.invokeMethod('configureDecoderHosts', {'count': count});
+      return true;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error configuring decoder hosts',
+        error: e,
+      );
+      return false;
+    }
+  }
+
+  /// Decoder-wide counters, session `pool` usage with time-to-first-frame
+  /// percentiles (ttffP50Ms, ttffP99Ms), and per-texture `sessions` (frames,
+  /// jitterMs, addedLatencyMs, presentationDelayMs, reconnects, ...). Each
+  /// session carries a `health` map with its load and recommended encoder
+  /// settings (overloaded, underused, recommendedMaxFps, ...). Sessions in
+  /// decoder hosts are marked `isolated` (decodeMs, handoffMs, hostPid,
+  /// hostRestarts); `decoderHosts` lists the host processes, and
+  /// `decodePaths` compares the in-process and hosted paths side by side
+  /// (sessions, decodeMs, handoffMs, frameLatencyMs); frameLatencyMs is the
+  /// comparable one, from the latest packet received to a frame ready for
+  /// the texture on both paths. `cpu` describes the topology (cores, nodes,
+  /// performanceCores, hybrid, pinning); pinned sessions report cpuCore and
+  /// cpuNode. configChanges counts mid-stream parameter set changes;
+  /// framesSkipped counts non-reference frames left undecoded at a reduced
+  /// frame rate.
+  /// Stream losses are counted in lossIncidents, with lastRecoveryMs /
+  /// maxRecoveryMs and a `recovering` flag.
+  /// frameHash is the latest frame's hash, see [getFrameHash].
+  /// Relayed sessions carry a `relay` map, see [startRelay].
+  /// `frameNotifier` shows how frame marks are batched per display refresh
+  /// (requestsPerSecond, postsPerSecond, averageDelayMs, maxDelayMs,
+  /// refreshHz).
+  /// `syncGroups` lists each group's members, delayMs, skewMs and
+  /// maxErrorMs; grouped sessions report syncGroup and syncErrorMs, and
+  /// their hold time in addedLatencyMs.
+  /// Each session's `activity` map scores how busy its screen is (score
+  /// 0..1, sizeRatio), see [activityScores].
+  static Future<Map<String, dynamic>?> getStats() async {
+    try {
+      final result = await _channel.invokeMethod('getStats');
+      if (result is Map) return Map<String, dynamic>.from(result);
+      return null;
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error reading stats', error: e);
+      return null;
+    }
+  }
+
+  /// Smoothed activity score (0 static .. 1 busy) per texture from a
+  /// [getStats] result, for ordering tiles. Derived from the size of each
+  /// compressed frame against the last keyframe, without looking at pixels;
+  /// it decays to 0 within a few seconds of a screen going still.
+  static Map<int, double> activityScores(Map<String, dynamic>? stats) {
+    final sessions = stats?['sessions'];
+    if (sessions is! Map) return {};
+    final scores = <int, double>{};
+    sessions.forEach((textureId, session) {
+      final activity = session is Map ? session['activity'] : null;
+      final score = activity is Map ? activity['score'] : null;
+      if (textureId is int && score is num) {
+        scores[textureId] = score.toDouble();
+      }
+    });
+    return scores;
+  }
+
+  /// Encodes the newest frame of [textureId] as `png` or `jpeg` off the
+  /// decoder threads. The longer edge is limited to [maxSize] (0 keeps full
+  /// size). Returns `{width, height, bytes}`, or `{width, height, path}` when
+  /// [path] is given.
+  Future<Map<String, dynamic>?> captureFrame(
+    int textureId, {
+    String format = 'png',
+    int maxSize = 0,
+    int quality = 85,
+    String? path,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('captureFrame', {
+        'textureId': textureId,
+        'format': format,
+        'maxSize': maxSize,
+        'quality': quality,
+        'path': path,
+      });
+      if (result is Map) return Map<String, dynamic>.from(result);
+      return null;
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error capturing frame', error: e);
+      return null;
+    }
+  }
+
+  /// Captures every session in one call, keyed by texture id. With
+  /// [directory] each image is written to `<directory>/<textureId>.<ext>`.
+  /// Failed sessions carry an `error` entry instead of image data.
+  static Future<Map<int, Map<String, dynamic>>> captureAllFrames({
+    String format = 'png',
+    int maxSize = 0,
+    int quality = 85,
+    String? directory,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('captureAllFrames', {
+        'format': format,
+        'maxSize': maxSize,
+        'quality': quality,
+        'directory': directory,
+      });
+      if (result is! Map) return {};
+      return result.map(
+        (key, value) => MapEntry(
+          key as int,
+          Map<String, dynamic>.from(value as Map),
+        ),
+      );
+    } catch (e) {
+      logger.e('[NativeVideoDecoderService] Error capturing frames', error: e);
+      return {};
+    }
+  }
+
+  /// Perceptual hash of the newest decoded frame of [textureId]: a 64-bit
+  /// difference hash of the luma plane as 16 hex digits, computed natively
+  /// for every frame. Returns `{hash, ptsUs, ageMs}`, or null before the
+  /// first frame.
+  Future<Map<String, dynamic>?> getFrameHash(int textureId) async {
+    try {
+      final result = await _channel.invokeMethod('getFrameHash', {
+        'textureId': textureId,
+      });
+      return result is Map ? Map<String, dynamic>.from(result) : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error reading frame hash',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Completes once the screen of [textureId] is within [maxDistance] bits
+  /// of [hash] (right away if it already is), or after [timeout]. Returns
+  /// `{matched, hash, distance, ptsUs, elapsedMs}`; `hash` is null when no
+  /// frame was decoded yet. Nothing leaves the device for the comparison.
+  Future<Map<String, dynamic>?> waitForFrameHash(
+    int textureId,
+    String hash, {
+    int maxDistance = 5,
+    Duration timeout = const Duration(seconds: 5),
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('waitForFrameHash', {
+        'textureId': textureId,
+        'hash': hash,
+        'maxDistance': maxDistance,
+        'timeoutMs': timeout.inMilliseconds,
+      });
+      return result is Map ? Map<String, dynamic>.from(result) : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error waiting for frame hash',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Starts collecting control messages for an input script recorded on a
+  /// [width] x [height] screen. Returns the recording id.
+  static Future<int?> startInputRecording({
+    required int width,
+    required int height,
+  }) async {
+    try {
+      return await _channel.invokeMethod<int>('startInputRecording', {
+        'width': width,
+        'height': height,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error starting input recording',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Adds one serialized control message, sent at [timestampUs] on any
+  /// monotonic clock (only differences are kept).
+  static void recordInput(
+    int recordingId,
+    List<int> message,
+    int timestampUs,
+  ) {
+    _channel
+        .invokeMethod('recordInput', {
+          'recordingId': recordingId,
+          'data': Uint8List.fromList(message),
+          'timestampUs': timestampUs,
+        })
+        .catchError((Object e) {
+          logger.e(
+            '[NativeVideoDecoderService] Error recording input',
+            error: e,
+          );
+        });
+  }
+
+  /// Ends the recording and returns the compact binary script, which can be
+  /// saved and passed to [replayInputScript].
+  static Future<Uint8List?> stopInputRecording(int recordingId) async {
+    try {
+      return await _channel.invokeMethod<Uint8List>('stopInputRecording', {
+        'recordingId': recordingId,
+      });
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error stopping input recording',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Re-injects [script] into every target at once from a native timer
+  /// thread, rescaling touch positions to each screen, at [speed] times the
+  /// recorded pace. Completes when the replay ends with its timing report:
+  /// messagesSent, targetsConnected, sendErrors, meanErrorUs, p99ErrorUs,
+  /// maxErrorUs (lateness against the script), maxFanOutUs, durationMs and
+  /// cancelled.
+  static Future<Map<String, dynamic>?> replayInputScript(
+    Uint8List script,
+    List<InputReplayTarget> targets, {
+    double speed = 1.0,
+  }) async {
+    try {
+      final result = await _channel.invokeMethod('replayInputScript', {
+        'script': script,
+        'targets': [for (final target in targets) target.toMap()],
+        'speed': speed,
+      });
+      return result is Map ? Map<String, dynamic>.from(result) : null;
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error replaying input script',
+        error: e,
+      );
+      return null;
+    }
+  }
+
+  /// Stops every running replay; their futures complete with cancelled.
+  static Future<void> cancelInputReplays() async {
+    try {
+      await _channel.invokeMethod('cancelInputReplays');
+    } catch (e) {
+      logger.e(
+        '[NativeVideoDecoderService] Error cancelling input replays',
+        error: e,
+      );
+    }
+  }
+
+  /// Bits differing between two hashes from [getFrameHash] (0..64).
+  static int frameHashDistance(String a, String b) {
+    var diff = BigInt.parse(a, radix: 16) ^ BigInt.parse(b, radix: 16);
+    var bits = 0;
+    while (diff > BigInt.zero) {
+      if (diff.isOdd) bits++;
+      diff >>= 1;
+    }
+    return bits;
+  }
 }
@@ -27,6 +27,21 @@ abstract class _NativeVideoDecoderStore with Store {
   /// Whether the video is currently visible in the viewport.
   /// When false, texture will be released to save GPU memory.
   final bool isVisible;
+
+  /// Whether to render from a shared atlas page instead of the session's
+  /// own texture (grid mode).
+  final bool useAtlas;
+
+  /// Native scheduling class requested for this view.
+  final SessionPriority priority;
+
+  /// When positive, render from an extra output of the session fitted into
+  /// this size instead of the full-size texture.
+  final int outputMaxSize;
+
+  /// Frame rate cap of that output (0 = every frame).
+  final int outputMaxFps;
+
   _NativeVideoDecoderStore({
     required this.streamUrl,
     required this.nativeWidth,
@@ -34,6 +49,10 @@ abstract class _NativeVideoDecoderStore with Store {
     required this.service,
     required this.isVisible,
     required this.onError,
+    this.useAtlas = false,
+    this.priority = SessionPriority.visible,
+    this.outputMaxSize = 0,
+    this.outputMaxFps = 0,
   }) {
     if (isVisible) {
       acquireTexture();
@@ -50,12 +69,31 @@ abstract class _NativeVideoDecoderStore with Store {
   @readonly
   bool _isInitializing = true;
 
+  @readonly
+  NativeAtlasTile? _atlasTile;
+
+  @readonly
+  int? _outputTextureId;
+
   @action
   Future<void> acquireTexture() async {
     _isInitializing = true;
     try {
       logger.i('[NativeVideoDecoder] Acquiring texture for $streamUrl');
-      _textureId = await service.start(streamUrl);
+      _textureId = await service.start(streamUrl, priority: priority);
+      if (useAtlas && _textureId != null) {
+        _atlasTile = await service.attachToAtlas(
+          _textureId!,
+          atlasOnly: true,
+        );
+      } else if (outputMaxSize > 0 && _textureId != null) {
+        _outputTextureId = await service.addOutput(
+          _textureId!,
+          maxWidth: outputMaxSize,
+          maxHeight: outputMaxSize,
+          maxFps: outputMaxFps,
+        );
+      }
       _isInitializing = false;
       logger.i('[NativeVideoDecoder] Received texture ID: $_textureId');
     } catch (e) {
@@ -68,7 +106,15 @@ abstract class _NativeVideoDecoderStore with Store {
   void releaseTexture() {
     if (_textureId != null) {
       logger.i('[NativeVideoDecoder] Releasing texture for $streamUrl');
-      service.stop(streamUrl);
+      if (_atlasTile != null) {
+        service.detachFromAtlas(_textureId!, atlasOnly: true);
+        _atlasTile = null;
+      }
+      if (_outputTextureId != null) {
+        service.removeOutput(_textureId!, _outputTextureId!);
+        _outputTextureId = null;
+      }
+      service.stop(streamUrl, priority: priority);
       _textureId = null;
     }
   }
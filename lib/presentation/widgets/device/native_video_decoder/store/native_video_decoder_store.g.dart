@@ -49,6 +49,46 @@ mixin _$NativeVideoDecoderStore on _NativeVideoDecoderStore, Store {
     });
   }
 
+  late final _$_atlasTileAtom = Atom(
+    name: '_NativeVideoDecoderStore._atlasTile',
+    context: context,
+  );
+
+  NativeAtlasTile? get atlasTile {
+    _$_atlasTileAtom.reportRead();
+    return super._atlasTile;
+  }
+
+  @override
+  NativeAtlasTile? get _atlasTile => atlasTile;
+
+  @override
+  set _atlasTile(NativeAtlasTile? value) {
+    _$_atlasTileAtom.reportWrite(value, super._atlasTile, () {
+      super._atlasTile = value;
+    });
+  }
+
+  late final _$_outputTextureIdAtom = Atom(
+    name: '_NativeVideoDecoderStore._outputTextureId',
+    context: context,
+  );
+
+  int? get outputTextureId {
+    _$_outputTextureIdAtom.reportRead();
+    return super._outputTextureId;
+  }
+
+  @override
+  int? get _outputTextureId => outputTextureId;
+
+  @override
+  set _outputTextureId(int? value) {
+    _$_outputTextureIdAtom.reportWrite(value, super._outputTextureId, () {
+      super._outputTextureId = value;
+    });
+  }
+
   late final _$acquireTextureAsyncAction = AsyncAction(
     '_NativeVideoDecoderStore.acquireTexture',
     context: context,
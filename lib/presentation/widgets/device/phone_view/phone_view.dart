@@ -11,6 +11,7 @@ import '../../../widgets/common/loading_view.dart';
 import '../../../widgets/common/error_view.dart';
 import '../../../widgets/common/connection_lost_view.dart';
 import '../native_video_decoder/native_video_decoder.dart';
+import '../native_video_decoder/native_video_decoder_service.dart';
 import 'widgets/mirror_navigation_bar.dart';
 import 'widgets/drag_overlay_view.dart';
 import 'widgets/push_progress_view.dart';
@@ -220,6 +221,11 @@ class _PhoneViewState extends State<PhoneView> {
                   service: session.decoderService,
                   fit: widget.fit,
                   isVisible: _store.isVisible,
+                  useAtlas:
+                      !widget.isFloating && UIConstants.gridUsesTextureAtlas,
+                  priority: widget.isFloating
+                      ? SessionPriority.interactive
+                      : SessionPriority.visible,
                   onError: (error) =>
                       _store.setDecoderError(widget.serial, error),
                 );
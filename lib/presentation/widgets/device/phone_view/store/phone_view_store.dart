@@ -1,4 +1,5 @@
 import 'dart:async';
+import 'dart:typed_data';
 import 'package:flutter/gestures.dart';
 import 'package:flutter/services.dart';
 import 'package:mobx/mobx.dart';
@@ -8,6 +9,7 @@ import 'package:scraki/core/utils/android_key_codes.dart';
 import 'package:scraki/core/utils/logger.dart';
 import 'package:scraki/data/datasources/scrcpy_client.dart';
 import 'package:scraki/data/services/scrcpy_service.dart';
+import 'package:scraki/data/services/stream_adaptation_controller.dart';
 import 'package:scraki/data/services/video_worker_manager.dart';
 import 'package:scraki/data/utils/scrcpy_input_serializer.dart';
 import 'package:scraki/domain/entities/mirror_session.dart';
@@ -56,6 +58,14 @@ abstract class _PhoneViewStore with Store, MirroringStoreMixin {
 
   ReactionDisposer? _floatingDisposer;
 
+  StreamAdaptationController? _adaptation;
+  bool _sampling = false;
+  bool _isAdapting = false;
+
+  StreamSubscription<Map<String, dynamic>>? _recoverySubscription;
+  int? _inputRecordingId;
+  final Stopwatch _inputClock = Stopwatch()..start();
+
   _PhoneViewStore(this.serial, this.isFloatingView) {
     sessionId = isFloatingView ? '${serial}_floating' : '${serial}_grid';
     initializing();
@@ -85,6 +95,7 @@ abstract class _PhoneViewStore with Store, MirroringStoreMixin {
   void dispose() {
     setVisibility(serial, false, isFloating: isFloatingView);
     _floatingDisposer?.call();
+    _stopAdaptation();
     stopMirroring();
   }
 
@@ -216,6 +227,7 @@ abstract class _PhoneViewStore with Store, MirroringStoreMixin {
       );
       final adbPort = portsData['adbPort'] as int;
       final proxyPort = portsData['proxyPort'] as int;
+      final controlPort = portsData['controlPort'] as int?;
 
       // Setup Scrcpy Server
       final serverData = await _scrcpyService.initServer(
@@ -239,16 +251,20 @@ abstract class _PhoneViewStore with Store, MirroringStoreMixin {
         port: adbPort,
         scid: scid,
         decoderService: NativeVideoDecoderService(),
+        controlPort: controlPort,
       );
 
       // Pre-warm decoder
       await mirrorSession.decoderService.start(url);
+      _listenForRecovery(mirrorSession);
 
       runInAction(() {
         mirroringStore.activeSessions[sessionId] = mirrorSession;
         isLoading = false;
       });
 
+      _startAdaptation(scrcpyOptions);
+
       return mirrorSession;
     } catch (e, stackTrace) {
       logger.e(
@@ -269,6 +285,9 @@ abstract class _PhoneViewStore with Store, MirroringStoreMixin {
   @action
   Future<void> stopMirroring() async {
     logger.i('[MirroringStore] Stopping mirroring for $sessionId');
+    if (!_isAdapting) _stopAdaptation();
+    _recoverySubscription?.cancel();
+    _recoverySubscription = null;
     final currentSession = session;
     if (currentSession != null) {
       await currentSession.decoderService.stop(currentSession.videoUrl);
@@ -300,6 +319,142 @@ abstract class _PhoneViewStore with Store, MirroringStoreMixin {
     }
   }
 
+  // ═══════════════════════════════════════════════════════════════
+  // LOSS RECOVERY
+  // ═══════════════════════════════════════════════════════════════
+
+  /// The decoder skips to the next keyframe after stream damage; asking the
+  /// server to reset the encoder makes one arrive now instead of at the next
+  /// scheduled I-frame. Needs the control socket (not in grid profiles).
+  void _listenForRecovery(MirrorSession mirrorSession) {
+    final textureId = mirrorSession.decoderService.textureIdFor(
+      mirrorSession.videoUrl,
+    );
+    if (textureId == null) return;
+    _recoverySubscription?.cancel();
+    _recoverySubscription = NativeVideoDecoderService.recoveryEvents(
+      textureId,
+    ).listen((event) {
+      if (event['type'] == 'recovered') {
+        logger.i(
+          '[MirroringStore] $sessionId recovered from ${event['reason']} '
+          'in ${event['elapsedMs']}ms',
+        );
+        return;
+      }
+      logger.w(
+        '[MirroringStore] Stream loss (${event['reason']}) on $sessionId, '
+        'requesting a keyframe',
+      );
+      _workerManager.sendControl(
+        sessionId,
+        ResetVideoControlMessage().serialize(),
+      );
+    });
+  }
+
+  // ═══════════════════════════════════════════════════════════════
+  // INPUT RECORDING
+  // ═══════════════════════════════════════════════════════════════
+
+  /// Records every control message sent to this device, with its time, until
+  /// [stopInputRecording]. Returns false without a session or when already
+  /// recording.
+  Future<bool> startInputRecording() async {
+    final current = session;
+    if (current == null || _inputRecordingId != null) return false;
+    final id = await NativeVideoDecoderService.startInputRecording(
+      width: current.width,
+      height: current.height,
+    );
+    if (id == null) return false;
+    _inputRecordingId = id;
+    _workerManager.setControlTap(
+      sessionId,
+      (data) => NativeVideoDecoderService.recordInput(
+        id,
+        data,
+        _inputClock.elapsedMicroseconds,
+      ),
+    );
+    return true;
+  }
+
+  /// Ends the recording and returns the script for
+  /// [NativeVideoDecoderService.replayInputScript].
+  Future<Uint8List?> stopInputRecording() async {
+    final id = _inputRecordingId;
+    if (id == null) return null;
+    _inputRecordingId = null;
+    _workerManager.setControlTap(sessionId, null);
+    return NativeVideoDecoderService.stopInputRecording(id);
+  }
+
+  /// This device as a replay target, once mirroring.
+  InputReplayTarget? get inputReplayTarget {
+    final current = session;
+    final controlPort = current?.controlPort;
+    if (current == null || controlPort == null) return null;
+    return InputReplayTarget(
+      controlPort: controlPort,
+      textureId: current.decoderService.textureIdFor(current.videoUrl),
+    );
+  }
+
+  // ═══════════════════════════════════════════════════════════════
+  // STREAM ADAPTATION
+  // ═══════════════════════════════════════════════════════════════
+
+  void _startAdaptation(ScrcpyOptions profile) {
+    if (!UIConstants.adaptiveStreamQuality || _sampling) return;
+    // Kept across restarts so streaks and cooldown carry over
+    _adaptation ??= StreamAdaptationController(ceiling: profile);
+    // The manager polls the stats once for every store
+    _workerManager.setHealthListener(sessionId, _onHealth);
+    _sampling = true;
+  }
+
+  void _stopAdaptation() {
+    _workerManager.setHealthListener(sessionId, null);
+    _sampling = false;
+    _adaptation = null;
+  }
+
+  Future<void> _onHealth(Map<dynamic, dynamic> sessions) async {
+    final currentSession = session;
+    final adaptation = _adaptation;
+    if (currentSession == null || adaptation == null || _isAdapting) return;
+
+    final textureId = currentSession.decoderService.textureIdFor(
+      currentSession.videoUrl,
+    );
+    if (textureId == null) return;
+
+    final health = (sessions[textureId] as Map?)?['health'];
+    if (health is! Map) return;
+
+    final next = adaptation.addSample(StreamHealthSample.fromMap(health));
+    if (next != null) await _restartWithOptions(next);
+  }
+
+  /// Scrcpy applies encoder settings only at server start, so adapting means
+  /// a fresh stream. The native decoder is reused from the session pool.
+  Future<void> _restartWithOptions(ScrcpyOptions options) async {
+    logger.i(
+      '[MirroringStore] Adapting $sessionId to ${options.maxFps}fps, '
+      'maxSize ${options.maxSize}, ${options.bitRate}bps',
+    );
+    _isAdapting = true;
+    try {
+      await stopMirroring();
+      await startMirroring(options);
+    } catch (e) {
+      logger.e('[MirroringStore] Failed to adapt $sessionId', error: e);
+    } finally {
+      _isAdapting = false;
+    }
+  }
+
   @action
   void setDecoderError(String serial, String error) {
     error = 'Decoder error: $error';
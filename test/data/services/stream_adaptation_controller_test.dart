@@ -0,0 +1,185 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:scraki/data/services/stream_adaptation_controller.dart';
+import 'package:scraki/domain/entities/scrcpy_options.dart';
+
+void main() {
+  const ceiling = ScrcpyOptions(bitRate: 4000000, maxFps: 60, maxSize: 1080);
+
+  const overloaded = StreamHealthSample(
+    overloaded: true,
+    recommendedMaxFps: 24,
+    recommendedMaxSize: 648,
+    recommendedBitRate: 1500000,
+  );
+  const underused = StreamHealthSample(
+    underused: true,
+    recommendedMaxFps: 60,
+    recommendedMaxSize: 1620,
+    recommendedBitRate: 6000000,
+  );
+  const steady = StreamHealthSample();
+
+  late DateTime now;
+  late StreamAdaptationController controller;
+
+  /// Replays a recorded trace at the 2s polling interval of the store and
+  /// returns every restart the controller asked for.
+  List<ScrcpyOptions> replay(List<StreamHealthSample> trace) {
+    final changes = <ScrcpyOptions>[];
+    for (final sample in trace) {
+      final next = controller.addSample(sample);
+      if (next != null) changes.add(next);
+      now = now.add(const Duration(seconds: 2));
+    }
+    return changes;
+  }
+
+  setUp(() {
+    now = DateTime(2024);
+    controller = StreamAdaptationController(
+      ceiling: ceiling,
+      clock: () => now,
+    );
+  });
+
+  group('StreamAdaptationController', () {
+    test('steps down to the native recommendation after sustained load', () {
+      final changes = replay([overloaded, overloaded, overloaded]);
+
+      expect(changes, hasLength(1));
+      expect(changes.single.maxFps, 24);
+      expect(changes.single.maxSize, 648);
+      expect(changes.single.bitRate, 1500000);
+      expect(controller.current, changes.single);
+    });
+
+    test('ignores short load spikes', () {
+      final changes = replay([
+        overloaded,
+        overloaded,
+        steady,
+        overloaded,
+        overloaded,
+        steady,
+      ]);
+
+      expect(changes, isEmpty);
+      expect(controller.current, ceiling);
+    });
+
+    test('waits for the cooldown between changes', () {
+      const heavier = StreamHealthSample(
+        overloaded: true,
+        recommendedMaxFps: 12,
+        recommendedMaxSize: 480,
+        recommendedBitRate: 750000,
+      );
+
+      // Steps down at 4s
+      expect(replay([overloaded, overloaded, overloaded]), hasLength(1));
+
+      // 6s..22s: heavier load inside the 20s cooldown is held back
+      expect(replay(List.filled(9, heavier)), isEmpty);
+      expect(controller.current.maxFps, 24);
+
+      // 24s: the cooldown is over and the sustained load applies
+      final changes = replay([heavier]);
+      expect(changes, hasLength(1));
+      expect(changes.single.maxFps, 12);
+      expect(changes.single.maxSize, 480);
+      expect(changes.single.bitRate, 750000);
+    });
+
+    test('steps back up gradually and never above the profile', () {
+      replay([overloaded, overloaded, overloaded]);
+
+      final changes = replay(List.filled(60, underused));
+
+      expect(changes, isNotEmpty);
+      for (var i = 1; i < changes.length; i++) {
+        expect(changes[i].maxFps, greaterThanOrEqualTo(changes[i - 1].maxFps));
+      }
+      expect(controller.current.maxFps, ceiling.maxFps);
+      expect(controller.current.maxSize, ceiling.maxSize);
+      expect(controller.current.bitRate, ceiling.bitRate);
+    });
+
+    test('does not restart for changes below the threshold', () {
+      const mild = StreamHealthSample(
+        overloaded: true,
+        recommendedMaxFps: 55,
+        recommendedMaxSize: 1000,
+        recommendedBitRate: 3600000,
+      );
+
+      expect(replay([mild, mild, mild, mild]), isEmpty);
+    });
+
+    test('keeps settings above the floor', () {
+      const severe = StreamHealthSample(
+        overloaded: true,
+        recommendedMaxFps: 2,
+        recommendedMaxSize: 100,
+        recommendedBitRate: 50000,
+      );
+
+      final changes = replay([severe, severe, severe]);
+
+      expect(changes.single.maxFps, 5);
+      expect(changes.single.maxSize, 360);
+      expect(changes.single.bitRate, 250000);
+    });
+
+    test('limits an unlimited size only when overloaded', () {
+      controller = StreamAdaptationController(
+        ceiling: const ScrcpyOptions(maxFps: 60, bitRate: 4000000),
+        clock: () => now,
+      );
+
+      expect(replay(List.filled(15, underused)), isEmpty);
+
+      final changes = replay([overloaded, overloaded, overloaded]);
+      expect(changes.single.maxSize, 648);
+    });
+
+    test('returns to an unlimited size at the stream size', () {
+      controller = StreamAdaptationController(
+        ceiling: const ScrcpyOptions(maxFps: 60, bitRate: 4000000),
+        clock: () => now,
+      );
+      const limited = StreamHealthSample(
+        overloaded: true,
+        recommendedMaxFps: 24,
+        recommendedMaxSize: 1296,
+        recommendedBitRate: 1500000,
+        maxDimension: 2160,
+      );
+
+      expect(replay([limited, limited, limited]).single.maxSize, 1296);
+
+      final changes = replay(List.filled(100, underused));
+
+      // 2025 * 1.25 passes the 2160 stream size, so the limit is lifted
+      expect(changes.map((change) => change.maxSize), [1620, 2025, 0, 0, 0]);
+      expect(controller.current.maxSize, 0);
+      expect(controller.current.maxFps, 60);
+      expect(controller.current.bitRate, 4000000);
+    });
+
+    test('parses the native health map', () {
+      final sample = StreamHealthSample.fromMap({
+        'overloaded': true,
+        'underused': false,
+        'recommendedMaxFps': 30,
+        'recommendedMaxSize': 720,
+        'recommendedBitRate': 2000000,
+        'decodeMs': 12.5,
+      });
+
+      expect(sample.overloaded, isTrue);
+      expect(sample.recommendedMaxFps, 30);
+      expect(sample.recommendedMaxSize, 720);
+      expect(sample.recommendedBitRate, 2000000);
+    });
+  });
+}
@@ -0,0 +1,25 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:scraki/data/services/video_worker_manager.dart';
+import 'package:scraki/data/utils/scrcpy_input_serializer.dart';
+
+void main() {
+  test('control tap records input but not stream recovery', () {
+    final manager = VideoWorkerManager();
+    final tapped = <List<int>>[];
+    manager.setControlTap('s1', tapped.add);
+
+    final touch = TouchControlMessage(
+      action: TouchControlMessage.actionDown,
+      x: 10,
+      y: 20,
+      width: 1080,
+      height: 2340,
+    ).serialize();
+    final text = InjectTextControlMessage('hi').serialize();
+    manager.sendControl('s1', touch);
+    manager.sendControl('s1', ResetVideoControlMessage().serialize());
+    manager.sendControl('s1', text);
+
+    expect(tapped, [touch, text]);
+  });
+}
@@ -49,5 +49,12 @@ void main() {
       expect(buffer.getUint16(22, Endian.big), 0); // Pressure (Up = 0)
       expect(buffer.getInt32(28, Endian.big), 0); // Buttons (Up = 0)
     });
+
+    test('ResetVideoControlMessage is a bare type byte', () {
+      final bytes = ResetVideoControlMessage().serialize();
+
+      expect(bytes, [ResetVideoControlMessage.typeResetVideo]);
+      expect(bytes.first, 17);
+    });
   });
 }
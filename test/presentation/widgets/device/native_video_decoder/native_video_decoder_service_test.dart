@@ -0,0 +1,83 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:scraki/presentation/widgets/device/native_video_decoder/native_video_decoder_service.dart';
+
+void main() {
+  group('NativeVideoDecoderService.frameHashDistance', () {
+    test('identical hashes are 0 apart', () {
+      expect(
+        NativeVideoDecoderService.frameHashDistance(
+          'b65b24da6db649b4',
+          'b65b24da6db649b4',
+        ),
+        0,
+      );
+    });
+
+    test('counts differing bits across all 64', () {
+      expect(
+        NativeVideoDecoderService.frameHashDistance(
+          '0000000000000000',
+          'ffffffffffffffff',
+        ),
+        64,
+      );
+      expect(
+        NativeVideoDecoderService.frameHashDistance(
+          '8000000000000001',
+          '0000000000000003',
+        ),
+        2,
+      );
+    });
+  });
+
+  group('InputReplayTarget', () {
+    test('omits unset sizes so the session size is used', () {
+      expect(
+        const InputReplayTarget(controlPort: 5000, textureId: 7).toMap(),
+        {'controlPort': 5000, 'textureId': 7},
+      );
+    });
+
+    test('passes an explicit screen size', () {
+      expect(
+        const InputReplayTarget(
+          controlPort: 5000,
+          width: 720,
+          height: 1600,
+        ).toMap(),
+        {'controlPort': 5000, 'width': 720, 'height': 1600},
+      );
+    });
+  });
+
+  group('NativeVideoDecoderService.activityScores', () {
+    test('maps each session to its activity score', () {
+      expect(
+        NativeVideoDecoderService.activityScores({
+          'sessions': {
+            1: {
+              'activity': {'score': 0.75, 'sizeRatio': 0.2},
+            },
+            2: {
+              'activity': {'score': 0},
+            },
+          },
+        }),
+        {1: 0.75, 2: 0.0},
+      );
+    });
+
+    test('skips sessions without activity', () {
+      expect(
+        NativeVideoDecoderService.activityScores({
+          'sessions': {
+            3: {'width': 720},
+          },
+        }),
+        isEmpty,
+      );
+      expect(NativeVideoDecoderService.activityScores(null), isEmpty);
+    });
+  });
+}
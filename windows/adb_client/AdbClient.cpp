@@ -0,0 +1,322 @@
+#include "AdbClient.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Larger DATA chunks are rejected by the device
+static const size_t kSyncChunkSize = 64 * 1024;
+// Idle sync connections kept per device for later pushes
+static const size_t kMaxIdleSync = 2;
+static const auto kTrackerRetryDelay = std::chrono::seconds(1);
+
+FILE* OpenLocalFile(const std::string& path, uint32_t* mtime) {
+#ifdef _WIN32
+    // Paths arrive as UTF-8
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (length <= 0) return nullptr;
+    std::wstring wide(static_cast<size_t>(length), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+    struct _stat64 info;
+    if (_wstat64(wide.c_str(), &info) != 0) return nullptr;
+    *mtime = static_cast<uint32_t>(info.st_mtime);
+    FILE* file = nullptr;
+    return _wfopen_s(&file, wide.c_str(), L"rb") == 0 ? file : nullptr;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return nullptr;
+    *mtime = static_cast<uint32_t>(info.st_mtime);
+    return fopen(path.c_str(), "rb");
+#endif
+}
+
+static bool SendSyncRequest(AdbConnection* connection, const char* id, const void* data, uint32_t length) {
+    std::string header(id, 4);
+    AppendLe32(&header, length);
+    if (!connection->WriteAll(header.data(), header.size())) return false;
+    return length == 0 || connection->WriteAll(data, length);
+}
+
+AdbClient::AdbClient(std::string host, int port) : host_(std::move(host)), port_(port) {}
+
+AdbClient::~AdbClient() {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    for (auto& entry : idle_sync_) {
+        for (auto& connection : entry.second) SendSyncRequest(connection.get(), "QUIT", nullptr, 0);
+    }
+    idle_sync_.clear();
+}
+
+std::unique_ptr<AdbConnection> AdbClient::Connect(std::string* error) {
+    return AdbConnection::Open(host_, port_, error);
+}
+
+std::unique_ptr<AdbConnection> AdbClient::Transport(const std::string& serial, std::string* error) {
+    auto connection = Connect(error);
+    if (!connection) return nullptr;
+    std::string request = serial.empty() ? "host:transport-any" : "host:transport:" + serial;
+    if (!connection->Request(request, error)) return nullptr;
+    return connection;
+}
+
+bool AdbClient::HostQuery(const std::string& request, std::string* response, std::string* error) {
+    auto connection = Connect(error);
+    if (!connection || !connection->Request(request, error)) return false;
+    std::string data;
+    if (!connection->ReadToEnd(&data)) {
+        *error = "connection to adb server lost";
+        return false;
+    }
+    // Strip the length prefix when the service sent one
+    if (data.size() >= 4) {
+        std::string prefix = data.substr(0, 4);
+        char* end = nullptr;
+        unsigned long length = strtoul(prefix.c_str(), &end, 16);
+        if (end == prefix.c_str() + 4 && length == data.size() - 4) data.erase(0, 4);
+    }
+    *response = std::move(data);
+    return true;
+}
+
+bool AdbClient::Shell(const std::string& serial, const std::string& command, std::string* output,
+                      std::string* error) {
+    auto connection = Transport(serial, error);
+    if (!connection || !connection->Request("shell:" + command, error)) return false;
+    output->clear();
+    if (!connection->ReadToEnd(output)) {
+        *error = "connection to adb server lost";
+        return false;
+    }
+    return true;
+}
+
+bool AdbClient::Forward(const std::string& serial, const std::string& local, const std::string& remote,
+                        std::string* error) {
+    auto connection = Connect(error);
+    if (!connection) return false;
+    std::string prefix = serial.empty() ? "host:" : "host-serial:" + serial + ":";
+    // Accepted by the server first, then the outcome of binding the port
+    return connection->Request(prefix + "forward:" + local + ";" + remote, error) && connection->ReadStatus(error);
+}
+
+bool AdbClient::Reverse(const std::string& serial, const std::string& remote, const std::string& local,
+                        std::string* error) {
+    auto connection = Transport(serial, error);
+    if (!connection) return false;
+    return connection->Request("reverse:forward:" + remote + ";" + local, error) && connection->ReadStatus(error);
+}
+
+bool AdbClient::RemoveReverse(const std::string& serial, const std::string& remote, std::string* error) {
+    auto connection = Transport(serial, error);
+    if (!connection) return false;
+    return connection->Request("reverse:killforward:" + remote, error) && connection->ReadStatus(error);
+}
+
+std::unique_ptr<AdbConnection> AdbClient::AcquireSync(const std::string& serial, bool* reused,
+                                                      std::string* error) {
+    {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        auto it = idle_sync_.find(serial);
+        if (it != idle_sync_.end() && !it->second.empty()) {
+            auto connection = std::move(it->second.back());
+            it->second.pop_back();
+            *reused = true;
+            return connection;
+        }
+    }
+    *reused = false;
+    auto connection = Transport(serial, error);
+    if (!connection || !connection->Request("sync:", error)) return nullptr;
+    return connection;
+}
+
+void AdbClient::ReleaseSync(const std::string& serial, std::unique_ptr<AdbConnection> connection) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    auto& idle = idle_sync_[serial];
+    if (idle.size() < kMaxIdleSync) {
+        idle.push_back(std::move(connection));
+    } else {
+        SendSyncRequest(connection.get(), "QUIT", nullptr, 0);
+    }
+}
+
+bool AdbClient::SendData(AdbConnection* connection, const Reader& read, const std::string& remote_path, int mode,
+                         uint32_t mtime, bool* stale, std::string* error) {
+    // Nothing reached the device until the first reply, so a dead pooled
+    // connection is safe to retry on a fresh one
+    *stale = false;
+    std::string target = remote_path + "," + std::to_string(mode);
+    if (!SendSyncRequest(connection, "SEND", target.data(), static_cast<uint32_t>(target.size()))) {
+        *stale = true;
+        *error = "connection to adb server lost";
+        return false;
+    }
+
+    std::vector<char> chunk(kSyncChunkSize);
+    int64_t read_size = 0;
+    while ((read_size = read(chunk.data(), chunk.size())) > 0) {
+        if (!SendSyncRequest(connection, "DATA", chunk.data(), static_cast<uint32_t>(read_size))) {
+            *stale = true;
+            *error = "connection to adb server lost";
+            return false;
+        }
+    }
+    if (read_size < 0) {
+        // The device holds a half-written file; the session cannot continue
+        *error = "cannot read local data";
+        return false;
+    }
+    std::string done("DONE", 4);
+    AppendLe32(&done, mtime);
+    uint8_t reply[8];
+    if (!connection->WriteAll(done.data(), done.size()) || !connection->ReadExact(reply, sizeof(reply))) {
+        *stale = true;
+        *error = "connection to adb server lost";
+        return false;
+    }
+    if (memcmp(reply, "OKAY", 4) == 0) return true;
+    if (memcmp(reply, "FAIL", 4) == 0) {
+        std::string message(ReadLe32(reply + 4), '\0');
+        if (!message.empty() && !connection->ReadExact(&message[0], message.size())) {
+            *error = "connection to adb server lost";
+            return false;
+        }
+        *error = message;
+        return false;
+    }
+    *error = "unexpected sync reply";
+    return false;
+}
+
+bool AdbClient::Upload(const std::string& serial, const Reader& read, const std::function<void()>& restart,
+                       const std::string& remote_path, int mode, uint32_t mtime, std::string* error) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        auto connection = AcquireSync(serial, &reused, error);
+        if (!connection) return false;
+        bool stale = false;
+        if (SendData(connection.get(), read, remote_path, mode, mtime, &stale, error)) {
+            ReleaseSync(serial, std::move(connection));
+            return true;
+        }
+        // Only a pooled connection that died before the device answered is
+        // worth another try; anything else is the device's verdict
+        if (!stale || !reused) return false;
+        restart();
+    }
+    return false;
+}
+
+bool AdbClient::Push(const std::string& serial, const std::string& local_path, const std::string& remote_path,
+                     int mode, std::string* error) {
+    uint32_t mtime = 0;
+    FILE* file = OpenLocalFile(local_path, &mtime);
+    if (!file) {
+        *error = "cannot open " + local_path;
+        return false;
+    }
+    auto read = [file](char* buffer, size_t size) -> int64_t {
+        size_t read_size = fread(buffer, 1, size, file);
+        return read_size == 0 && ferror(file) ? -1 : static_cast<int64_t>(read_size);
+    };
+    bool ok = Upload(serial, read, [file] { rewind(file); }, remote_path, mode, mtime, error);
+    fclose(file);
+    return ok;
+}
+
+bool AdbClient::PushData(const std::string& serial, const std::string& data, const std::string& remote_path,
+                         int mode, uint32_t mtime, std::string* error) {
+    size_t offset = 0;
+    auto read = [&data, &offset](char* buffer, size_t size) -> int64_t {
+        size_t take = std::min(size, data.size() - offset);
+        memcpy(buffer, data.data() + offset, take);
+        offset += take;
+        return static_cast<int64_t>(take);
+    };
+    return Upload(serial, read, [&offset] { offset = 0; }, remote_path, mode, mtime, error);
+}
+
+bool AdbClient::Stat(const std::string& serial, const std::string& remote_path, FileStat* stat, std::string* error) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        auto connection = AcquireSync(serial, &reused, error);
+        if (!connection) return false;
+        uint8_t reply[16];
+        if (SendSyncRequest(connection.get(), "STAT", remote_path.data(), static_cast<uint32_t>(remote_path.size())) &&
+            connection->ReadExact(reply, sizeof(reply))) {
+            if (memcmp(reply, "STAT", 4) != 0) {
+                *error = "unexpected sync reply";
+                return false;
+            }
+            // A missing file reads as all zeros
+            stat->mode = ReadLe32(reply + 4);
+            stat->size = ReadLe32(reply + 8);
+            stat->mtime = ReadLe32(reply + 12);
+            ReleaseSync(serial, std::move(connection));
+            return true;
+        }
+        *error = "connection to adb server lost";
+        if (!reused) return false;
+    }
+    return false;
+}
+
+std::unique_ptr<AdbClient::Tracker> AdbClient::TrackDevices(std::function<void(const std::string&)> callback) {
+    return std::unique_ptr<Tracker>(new Tracker(this, std::move(callback)));
+}
+
+AdbClient::Tracker::Tracker(AdbClient* client, std::function<void(const std::string&)> callback)
+    : client_(client), callback_(std::move(callback)) {
+    thread_ = std::thread(&Tracker::Run, this);
+}
+
+AdbClient::Tracker::~Tracker() {
+    Stop();
+}
+
+void AdbClient::Tracker::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(connection_mutex_);
+        running_ = false;
+        if (connection_) connection_->Shutdown();
+    }
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        wait_cv_.notify_all();
+    }
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) thread_.join();
+}
+
+void AdbClient::Tracker::Run() {
+    while (running_) {
+        std::string error;
+        auto connection = client_->Connect(&error);
+        if (connection) {
+            {
+                // Published under the lock so Stop() either sees it or has
+                // already cleared running_
+                std::lock_guard<std::mutex> lock(connection_mutex_);
+                if (running_) connection_ = connection.get();
+            }
+            std::string devices;
+            if (running_ && connection->Request("host:track-devices-l", &error)) {
+                while (running_ && connection->ReadLengthPrefixed(&devices, &error)) callback_(devices);
+            }
+            std::lock_guard<std::mutex> lock(connection_mutex_);
+            connection_ = nullptr;
+        }
+        if (!running_) break;
+        // The server went away or is restarting
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cv_.wait_for(lock, kTrackerRetryDelay, [this] { return !running_; });
+    }
+}
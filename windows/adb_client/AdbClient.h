@@ -0,0 +1,103 @@
+#ifndef ADB_CLIENT_H_
+#define ADB_CLIENT_H_
+
+#include "AdbConnection.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Talks to the adb server directly over its smart-socket protocol instead of
+// spawning the adb executable per command. Every call opens (or, for sync,
+// reuses) its own connection, so calls are blocking but may run
+// concurrently from any thread.
+class AdbClient {
+ public:
+  // Streams host:track-devices-l until stopped, reconnecting if the server
+  // restarts. The callback runs on the tracker's thread with each full list.
+  class Tracker {
+   public:
+    ~Tracker();
+    void Stop();
+
+   private:
+    friend class AdbClient;
+    Tracker(AdbClient* client, std::function<void(const std::string&)> callback);
+    void Run();
+
+    AdbClient* client_;
+    std::function<void(const std::string&)> callback_;
+    std::atomic<bool> running_{true};
+    std::mutex connection_mutex_;
+    AdbConnection* connection_ = nullptr; // The blocking one, for Stop()
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    std::thread thread_;
+  };
+
+  explicit AdbClient(std::string host = "127.0.0.1", int port = 5037);
+  ~AdbClient();
+
+  // A host service answering with a length-prefixed string, e.g.
+  // "host:devices-l" or "host:connect:1.2.3.4:5555". Services that answer
+  // with the status alone leave response empty.
+  bool HostQuery(const std::string& request, std::string* response, std::string* error);
+
+  // Runs "shell:<command>" on the device and collects its output.
+  bool Shell(const std::string& serial, const std::string& command, std::string* output, std::string* error);
+
+  bool Forward(const std::string& serial, const std::string& local, const std::string& remote, std::string* error);
+  bool Reverse(const std::string& serial, const std::string& remote, const std::string& local, std::string* error);
+  bool RemoveReverse(const std::string& serial, const std::string& remote, std::string* error);
+
+  // Uploads a local file through the sync service. Sync connections stay
+  // open between pushes to the same device.
+  bool Push(const std::string& serial, const std::string& local_path, const std::string& remote_path, int mode,
+            std::string* error);
+
+  // Uploads an in-memory buffer, sharing the sync connections with Push().
+  bool PushData(const std::string& serial, const std::string& data, const std::string& remote_path, int mode,
+                uint32_t mtime, std::string* error);
+
+  // Sync STAT (v1). A missing file succeeds with all fields zero; sizes
+  // wrap at 4 GiB.
+  struct FileStat {
+      uint32_t mode = 0;
+      uint32_t size = 0;
+      uint32_t mtime = 0;
+  };
+  bool Stat(const std::string& serial, const std::string& remote_path, FileStat* stat, std::string* error);
+
+  std::unique_ptr<Tracker> TrackDevices(std::function<void(const std::string&)> callback);
+
+ private:
+  std::unique_ptr<AdbConnection> Connect(std::string* error);
+  std::unique_ptr<AdbConnection> Transport(const std::string& serial, std::string* error);
+  std::unique_ptr<AdbConnection> AcquireSync(const std::string& serial, bool* reused, std::string* error);
+  void ReleaseSync(const std::string& serial, std::unique_ptr<AdbConnection> connection);
+  // Fills the buffer and returns the bytes written, 0 at the end, -1 on error
+  using Reader = std::function<int64_t(char* buffer, size_t size)>;
+  bool Upload(const std::string& serial, const Reader& read, const std::function<void()>& restart,
+              const std::string& remote_path, int mode, uint32_t mtime, std::string* error);
+  bool SendData(AdbConnection* connection, const Reader& read, const std::string& remote_path, int mode,
+                uint32_t mtime, bool* stale, std::string* error);
+
+  std::string host_;
+  int port_;
+
+  std::mutex sync_mutex_;
+  std::map<std::string, std::vector<std::unique_ptr<AdbConnection>>> idle_sync_;
+};
+
+// Opens a local file named in UTF-8 for reading, with its modification time
+// in seconds since the epoch.
+FILE* OpenLocalFile(const std::string& path, uint32_t* mtime);
+
+#endif  // ADB_CLIENT_H_
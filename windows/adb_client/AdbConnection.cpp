@@ -0,0 +1,173 @@
+#include "AdbConnection.h"
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+static const AdbConnection::Socket kInvalidSocket = INVALID_SOCKET;
+static void CloseSocket(AdbConnection::Socket s) { closesocket(s); }
+static const int kShutdownBoth = SD_BOTH;
+#else
+static const AdbConnection::Socket kInvalidSocket = -1;
+static void CloseSocket(AdbConnection::Socket s) { close(s); }
+static const int kShutdownBoth = SHUT_RDWR;
+#endif
+
+#ifdef MSG_NOSIGNAL
+static const int kSendFlags = MSG_NOSIGNAL; // A closed server must not raise SIGPIPE
+#else
+static const int kSendFlags = 0;
+#endif
+
+// Longest payload the server accepts in one request
+static const size_t kMaxRequestSize = 0xFFFF;
+
+void AppendLe32(std::string* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+uint32_t ReadLe32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+std::unique_ptr<AdbConnection> AdbConnection::Open(const std::string& host, int port, std::string* error) {
+#ifdef _WIN32
+    static const bool winsock_ready = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!winsock_ready) {
+        *error = "cannot initialize Winsock";
+        return nullptr;
+    }
+#endif
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* address = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &address) != 0 || !address) {
+        *error = "cannot resolve " + host;
+        return nullptr;
+    }
+    Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == kInvalidSocket) {
+        freeaddrinfo(address);
+        *error = "cannot create socket";
+        return nullptr;
+    }
+    bool connected = connect(s, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0;
+    freeaddrinfo(address);
+    if (!connected) {
+        CloseSocket(s);
+        *error = "cannot connect to adb server at " + host + ":" + std::to_string(port);
+        return nullptr;
+    }
+    int nodelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+    return std::unique_ptr<AdbConnection>(new AdbConnection(s));
+}
+
+AdbConnection::~AdbConnection() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (socket_ != kInvalidSocket) CloseSocket(socket_);
+}
+
+void AdbConnection::Shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (socket_ != kInvalidSocket) shutdown(socket_, kShutdownBoth);
+}
+
+bool AdbConnection::WriteAll(const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        int sent = send(socket_, p, static_cast<int>(size > (1 << 20) ? (1 << 20) : size), kSendFlags);
+        if (sent <= 0) return false;
+        p += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool AdbConnection::ReadExact(void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        int received = recv(socket_, p, static_cast<int>(size > (1 << 20) ? (1 << 20) : size), 0);
+        if (received <= 0) return false;
+        p += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool AdbConnection::ReadToEnd(std::string* data) {
+    char buffer[16384];
+    while (true) {
+        int received = recv(socket_, buffer, sizeof(buffer), 0);
+        if (received == 0) return true;
+        if (received < 0) return false;
+        data->append(buffer, static_cast<size_t>(received));
+    }
+}
+
+bool AdbConnection::Request(const std::string& request, std::string* error) {
+    if (request.size() > kMaxRequestSize) {
+        *error = "request too long";
+        return false;
+    }
+    char length[5];
+    snprintf(length, sizeof(length), "%04zx", request.size());
+    std::string message = length + request;
+    if (!WriteAll(message.data(), message.size())) {
+        *error = "connection to adb server lost";
+        return false;
+    }
+    return ReadStatus(error);
+}
+
+bool AdbConnection::ReadStatus(std::string* error) {
+    char status[4];
+    if (!ReadExact(status, sizeof(status))) {
+        *error = "connection to adb server lost";
+        return false;
+    }
+    if (memcmp(status, "OKAY", 4) == 0) return true;
+    if (memcmp(status, "FAIL", 4) == 0) {
+        std::string message;
+        *error = ReadLengthPrefixed(&message, error) ? message : "adb server failed the request";
+        return false;
+    }
+    *error = "unexpected adb server reply: " + std::string(status, sizeof(status));
+    return false;
+}
+
+bool AdbConnection::ReadLengthPrefixed(std::string* data, std::string* error) {
+    char length[5] = {};
+    if (!ReadExact(length, 4)) {
+        *error = "connection to adb server lost";
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long size = strtoul(length, &end, 16);
+    if (end != length + 4) {
+        *error = "malformed length from adb server";
+        return false;
+    }
+    data->resize(size);
+    if (size > 0 && !ReadExact(&(*data)[0], size)) {
+        *error = "connection to adb server lost";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef ADB_CONNECTION_H_
+#define ADB_CONNECTION_H_
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// One TCP connection to the adb server, speaking its smart-socket framing:
+// requests are "<4 hex digits length><payload>", answered with "OKAY" or
+// "FAIL<4 hex digits length><message>". Not thread-safe except Shutdown().
+class AdbConnection {
+ public:
+#ifdef _WIN32
+  using Socket = SOCKET;
+#else
+  using Socket = int;
+#endif
+
+  static std::unique_ptr<AdbConnection> Open(const std::string& host, int port, std::string* error);
+  ~AdbConnection();
+
+  AdbConnection(const AdbConnection&) = delete;
+  AdbConnection& operator=(const AdbConnection&) = delete;
+
+  // Sends a request and reads its status. A FAIL message ends up in error.
+  bool Request(const std::string& request, std::string* error);
+  bool ReadStatus(std::string* error);
+  // "<4 hex digits length><data>", as host queries answer.
+  bool ReadLengthPrefixed(std::string* data, std::string* error);
+  // Everything until the server closes the connection.
+  bool ReadToEnd(std::string* data);
+
+  bool WriteAll(const void* data, size_t size);
+  bool ReadExact(void* data, size_t size);
+
+  // Unblocks a reader on another thread; the connection is unusable after.
+  void Shutdown();
+
+ private:
+  explicit AdbConnection(Socket socket) : socket_(socket) {}
+
+  std::mutex mutex_; // Guards closing against Shutdown()
+  Socket socket_;
+};
+
+// Sync protocol ids and lengths are little-endian 32-bit
+void AppendLe32(std::string* out, uint32_t value);
+uint32_t ReadLe32(const uint8_t* data);
+
+#endif  // ADB_CONNECTION_H_
@@ -0,0 +1,253 @@
+#include "DeployEngine.h"
+
+#include "Sha256.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+using Clock = std::chrono::steady_clock;
+
+// Single-quotes a path for the device shell
+static std::string ShellQuote(const std::string& value) {
+    std::string quoted = "'";
+    for (char c : value) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+static std::string Trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    size_t end = value.find_last_not_of(" \t\r\n");
+    return value.substr(begin, end - begin + 1);
+}
+
+static double MillisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool DeployEngine::Deploy(const std::vector<std::string>& serials, const std::string& local_path,
+                          const std::string& remote_path, int mode, const Options& options, Report* report,
+                          std::string* error) {
+    auto start = Clock::now();
+    Payload payload;
+    FILE* file = OpenLocalFile(local_path, &payload.mtime);
+    if (!file) {
+        *error = "cannot open " + local_path;
+        return false;
+    }
+    char buffer[16384];
+    size_t read = 0;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) payload.data.append(buffer, read);
+    bool read_failed = ferror(file) != 0;
+    fclose(file);
+    if (read_failed) {
+        *error = "cannot read " + local_path;
+        return false;
+    }
+    Sha256 hash;
+    hash.Update(payload.data.data(), payload.data.size());
+    payload.sha256 = hash.HexDigest();
+
+    *report = Report();
+    report->sha256 = payload.sha256;
+    report->size = payload.data.size();
+    auto hubs = HubsOf(serials);
+    report->devices.resize(serials.size());
+
+    // Devices waiting for a slot, or for their backoff to pass
+    struct Pending {
+        size_t index;
+        Clock::time_point ready_at;
+    };
+    std::vector<Pending> pending;
+    for (size_t i = 0; i < serials.size(); ++i) {
+        report->devices[i].serial = serials[i];
+        report->devices[i].hub = hubs[serials[i]];
+        pending.push_back({i, start});
+    }
+
+    auto work = [&]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!pending.empty()) {
+            auto now = Clock::now();
+            auto next_ready = Clock::time_point::max();
+            auto job = pending.end();
+            for (auto it = pending.begin(); it != pending.end(); ++it) {
+                if (it->ready_at > now) {
+                    next_ready = std::min(next_ready, it->ready_at);
+                } else if (TryAcquire(report->devices[it->index].hub, options)) {
+                    job = it;
+                    break;
+                }
+            }
+            if (job == pending.end()) {
+                if (next_ready == Clock::time_point::max()) {
+                    slot_freed_.wait(lock);
+                } else {
+                    slot_freed_.wait_until(lock, next_ready);
+                }
+                continue;
+            }
+
+            size_t index = job->index;
+            pending.erase(job);
+            DeviceResult& result = report->devices[index];
+            lock.unlock();
+            bool finished = Attempt(&result, payload, remote_path, mode, options);
+            lock.lock();
+            Release(result.hub);
+            if (!finished) {
+                auto delay = options.backoff * (1 << std::min(result.attempts - 1, 10));
+                pending.push_back({index, Clock::now() + delay});
+            }
+        }
+    };
+
+    size_t workers = std::min(serials.size(), static_cast<size_t>(std::max(options.max_parallel, 1)));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) threads.emplace_back(work);
+    if (workers > 0) work();
+    for (auto& thread : threads) thread.join();
+
+    for (auto& device : report->devices) {
+        if (device.outcome == Outcome::kPushed) report->pushed++;
+        if (device.outcome == Outcome::kSkipped) report->skipped++;
+        if (device.outcome == Outcome::kFailed) report->failed++;
+    }
+    report->elapsed_ms = MillisecondsSince(start);
+    return true;
+}
+
+bool DeployEngine::Attempt(DeviceResult* result, const Payload& payload, const std::string& remote_path, int mode,
+                           const Options& options) {
+    auto start = Clock::now();
+    result->attempts++;
+    std::string error;
+    bool current = false;
+    bool ok = IsCurrent(result->serial, payload, remote_path, &current, &error);
+    if (ok && !current) {
+        // The marker goes last, so an interrupted push is redone next time
+        ok = client_->PushData(result->serial, payload.data, remote_path, mode, payload.mtime, &error) &&
+             client_->PushData(result->serial, payload.sha256 + "\n", remote_path + ".sha256", 0644, payload.mtime,
+                               &error);
+    }
+    result->elapsed_ms += MillisecondsSince(start);
+    if (ok) {
+        result->outcome = current ? Outcome::kSkipped : Outcome::kPushed;
+        return true;
+    }
+    result->error = error;
+    result->outcome = Outcome::kFailed;
+    return result->attempts >= options.max_attempts;
+}
+
+bool DeployEngine::IsCurrent(const std::string& serial, const Payload& payload, const std::string& remote_path,
+                             bool* current, std::string* error) {
+    *current = false;
+    AdbClient::FileStat stat;
+    if (!client_->Stat(serial, remote_path, &stat, error)) return false;
+    if (stat.mode == 0 || stat.size != static_cast<uint32_t>(payload.data.size())) return true;
+
+    std::string marker;
+    if (!client_->Shell(serial, "cat " + ShellQuote(remote_path + ".sha256") + " 2>/dev/null", &marker, error)) {
+        return false;
+    }
+    *current = Trim(marker) == payload.sha256;
+    return true;
+}
+
+std::map<std::string, std::string> DeployEngine::HubsOf(const std::vector<std::string>& serials) {
+    std::map<std::string, std::string> hubs;
+    for (const auto& serial : serials) hubs[serial] = "unknown";
+
+    std::string devices;
+    std::string error;
+    if (!client_->HostQuery("host:devices-l", &devices, &error)) return hubs;
+    std::istringstream lines(devices);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string serial;
+        fields >> serial;
+        auto it = hubs.find(serial);
+        if (it == hubs.end()) continue;
+        it->second = serial.find(':') != std::string::npos ? "network" : "unknown";
+        std::string field;
+        while (fields >> field) {
+            if (field.rfind("usb:", 0) != 0) continue;
+            // usb:<bus>-<port>.<port>...; the hub is the path minus the last
+            // port, devices on root ports share the bus
+            size_t dot = field.rfind('.');
+            it->second = dot != std::string::npos ? field.substr(0, dot) : field.substr(0, field.find('-'));
+            break;
+        }
+    }
+    return hubs;
+}
+
+bool DeployEngine::TryAcquire(const std::string& hub, const Options& options) {
+    int& hub_active = hub_active_[hub];
+    if (active_ >= std::max(options.max_parallel, 1) || hub_active >= std::max(options.per_hub, 1)) return false;
+    active_++;
+    hub_active++;
+    return true;
+}
+
+void DeployEngine::Release(const std::string& hub) {
+    active_--;
+    hub_active_[hub]--;
+    slot_freed_.notify_all();
+}
+
+const char* DeployEngine::OutcomeName(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::kSkipped:
+            return "skipped";
+        case Outcome::kPushed:
+            return "pushed";
+        default:
+            return "failed";
+    }
+}
+
+static std::string JsonString(const std::string& value) {
+    std::string out = "\"";
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+std::string DeployEngine::ToJson(const Report& report) {
+    std::ostringstream json;
+    json << "{\"sha256\":" << JsonString(report.sha256) << ",\"size\":" << report.size
+         << ",\"elapsedMs\":" << report.elapsed_ms << ",\"pushed\":" << report.pushed
+         << ",\"skipped\":" << report.skipped << ",\"failed\":" << report.failed << ",\"devices\":[";
+    for (size_t i = 0; i < report.devices.size(); ++i) {
+        const auto& device = report.devices[i];
+        if (i > 0) json << ",";
+        json << "{\"serial\":" << JsonString(device.serial) << ",\"hub\":" << JsonString(device.hub)
+             << ",\"outcome\":\"" << OutcomeName(device.outcome) << "\",\"attempts\":" << device.attempts
+             << ",\"elapsedMs\":" << device.elapsed_ms;
+        if (!device.error.empty()) json << ",\"error\":" << JsonString(device.error);
+        json << "}";
+    }
+    json << "]}";
+    return json.str();
+}
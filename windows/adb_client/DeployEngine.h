@@ -0,0 +1,90 @@
+#ifndef DEPLOY_ENGINE_H_
+#define DEPLOY_ENGINE_H_
+
+#include "AdbClient.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pushes one file to many devices, skipping devices that already hold it.
+// A device counts as up to date when the remote file has the local size
+// and a "<remote>.sha256" marker next to it names the local hash; the
+// marker is written after every push.
+//
+// Devices are grouped by the USB hub they hang off (from host:devices-l,
+// network devices form one group). Pushes run in parallel up to a global
+// and a per-hub limit, shared by all Deploy() calls in flight, so sessions
+// starting at once do not saturate a hub. Failed devices are retried with
+// exponential backoff.
+class DeployEngine {
+ public:
+  struct Options {
+      int max_parallel = 8;
+      int per_hub = 2;
+      int max_attempts = 3;
+      std::chrono::milliseconds backoff{250}; // Doubles per retry
+  };
+
+  enum class Outcome { kSkipped, kPushed, kFailed };
+
+  struct DeviceResult {
+      std::string serial;
+      std::string hub;
+      Outcome outcome = Outcome::kFailed;
+      int attempts = 0;
+      double elapsed_ms = 0;
+      std::string error; // Last failure, also set when a retry succeeded
+  };
+
+  struct Report {
+      std::string sha256;
+      uint64_t size = 0;
+      std::vector<DeviceResult> devices;
+      double elapsed_ms = 0; // Wall time for the whole fleet
+      int pushed = 0;
+      int skipped = 0;
+      int failed = 0;
+  };
+
+  explicit DeployEngine(AdbClient* client) : client_(client) {}
+
+  // Fails only when the local file cannot be read; per-device failures are
+  // in the report.
+  bool Deploy(const std::vector<std::string>& serials, const std::string& local_path, const std::string& remote_path,
+              int mode, const Options& options, Report* report, std::string* error);
+
+  static const char* OutcomeName(Outcome outcome);
+  static std::string ToJson(const Report& report);
+
+ private:
+  struct Payload {
+      std::string data;
+      std::string sha256;
+      uint32_t mtime = 0;
+  };
+
+  std::map<std::string, std::string> HubsOf(const std::vector<std::string>& serials);
+  // One try on one device; false while it should be retried.
+  bool Attempt(DeviceResult* result, const Payload& payload, const std::string& remote_path, int mode,
+               const Options& options);
+  bool IsCurrent(const std::string& serial, const Payload& payload, const std::string& remote_path, bool* current,
+                 std::string* error);
+
+  // Called with mutex_ held
+  bool TryAcquire(const std::string& hub, const Options& options);
+  void Release(const std::string& hub);
+
+  AdbClient* client_;
+
+  std::mutex mutex_;
+  std::condition_variable slot_freed_;
+  int active_ = 0;
+  std::map<std::string, int> hub_active_;
+};
+
+#endif  // DEPLOY_ENGINE_H_
@@ -0,0 +1,28 @@
+#ifndef SHA256_H_
+#define SHA256_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// FIPS 180-4 SHA-256, enough to fingerprint deployed files without pulling
+// in a crypto library.
+class Sha256 {
+ public:
+  Sha256();
+
+  void Update(const void* data, size_t size);
+  // Lowercase hex digest; the object must not be updated afterwards.
+  std::string HexDigest();
+
+ private:
+  static std::string Hex(const std::string& data);
+  void Transform(const uint8_t* block);
+
+  uint32_t state_[8];
+  uint8_t buffer_[64];
+  size_t buffered_ = 0;
+  uint64_t length_ = 0; // Bytes hashed so far
+};
+
+#endif  // SHA256_H_
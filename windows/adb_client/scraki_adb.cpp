@@ -0,0 +1,128 @@
+#include "scraki_adb.h"
+
+#include "AdbClient.h"
+#include "DeployEngine.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+struct scraki_adb {
+    explicit scraki_adb(std::string host, int port) : client(std::move(host), port), deploy(&client) {}
+    AdbClient client;
+    DeployEngine deploy; // One per client so concurrent deploys share its limits
+};
+
+struct scraki_adb_tracker {
+    std::unique_ptr<AdbClient::Tracker> tracker;
+};
+
+static char* CopyString(const std::string& value) {
+    char* copy = static_cast<char*>(malloc(value.size() + 1));
+    if (!copy) return nullptr;
+    memcpy(copy, value.data(), value.size());
+    copy[value.size()] = '\0';
+    return copy;
+}
+
+static std::string Argument(const char* value) {
+    return value ? std::string(value) : std::string();
+}
+
+static int32_t Finish(bool ok, const std::string& error_message, char** error) {
+    if (ok) return 0;
+    if (error) *error = CopyString(error_message);
+    return -1;
+}
+
+scraki_adb* scraki_adb_create(const char* host, int32_t port) {
+    return new scraki_adb(host && *host ? host : "127.0.0.1", port > 0 ? port : 5037);
+}
+
+void scraki_adb_destroy(scraki_adb* adb) {
+    delete adb;
+}
+
+void scraki_adb_free(void* string) {
+    free(string);
+}
+
+int32_t scraki_adb_host(scraki_adb* adb, const char* request, char** response, char** error) {
+    std::string result;
+    std::string error_message;
+    bool ok = adb->client.HostQuery(Argument(request), &result, &error_message);
+    if (ok && response) *response = CopyString(result);
+    return Finish(ok, error_message, error);
+}
+
+int32_t scraki_adb_shell(scraki_adb* adb, const char* serial, const char* command, char** output, char** error) {
+    std::string result;
+    std::string error_message;
+    bool ok = adb->client.Shell(Argument(serial), Argument(command), &result, &error_message);
+    if (ok && output) *output = CopyString(result);
+    return Finish(ok, error_message, error);
+}
+
+int32_t scraki_adb_forward(scraki_adb* adb, const char* serial, const char* local, const char* remote,
+                           char** error) {
+    std::string error_message;
+    bool ok = adb->client.Forward(Argument(serial), Argument(local), Argument(remote), &error_message);
+    return Finish(ok, error_message, error);
+}
+
+int32_t scraki_adb_reverse(scraki_adb* adb, const char* serial, const char* remote, const char* local,
+                           char** error) {
+    std::string error_message;
+    bool ok = adb->client.Reverse(Argument(serial), Argument(remote), Argument(local), &error_message);
+    return Finish(ok, error_message, error);
+}
+
+int32_t scraki_adb_reverse_remove(scraki_adb* adb, const char* serial, const char* remote, char** error) {
+    std::string error_message;
+    bool ok = adb->client.RemoveReverse(Argument(serial), Argument(remote), &error_message);
+    return Finish(ok, error_message, error);
+}
+
+int32_t scraki_adb_push(scraki_adb* adb, const char* serial, const char* local_path, const char* remote_path,
+                        int32_t mode, char** error) {
+    std::string error_message;
+    bool ok = adb->client.Push(Argument(serial), Argument(local_path), Argument(remote_path), mode, &error_message);
+    return Finish(ok, error_message, error);
+}
+
+int32_t scraki_adb_deploy(scraki_adb* adb, const char* serials, const char* local_path, const char* remote_path,
+                          int32_t mode, int32_t max_parallel, int32_t per_hub, int32_t max_attempts, char** report,
+                          char** error) {
+    std::vector<std::string> devices;
+    std::istringstream lines(Argument(serials));
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) devices.push_back(line);
+    }
+    DeployEngine::Options options;
+    if (max_parallel > 0) options.max_parallel = max_parallel;
+    if (per_hub > 0) options.per_hub = per_hub;
+    if (max_attempts > 0) options.max_attempts = max_attempts;
+
+    DeployEngine::Report result;
+    std::string error_message;
+    bool ok = adb->deploy.Deploy(devices, Argument(local_path), Argument(remote_path), mode, options, &result,
+                                 &error_message);
+    if (ok && report) *report = CopyString(DeployEngine::ToJson(result));
+    return Finish(ok, error_message, error);
+}
+
+scraki_adb_tracker* scraki_adb_track_devices(scraki_adb* adb, scraki_adb_devices_callback callback, void* context) {
+    auto* tracker = new scraki_adb_tracker();
+    tracker->tracker = adb->client.TrackDevices([callback, context](const std::string& devices) {
+        callback(context, CopyString(devices));
+    });
+    return tracker;
+}
+
+void scraki_adb_track_stop(scraki_adb_tracker* tracker) {
+    if (!tracker) return;
+    tracker->tracker->Stop();
+    delete tracker;
+}
@@ -0,0 +1,91 @@
+/*
+ * C interface to the native adb client, loaded by the app through dart:ffi
+ * (scraki_adb.dll next to the executable).
+ *
+ * Calls block and may run concurrently on different threads with the same
+ * client. They return 0 on success, or -1 with *error set to a message.
+ * Strings handed out (error, output) are owned by the caller and released
+ * with scraki_adb_free.
+ *
+ *     scraki_adb* adb = scraki_adb_create(NULL, 0);
+ *     char* devices;
+ *     char* error;
+ *     if (scraki_adb_host(adb, "host:devices-l", &devices, &error) == 0) {
+ *         puts(devices);
+ *         scraki_adb_free(devices);
+ *     } else {
+ *         scraki_adb_free(error);
+ *     }
+ *     scraki_adb_destroy(adb);
+ */
+#ifndef SCRAKI_ADB_H_
+#define SCRAKI_ADB_H_
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define SCRAKI_ADB_API __declspec(dllexport)
+#else
+#define SCRAKI_ADB_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct scraki_adb scraki_adb;
+typedef struct scraki_adb_tracker scraki_adb_tracker;
+
+/* Full device list, as "host:devices-l" prints it. Called on the tracker's
+ * thread; the callee owns devices and frees it with scraki_adb_free. */
+typedef void (*scraki_adb_devices_callback)(void* context, char* devices);
+
+/* host defaults to 127.0.0.1 and port to 5037 when NULL / 0. Does not
+ * connect; every call does. */
+SCRAKI_ADB_API scraki_adb* scraki_adb_create(const char* host, int32_t port);
+/* Closes pooled connections. Stop trackers first. */
+SCRAKI_ADB_API void scraki_adb_destroy(scraki_adb* adb);
+SCRAKI_ADB_API void scraki_adb_free(void* string);
+
+/* A host service, e.g. "host:devices-l", "host:connect:<address>" or
+ * "host-serial:<serial>:get-state". response may be NULL. */
+SCRAKI_ADB_API int32_t scraki_adb_host(scraki_adb* adb, const char* request, char** response, char** error);
+
+/* serial NULL or "" picks the only device, as adb without -s does. */
+SCRAKI_ADB_API int32_t scraki_adb_shell(scraki_adb* adb, const char* serial, const char* command, char** output,
+                                        char** error);
+SCRAKI_ADB_API int32_t scraki_adb_forward(scraki_adb* adb, const char* serial, const char* local, const char* remote,
+                                          char** error);
+SCRAKI_ADB_API int32_t scraki_adb_reverse(scraki_adb* adb, const char* serial, const char* remote, const char* local,
+                                          char** error);
+SCRAKI_ADB_API int32_t scraki_adb_reverse_remove(scraki_adb* adb, const char* serial, const char* remote,
+                                                 char** error);
+/* local_path is UTF-8. mode is the file mode, e.g. 0644. */
+SCRAKI_ADB_API int32_t scraki_adb_push(scraki_adb* adb, const char* serial, const char* local_path,
+                                       const char* remote_path, int32_t mode, char** error);
+
+/* Pushes local_path to remote_path on every device in serials (separated by
+ * newlines), skipping devices whose copy matches by size and SHA-256. At
+ * most max_parallel pushes run at once, per_hub on one USB hub; each device
+ * gets max_attempts tries with backoff. Zero or negative limits pick the
+ * defaults. Device failures do not fail the call; report receives JSON:
+ *
+ *     {"sha256": "...", "size": 90000, "elapsedMs": 812.5, "pushed": 97,
+ *      "skipped": 2, "failed": 1, "devices": [{"serial": "...",
+ *      "hub": "usb:1-2", "outcome": "pushed|skipped|failed",
+ *      "attempts": 1, "elapsedMs": 120.3, "error": "..."}]}
+ */
+SCRAKI_ADB_API int32_t scraki_adb_deploy(scraki_adb* adb, const char* serials, const char* local_path,
+                                         const char* remote_path, int32_t mode, int32_t max_parallel,
+                                         int32_t per_hub, int32_t max_attempts, char** report, char** error);
+
+SCRAKI_ADB_API scraki_adb_tracker* scraki_adb_track_devices(scraki_adb* adb, scraki_adb_devices_callback callback,
+                                                            void* context);
+/* Blocks until the tracker's thread has finished; no callback follows. */
+SCRAKI_ADB_API void scraki_adb_track_stop(scraki_adb_tracker* tracker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* SCRAKI_ADB_H_ */
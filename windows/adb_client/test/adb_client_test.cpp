@@ -0,0 +1,482 @@
+// Exercises AdbClient against a fake adb server on a loopback port that
+// answers the subset of the smart-socket and sync protocols the client uses.
+
+#include "AdbClient.h"
+#include "DeployEngine.h"
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#define CHECK(condition)                                                      \
+    do {                                                                      \
+        if (!(condition)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                    #condition);                                              \
+            exit(1);                                                          \
+        }                                                                     \
+    } while (0)
+
+using Socket = AdbConnection::Socket;
+
+#ifdef _WIN32
+static void CloseSocket(Socket s) { closesocket(s); }
+#else
+static void CloseSocket(Socket s) { close(s); }
+#endif
+
+static bool SendAll(Socket s, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        int sent = send(s, data.data() + offset, static_cast<int>(data.size() - offset), 0);
+        if (sent <= 0) return false;
+        offset += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static bool RecvExact(Socket s, std::string* data, size_t size) {
+    data->resize(size);
+    size_t offset = 0;
+    while (offset < size) {
+        int received = recv(s, &(*data)[offset], static_cast<int>(size - offset), 0);
+        if (received <= 0) return false;
+        offset += static_cast<size_t>(received);
+    }
+    return true;
+}
+
+static std::string Prefixed(const std::string& data) {
+    char length[5];
+    snprintf(length, sizeof(length), "%04zx", data.size());
+    return length + data;
+}
+
+class FakeAdbServer {
+ public:
+  static constexpr const char* kSerial = "emulator-5554";
+  // Two hubs of three phones each, plus the emulator
+  static constexpr const char* kDevices =
+      "emulator-5554          device product:sdk model:Pixel transport_id:1\n"
+      "A1                     device usb:1-2.1 product:p model:A transport_id:2\n"
+      "A2                     device usb:1-2.2 product:p model:A transport_id:3\n"
+      "A3                     device usb:1-2.3 product:p model:A transport_id:4\n"
+      "B1                     device usb:1-3.1 product:p model:B transport_id:5\n"
+      "B2                     device usb:1-3.2 product:p model:B transport_id:6\n"
+      "B3                     device usb:1-3.3 product:p model:B transport_id:7\n";
+
+  FakeAdbServer() {
+      listener_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      sockaddr_in address = {};
+      address.sin_family = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      address.sin_port = 0;
+      CHECK(bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+      CHECK(listen(listener_, 64) == 0);
+      socklen_t length = sizeof(address);
+      CHECK(getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+      port_ = ntohs(address.sin_port);
+      accept_thread_ = std::thread(&FakeAdbServer::AcceptLoop, this);
+  }
+
+  ~FakeAdbServer() {
+      running_ = false;
+      // Wakes accept()
+      std::string error;
+      AdbConnection::Open("127.0.0.1", port_, &error);
+      accept_thread_.join();
+      CloseSocket(listener_);
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (Socket s : open_) {
+#ifdef _WIN32
+          shutdown(s, SD_BOTH);
+#else
+          shutdown(s, SHUT_RDWR);
+#endif
+      }
+      for (auto& worker : workers_) worker.join();
+  }
+
+  int port() const { return port_; }
+  int connections() const { return connections_; }
+
+  std::map<std::string, std::string> files(const std::string& serial = kSerial) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return files_[serial];
+  }
+
+  // Uploads (SEND to DONE) ever in flight at once on one hub
+  int max_uploads_per_hub() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return max_uploads_per_hub_;
+  }
+
+  // The next count transport requests for serial fail
+  void FailTransport(const std::string& serial, int count) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      failing_[serial] = count;
+  }
+
+  // Pushes a new device list to every tracking connection
+  void ChangeDevices(const std::string& devices) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      devices_ = devices;
+      for (Socket s : trackers_) SendAll(s, Prefixed(devices));
+  }
+
+ private:
+  void AcceptLoop() {
+      while (true) {
+          Socket client = accept(listener_, nullptr, nullptr);
+          if (!running_) {
+              CloseSocket(client);
+              return;
+          }
+          connections_++;
+          std::lock_guard<std::mutex> lock(mutex_);
+          open_.insert(client);
+          workers_.emplace_back(&FakeAdbServer::Serve, this, client);
+      }
+  }
+
+  bool ReadRequest(Socket s, std::string* request) {
+      std::string length;
+      if (!RecvExact(s, &length, 4)) return false;
+      return RecvExact(s, request, strtoul(length.c_str(), nullptr, 16));
+  }
+
+  void Serve(Socket s) {
+      std::string request;
+      std::string serial;
+      while (ReadRequest(s, &request)) {
+          if (request == "host:devices-l") {
+              std::lock_guard<std::mutex> lock(mutex_);
+              SendAll(s, "OKAY" + Prefixed(devices_));
+              break;
+          } else if (request == "host:track-devices-l") {
+              std::lock_guard<std::mutex> lock(mutex_);
+              SendAll(s, "OKAY" + Prefixed(devices_));
+              trackers_.insert(s);
+              continue;
+          } else if (request.rfind("host:transport:", 0) == 0) {
+              std::string wanted = request.substr(15);
+              bool known = std::string(kDevices).find(wanted + " ") != std::string::npos;
+              {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  if (failing_[wanted] > 0) {
+                      failing_[wanted]--;
+                      known = false;
+                  }
+              }
+              if (!known) {
+                  SendAll(s, "FAIL" + Prefixed("device '" + wanted + "' not found"));
+                  break;
+              }
+              SendAll(s, "OKAY");
+              serial = wanted;
+          } else if (request.rfind("host-serial:", 0) == 0 && request.find(":forward:") != std::string::npos) {
+              SendAll(s, "OKAYOKAY");
+              break;
+          } else if (!serial.empty() && request.rfind("shell:cat '", 0) == 0) {
+              // cat '<path>' 2>/dev/null
+              std::string path = request.substr(11, request.find('\'', 11) - 11);
+              std::lock_guard<std::mutex> lock(mutex_);
+              SendAll(s, "OKAY" + files_[serial][path]);
+              break;
+          } else if (!serial.empty() && request.rfind("shell:", 0) == 0) {
+              SendAll(s, "OKAY" + request.substr(6) + "\n");
+              break;
+          } else if (!serial.empty() && request.rfind("reverse:forward:", 0) == 0) {
+              SendAll(s, "OKAYOKAY");
+              break;
+          } else if (!serial.empty() && request == "sync:") {
+              SendAll(s, "OKAY");
+              ServeSync(s, serial);
+              break;
+          } else {
+              SendAll(s, "FAIL" + Prefixed("unknown service " + request));
+              break;
+          }
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      trackers_.erase(s);
+      open_.erase(s);
+      CloseSocket(s);
+  }
+
+  void ServeSync(Socket s, const std::string& serial) {
+      std::string hub = serial.substr(0, 1);
+      std::string header;
+      std::string path;
+      std::string content;
+      while (RecvExact(s, &header, 8)) {
+          std::string id = header.substr(0, 4);
+          uint32_t length = ReadLe32(reinterpret_cast<const uint8_t*>(header.data() + 4));
+          if (id == "QUIT") return;
+          if (id == "STAT") {
+              if (!RecvExact(s, &path, length)) return;
+              std::string reply("STAT", 4);
+              std::lock_guard<std::mutex> lock(mutex_);
+              auto& files = files_[serial];
+              bool exists = files.count(path) > 0;
+              AppendLe32(&reply, exists ? 0100644 : 0);
+              AppendLe32(&reply, exists ? static_cast<uint32_t>(files[path].size()) : 0);
+              AppendLe32(&reply, 0);
+              SendAll(s, reply);
+          } else if (id == "SEND") {
+              if (!RecvExact(s, &path, length)) return;
+              path = path.substr(0, path.find(','));
+              content.clear();
+              std::lock_guard<std::mutex> lock(mutex_);
+              max_uploads_per_hub_ = std::max(max_uploads_per_hub_, ++uploads_[hub]);
+          } else if (id == "DATA") {
+              std::string chunk;
+              if (length > 64 * 1024 || !RecvExact(s, &chunk, length)) return;
+              content += chunk;
+          } else if (id == "DONE") {
+              // Long enough for uploads on one hub to overlap if allowed
+              std::this_thread::sleep_for(std::chrono::milliseconds(20));
+              {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  uploads_[hub]--;
+              }
+              if (path.rfind("/readonly/", 0) == 0) {
+                  std::string reply("FAIL", 4);
+                  std::string message = "Read-only file system";
+                  AppendLe32(&reply, static_cast<uint32_t>(message.size()));
+                  SendAll(s, reply + message);
+                  return;
+              }
+              {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  files_[serial][path] = content;
+              }
+              std::string reply("OKAY", 4);
+              AppendLe32(&reply, 0);
+              SendAll(s, reply);
+          } else {
+              return;
+          }
+      }
+  }
+
+  Socket listener_;
+  int port_ = 0;
+  std::atomic<bool> running_{true};
+  std::atomic<int> connections_{0};
+  std::thread accept_thread_;
+
+  std::mutex mutex_;
+  std::vector<std::thread> workers_;
+  std::set<Socket> open_;
+  std::set<Socket> trackers_;
+  std::map<std::string, std::map<std::string, std::string>> files_;
+  std::map<std::string, int> failing_;
+  std::map<std::string, int> uploads_;
+  int max_uploads_per_hub_ = 0;
+  std::string devices_ = kDevices;
+};
+
+static std::string WriteTempFile(const std::string& name, const std::string& content) {
+    std::string path = name;
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+    return path;
+}
+
+static void TestHostQuery(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    std::string response;
+    std::string error;
+    CHECK(client.HostQuery("host:devices-l", &response, &error));
+    CHECK(response == FakeAdbServer::kDevices);
+
+    CHECK(!client.HostQuery("host:bogus", &response, &error));
+    CHECK(error == "unknown service host:bogus");
+}
+
+static void TestShellAndForwarding(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    std::string output;
+    std::string error;
+    CHECK(client.Shell(FakeAdbServer::kSerial, "echo hi", &output, &error));
+    CHECK(output == "echo hi\n");
+
+    CHECK(!client.Shell("missing", "echo hi", &output, &error));
+    CHECK(error == "device 'missing' not found");
+
+    CHECK(client.Forward(FakeAdbServer::kSerial, "tcp:27183", "localabstract:scrcpy", &error));
+    CHECK(client.Reverse(FakeAdbServer::kSerial, "localabstract:scrcpy", "tcp:27183", &error));
+}
+
+static void TestConcurrentRequests(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    const int kThreads = 16;
+    std::atomic<int> succeeded{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 10; ++i) {
+                std::string command = "cmd " + std::to_string(t) + " " + std::to_string(i);
+                std::string output;
+                std::string error;
+                if (client.Shell(FakeAdbServer::kSerial, command, &output, &error) && output == command + "\n") {
+                    succeeded++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    CHECK(succeeded == kThreads * 10);
+}
+
+static void TestPushReusesSyncConnection(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    // Spans several DATA chunks
+    std::string large(200 * 1024 + 17, '\0');
+    for (size_t i = 0; i < large.size(); ++i) large[i] = static_cast<char>(i * 31);
+    std::string large_path = WriteTempFile("adb_client_test_large.bin", large);
+    std::string small_path = WriteTempFile("adb_client_test_small.txt", "hello");
+
+    std::string error;
+    int before = server.connections();
+    CHECK(client.Push(FakeAdbServer::kSerial, large_path, "/data/local/tmp/large.bin", 0644, &error));
+    CHECK(client.Push(FakeAdbServer::kSerial, small_path, "/data/local/tmp/small.txt", 0644, &error));
+    CHECK(server.connections() - before == 1);
+
+    auto files = server.files();
+    CHECK(files["/data/local/tmp/large.bin"] == large);
+    CHECK(files["/data/local/tmp/small.txt"] == "hello");
+
+    CHECK(!client.Push(FakeAdbServer::kSerial, small_path, "/readonly/small.txt", 0644, &error));
+    CHECK(error == "Read-only file system");
+    CHECK(!client.Push(FakeAdbServer::kSerial, "does-not-exist", "/data/local/tmp/x", 0644, &error));
+
+    remove(large_path.c_str());
+    remove(small_path.c_str());
+}
+
+static void TestTrackDevices(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> lists;
+    auto tracker = client.TrackDevices([&](const std::string& devices) {
+        std::lock_guard<std::mutex> lock(mutex);
+        lists.push_back(devices);
+        changed.notify_all();
+    });
+
+    auto wait_for = [&](size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(5), [&] { return lists.size() >= count; });
+    };
+    CHECK(wait_for(1));
+    server.ChangeDevices("");
+    CHECK(wait_for(2));
+    tracker->Stop();
+    server.ChangeDevices(FakeAdbServer::kDevices);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(lists[0] == FakeAdbServer::kDevices);
+    CHECK(lists[1].empty());
+}
+
+static void TestDeploySkipsUnchangedDevices(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    DeployEngine engine(&client);
+    std::string path = WriteTempFile("adb_client_test_server.jar", std::string(3000, 'j'));
+    const std::string remote = "/data/local/tmp/server.jar";
+    DeployEngine::Options options;
+    DeployEngine::Report report;
+    std::string error;
+
+    CHECK(engine.Deploy({FakeAdbServer::kSerial}, path, remote, 0644, options, &report, &error));
+    CHECK(report.pushed == 1 && report.skipped == 0 && report.failed == 0);
+    // SHA-256 of 3000 'j's
+    CHECK(report.sha256 == "51e05a0097a1097f56b8afe1c5e1c1145046512f6a46133d28c828fca60bf228");
+    CHECK(server.files()[remote] == std::string(3000, 'j'));
+    CHECK(server.files()[remote + ".sha256"] == report.sha256 + "\n");
+
+    CHECK(engine.Deploy({FakeAdbServer::kSerial}, path, remote, 0644, options, &report, &error));
+    CHECK(report.skipped == 1 && report.pushed == 0);
+
+    // Same size, different content
+    WriteTempFile(path, std::string(3000, 'k'));
+    CHECK(engine.Deploy({FakeAdbServer::kSerial}, path, remote, 0644, options, &report, &error));
+    CHECK(report.pushed == 1);
+    CHECK(server.files()[remote] == std::string(3000, 'k'));
+
+    CHECK(!engine.Deploy({FakeAdbServer::kSerial}, "does-not-exist", remote, 0644, options, &report, &error));
+    remove(path.c_str());
+}
+
+static void TestDeployBoundsParallelismPerHub(FakeAdbServer& server) {
+    AdbClient client("127.0.0.1", server.port());
+    DeployEngine engine(&client);
+    std::string path = WriteTempFile("adb_client_test_fleet.jar", "fleet");
+    DeployEngine::Options options;
+    options.max_parallel = 6;
+    options.per_hub = 2;
+    options.backoff = std::chrono::milliseconds(10);
+    server.FailTransport("B2", 2);
+    DeployEngine::Report report;
+    std::string error;
+
+    std::vector<std::string> fleet = {"A1", "A2", "A3", "B1", "B2", "B3", "missing"};
+    CHECK(engine.Deploy(fleet, path, "/data/local/tmp/fleet.jar", 0644, options, &report, &error));
+    CHECK(report.pushed == 6 && report.failed == 1);
+    CHECK(server.max_uploads_per_hub() == 2);
+    for (const auto& device : report.devices) {
+        if (device.serial[0] == 'A') CHECK(device.hub == "usb:1-2");
+        if (device.serial[0] == 'B') CHECK(device.hub == "usb:1-3");
+        if (device.serial == "B2") CHECK(device.attempts == 3 && device.outcome == DeployEngine::Outcome::kPushed);
+        if (device.serial == "missing") {
+            CHECK(device.attempts == options.max_attempts);
+            CHECK(device.error == "device 'missing' not found");
+        }
+    }
+    std::string json = DeployEngine::ToJson(report);
+    CHECK(json.find("\"serial\":\"B2\",\"hub\":\"usb:1-3\",\"outcome\":\"pushed\",\"attempts\":3") !=
+          std::string::npos);
+    remove(path.c_str());
+}
+
+static void TestServerDown() {
+    int port = 0;
+    {
+        FakeAdbServer server;
+        port = server.port();
+    }
+    AdbClient client("127.0.0.1", port);
+    std::string response;
+    std::string error;
+    CHECK(!client.HostQuery("host:devices-l", &response, &error));
+    CHECK(error.find("cannot connect") == 0);
+}
+
+int main() {
+    FakeAdbServer server;
+    TestHostQuery(server);
+    TestShellAndForwarding(server);
+    TestConcurrentRequests(server);
+    TestPushReusesSyncConnection(server);
+    TestTrackDevices(server);
+    TestDeploySkipsUnchangedDevices(server);
+    TestDeployBoundsParallelismPerHub(server);
+    TestServerDown();
+    printf("adb_client_test passed\n");
+    return 0;
+}
@@ -0,0 +1,83 @@
+#ifndef HOST_PROTOCOL_H_
+#define HOST_PROTOCOL_H_
+
+#include <windows.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Messages between the app and scraki_decoder_host.exe. The host reads
+// commands on stdin and writes events on stdout, both anonymous pipes set up
+// by the app. Every message is a HostMessage followed by size payload bytes.
+// Decoded frames never go through the pipe: they are written to a shared
+// memory ring (frame_reader/scraki_frames.h) and only announced here.
+
+enum class HostMessageType : uint32_t {
+    // App to host
+    kStartSession = 1,   // payload "host:port"
+    kStopSession = 2,
+
+    // Host to app
+    kFramesMapping = 16, // payload: name of the session's (new) frame ring
+    kFrame = 17,         // value: sequence number in the ring; payload: int64 time_us its packet was received
+    kConnection = 18,    // payload: event type as in-process; value: elapsed ms
+};
+
+struct HostMessage {
+    HostMessageType type;
+    uint32_t size = 0;
+    int64_t texture_id = 0;
+    int64_t value = 0;
+    int64_t time_us = 0; // Sender's steady clock (QPC based, shared by processes)
+};
+static_assert(sizeof(HostMessage) == 32, "host message layout");
+
+static constexpr uint32_t kMaxHostPayload = 4096;
+
+inline int64_t HostClockUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline bool ReadExact(HANDLE pipe, void* data, DWORD size) {
+    auto* p = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        DWORD read = 0;
+        if (!ReadFile(pipe, p, size, &read, nullptr) || read == 0) return false;
+        p += read;
+        size -= read;
+    }
+    return true;
+}
+
+// False once the other side closed its end (or died).
+inline bool ReadHostMessage(HANDLE pipe, HostMessage* message, std::string* payload) {
+    if (!ReadExact(pipe, message, sizeof(HostMessage)) || message->size > kMaxHostPayload) return false;
+    payload->resize(message->size);
+    return message->size == 0 || ReadExact(pipe, payload->data(), message->size);
+}
+
+// Callers serialize writes to one pipe.
+inline bool WriteHostMessage(HANDLE pipe, HostMessageType type, int64_t texture_id, int64_t value,
+                             const std::string& payload = std::string()) {
+    if (payload.size() > kMaxHostPayload) return false;
+    HostMessage message;
+    message.type = type;
+    message.size = static_cast<uint32_t>(payload.size());
+    message.texture_id = texture_id;
+    message.value = value;
+    message.time_us = HostClockUs();
+
+    // One write per message keeps small messages atomic on the pipe
+    char buffer[sizeof(HostMessage) + kMaxHostPayload];
+    memcpy(buffer, &message, sizeof(message));
+    if (!payload.empty()) memcpy(buffer + sizeof(message), payload.data(), payload.size());
+    DWORD total = static_cast<DWORD>(sizeof(message) + payload.size());
+    DWORD written = 0;
+    return WriteFile(pipe, buffer, total, &written, nullptr) && written == total;
+}
+
+#endif  // HOST_PROTOCOL_H_
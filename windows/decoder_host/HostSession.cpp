@@ -0,0 +1,300 @@
+#include "HostSession.h"
+
+#include <ws2tcpip.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Same policy as in-process sessions
+static const int kConnectTimeoutMs = 1000;
+static const auto kReconnectInitialBackoff = std::chrono::milliseconds(50);
+static const auto kReconnectMaxBackoff = std::chrono::milliseconds(2000);
+static const auto kReconnectWindow = std::chrono::seconds(15);
+
+// A corrupt stream still only costs this session, not the host's others
+static int SwsScaleSafe(SwsContext* context, uint8_t* src_data[], int src_linesize[], int src_y, int src_h,
+                        uint8_t* dst_data[], int dst_linesize[]) {
+    __try {
+        return sws_scale(context, src_data, src_linesize, src_y, src_h, dst_data, dst_linesize);
+    } __except (EXCEPTION_EXECUTE_HANDLER) {
+        return -1;
+    }
+}
+
+static int AvCodecSendPacketSafe(AVCodecContext* ctx, AVPacket* pkt) {
+    __try {
+        return avcodec_send_packet(ctx, pkt);
+    } __except (EXCEPTION_EXECUTE_HANDLER) {
+        return -1;
+    }
+}
+
+static int AvCodecReceiveFrameSafe(AVCodecContext* ctx, AVFrame* frame) {
+    __try {
+        return avcodec_receive_frame(ctx, frame);
+    } __except (EXCEPTION_EXECUTE_HANDLER) {
+        return -1;
+    }
+}
+
+bool HostChannel::Send(HostMessageType type, int64_t texture_id, int64_t value, const std::string& payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return WriteHostMessage(pipe_, type, texture_id, value, payload);
+}
+
+HostSession::HostSession(int64_t texture_id, std::string host, int port, std::shared_ptr<HostChannel> channel)
+    : texture_id_(texture_id), host_(std::move(host)), port_(port), channel_(std::move(channel)) {
+    thread_ = std::thread([this]() { Run(); });
+}
+
+HostSession::~HostSession() {
+    running_ = false;
+    CloseSocket();
+    if (thread_.joinable()) thread_.join();
+
+    if (sws_context_) sws_freeContext(sws_context_);
+    if (frame_) av_frame_free(&frame_);
+    if (packet_) av_packet_free(&packet_);
+    if (codec_context_) avcodec_free_context(&codec_context_);
+}
+
+void HostSession::SendConnection(const char* type, int64_t elapsed_ms) {
+    channel_->Send(HostMessageType::kConnection, texture_id_, elapsed_ms, type);
+}
+
+bool HostSession::OpenDecoder() {
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_HEVC);
+    if (!codec) return false;
+    codec_context_ = avcodec_alloc_context3(codec);
+    if (!codec_context_) return false;
+    codec_context_->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    codec_context_->flags2 |= AV_CODEC_FLAG2_FAST;
+    codec_context_->thread_count = 1;
+    if (avcodec_open2(codec_context_, codec, NULL) < 0) return false;
+    packet_ = av_packet_alloc();
+    frame_ = av_frame_alloc();
+    return packet_ && frame_;
+}
+
+void HostSession::Run() {
+    if (!OpenDecoder()) {
+        LogTrace("HostSession [%lld] - Error: decoder open failed", texture_id_);
+        SendConnection("disconnected", 0);
+        return;
+    }
+
+    bool was_connected = false;
+    while (running_) {
+        auto reconnect_start = std::chrono::steady_clock::now();
+        if (!ConnectWithRetry()) break;
+        if (was_connected) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - reconnect_start).count();
+            avcodec_flush_buffers(codec_context_);
+            SendConnection("reconnected", elapsed);
+        }
+        was_connected = true;
+
+        ReceiveLoop();
+        CloseSocket();
+        if (running_) SendConnection("reconnecting", 0);
+    }
+    if (running_) SendConnection("disconnected", 0);
+}
+
+bool HostSession::Connect(int timeout_ms) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* address = nullptr;
+    if (getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &address) != 0 || !address) return false;
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        freeaddrinfo(address);
+        return false;
+    }
+    {
+        // Published first so the destructor can abort the connect
+        std::lock_guard<std::mutex> lock(socket_mutex_);
+        if (!running_) {
+            closesocket(sock);
+            freeaddrinfo(address);
+            return false;
+        }
+        socket_ = sock;
+    }
+
+    int rcvbuf = 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf));
+    BOOL nodelay = TRUE;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+
+    u_long non_blocking = 1;
+    ioctlsocket(sock, FIONBIO, &non_blocking);
+    bool connected = connect(sock, address->ai_addr, (int)address->ai_addrlen) != SOCKET_ERROR;
+    int err = connected ? 0 : WSAGetLastError();
+    freeaddrinfo(address);
+    if (!connected && err == WSAEWOULDBLOCK) {
+        fd_set write_set;
+        FD_ZERO(&write_set);
+        FD_SET(sock, &write_set);
+        timeval timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+        if (select(0, NULL, &write_set, NULL, &timeout) > 0) {
+            int so_error = 0;
+            int len = sizeof(so_error);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&so_error, &len);
+            connected = so_error == 0;
+        }
+    }
+    if (!connected || !running_) {
+        CloseSocket();
+        return false;
+    }
+
+    u_long blocking = 0;
+    ioctlsocket(sock, FIONBIO, &blocking);
+    return true;
+}
+
+bool HostSession::ConnectWithRetry() {
+    auto deadline = std::chrono::steady_clock::now() + kReconnectWindow;
+    auto backoff = kReconnectInitialBackoff;
+    while (running_) {
+        if (Connect(kConnectTimeoutMs)) return true;
+        if (std::chrono::steady_clock::now() + backoff >= deadline) break;
+        auto wake = std::chrono::steady_clock::now() + backoff;
+        while (running_ && std::chrono::steady_clock::now() < wake) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        backoff = std::min(backoff * 2, kReconnectMaxBackoff);
+    }
+    return false;
+}
+
+void HostSession::CloseSocket() {
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    if (socket_ != INVALID_SOCKET) {
+        shutdown(socket_, SD_BOTH);
+        closesocket(socket_);
+        socket_ = INVALID_SOCKET;
+    }
+}
+
+bool HostSession::ReceiveExact(uint8_t* data, size_t size) {
+    while (size > 0 && running_) {
+        int received = recv(socket_, (char*)data, (int)std::min<size_t>(size, 1 << 20), 0);
+        if (received <= 0) return false;
+        data += received;
+        size -= (size_t)received;
+    }
+    return size == 0;
+}
+
+void HostSession::ReceiveLoop() {
+    std::vector<uint8_t> payload;
+    bool install_config = false;
+    bool awaiting_config = true;
+    bool awaiting_keyframe = true;
+
+    while (running_) {
+        // scrcpy frame header: 8 byte PTS with config/key flags, 4 byte size
+        uint8_t header[12];
+        if (!ReceiveExact(header, sizeof(header))) return;
+        uint64_t pts = 0;
+        for (int i = 0; i < 8; ++i) pts = (pts << 8) | header[i];
+        uint32_t size = ((uint32_t)header[8] << 24) | ((uint32_t)header[9] << 16) | ((uint32_t)header[10] << 8) |
+                        (uint32_t)header[11];
+        if (size > 20 * 1024 * 1024) {
+            LogTrace("HostSession [%lld] - Invalid payload size: %u", texture_id_, size);
+            return;
+        }
+        if (size == 0) continue;
+
+        bool is_config = (pts & 0x8000000000000000ULL) != 0;
+        bool is_key_frame = (pts & 0x4000000000000000ULL) != 0;
+        int64_t pts_us = (int64_t)(pts & 0x3FFFFFFFFFFFFFFFULL);
+
+        payload.resize(size);
+        if (!ReceiveExact(payload.data(), size)) return;
+
+        if (is_config) {
+            // Installed with the next frame, as in-process
+            if (bitstream_.SetConfig(payload.data(), payload.size()) || awaiting_config) install_config = true;
+            awaiting_config = false;
+            continue;
+        }
+        auto frame_type = bitstream_.Classify(payload.data(), payload.size());
+        bool key = frame_type == BitstreamParser::FrameType::kKey ||
+                   (frame_type == BitstreamParser::FrameType::kUnknown && is_key_frame);
+        if (awaiting_config || (awaiting_keyframe && !key)) continue;
+        awaiting_keyframe = false;
+
+        packet_received_us_ = HostClockUs();
+        Decode(payload, pts_us, install_config ? &bitstream_.extradata() : nullptr);
+        install_config = false;
+    }
+}
+
+void HostSession::Decode(const std::vector<uint8_t>& data, int64_t pts_us, const std::vector<uint8_t>* extradata) {
+    packet_->data = (uint8_t*)data.data();
+    packet_->size = (int)data.size();
+    packet_->pts = pts_us;
+    if (extradata && !extradata->empty()) {
+        uint8_t* side_data = av_packet_new_side_data(packet_, AV_PKT_DATA_NEW_EXTRADATA, extradata->size());
+        if (side_data) memcpy(side_data, extradata->data(), extradata->size());
+    }
+    int ret = AvCodecSendPacketSafe(codec_context_, packet_);
+    av_packet_unref(packet_);
+    if (ret < 0 && ret != AVERROR(EAGAIN)) {
+        LogTrace("HostSession [%lld] - Error: send packet failed: %d", texture_id_, ret);
+        return;
+    }
+    while (AvCodecReceiveFrameSafe(codec_context_, frame_) >= 0) {
+        Present(frame_);
+        av_frame_unref(frame_);
+    }
+}
+
+void HostSession::Present(AVFrame* frame) {
+    if (frame->width <= 0 || frame->height <= 0) return;
+
+    uint8_t* pixels = ring_ ? ring_->BeginWrite(frame->width, frame->height, frame->pts) : nullptr;
+    if (!pixels) {
+        // First frame, or a size the ring was not made for (rotation). The
+        // new mapping is announced; the app lets go of the old one once it
+        // shows a frame of the new one.
+        std::string name = "Local\\scraki_frames_" + std::to_string(texture_id_) + "_" +
+                           std::to_string(GetCurrentProcessId()) + "_" + std::to_string(++ring_generation_);
+        std::string error;
+        auto ring = FrameExporter::Create(name, kRingSlots, static_cast<size_t>(frame->width) * frame->height * 4,
+                                          &error);
+        if (!ring) {
+            LogTrace("HostSession [%lld] - Error: %s", texture_id_, error.c_str());
+            return;
+        }
+        ring_ = std::move(ring);
+        channel_->Send(HostMessageType::kFramesMapping, texture_id_, kRingSlots, ring_->name());
+        pixels = ring_->BeginWrite(frame->width, frame->height, frame->pts);
+        if (!pixels) return;
+    }
+
+    sws_context_ = sws_getCachedContext(sws_context_, frame->width, frame->height, (AVPixelFormat)frame->format,
+                                        frame->width, frame->height, AV_PIX_FMT_RGBA, SWS_FAST_BILINEAR, NULL,
+                                        NULL, NULL);
+    // Converted in place: the app displays the slot without another copy
+    uint8_t* dest[4] = { pixels, NULL, NULL, NULL };
+    int dest_linesize[4] = { frame->width * 4, 0, 0, 0 };
+    if (!sws_context_ ||
+        SwsScaleSafe(sws_context_, frame->data, frame->linesize, 0, frame->height, dest, dest_linesize) <= 0) {
+        LogTrace("HostSession [%lld] - Error: conversion failed", texture_id_);
+        ring_->AbortWrite();
+        return;
+    }
+    // Lets the app compare decode time with in-process sessions
+    std::string received(sizeof(packet_received_us_), '\0');
+    memcpy(received.data(), &packet_received_us_, sizeof(packet_received_us_));
+    channel_->Send(HostMessageType::kFrame, texture_id_, ring_->CommitWrite(), received);
+}
@@ -0,0 +1,86 @@
+#ifndef HOST_SESSION_H_
+#define HOST_SESSION_H_
+
+#include <winsock2.h>
+#include <windows.h>
+
+#include "HostProtocol.h"
+#include "runner/BitstreamParser.h"
+#include "runner/FrameExporter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+void LogTrace(const char* format, ...);
+
+// Serialized writer for the host's event pipe (stdout).
+class HostChannel {
+ public:
+  explicit HostChannel(HANDLE pipe) : pipe_(pipe) {}
+
+  bool Send(HostMessageType type, int64_t texture_id, int64_t value, const std::string& payload = std::string());
+
+ private:
+  HANDLE pipe_;
+  std::mutex mutex_;
+};
+
+// One device stream decoded inside the host process: the same scrcpy
+// framing, reconnect policy and FFmpeg decode as an in-process session, but
+// frames are converted straight into a shared-memory ring the app maps.
+// Display-side features (pacing, QoS, taps) stay in the app.
+class HostSession {
+ public:
+  HostSession(int64_t texture_id, std::string host, int port, std::shared_ptr<HostChannel> channel);
+  ~HostSession();
+
+  HostSession(const HostSession&) = delete;
+  HostSession& operator=(const HostSession&) = delete;
+
+ private:
+  void Run();
+  bool OpenDecoder();
+  bool Connect(int timeout_ms);
+  bool ConnectWithRetry();
+  void CloseSocket();
+  bool ReceiveExact(uint8_t* data, size_t size);
+  void ReceiveLoop();
+  void Decode(const std::vector<uint8_t>& data, int64_t pts_us, const std::vector<uint8_t>* extradata = nullptr);
+  void Present(AVFrame* frame);
+  void SendConnection(const char* type, int64_t elapsed_ms);
+
+  static constexpr int kRingSlots = 4; // Newest, pinned by the app, one being written, spare
+
+  const int64_t texture_id_;
+  const std::string host_;
+  const int port_;
+  std::shared_ptr<HostChannel> channel_;
+
+  std::atomic<bool> running_{true};
+  std::mutex socket_mutex_;
+  SOCKET socket_ = INVALID_SOCKET;
+
+  // Session thread only
+  AVCodecContext* codec_context_ = nullptr;
+  AVPacket* packet_ = nullptr;
+  AVFrame* frame_ = nullptr;
+  BitstreamParser bitstream_{BitstreamParser::Codec::kHevc};
+  SwsContext* sws_context_ = nullptr;
+  std::unique_ptr<FrameExporter> ring_;
+  int ring_generation_ = 0;
+  int64_t packet_received_us_ = 0; // Of the packet being decoded
+
+  std::thread thread_;
+};
+
+#endif  // HOST_SESSION_H_
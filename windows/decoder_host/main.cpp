@@ -0,0 +1,76 @@
+// scraki_decoder_host: decodes device streams for the app in a separate
+// process (configureDecoderHosts), so a decoder crash or heap corruption
+// caused by a bad stream takes down this host and its sessions only. The app
+// relaunches a dead host and starts its sessions again.
+//
+// Commands arrive on stdin and events leave on stdout (HostProtocol.h); the
+// host exits when the app closes stdin or goes away.
+#define _CRT_SECURE_NO_WARNINGS
+#include <winsock2.h>
+#include <windows.h>
+
+#include "HostProtocol.h"
+#include "HostSession.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <memory>
+
+void LogTrace(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char message[2048];
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    SYSTEMTIME st;
+    GetLocalTime(&st);
+    char full_log[2500];
+    snprintf(full_log, sizeof(full_log), "[%02d:%02d:%02d.%03d] [PID:%lu] [DecoderHost] %s\n", st.wHour, st.wMinute,
+             st.wSecond, st.wMilliseconds, GetCurrentProcessId(), message);
+    OutputDebugStringA(full_log);
+
+    // stdout is the event pipe; errors go to the app's error log instead
+    if (strstr(message, "Error") || strstr(message, "failed")) {
+        FILE* f = fopen("C:\\Users\\Public\\scraki_errors.log", "a");
+        if (f) {
+            fprintf(f, "%s", full_log);
+            fclose(f);
+        }
+    }
+}
+
+int main() {
+    HANDLE commands = GetStdHandle(STD_INPUT_HANDLE);
+    HANDLE events = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (commands == INVALID_HANDLE_VALUE || events == INVALID_HANDLE_VALUE || !commands || !events) return 2;
+
+    WSADATA wsa_data;
+    WSAStartup(MAKEWORD(2, 2), &wsa_data);
+    av_log_set_level(AV_LOG_QUIET);
+    LogTrace("Started");
+
+    auto channel = std::make_shared<HostChannel>(events);
+    std::map<int64_t, std::unique_ptr<HostSession>> sessions;
+    HostMessage message;
+    std::string payload;
+    while (ReadHostMessage(commands, &message, &payload)) {
+        if (message.type == HostMessageType::kStartSession) {
+            size_t colon = payload.rfind(':');
+            if (colon == std::string::npos) continue;
+            int port = atoi(payload.c_str() + colon + 1);
+            // A repeated start (after a restart race) replaces the session
+            sessions.erase(message.texture_id);
+            sessions[message.texture_id] =
+                std::make_unique<HostSession>(message.texture_id, payload.substr(0, colon), port, channel);
+        } else if (message.type == HostMessageType::kStopSession) {
+            sessions.erase(message.texture_id);
+        }
+    }
+
+    LogTrace("App closed the command pipe, exiting");
+    sessions.clear();
+    WSACleanup();
+    return 0;
+}
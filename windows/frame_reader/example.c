@@ -0,0 +1,71 @@
+/*
+ * Follows the frames of one session and prints their rate; with an output
+ * path the newest frame is also saved as a PPM image.
+ *
+ *     scraki_frames_example <textureId> [frame.ppm]
+ */
+#include "scraki_frames.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+
+static int SavePpm(const scraki_frame* frame, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+    fprintf(f, "P6\n%u %u\n255\n", frame->width, frame->height);
+    for (uint32_t y = 0; y < frame->height; ++y) {
+        const uint8_t* row = frame->pixels + (size_t)y * frame->stride;
+        for (uint32_t x = 0; x < frame->width; ++x) fwrite(row + x * 4, 1, 3, f);
+    }
+    fclose(f);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <textureId> [frame.ppm]\n", argv[0]);
+        return 2;
+    }
+
+    scraki_frames* ring;
+    int64_t texture_id = _atoi64(argv[1]);
+    if (scraki_frames_open(texture_id, &ring) != 0) {
+        fprintf(stderr, "texture %lld is not exporting frames\n", (long long)texture_id);
+        return 1;
+    }
+
+    scraki_frame frame;
+    uint64_t seen = 0;
+    int frames = 0;
+    int stale = 0;
+    ULONGLONG window_start = GetTickCount64();
+    int result;
+    while ((result = scraki_frames_acquire(ring, seen, 2000, &frame)) >= 0) {
+        if (result == 0) {
+            printf("no new frame (static screen)\n");
+            continue;
+        }
+        /* A real consumer runs OCR or matching here, then validates */
+        if (argc > 2 && frames == 0) SavePpm(&frame, argv[2]);
+        if (!scraki_frames_validate(ring, &frame)) {
+            stale++;
+            continue;
+        }
+        seen = frame.seq;
+        frames++;
+
+        ULONGLONG now = GetTickCount64();
+        if (now - window_start >= 1000) {
+            printf("%ux%u  %d fps  seq %llu  pts %lld us  stale %d\n", frame.width, frame.height, frames,
+                   (unsigned long long)frame.seq, (long long)frame.pts_us, stale);
+            frames = 0;
+            stale = 0;
+            window_start = now;
+        }
+    }
+
+    printf("session stopped exporting\n");
+    scraki_frames_close(ring);
+    return 0;
+}
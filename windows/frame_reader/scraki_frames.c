@@ -0,0 +1,96 @@
+#include "scraki_frames.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+
+struct scraki_frames {
+    HANDLE mapping;
+    const uint8_t* base;
+    const scraki_ring_header* header;
+};
+
+static int64_t LoadAcquire(const int64_t* value) {
+    /* Interlocked read: a full barrier on every Windows target */
+    return InterlockedCompareExchange64((volatile LONG64*)value, 0, 0);
+}
+
+static const scraki_slot_header* Slot(const scraki_frames* ring, uint32_t index) {
+    return (const scraki_slot_header*)(ring->base + ring->header->header_size +
+                                       (size_t)index * ring->header->slot_size);
+}
+
+int scraki_frames_open(int64_t texture_id, scraki_frames** ring) {
+    char name[64];
+    snprintf(name, sizeof(name), SCRAKI_FRAMES_NAME_PREFIX "%lld", (long long)texture_id);
+
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (!mapping) return -1;
+    const uint8_t* base = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        CloseHandle(mapping);
+        return -1;
+    }
+
+    const scraki_ring_header* header = (const scraki_ring_header*)base;
+    if (header->magic != SCRAKI_FRAMES_MAGIC || header->version != SCRAKI_FRAMES_VERSION ||
+        header->slot_count == 0) {
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        return -2;
+    }
+
+    scraki_frames* result = (scraki_frames*)calloc(1, sizeof(scraki_frames));
+    if (!result) {
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        return -1;
+    }
+    result->mapping = mapping;
+    result->base = base;
+    result->header = header;
+    *ring = result;
+    return 0;
+}
+
+void scraki_frames_close(scraki_frames* ring) {
+    if (!ring) return;
+    UnmapViewOfFile(ring->base);
+    CloseHandle(ring->mapping);
+    free(ring);
+}
+
+int scraki_frames_acquire(scraki_frames* ring, uint64_t after_seq, uint32_t timeout_ms, scraki_frame* frame) {
+    ULONGLONG deadline = GetTickCount64() + timeout_ms;
+    for (;;) {
+        int64_t latest = LoadAcquire(&ring->header->latest_seq);
+        if ((uint64_t)latest > after_seq) {
+            uint32_t index = (uint32_t)((latest - 1) % ring->header->slot_count);
+            const scraki_slot_header* slot = Slot(ring, index);
+            int64_t lock = LoadAcquire(&slot->lock);
+            /* Odd: the writer lapped us and is refilling the slot; retry */
+            if ((lock & 1) == 0) {
+                frame->pixels = (const uint8_t*)(slot + 1);
+                frame->seq = (uint64_t)slot->seq;
+                frame->pts_us = slot->pts_us;
+                frame->width = slot->width;
+                frame->height = slot->height;
+                frame->stride = slot->stride;
+                frame->format = slot->format;
+                frame->lock = lock;
+                frame->slot = index;
+                if (LoadAcquire(&slot->lock) == lock && frame->seq > after_seq) return 1;
+            }
+            continue;
+        }
+        if (!ring->header->writer_alive) return -1;
+        if (GetTickCount64() >= deadline) return 0;
+        /* Frames come at most every few ms; polling keeps the writer free of
+         * any per-reader signalling */
+        Sleep(1);
+    }
+}
+
+int scraki_frames_validate(const scraki_frames* ring, const scraki_frame* frame) {
+    return LoadAcquire(&Slot(ring, frame->slot)->lock) == frame->lock;
+}
@@ -0,0 +1,98 @@
+/*
+ * Reader for the decoded frames Scraki exports to shared memory
+ * (startFrameExport on the scraki/video_decoder channel).
+ *
+ * Each exporting session owns a named file mapping "Local\scraki_frames_<id>"
+ * holding a ring of slots with the newest RGBA frames. Frames are read in
+ * place: acquire a frame, use its pixels, then check it was not overwritten.
+ * With N slots a reader has N - 1 frame intervals before that happens.
+ *
+ *     scraki_frames* ring;
+ *     scraki_frame frame;
+ *     uint64_t seen = 0;
+ *     if (scraki_frames_open(texture_id, &ring) == 0) {
+ *         while (scraki_frames_acquire(ring, seen, 1000, &frame) > 0) {
+ *             analyze(frame.pixels, frame.width, frame.height, frame.stride);
+ *             if (scraki_frames_validate(ring, &frame)) seen = frame.seq;
+ *         }
+ *         scraki_frames_close(ring);
+ *     }
+ */
+#ifndef SCRAKI_FRAMES_H_
+#define SCRAKI_FRAMES_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Shared-memory layout, written by the app. All fields are little-endian. */
+
+#define SCRAKI_FRAMES_MAGIC 0x31524653u /* "SFR1" */
+#define SCRAKI_FRAMES_VERSION 1
+#define SCRAKI_FRAMES_NAME_PREFIX "Local\\scraki_frames_"
+
+enum scraki_frame_format {
+    SCRAKI_FORMAT_RGBA = 1,
+};
+
+typedef struct scraki_ring_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;     /* Bytes per slot, slot header included */
+    uint32_t header_size;   /* Offset of the first slot */
+    uint32_t writer_alive;  /* 0 once the session stopped exporting */
+    int64_t latest_seq;     /* Newest complete frame, 0 before the first */
+    int64_t pinned_seq;     /* Frame the writer must not overwrite, 0 = none.
+                             * Set by the app itself when it displays frames
+                             * from a decoder host; other readers ignore it. */
+    uint8_t reserved[24];
+} scraki_ring_header;
+
+/* Frame n (from 1) lives in slot (n - 1) % slot_count. */
+typedef struct scraki_slot_header {
+    int64_t lock;           /* Seqlock: odd while the slot is written */
+    int64_t seq;
+    int64_t pts_us;         /* Device capture time */
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;        /* scraki_frame_format */
+    uint8_t reserved[24];
+} scraki_slot_header;       /* Pixels follow, 64-byte aligned */
+
+/* Reader API */
+
+typedef struct scraki_frames scraki_frames;
+
+typedef struct scraki_frame {
+    const uint8_t* pixels;  /* Points into the mapping, valid until overwritten */
+    uint64_t seq;
+    int64_t pts_us;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;
+    int64_t lock;           /* For scraki_frames_validate */
+    uint32_t slot;
+} scraki_frame;
+
+/* Returns 0, or -1 if the session does not export, -2 on a layout mismatch. */
+int scraki_frames_open(int64_t texture_id, scraki_frames** ring);
+void scraki_frames_close(scraki_frames* ring);
+
+/* Waits up to timeout_ms for a frame newer than after_seq. Returns 1 with
+ * frame filled, 0 on timeout, -1 once the writer stopped. */
+int scraki_frames_acquire(scraki_frames* ring, uint64_t after_seq, uint32_t timeout_ms, scraki_frame* frame);
+
+/* Returns 1 if the frame was not overwritten since it was acquired. Call it
+ * after reading the pixels and discard results computed from a stale frame. */
+int scraki_frames_validate(const scraki_frames* ring, const scraki_frame* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* SCRAKI_FRAMES_H_ */
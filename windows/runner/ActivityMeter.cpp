@@ -0,0 +1,39 @@
+#include "ActivityMeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+// An inter frame a quarter the size of a keyframe counts as fully changed
+static const double kSizeGain = 4.0;
+// Integrator time constant
+static const double kDecaySeconds = 1.0;
+
+void ActivityMeter::OnPacket(Clock::time_point now, size_t bytes, bool key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Keyframes come on a timer or on request and say nothing about the
+    // screen; they are the scale for the frames after them
+    if (key) {
+        key_bytes_ = bytes;
+        return;
+    }
+    if (key_bytes_ == 0) return;
+
+    double ratio = (double)bytes / (double)key_bytes_;
+    snapshot_.size_ratio += (ratio - snapshot_.size_ratio) / 8.0;
+    double intensity = std::min(1.0, ratio * kSizeGain);
+    level_ = ScoreLocked(now) + intensity / (kReferenceFps * kDecaySeconds);
+    level_time_ = now;
+}
+
+ActivityMeter::Snapshot ActivityMeter::GetSnapshot(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snapshot = snapshot_;
+    snapshot.score = std::min(1.0, ScoreLocked(now));
+    return snapshot;
+}
+
+double ActivityMeter::ScoreLocked(Clock::time_point now) const {
+    if (level_time_ == Clock::time_point()) return 0;
+    double elapsed = std::max(0.0, std::chrono::duration<double>(now - level_time_).count());
+    return level_ * std::exp(-elapsed / kDecaySeconds);
+}
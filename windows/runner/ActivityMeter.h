@@ -0,0 +1,40 @@
+#ifndef ACTIVITY_METER_H_
+#define ACTIVITY_METER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+// How busy a session's screen is, from the compressed stream alone: the size
+// of each inter frame against the last keyframe. A still screen encodes to
+// almost nothing between keyframes, a changing one to a sizeable share of a
+// keyframe. Each frame's intensity (0..1) goes into a leaky integrator, so the
+// score is the recent rate of change: about 1 at kReferenceFps fully changing
+// frames, and it decays to 0 on its own when the device stops sending.
+class ActivityMeter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Snapshot {
+      double score = 0;       // 0 static .. 1 busy
+      double size_ratio = 0;  // Inter frame size against the last keyframe (EWMA)
+  };
+
+  // Decoder thread, once per frame packet, decoded or not.
+  void OnPacket(Clock::time_point now, size_t bytes, bool key);
+
+  Snapshot GetSnapshot(Clock::time_point now) const;
+
+ private:
+  static constexpr double kReferenceFps = 30.0;
+
+  double ScoreLocked(Clock::time_point now) const;
+
+  mutable std::mutex mutex_;
+  Snapshot snapshot_;
+  double level_ = 0; // Integrator state at level_time_
+  Clock::time_point level_time_;
+  size_t key_bytes_ = 0;
+};
+
+#endif  // ACTIVITY_METER_H_
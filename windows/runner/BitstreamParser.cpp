@@ -0,0 +1,199 @@
+#include "BitstreamParser.h"
+
+// Calls visit(nal, size) for every NAL unit of an Annex B stream, start
+// codes stripped, until it returns false.
+template <typename Visit>
+static void ForEachNal(const uint8_t* data, size_t size, Visit&& visit) {
+    auto find_start = [data, size](size_t from) {
+        for (size_t i = from; i + 3 <= size; ++i) {
+            if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) return i;
+        }
+        return size;
+    };
+    size_t start = find_start(0);
+    while (start < size) {
+        size_t nal = start + 3;
+        size_t next = find_start(nal);
+        // A NAL never ends in a zero byte; those belong to a 4-byte start code
+        size_t end = next;
+        while (end > nal && data[end - 1] == 0) --end;
+        if (end > nal && !visit(data + nal, end - nal)) return;
+        start = next;
+    }
+}
+
+// Calls visit(type, payload, payload_size, obu, obu_size) for every OBU of
+// a low-overhead AV1 stream until it returns false.
+template <typename Visit>
+static void ForEachObu(const uint8_t* data, size_t size, Visit&& visit) {
+    size_t pos = 0;
+    while (pos < size) {
+        uint8_t header = data[pos];
+        int type = (header >> 3) & 0x0F;
+        bool has_size = (header & 0x02) != 0;
+        size_t header_size = (header & 0x04) ? 2 : 1;
+        if (pos + header_size > size) return;
+
+        size_t payload_size = size - pos - header_size;
+        if (has_size) {
+            // leb128
+            uint64_t value = 0;
+            int i = 0;
+            for (; i < 8 && pos + header_size + i < size; ++i) {
+                uint8_t byte = data[pos + header_size + i];
+                value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+                if (!(byte & 0x80)) break;
+            }
+            header_size += i + 1;
+            if (pos + header_size > size || value > size - pos - header_size) return;
+            payload_size = static_cast<size_t>(value);
+        }
+        if (!visit(type, data + pos + header_size, payload_size, data + pos, header_size + payload_size)) return;
+        if (!has_size) return;
+        pos += header_size + payload_size;
+    }
+}
+
+// An av1C record (as MediaCodec reports AV1 config) starts with its marker
+// bit set, which no OBU header has; the config OBUs follow its 4 bytes.
+static void SkipAv1CodecConfig(const uint8_t** data, size_t* size) {
+    if (*size >= 4 && ((*data)[0] & 0x80)) {
+        *data += 4;
+        *size -= 4;
+    }
+}
+
+static const int kAv1SequenceHeader = 1;
+static const int kAv1FrameHeader = 3;
+static const int kAv1Frame = 6;
+
+static void AppendUnit(std::vector<uint8_t>* out, const uint8_t* data, size_t size) {
+    for (int shift = 24; shift >= 0; shift -= 8) out->push_back(static_cast<uint8_t>(size >> shift));
+    out->insert(out->end(), data, data + size);
+}
+
+BitstreamParser::Codec BitstreamParser::FromCodecId(AVCodecID codec_id) {
+    switch (codec_id) {
+        case AV_CODEC_ID_H264:
+            return Codec::kH264;
+        case AV_CODEC_ID_HEVC:
+            return Codec::kHevc;
+        case AV_CODEC_ID_AV1:
+            return Codec::kAv1;
+        default:
+            return Codec::kUnknown;
+    }
+}
+
+std::vector<uint8_t> BitstreamParser::ParameterSets(const uint8_t* data, size_t size) const {
+    std::vector<uint8_t> sets;
+    if (codec_ == Codec::kH264 || codec_ == Codec::kHevc) {
+        ForEachNal(data, size, [this, &sets](const uint8_t* nal, size_t nal_size) {
+            bool parameter_set = false;
+            if (codec_ == Codec::kH264) {
+                int type = nal[0] & 0x1F;
+                parameter_set = type == 7 || type == 8 || type == 13; // SPS, PPS, SPS extension
+            } else if (nal_size >= 2) {
+                int type = (nal[0] >> 1) & 0x3F;
+                parameter_set = type >= 32 && type <= 34; // VPS, SPS, PPS
+            }
+            if (parameter_set) AppendUnit(&sets, nal, nal_size);
+            return true;
+        });
+    } else if (codec_ == Codec::kAv1) {
+        ForEachObu(data, size, [&sets](int type, const uint8_t* payload, size_t payload_size, const uint8_t*, size_t) {
+            if (type == kAv1SequenceHeader) AppendUnit(&sets, payload, payload_size);
+            return true;
+        });
+    }
+    return sets;
+}
+
+bool BitstreamParser::SetConfig(const uint8_t* data, size_t size) {
+    if (codec_ == Codec::kAv1) SkipAv1CodecConfig(&data, &size);
+
+    auto sets = ParameterSets(data, size);
+    // Nothing recognisable: any difference counts
+    if (sets.empty()) sets.assign(data, data + size);
+    bool changed = sets != parameter_sets_;
+    parameter_sets_ = std::move(sets);
+    extradata_.assign(data, data + size);
+
+    if (codec_ == Codec::kAv1) {
+        av1_reduced_still_picture_ = false;
+        ForEachObu(data, size, [this](int type, const uint8_t* payload, size_t payload_size, const uint8_t*, size_t) {
+            if (type != kAv1SequenceHeader || payload_size == 0) return true;
+            // seq_profile (3 bits), still_picture, reduced_still_picture_header
+            av1_reduced_still_picture_ = (payload[0] & 0x08) != 0;
+            return false;
+        });
+    }
+    return changed;
+}
+
+BitstreamParser::FrameType BitstreamParser::Classify(const uint8_t* data, size_t size) const {
+    FrameType result = FrameType::kUnknown;
+    switch (codec_) {
+        case Codec::kH264:
+            ForEachNal(data, size, [&result](const uint8_t* nal, size_t) {
+                int type = nal[0] & 0x1F;
+                if (type == 5) {
+                    result = FrameType::kKey;
+                } else if (type >= 1 && type <= 4) {
+                    result = ((nal[0] >> 5) & 0x03) == 0 ? FrameType::kDroppable : FrameType::kReference;
+                } else {
+                    return true;
+                }
+                return false;
+            });
+            break;
+        case Codec::kHevc:
+            ForEachNal(data, size, [&result](const uint8_t* nal, size_t) {
+                int type = (nal[0] >> 1) & 0x3F;
+                if (type >= 16 && type <= 23) {
+                    result = FrameType::kKey; // BLA, IDR, CRA
+                } else if (type < 16) {
+                    // Even types up to 14 are sub-layer non-reference pictures
+                    // (TRAIL_N, RASL_N, ...); streams here have one sub-layer
+                    result = (type % 2 == 0 && type <= 14) ? FrameType::kDroppable : FrameType::kReference;
+                } else {
+                    return true;
+                }
+                return false;
+            });
+            break;
+        case Codec::kAv1:
+            ForEachObu(data, size, [this, &result](int type, const uint8_t* payload, size_t payload_size,
+                                                   const uint8_t*, size_t) {
+                if ((type != kAv1FrameHeader && type != kAv1Frame) || payload_size == 0) return true;
+                if (av1_reduced_still_picture_) {
+                    result = FrameType::kKey;
+                } else if (payload[0] & 0x80) {
+                    result = FrameType::kReference; // show_existing_frame
+                } else {
+                    // frame_type 0 is KEY_FRAME. Whether other frames refresh a
+                    // reference slot takes the full header, so none count as
+                    // droppable.
+                    result = ((payload[0] >> 5) & 0x03) == 0 ? FrameType::kKey : FrameType::kReference;
+                }
+                return false;
+            });
+            break;
+        default:
+            break;
+    }
+    return result;
+}
+
+const char* BitstreamParser::FrameTypeName(FrameType type) {
+    switch (type) {
+        case FrameType::kKey:
+            return "key";
+        case FrameType::kReference:
+            return "reference";
+        case FrameType::kDroppable:
+            return "droppable";
+        default:
+            return "unknown";
+    }
+}
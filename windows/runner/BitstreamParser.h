@@ -0,0 +1,60 @@
+#ifndef BITSTREAM_PARSER_H_
+#define BITSTREAM_PARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// Reads just enough of H.264 / HEVC (Annex B) and AV1 (OBU) headers to tell
+// parameter sets, keyframes and frames nothing references apart, without
+// asking the decoder. Packets are scrcpy's: config packets carry the
+// parameter sets, every other packet one access unit. Decoder thread only.
+class BitstreamParser {
+ public:
+  enum class Codec { kUnknown, kH264, kHevc, kAv1 };
+
+  enum class FrameType {
+      kUnknown,   // No slice or frame header found
+      kKey,       // IDR / IRAP / AV1 key frame: decodable on its own
+      kReference, // Needs earlier frames and may be needed by later ones
+      kDroppable, // Nothing references it (H.264 nal_ref_idc 0, HEVC *_N)
+  };
+
+  static Codec FromCodecId(AVCodecID codec_id);
+
+  explicit BitstreamParser(Codec codec = Codec::kUnknown) : codec_(codec) {}
+
+  Codec codec() const { return codec_; }
+
+  // Takes a config packet. Returns true when its parameter sets differ from
+  // the current ones (always for the first), which it then replaces. Other
+  // units in the packet (SEI, AUD) do not count as a change.
+  bool SetConfig(const uint8_t* data, size_t size);
+
+  // Current parameter sets as decoder extradata: Annex B for H.264/HEVC,
+  // bare OBUs (the av1C header stripped) for AV1.
+  const std::vector<uint8_t>& extradata() const { return extradata_; }
+
+  // FFmpeg's H.264/HEVC decoders take new extradata as packet side data;
+  // AV1 decoders need the sequence header in-band in front of a frame.
+  bool config_in_band() const { return codec_ != Codec::kH264 && codec_ != Codec::kHevc; }
+
+  FrameType Classify(const uint8_t* data, size_t size) const;
+
+  static const char* FrameTypeName(FrameType type);
+
+ private:
+  // Canonical parameter set bytes, for change detection
+  std::vector<uint8_t> ParameterSets(const uint8_t* data, size_t size) const;
+
+  Codec codec_;
+  std::vector<uint8_t> parameter_sets_;
+  std::vector<uint8_t> extradata_;
+  bool av1_reduced_still_picture_ = false; // Every AV1 frame is a key frame
+};
+
+#endif  // BITSTREAM_PARSER_H_
@@ -0,0 +1,127 @@
+#include "CpuTopology.h"
+
+#include "QosGovernor.h"
+#include "VideoDecoderPlugin.h"
+
+#include <algorithm>
+#include <thread>
+
+CpuTopology& CpuTopology::GetInstance() {
+    static CpuTopology instance;
+    return instance;
+}
+
+CpuTopology::CpuTopology() {
+    if (!Discover()) {
+        // One core per logical processor of the first group, a single node
+        cores_.clear();
+        unsigned int count = std::clamp(std::thread::hardware_concurrency(), 1u, 64u);
+        for (unsigned int i = 0; i < count; ++i) {
+            Core core;
+            core.mask = static_cast<KAFFINITY>(1) << i;
+            cores_.push_back(core);
+        }
+        node_count_ = 1;
+        hybrid_ = false;
+    }
+    load_.assign(cores_.size(), 0);
+    LogTrace("CpuTopology - %zu cores, %d nodes, %d performance cores%s", cores_.size(), node_count_,
+             performance_cores(), hybrid_ ? " (hybrid)" : "");
+}
+
+bool CpuTopology::Discover() {
+    DWORD size = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &size);
+    if (size == 0) return false;
+    std::vector<uint8_t> buffer(size);
+    auto* first = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+    if (!GetLogicalProcessorInformationEx(RelationAll, first, &size)) return false;
+
+    std::vector<int> efficiency;
+    std::vector<std::pair<GROUP_AFFINITY, int>> nodes;
+    for (DWORD offset = 0; offset < size;) {
+        auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+        if (info->Size == 0) break;
+        if (info->Relationship == RelationProcessorCore && info->Processor.GroupCount > 0) {
+            Core core;
+            core.group = info->Processor.GroupMask[0].Group;
+            core.mask = info->Processor.GroupMask[0].Mask;
+            cores_.push_back(core);
+            efficiency.push_back(info->Processor.EfficiencyClass);
+        } else if (info->Relationship == RelationNumaNode) {
+            nodes.emplace_back(info->NumaNode.GroupMask, static_cast<int>(info->NumaNode.NodeNumber));
+        }
+        offset += info->Size;
+    }
+    if (cores_.empty()) return false;
+
+    int node_count = 1;
+    for (auto& core : cores_) {
+        for (auto& node : nodes) {
+            if (node.first.Group == core.group && (node.first.Mask & core.mask) != 0) {
+                core.node = node.second;
+                node_count = std::max(node_count, node.second + 1);
+                break;
+            }
+        }
+    }
+    node_count_ = node_count;
+
+    // Higher efficiency classes are the faster cores; all equal when the
+    // CPU is not hybrid
+    auto [lowest, highest] = std::minmax_element(efficiency.begin(), efficiency.end());
+    hybrid_ = *lowest != *highest;
+    for (size_t i = 0; i < cores_.size(); ++i) cores_[i].performance = efficiency[i] == *highest;
+    return true;
+}
+
+CpuTopology::Preference CpuTopology::PreferenceFor(int priority) {
+    switch (priority) {
+        case QosGovernor::kInteractive:
+            return Preference::kPerformance;
+        case QosGovernor::kBackground:
+            return Preference::kEfficiency;
+        default:
+            return Preference::kAny;
+    }
+}
+
+int CpuTopology::performance_cores() const {
+    return static_cast<int>(std::count_if(cores_.begin(), cores_.end(), [](const Core& c) { return c.performance; }));
+}
+
+void CpuTopology::SetPinning(bool enabled) {
+    if (pinning_.exchange(enabled) != enabled) generation_++;
+}
+
+CpuTopology::Placement CpuTopology::Acquire(Preference preference) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int best = -1;
+    for (int pass = 0; pass < 2 && best == -1; ++pass) {
+        for (size_t i = 0; i < cores_.size(); ++i) {
+            bool matches = pass == 1 || preference == Preference::kAny ||
+                           cores_[i].performance == (preference == Preference::kPerformance);
+            if (matches && (best == -1 || load_[i] < load_[best])) best = static_cast<int>(i);
+        }
+    }
+    Placement placement;
+    if (best == -1) return placement;
+    load_[best]++;
+    placement.core = best;
+    placement.node = cores_[best].node;
+    return placement;
+}
+
+void CpuTopology::Release(const Placement& placement) {
+    if (placement.core < 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (placement.core < static_cast<int>(load_.size()) && load_[placement.core] > 0) load_[placement.core]--;
+}
+
+bool CpuTopology::Pin(const Placement& placement, GROUP_AFFINITY* previous) const {
+    if (placement.core < 0 || placement.core >= static_cast<int>(cores_.size())) return false;
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = cores_[placement.core].group;
+    affinity.Mask = cores_[placement.core].mask;
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, previous) != FALSE;
+}
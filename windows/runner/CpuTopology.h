@@ -0,0 +1,111 @@
+#ifndef CPU_TOPOLOGY_H_
+#define CPU_TOPOLOGY_H_
+
+#include <windows.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Cores, NUMA nodes and efficiency classes of the machine, and the placement
+// of decoder threads on them. With pinning enabled each decoder thread is
+// restricted to the least loaded core of its kind (interactive sessions
+// prefer performance cores, background ones efficiency cores on hybrid CPUs)
+// and its frame buffers come from that core's node. Without pinning threads
+// run wherever the scheduler puts them, as before.
+class CpuTopology {
+ public:
+  struct Core {
+      WORD group = 0;
+      KAFFINITY mask = 0; // Logical processors of the core
+      int node = 0;
+      bool performance = true;
+  };
+
+  struct Placement {
+      int core = -1; // -1: not placed
+      int node = -1;
+  };
+
+  enum class Preference { kAny, kPerformance, kEfficiency };
+
+  static CpuTopology& GetInstance();
+
+  static Preference PreferenceFor(int priority);
+
+  const std::vector<Core>& cores() const { return cores_; }
+  int node_count() const { return node_count_; }
+  int performance_cores() const;
+  bool hybrid() const { return hybrid_; }
+
+  void SetPinning(bool enabled);
+  bool pinning() const { return pinning_; }
+  // Changes with every SetPinning so placed threads can notice.
+  int generation() const { return generation_; }
+
+  // Reserves the least loaded core matching preference, or of any kind when
+  // none matches.
+  Placement Acquire(Preference preference);
+  void Release(const Placement& placement);
+
+  // Restricts the calling thread to the placement's core; previous receives
+  // the affinity to restore.
+  bool Pin(const Placement& placement, GROUP_AFFINITY* previous) const;
+
+ private:
+  CpuTopology();
+
+  bool Discover();
+
+  std::vector<Core> cores_;
+  int node_count_ = 1;
+  bool hybrid_ = false;
+  std::atomic<bool> pinning_{false};
+  std::atomic<int> generation_{0};
+
+  std::mutex mutex_;
+  std::vector<int> load_; // Placed threads per core
+};
+
+// Allocates from a NUMA node (node < 0: the default heap), for buffers that
+// are written and read by a thread pinned to that node.
+template <typename T>
+struct NodeAllocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  int node = -1;
+
+  NodeAllocator() = default;
+  explicit NodeAllocator(int n) : node(n) {}
+  template <typename U>
+  NodeAllocator(const NodeAllocator<U>& other) : node(other.node) {}
+
+  T* allocate(size_t count) {
+      if (node < 0) return static_cast<T*>(::operator new(count * sizeof(T)));
+      void* p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, count * sizeof(T), MEM_RESERVE | MEM_COMMIT,
+                                   PAGE_READWRITE, static_cast<DWORD>(node));
+      if (!p) throw std::bad_alloc();
+      return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, size_t) {
+      if (node < 0) {
+          ::operator delete(p);
+      } else {
+          VirtualFree(p, 0, MEM_RELEASE);
+      }
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const NodeAllocator<T>& a, const NodeAllocator<U>& b) { return a.node == b.node; }
+template <typename T, typename U>
+bool operator!=(const NodeAllocator<T>& a, const NodeAllocator<U>& b) { return a.node != b.node; }
+
+#endif  // CPU_TOPOLOGY_H_
@@ -0,0 +1,293 @@
+#include "DecoderHost.h"
+
+#include "VideoDecoderPlugin.h"
+
+#include <algorithm>
+
+// A host that keeps dying right after launch is relaunched less and less often
+static const auto kRelaunchInitialBackoff = std::chrono::milliseconds(100);
+static const auto kRelaunchMaxBackoff = std::chrono::milliseconds(5000);
+static const auto kStableRunTime = std::chrono::seconds(10);
+static const DWORD kExitTimeoutMs = 2000;
+// How often a write to a host that stopped reading is cancelled again
+static const auto kCancelWriteInterval = std::chrono::milliseconds(20);
+
+DecoderHost::DecoderHost(std::wstring executable, HANDLE job) : executable_(std::move(executable)), job_(job) {
+    writer_ = std::thread([this]() { WriteCommands(); });
+    supervisor_ = std::thread([this]() { Supervise(); });
+}
+
+DecoderHost::~DecoderHost() {
+    active_ = false;
+    HANDLE process = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // EOF on its stdin lets the host stop its sessions and exit
+        CloseCommandsLocked(lock);
+        if (process_) {
+            DuplicateHandle(GetCurrentProcess(), process_, GetCurrentProcess(), &process, 0, FALSE,
+                            DUPLICATE_SAME_ACCESS);
+        }
+    }
+    if (process) {
+        if (WaitForSingleObject(process, kExitTimeoutMs) != WAIT_OBJECT_0) TerminateProcess(process, 1);
+        CloseHandle(process);
+    }
+    outbox_cv_.notify_all();
+    if (writer_.joinable()) writer_.join();
+    if (supervisor_.joinable()) supervisor_.join();
+}
+
+void DecoderHost::Attach(int64_t texture_id, const std::string& address, std::weak_ptr<DecoderHostClient> client) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[texture_id] = {address, std::move(client)};
+    // Without a running host the session starts with the next launch
+    if (commands_) QueueCommandLocked(HostMessageType::kStartSession, texture_id, address);
+}
+
+void DecoderHost::Detach(int64_t texture_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.erase(texture_id) && commands_) QueueCommandLocked(HostMessageType::kStopSession, texture_id);
+}
+
+void DecoderHost::QueueCommandLocked(HostMessageType type, int64_t texture_id, const std::string& payload) {
+    outbox_.push_back({type, texture_id, payload});
+    outbox_cv_.notify_one();
+}
+
+void DecoderHost::WriteCommands() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        outbox_cv_.wait(lock, [this]() { return !active_ || (commands_ && !outbox_.empty()); });
+        if (!active_) break;
+        Command command = std::move(outbox_.front());
+        outbox_.pop_front();
+        HANDLE commands = commands_;
+        writing_ = true;
+        lock.unlock();
+        // A failed write means the host is gone; the supervisor sees it too
+        WriteHostMessage(commands, command.type, command.texture_id, 0, command.payload);
+        lock.lock();
+        writing_ = false;
+        written_cv_.notify_all();
+    }
+}
+
+void DecoderHost::CloseCommandsLocked(std::unique_lock<std::mutex>& lock) {
+    // The handle stays open until the writer is off it; a write stuck on a
+    // full pipe is cancelled, again if it started after the first cancel
+    while (writing_) {
+        CancelSynchronousIo(writer_.native_handle());
+        written_cv_.wait_for(lock, kCancelWriteInterval);
+    }
+    outbox_.clear();
+    if (commands_) {
+        CloseHandle(commands_);
+        commands_ = nullptr;
+    }
+}
+
+int DecoderHost::session_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (int)sessions_.size();
+}
+
+DecoderHost::Stats DecoderHost::GetStats() {
+    Stats stats;
+    stats.pid = pid_;
+    stats.sessions = session_count();
+    stats.restarts = restarts_;
+    return stats;
+}
+
+std::shared_ptr<DecoderHostClient> DecoderHost::FindClient(int64_t texture_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(texture_id);
+    return it == sessions_.end() ? nullptr : it->second.client.lock();
+}
+
+void DecoderHost::Supervise() {
+    auto backoff = kRelaunchInitialBackoff;
+    while (active_) {
+        auto launched = std::chrono::steady_clock::now();
+        if (Launch()) {
+            // Returns when the host exits, crashes or closes its stdout
+            ReadEvents();
+        }
+        CloseProcess();
+        if (!active_) break;
+
+        restarts_++;
+        std::vector<std::shared_ptr<DecoderHostClient>> clients;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& entry : sessions_) {
+                if (auto client = entry.second.client.lock()) clients.push_back(client);
+            }
+        }
+        for (auto& client : clients) client->OnHostLost();
+
+        if (std::chrono::steady_clock::now() - launched > kStableRunTime) backoff = kRelaunchInitialBackoff;
+        auto wake = std::chrono::steady_clock::now() + backoff;
+        while (active_ && std::chrono::steady_clock::now() < wake) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        backoff = std::min(backoff * 2, kRelaunchMaxBackoff);
+    }
+}
+
+bool DecoderHost::Launch() {
+    SECURITY_ATTRIBUTES inheritable = { sizeof(inheritable), nullptr, TRUE };
+    HANDLE child_stdin = nullptr;
+    HANDLE commands = nullptr;
+    HANDLE events = nullptr;
+    HANDLE child_stdout = nullptr;
+    if (!CreatePipe(&child_stdin, &commands, &inheritable, 64 * 1024)) return false;
+    if (!CreatePipe(&events, &child_stdout, &inheritable, 256 * 1024)) {
+        CloseHandle(child_stdin);
+        CloseHandle(commands);
+        return false;
+    }
+    SetHandleInformation(commands, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(events, HANDLE_FLAG_INHERIT, 0);
+
+    // Only the two pipe ends are inherited; sockets of in-process sessions
+    // are inheritable too and must not leak into the host
+    SIZE_T attributes_size = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attributes_size);
+    std::vector<uint8_t> attributes(attributes_size);
+    auto* attribute_list = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributes.data());
+    InitializeProcThreadAttributeList(attribute_list, 1, 0, &attributes_size);
+    HANDLE inherited[2] = { child_stdin, child_stdout };
+    UpdateProcThreadAttribute(attribute_list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherited, sizeof(inherited),
+                              nullptr, nullptr);
+
+    STARTUPINFOEXW startup = {};
+    startup.StartupInfo.cb = sizeof(startup);
+    startup.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    startup.StartupInfo.hStdInput = child_stdin;
+    startup.StartupInfo.hStdOutput = child_stdout;
+    startup.lpAttributeList = attribute_list;
+    PROCESS_INFORMATION info = {};
+    std::wstring command_line = L"\"" + executable_ + L"\"";
+    BOOL created = CreateProcessW(executable_.c_str(), command_line.data(), nullptr, nullptr, TRUE,
+                                  EXTENDED_STARTUPINFO_PRESENT | CREATE_NO_WINDOW | CREATE_SUSPENDED, nullptr,
+                                  nullptr, &startup.StartupInfo, &info);
+    DeleteProcThreadAttributeList(attribute_list);
+    // The host holds the only copies now, so its exit breaks the pipes
+    CloseHandle(child_stdin);
+    CloseHandle(child_stdout);
+    if (!created) {
+        LogTrace("DecoderHost - Error: failed to launch host (%lu)", GetLastError());
+        CloseHandle(commands);
+        CloseHandle(events);
+        return false;
+    }
+
+    if (job_) AssignProcessToJobObject(job_, info.hProcess);
+    ResumeThread(info.hThread);
+    CloseHandle(info.hThread);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_) {
+            // Shutting down meanwhile: the closed stdin ends the host
+            CloseHandle(commands);
+            commands = nullptr;
+        }
+        commands_ = commands;
+        process_ = info.hProcess;
+        // Under the same lock as commands_, so an Attach meanwhile is not started twice
+        if (commands_) {
+            for (auto& entry : sessions_) {
+                QueueCommandLocked(HostMessageType::kStartSession, entry.first, entry.second.address);
+            }
+        }
+    }
+    events_ = events;
+    pid_ = info.dwProcessId;
+    LogTrace("DecoderHost - Launched host %lu", info.dwProcessId);
+    return true;
+}
+
+void DecoderHost::ReadEvents() {
+    HostMessage message;
+    std::string payload;
+    while (ReadHostMessage(events_, &message, &payload)) {
+        auto client = FindClient(message.texture_id);
+        if (!client) continue;
+        switch (message.type) {
+            case HostMessageType::kFramesMapping:
+                client->OnFramesMapping(payload);
+                break;
+            case HostMessageType::kFrame: {
+                int64_t received_us = 0;
+                if (payload.size() == sizeof(received_us)) memcpy(&received_us, payload.data(), sizeof(received_us));
+                client->OnFrame(message.value, message.time_us, received_us);
+                break;
+            }
+            case HostMessageType::kConnection:
+                client->OnConnection(payload, message.value);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void DecoderHost::CloseProcess() {
+    HANDLE process = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        CloseCommandsLocked(lock);
+        process = process_;
+        process_ = nullptr;
+    }
+    if (events_) {
+        CloseHandle(events_);
+        events_ = nullptr;
+    }
+    if (!process) return;
+
+    if (WaitForSingleObject(process, kExitTimeoutMs) != WAIT_OBJECT_0) TerminateProcess(process, 1);
+    DWORD exit_code = 0;
+    GetExitCodeProcess(process, &exit_code);
+    if (active_) LogTrace("DecoderHost - Error: host %lu exited (0x%08lx)", pid_.load(), exit_code);
+    CloseHandle(process);
+    pid_ = 0;
+}
+
+DecoderHostPool::DecoderHostPool(const std::wstring& executable, int count) {
+    // Hosts are killed with the app, even when it crashes
+    job_ = CreateJobObjectW(nullptr, nullptr);
+    if (job_) {
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        SetInformationJobObject(job_, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+    }
+    for (int i = 0; i < count; ++i) hosts_.push_back(std::make_unique<DecoderHost>(executable, job_));
+}
+
+DecoderHostPool::~DecoderHostPool() {
+    hosts_.clear();
+    if (job_) CloseHandle(job_);
+}
+
+DecoderHost* DecoderHostPool::Pick() {
+    DecoderHost* best = nullptr;
+    int best_count = 0;
+    for (auto& host : hosts_) {
+        int count = host->session_count();
+        if (!best || count < best_count) {
+            best = host.get();
+            best_count = count;
+        }
+    }
+    return best;
+}
+
+std::vector<DecoderHost::Stats> DecoderHostPool::GetStats() {
+    std::vector<DecoderHost::Stats> stats;
+    for (auto& host : hosts_) stats.push_back(host->GetStats());
+    return stats;
+}
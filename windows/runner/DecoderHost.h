@@ -0,0 +1,116 @@
+#ifndef DECODER_HOST_H_
+#define DECODER_HOST_H_
+
+#include <windows.h>
+
+#include "decoder_host/HostProtocol.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Receives what a host reports about one session, on the host's supervisor
+// thread.
+class DecoderHostClient {
+ public:
+  virtual ~DecoderHostClient() = default;
+
+  virtual void OnFramesMapping(const std::string& name) = 0;
+  // received_us is when the host had the frame's packet (0 if unknown).
+  virtual void OnFrame(int64_t seq, int64_t sent_us, int64_t received_us) = 0;
+  virtual void OnConnection(const std::string& type, int64_t elapsed_ms) = 0;
+  // The process died; the session is started again on its replacement.
+  virtual void OnHostLost() = 0;
+};
+
+// One scraki_decoder_host.exe and the sessions sharded onto it. A supervisor
+// thread launches the process, dispatches its events and, when it exits,
+// launches a new one and starts every attached session on it again. Commands
+// go out on a writer thread, so a host that stops reading never blocks the
+// caller.
+class DecoderHost {
+ public:
+  struct Stats {
+      DWORD pid = 0;
+      int sessions = 0;
+      int64_t restarts = 0;
+  };
+
+  DecoderHost(std::wstring executable, HANDLE job);
+  ~DecoderHost();
+
+  DecoderHost(const DecoderHost&) = delete;
+  DecoderHost& operator=(const DecoderHost&) = delete;
+
+  // address is "host:port" of the scrcpy video socket.
+  void Attach(int64_t texture_id, const std::string& address, std::weak_ptr<DecoderHostClient> client);
+  void Detach(int64_t texture_id);
+
+  int session_count();
+  Stats GetStats();
+
+ private:
+  struct Attached {
+      std::string address;
+      std::weak_ptr<DecoderHostClient> client;
+  };
+
+  struct Command {
+      HostMessageType type;
+      int64_t texture_id;
+      std::string payload;
+  };
+
+  void Supervise();
+  bool Launch();
+  void ReadEvents();
+  void CloseProcess();
+  void WriteCommands();
+  void QueueCommandLocked(HostMessageType type, int64_t texture_id, const std::string& payload = std::string());
+  void CloseCommandsLocked(std::unique_lock<std::mutex>& lock);
+  std::shared_ptr<DecoderHostClient> FindClient(int64_t texture_id);
+
+  const std::wstring executable_;
+  HANDLE job_;
+
+  std::mutex mutex_;
+  std::map<int64_t, Attached> sessions_;
+  HANDLE commands_ = nullptr; // Our end of the host's stdin
+  HANDLE process_ = nullptr;
+  std::deque<Command> outbox_; // For the current process only
+  bool writing_ = false;       // The writer is using commands_ unlocked
+  std::condition_variable outbox_cv_;
+  std::condition_variable written_cv_;
+
+  HANDLE events_ = nullptr;   // Supervisor thread only
+  std::atomic<DWORD> pid_{0};
+  std::atomic<int64_t> restarts_{0};
+  std::atomic<bool> active_{true};
+  std::thread supervisor_;
+  std::thread writer_;
+};
+
+// The configured hosts. Sessions go to the host with the fewest sessions;
+// hosts belong to a job object so they never outlive the app.
+class DecoderHostPool {
+ public:
+  DecoderHostPool(const std::wstring& executable, int count);
+  ~DecoderHostPool();
+
+  DecoderHost* Pick();
+  int size() const { return (int)hosts_.size(); }
+  std::vector<DecoderHost::Stats> GetStats();
+
+ private:
+  HANDLE job_ = nullptr;
+  std::vector<std::unique_ptr<DecoderHost>> hosts_;
+};
+
+#endif  // DECODER_HOST_H_
@@ -0,0 +1,114 @@
+#include "FrameAnalyzer.h"
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAME_ANALYZER_SSE2 1
+#endif
+
+static bool HasLumaPlane(int format) {
+    return format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_NV12 ||
+           format == AV_PIX_FMT_GRAY8;
+}
+
+FrameAnalysisHost::FrameAnalysisHost(std::vector<std::unique_ptr<FrameAnalyzer>> analyzers, int interval_ms,
+                                     int downsample, EventSink sink)
+    : analyzers_(std::move(analyzers)),
+      interval_(std::max(0, interval_ms)),
+      downsample_(std::clamp(downsample, 1, 8)),
+      sink_(std::move(sink)) {}
+
+FrameAnalysisHost::~FrameAnalysisHost() = default;
+
+void FrameAnalysisHost::Submit(const AVFrame* frame, Clock::time_point now) {
+    if (!active_ || !frame || !frame->data[0] || !HasLumaPlane(frame->format)) return;
+    if (now - last_submit_ < interval_) return;
+    if (busy_.exchange(true)) return;
+
+    AVFrame* ref = av_frame_clone(frame);
+    if (!ref) {
+        busy_ = false;
+        return;
+    }
+    last_submit_ = now;
+    int64_t time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+    auto self = shared_from_this();
+    WorkerPool::GetInstance().Post([self, ref, time_ms]() {
+        AVFrame* owned = ref;
+        self->Run(owned, time_ms);
+        av_frame_free(&owned);
+        self->busy_ = false;
+    });
+}
+
+void FrameAnalysisHost::Run(AVFrame* frame, int64_t time_ms) {
+    auto start = Clock::now();
+    Downsample(frame->data[0], frame->linesize[0], frame->width, frame->height, downsample_, &image_);
+    image_.pts_us = frame->pts == AV_NOPTS_VALUE ? 0 : frame->pts;
+    image_.time_ms = time_ms;
+
+    for (auto& analyzer : analyzers_) {
+        flutter::EncodableMap event;
+        if (!analyzer->Analyze(image_, &event) || !active_) continue;
+        event[flutter::EncodableValue("type")] = flutter::EncodableValue("analysis");
+        event[flutter::EncodableValue("analyzer")] = flutter::EncodableValue(analyzer->id());
+        event[flutter::EncodableValue("ptsUs")] = flutter::EncodableValue(image_.pts_us);
+        if (sink_) sink_(std::move(event));
+    }
+
+    frames_analyzed_++;
+    total_us_ += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+double FrameAnalysisHost::average_ms() const {
+    int64_t frames = frames_analyzed_;
+    return frames ? (double)total_us_ / frames / 1000.0 : 0;
+}
+
+void FrameAnalysisHost::Downsample(const uint8_t* src, int linesize, int width, int height, int factor,
+                                   LumaImage* out) {
+    factor = std::max(1, factor);
+    out->width = width / factor;
+    out->height = height / factor;
+    out->scale = factor;
+    out->pixels.resize((size_t)out->width * out->height);
+
+    for (int y = 0; y < out->height; ++y) {
+        uint8_t* dst = out->pixels.data() + (size_t)y * out->width;
+        const uint8_t* row = src + (size_t)y * factor * linesize;
+        if (factor == 1) {
+            std::copy(row, row + out->width, dst);
+            continue;
+        }
+
+        int x = 0;
+#ifdef FRAME_ANALYZER_SSE2
+        if (factor == 2) {
+            // Average two rows, then adjacent byte pairs
+            const __m128i mask = _mm_set1_epi16(0x00FF);
+            for (; x + 8 <= out->width; x += 8) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 2));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + linesize + x * 2));
+                __m128i v = _mm_avg_epu8(a, b);
+                __m128i even = _mm_and_si128(v, mask);
+                __m128i odd = _mm_srli_epi16(v, 8);
+                __m128i avg = _mm_avg_epu16(even, odd);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(avg, avg));
+            }
+        }
+#endif
+        int area = factor * factor;
+        for (; x < out->width; ++x) {
+            int sum = 0;
+            for (int dy = 0; dy < factor; ++dy) {
+                const uint8_t* p = row + (size_t)dy * linesize + (size_t)x * factor;
+                for (int dx = 0; dx < factor; ++dx) sum += p[dx];
+            }
+            dst[x] = (uint8_t)((sum + area / 2) / area);
+        }
+    }
+}
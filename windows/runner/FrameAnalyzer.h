@@ -0,0 +1,83 @@
+#ifndef FRAME_ANALYZER_H_
+#define FRAME_ANALYZER_H_
+
+#include <flutter/encodable_value.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// Luma plane of a decoded frame, box-downsampled by an integer factor.
+struct LumaImage {
+    std::vector<uint8_t> pixels; // width * height, tightly packed
+    int width = 0;
+    int height = 0;
+    int scale = 1;               // Source pixels per image pixel
+    int64_t pts_us = 0;
+    int64_t time_ms = 0;         // Local steady clock
+};
+
+// Per-frame check on the Y plane, before any RGBA conversion. Analyze() runs
+// on the worker pool, never concurrently for one analyzer. Returning true
+// posts *event to Dart as an "analysis" session event.
+class FrameAnalyzer {
+ public:
+  virtual ~FrameAnalyzer() = default;
+
+  // Stable identifier reported as "analyzer" in events.
+  virtual std::string id() const = 0;
+
+  virtual bool Analyze(const LumaImage& image, flutter::EncodableMap* event) = 0;
+};
+
+// Feeds one session's analyzers at a fixed rate. Frames arriving while the
+// previous analysis still runs are skipped rather than queued.
+class FrameAnalysisHost : public std::enable_shared_from_this<FrameAnalysisHost> {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using EventSink = std::function<void(flutter::EncodableMap event)>;
+
+  FrameAnalysisHost(std::vector<std::unique_ptr<FrameAnalyzer>> analyzers, int interval_ms, int downsample,
+                    EventSink sink);
+  ~FrameAnalysisHost();
+
+  // Decoder thread.
+  void Submit(const AVFrame* frame, Clock::time_point now);
+
+  // Stops delivering events; analysis in flight finishes silently.
+  void Stop() { active_ = false; }
+
+  int64_t frames_analyzed() const { return frames_analyzed_; }
+  double average_ms() const;
+
+  // Box filter of the Y plane (SSE2 for the 2x case). Exposed for analyzers
+  // that downsample their own reference images.
+  static void Downsample(const uint8_t* src, int linesize, int width, int height, int factor, LumaImage* out);
+
+ private:
+  void Run(AVFrame* frame, int64_t time_ms);
+
+  std::vector<std::unique_ptr<FrameAnalyzer>> analyzers_; // Worker only
+  const std::chrono::milliseconds interval_;
+  const int downsample_;
+  EventSink sink_;
+
+  Clock::time_point last_submit_; // Decoder thread only
+  std::atomic<bool> busy_{false};
+  std::atomic<bool> active_{true};
+  LumaImage image_; // Worker only
+
+  std::atomic<int64_t> frames_analyzed_{0};
+  std::atomic<int64_t> total_us_{0};
+};
+
+#endif  // FRAME_ANALYZER_H_
@@ -0,0 +1,312 @@
+#include "FrameAnalyzers.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAME_ANALYZERS_SSE2 1
+#endif
+
+// BlackScreenAnalyzer
+
+BlackScreenAnalyzer::BlackScreenAnalyzer(std::string id, int threshold, double max_bright_fraction)
+    : id_(std::move(id)),
+      threshold_((uint8_t)std::clamp(threshold, 0, 255)),
+      max_bright_fraction_(max_bright_fraction) {}
+
+bool BlackScreenAnalyzer::Analyze(const LumaImage& image, flutter::EncodableMap* event) {
+    size_t count = image.pixels.size();
+    if (count == 0) return false;
+    const uint8_t* pixels = image.pixels.data();
+
+    uint64_t total = 0;
+    size_t bright = 0;
+    size_t i = 0;
+#ifdef FRAME_ANALYZERS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i threshold = _mm_set1_epi8((char)threshold_);
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+        // Saturating subtract leaves zero for pixels at or below the threshold
+        int dark = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(v, threshold), zero));
+        bright += 16 - std::bitset<16>((unsigned)dark).count();
+    }
+    sum = _mm_add_epi64(sum, _mm_srli_si128(sum, 8));
+    total = (uint64_t)_mm_cvtsi128_si32(sum);
+#endif
+    for (; i < count; ++i) {
+        total += pixels[i];
+        if (pixels[i] > threshold_) bright++;
+    }
+
+    bool black = (double)bright / count <= max_bright_fraction_;
+    if (black == black_) return false;
+    black_ = black;
+    (*event)[flutter::EncodableValue("black")] = flutter::EncodableValue(black);
+    (*event)[flutter::EncodableValue("meanLuma")] = flutter::EncodableValue((double)total / count);
+    return true;
+}
+
+// FrozenScreenAnalyzer
+
+FrozenScreenAnalyzer::FrozenScreenAnalyzer(std::string id, int duration_ms, double tolerance)
+    : id_(std::move(id)), duration_ms_(std::max(0, duration_ms)), tolerance_(tolerance) {}
+
+bool FrozenScreenAnalyzer::Analyze(const LumaImage& image, flutter::EncodableMap* event) {
+    size_t count = image.pixels.size();
+    if (count == 0) return false;
+
+    if (previous_.size() != count) {
+        previous_ = image.pixels;
+        last_change_ms_ = image.time_ms;
+        return false;
+    }
+
+    const uint8_t* a = image.pixels.data();
+    const uint8_t* b = previous_.data();
+    uint64_t difference = 0;
+    size_t i = 0;
+#ifdef FRAME_ANALYZERS_SSE2
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+    }
+    sum = _mm_add_epi64(sum, _mm_srli_si128(sum, 8));
+    difference = (uint64_t)_mm_cvtsi128_si32(sum);
+#endif
+    for (; i < count; ++i) difference += (uint64_t)std::abs((int)a[i] - (int)b[i]);
+    std::copy(image.pixels.begin(), image.pixels.end(), previous_.begin());
+
+    double mean_difference = (double)difference / count;
+    if (mean_difference > tolerance_) {
+        last_change_ms_ = image.time_ms;
+        if (!frozen_) return false;
+        frozen_ = false;
+    } else {
+        if (frozen_ || image.time_ms - last_change_ms_ < duration_ms_) return false;
+        frozen_ = true;
+    }
+    (*event)[flutter::EncodableValue("frozen")] = flutter::EncodableValue(frozen_);
+    (*event)[flutter::EncodableValue("frozenMs")] =
+        flutter::EncodableValue(frozen_ ? image.time_ms - last_change_ms_ : (int64_t)0);
+    return true;
+}
+
+// TemplateMatchAnalyzer
+
+// Multiply-adds per frame above which the coarse search skips every other
+// position
+static const int64_t kExhaustiveSearchBudget = 32 * 1000 * 1000;
+
+TemplateMatchAnalyzer::TemplateMatchAnalyzer(std::string id, std::vector<uint8_t> pixels, int width, int height,
+                                             double threshold, Region region)
+    : id_(std::move(id)),
+      source_(std::move(pixels)),
+      source_width_(width),
+      source_height_(height),
+      threshold_(threshold),
+      region_(region) {}
+
+void TemplateMatchAnalyzer::PrepareTemplate(int scale) {
+    scale_ = scale;
+    LumaImage scaled;
+    FrameAnalysisHost::Downsample(source_.data(), source_width_, source_width_, source_height_, scale, &scaled);
+    width_ = scaled.width;
+    height_ = scaled.height;
+    stride_ = (width_ + 7) & ~7;
+    zero_mean_.assign((size_t)stride_ * height_, 0);
+    norm_ = 0;
+    zero_mean_sum_ = 0;
+    if (width_ < 2 || height_ < 2) {
+        width_ = height_ = 0;
+        return;
+    }
+
+    double mean = 0;
+    for (uint8_t p : scaled.pixels) mean += p;
+    mean /= scaled.pixels.size();
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            int16_t value = (int16_t)std::lround(scaled.pixels[(size_t)y * width_ + x] - mean);
+            zero_mean_[(size_t)y * stride_ + x] = value;
+            zero_mean_sum_ += value;
+            norm_ += (double)value * value;
+        }
+    }
+    norm_ = std::sqrt(norm_);
+}
+
+double TemplateMatchAnalyzer::Score(int x, int y) const {
+    auto area = [&](const std::vector<int64_t>& integral) {
+        size_t row = (size_t)search_width_ + 1;
+        return integral[(y + height_) * row + x + width_] - integral[(size_t)y * row + x + width_] -
+               integral[(y + height_) * row + x] + integral[(size_t)y * row + x];
+    };
+    double n = (double)width_ * height_;
+    double sum = (double)area(sum_);
+    double variance = (double)area(sum_sq_) - sum * sum / n;
+    // Flat patches correlate with nothing
+    if (variance < n || norm_ <= 0) return 0;
+
+    // sum((I - mean) * T') = sum(I * T') - mean * sum(T'); the last term is
+    // only rounding residue since T' is zero mean
+    int64_t dot = 0;
+    for (int row = 0; row < height_; ++row) {
+        const uint8_t* image_row = search_.data() + (size_t)(y + row) * search_stride_ + x;
+        const int16_t* template_row = zero_mean_.data() + (size_t)row * stride_;
+        int col = 0;
+#ifdef FRAME_ANALYZERS_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for (; col < stride_; col += 8) {
+            __m128i iv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(image_row + col)), zero);
+            __m128i tv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(template_row + col));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(iv, tv));
+        }
+        acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+        acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 4));
+        dot += _mm_cvtsi128_si32(acc);
+#endif
+        for (; col < width_; ++col) dot += (int64_t)image_row[col] * template_row[col];
+    }
+    double centered = (double)dot - sum / n * (double)zero_mean_sum_;
+    return centered / (std::sqrt(variance) * norm_);
+}
+
+bool TemplateMatchAnalyzer::Analyze(const LumaImage& image, flutter::EncodableMap* event) {
+    if (image.scale != scale_) PrepareTemplate(image.scale);
+
+    // Region in image pixels
+    int scale = image.scale;
+    int rx = std::clamp(region_.x / scale, 0, image.width);
+    int ry = std::clamp(region_.y / scale, 0, image.height);
+    int rw = region_.width > 0 ? region_.width / scale : image.width;
+    int rh = region_.height > 0 ? region_.height / scale : image.height;
+    rw = std::min(rw, image.width - rx);
+    rh = std::min(rh, image.height - ry);
+
+    double best_score = -1;
+    int best_x = 0;
+    int best_y = 0;
+    if (width_ > 0 && rw >= width_ && rh >= height_) {
+        // Region copy padded for 8-byte loads past the last column
+        search_width_ = rw;
+        search_height_ = rh;
+        search_stride_ = rw + 8;
+        search_.assign((size_t)search_stride_ * rh, 0);
+        size_t row_size = (size_t)rw + 1;
+        sum_.assign(row_size * (rh + 1), 0);
+        sum_sq_.assign(row_size * (rh + 1), 0);
+        for (int y = 0; y < rh; ++y) {
+            const uint8_t* src = image.pixels.data() + (size_t)(ry + y) * image.width + rx;
+            std::copy(src, src + rw, search_.begin() + (size_t)y * search_stride_);
+            int64_t row_sum = 0;
+            int64_t row_sum_sq = 0;
+            for (int x = 0; x < rw; ++x) {
+                row_sum += src[x];
+                row_sum_sq += (int64_t)src[x] * src[x];
+                sum_[(y + 1) * row_size + x + 1] = sum_[(size_t)y * row_size + x + 1] + row_sum;
+                sum_sq_[(y + 1) * row_size + x + 1] = sum_sq_[(size_t)y * row_size + x + 1] + row_sum_sq;
+            }
+        }
+
+        // Exhaustive when cheap, otherwise a 2-pixel grid; screen content is
+        // smooth enough at analysis scale for the refinement to recover
+        int64_t positions = (int64_t)(rw - width_ + 1) * (rh - height_ + 1);
+        int step = positions * width_ * height_ > kExhaustiveSearchBudget ? 2 : 1;
+        for (int y = 0; y <= rh - height_; y += step) {
+            for (int x = 0; x <= rw - width_; x += step) {
+                double score = Score(x, y);
+                if (score > best_score) {
+                    best_score = score;
+                    best_x = x;
+                    best_y = y;
+                }
+            }
+        }
+        int coarse_x = best_x;
+        int coarse_y = best_y;
+        for (int y = std::max(0, coarse_y - 1); y <= std::min(rh - height_, coarse_y + 1); ++y) {
+            for (int x = std::max(0, coarse_x - 1); x <= std::min(rw - width_, coarse_x + 1); ++x) {
+                double score = Score(x, y);
+                if (score > best_score) {
+                    best_score = score;
+                    best_x = x;
+                    best_y = y;
+                }
+            }
+        }
+    }
+
+    bool matched = best_score >= threshold_;
+    if (matched == matched_) return false;
+    matched_ = matched;
+    (*event)[flutter::EncodableValue("matched")] = flutter::EncodableValue(matched);
+    (*event)[flutter::EncodableValue("score")] = flutter::EncodableValue(std::max(0.0, best_score));
+    (*event)[flutter::EncodableValue("x")] = flutter::EncodableValue((rx + best_x) * scale);
+    (*event)[flutter::EncodableValue("y")] = flutter::EncodableValue((ry + best_y) * scale);
+    (*event)[flutter::EncodableValue("width")] = flutter::EncodableValue(source_width_);
+    (*event)[flutter::EncodableValue("height")] = flutter::EncodableValue(source_height_);
+    return true;
+}
+
+// Factory
+
+std::unique_ptr<FrameAnalyzer> CreateFrameAnalyzer(const flutter::EncodableMap& config, std::string* error) {
+    auto find = [&](const char* key) -> const flutter::EncodableValue* {
+        auto it = config.find(flutter::EncodableValue(key));
+        return it == config.end() ? nullptr : &it->second;
+    };
+    auto number = [&](const char* key, double fallback) {
+        const auto* value = find(key);
+        if (!value) return fallback;
+        if (const auto* d = std::get_if<double>(value)) return *d;
+        if (std::holds_alternative<int32_t>(*value) || std::holds_alternative<int64_t>(*value)) {
+            return (double)value->LongValue();
+        }
+        return fallback;
+    };
+    auto text = [&](const char* key) {
+        const auto* value = find(key);
+        return value && std::holds_alternative<std::string>(*value) ? std::get<std::string>(*value) : std::string();
+    };
+
+    std::string type = text("type");
+    std::string id = text("id");
+    if (id.empty()) id = type;
+
+    if (type == "black") {
+        return std::make_unique<BlackScreenAnalyzer>(id, (int)number("threshold", 24),
+                                                     number("maxBrightFraction", 0.01));
+    }
+    if (type == "frozen") {
+        return std::make_unique<FrozenScreenAnalyzer>(id, (int)number("durationMs", 3000),
+                                                      number("tolerance", 2.0));
+    }
+    if (type == "template") {
+        const auto* pixels = find("pixels");
+        int width = (int)number("width", 0);
+        int height = (int)number("height", 0);
+        if (!pixels || !std::holds_alternative<std::vector<uint8_t>>(*pixels) || width <= 0 || height <= 0 ||
+            std::get<std::vector<uint8_t>>(*pixels).size() != (size_t)width * height) {
+            *error = "template needs width, height and width * height grayscale pixels";
+            return nullptr;
+        }
+        TemplateMatchAnalyzer::Region region;
+        region.x = (int)number("regionX", 0);
+        region.y = (int)number("regionY", 0);
+        region.width = (int)number("regionWidth", 0);
+        region.height = (int)number("regionHeight", 0);
+        return std::make_unique<TemplateMatchAnalyzer>(id, std::get<std::vector<uint8_t>>(*pixels), width, height,
+                                                       number("threshold", 0.85), region);
+    }
+
+    *error = "Unknown analyzer type '" + type + "' (black, frozen, template)";
+    return nullptr;
+}
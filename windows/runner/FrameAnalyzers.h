@@ -0,0 +1,99 @@
+#ifndef FRAME_ANALYZERS_H_
+#define FRAME_ANALYZERS_H_
+
+#include "FrameAnalyzer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Built-in analyzers. Each reports transitions only, not every frame.
+
+// "black": fewer than max_bright_fraction of the pixels above threshold.
+class BlackScreenAnalyzer : public FrameAnalyzer {
+ public:
+  BlackScreenAnalyzer(std::string id, int threshold, double max_bright_fraction);
+
+  std::string id() const override { return id_; }
+  bool Analyze(const LumaImage& image, flutter::EncodableMap* event) override;
+
+ private:
+  std::string id_;
+  uint8_t threshold_;
+  double max_bright_fraction_;
+  bool black_ = false;
+};
+
+// "frozen": mean absolute difference to the previous analyzed frame stayed
+// below tolerance for duration_ms. Unlike the idle event it tolerates noise
+// such as a blinking cursor or a spinner.
+class FrozenScreenAnalyzer : public FrameAnalyzer {
+ public:
+  FrozenScreenAnalyzer(std::string id, int duration_ms, double tolerance);
+
+  std::string id() const override { return id_; }
+  bool Analyze(const LumaImage& image, flutter::EncodableMap* event) override;
+
+ private:
+  std::string id_;
+  int64_t duration_ms_;
+  double tolerance_;
+  std::vector<uint8_t> previous_;
+  int64_t last_change_ms_ = -1;
+  bool frozen_ = false;
+};
+
+// "template": zero-mean normalized cross-correlation of a grayscale template
+// (full stream resolution) against the frame, optionally within a region.
+// Coarse search on a 2-pixel grid, refined around the best candidate.
+class TemplateMatchAnalyzer : public FrameAnalyzer {
+ public:
+  struct Region {
+      int x = 0;
+      int y = 0;
+      int width = 0; // 0 = whole frame
+      int height = 0;
+  };
+
+  TemplateMatchAnalyzer(std::string id, std::vector<uint8_t> pixels, int width, int height, double threshold,
+                        Region region);
+
+  std::string id() const override { return id_; }
+  bool Analyze(const LumaImage& image, flutter::EncodableMap* event) override;
+
+ private:
+  void PrepareTemplate(int scale);
+  double Score(int x, int y) const;
+
+  std::string id_;
+  std::vector<uint8_t> source_;
+  int source_width_;
+  int source_height_;
+  double threshold_;
+  Region region_;
+
+  // Template at the current image scale, zero mean, rows padded to 8
+  int scale_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+  int stride_ = 0;
+  std::vector<int16_t> zero_mean_;
+  int64_t zero_mean_sum_ = 0;
+  double norm_ = 0;
+
+  // Search region copy (padded for vector loads) and its integral images
+  std::vector<uint8_t> search_;
+  int search_width_ = 0;
+  int search_height_ = 0;
+  int search_stride_ = 0;
+  std::vector<int64_t> sum_;
+  std::vector<int64_t> sum_sq_;
+
+  bool matched_ = false;
+};
+
+// Builds an analyzer from a Dart config map ({type, id, ...}); null with
+// *error set when the config is invalid.
+std::unique_ptr<FrameAnalyzer> CreateFrameAnalyzer(const flutter::EncodableMap& config, std::string* error);
+
+#endif  // FRAME_ANALYZERS_H_
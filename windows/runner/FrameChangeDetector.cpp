@@ -0,0 +1,93 @@
+#include "FrameChangeDetector.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAME_CHANGE_DETECTOR_SSE2 1
+#endif
+
+static bool HasLumaPlane(int format) {
+    // Planar/semi-planar 8-bit layouts where data[0] is the Y plane
+    return format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_NV12 ||
+           format == AV_PIX_FMT_GRAY8;
+}
+
+uint64_t FrameChangeDetector::BlockChecksum(const uint8_t* data, int linesize, int width, int rows) {
+    uint64_t scalar = 0;
+    int vector_width = 0;
+
+#ifdef FRAME_CHANGE_DETECTOR_SSE2
+    // Byte sum (SAD against zero) plus a rotating xor so reordered content
+    // does not collide.
+    vector_width = width & ~15;
+    __m128i sum = _mm_setzero_si128();
+    __m128i mix = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (int row = 0; row < rows; ++row) {
+        const uint8_t* line = data + (size_t)row * linesize;
+        for (int x = 0; x < vector_width; x += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + x));
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+            mix = _mm_xor_si128(_mm_or_si128(_mm_slli_epi32(mix, 1), _mm_srli_epi32(mix, 31)), v);
+        }
+    }
+    sum = _mm_add_epi64(sum, _mm_srli_si128(sum, 8));
+    mix = _mm_xor_si128(mix, _mm_srli_si128(mix, 8));
+    mix = _mm_xor_si128(mix, _mm_srli_si128(mix, 4));
+    scalar = ((uint64_t)(uint32_t)_mm_cvtsi128_si32(mix) << 32) ^ (uint64_t)_mm_cvtsi128_si32(sum);
+#endif
+
+    // Remaining columns (all of them without SSE2), FNV-1a style
+    for (int row = 0; row < rows; ++row) {
+        const uint8_t* line = data + (size_t)row * linesize;
+        for (int x = vector_width; x < width; ++x) {
+            scalar = (scalar ^ line[x]) * 0x100000001B3ULL;
+        }
+    }
+    return scalar;
+}
+
+bool FrameChangeDetector::Update(const AVFrame* frame) {
+    if (!frame || !frame->data[0] || !HasLumaPlane(frame->format)) {
+        Reset();
+        return true;
+    }
+
+    int columns = (frame->width + kBlockWidth - 1) / kBlockWidth;
+    int rows = (frame->height + kBlockHeight - 1) / kBlockHeight;
+    size_t block_count = (size_t)columns * rows;
+    bool resized = frame->width != width_ || frame->height != height_ || checksums_.size() != block_count;
+    if (resized) {
+        width_ = frame->width;
+        height_ = frame->height;
+        checksums_.assign(block_count, 0);
+    }
+
+    size_t changed = 0;
+    for (int by = 0; by < rows; ++by) {
+        int y = by * kBlockHeight;
+        int block_rows = std::min(kBlockHeight, frame->height - y);
+        for (int bx = 0; bx < columns; ++bx) {
+            int x = bx * kBlockWidth;
+            int block_width = std::min(kBlockWidth, frame->width - x);
+            uint64_t checksum = BlockChecksum(frame->data[0] + (size_t)y * frame->linesize[0] + x,
+                                              frame->linesize[0], block_width, block_rows);
+            uint64_t& previous = checksums_[(size_t)by * columns + bx];
+            if (resized || previous != checksum) {
+                previous = checksum;
+                changed++;
+            }
+        }
+    }
+
+    changed_fraction_ = block_count ? (double)changed / block_count : 1.0;
+    return resized || changed > 0;
+}
+
+void FrameChangeDetector::Reset() {
+    checksums_.clear();
+    width_ = 0;
+    height_ = 0;
+    changed_fraction_ = 1.0;
+}
@@ -0,0 +1,38 @@
+#ifndef FRAME_CHANGE_DETECTOR_H_
+#define FRAME_CHANGE_DETECTOR_H_
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// Detects decoded frames whose luma plane is identical to the previous one by
+// comparing per-block checksums (SSE2 on x86). Costs a single read of the Y
+// plane, a fraction of an RGBA conversion. Decoder thread only.
+class FrameChangeDetector {
+ public:
+  static constexpr int kBlockWidth = 64; // Bytes
+  static constexpr int kBlockHeight = 16; // Rows
+
+  // Returns false only when every block matches the previous frame. Frames in
+  // unsupported formats always count as changed.
+  bool Update(const AVFrame* frame);
+
+  // Makes the next Update() report a change.
+  void Reset();
+
+  // Share of blocks that changed in the last Update(), 0..1.
+  double changed_fraction() const { return changed_fraction_; }
+
+ private:
+  static uint64_t BlockChecksum(const uint8_t* data, int linesize, int width, int rows);
+
+  std::vector<uint64_t> checksums_;
+  int width_ = 0;
+  int height_ = 0;
+  double changed_fraction_ = 1.0;
+};
+
+#endif  // FRAME_CHANGE_DETECTOR_H_
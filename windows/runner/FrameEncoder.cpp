@@ -0,0 +1,131 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "FrameEncoder.h"
+
+#include "VideoDecoderPlugin.h"
+
+#include <algorithm>
+#include <cstdio>
+
+bool FrameEncoder::ParseFormat(const std::string& name, Format* format) {
+    if (name == "png") {
+        *format = Format::kPng;
+        return true;
+    }
+    if (name == "jpeg" || name == "jpg") {
+        *format = Format::kJpeg;
+        return true;
+    }
+    return false;
+}
+
+const char* FrameEncoder::Extension(Format format) {
+    return format == Format::kPng ? "png" : "jpg";
+}
+
+bool FrameEncoder::Encode(const uint8_t* rgba, int width, int height, int stride, Format format, int max_size,
+                          int quality, std::vector<uint8_t>* out, int* out_width, int* out_height,
+                          std::string* error) {
+    int dst_width = width;
+    int dst_height = height;
+    if (max_size > 0 && std::max(width, height) > max_size) {
+        double scale = (double)max_size / std::max(width, height);
+        dst_width = std::max(2, (int)(width * scale) & ~1);
+        dst_height = std::max(2, (int)(height * scale) & ~1);
+    }
+
+    bool png = format == Format::kPng;
+    // MJPEG needs full-range 4:2:0; PNG takes RGBA as is
+    AVPixelFormat pix_fmt = png ? AV_PIX_FMT_RGBA : AV_PIX_FMT_YUVJ420P;
+    const AVCodec* codec = avcodec_find_encoder(png ? AV_CODEC_ID_PNG : AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        *error = png ? "PNG encoder not available" : "JPEG encoder not available";
+        return false;
+    }
+
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    SwsContext* sws = nullptr;
+    bool ok = false;
+
+    do {
+        if (!context || !frame || !packet) {
+            *error = "Allocation failed";
+            break;
+        }
+        context->width = dst_width;
+        context->height = dst_height;
+        context->pix_fmt = pix_fmt;
+        context->time_base = AVRational{1, 25};
+        if (!png) {
+            // Map 1-100 onto the MJPEG qscale range 31-2
+            int q = std::clamp(quality, 1, 100);
+            int qscale = 31 - (q - 1) * 29 / 99;
+            context->flags |= AV_CODEC_FLAG_QSCALE;
+            context->global_quality = qscale * FF_QP2LAMBDA;
+            frame->quality = context->global_quality;
+        }
+        {
+            std::lock_guard<std::mutex> lock(g_ffmpeg_init_mutex);
+            if (avcodec_open2(context, codec, NULL) < 0) {
+                *error = "Encoder open failed";
+                break;
+            }
+        }
+
+        frame->format = pix_fmt;
+        frame->width = dst_width;
+        frame->height = dst_height;
+        if (av_frame_get_buffer(frame, 0) < 0) {
+            *error = "Frame buffer allocation failed";
+            break;
+        }
+
+        sws = sws_getContext(width, height, AV_PIX_FMT_RGBA, dst_width, dst_height, pix_fmt, SWS_BILINEAR, NULL,
+                             NULL, NULL);
+        if (!sws) {
+            *error = "Scaler init failed";
+            break;
+        }
+        const uint8_t* src[4] = { rgba, NULL, NULL, NULL };
+        int src_linesize[4] = { stride, 0, 0, 0 };
+        if (sws_scale(sws, src, src_linesize, 0, height, frame->data, frame->linesize) <= 0) {
+            *error = "Scale failed";
+            break;
+        }
+
+        if (avcodec_send_frame(context, frame) < 0 || avcodec_send_frame(context, NULL) < 0) {
+            *error = "Encode failed";
+            break;
+        }
+        if (avcodec_receive_packet(context, packet) < 0) {
+            *error = "Encoder produced no output";
+            break;
+        }
+        out->assign(packet->data, packet->data + packet->size);
+        *out_width = dst_width;
+        *out_height = dst_height;
+        ok = true;
+    } while (false);
+
+    if (sws) sws_freeContext(sws);
+    if (packet) av_packet_free(&packet);
+    if (frame) av_frame_free(&frame);
+    if (context) avcodec_free_context(&context);
+    return ok;
+}
+
+bool FrameEncoder::WriteFile(const std::string& path, const std::vector<uint8_t>& data, std::string* error) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        *error = "Cannot open " + path;
+        return false;
+    }
+    size_t written = fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+    if (written != data.size()) {
+        *error = "Short write to " + path;
+        return false;
+    }
+    return true;
+}
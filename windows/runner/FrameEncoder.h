@@ -0,0 +1,26 @@
+#ifndef FRAME_ENCODER_H_
+#define FRAME_ENCODER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Still-image encoding of an RGBA frame with libavcodec's PNG and MJPEG
+// encoders. Stateless and safe to call from any worker thread.
+class FrameEncoder {
+ public:
+  enum class Format { kPng, kJpeg };
+
+  static bool ParseFormat(const std::string& name, Format* format);
+  static const char* Extension(Format format);
+
+  // Downscales so the longer edge is at most max_size (0 keeps full size).
+  // quality is 1-100 and only used for JPEG.
+  static bool Encode(const uint8_t* rgba, int width, int height, int stride, Format format, int max_size,
+                     int quality, std::vector<uint8_t>* out, int* out_width, int* out_height,
+                     std::string* error);
+
+  static bool WriteFile(const std::string& path, const std::vector<uint8_t>& data, std::string* error);
+};
+
+#endif  // FRAME_ENCODER_H_
@@ -0,0 +1,141 @@
+#include "FrameExporter.h"
+
+#include "frame_reader/scraki_frames.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Provided by the runner and by the decoder host
+void LogTrace(const char* format, ...);
+
+static_assert(sizeof(scraki_ring_header) == 64, "ring header layout");
+static_assert(sizeof(scraki_slot_header) == 64, "slot header layout");
+
+static size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static void StoreRelease(int64_t* target, int64_t value) {
+    InterlockedExchange64(reinterpret_cast<volatile LONG64*>(target), value);
+}
+
+std::unique_ptr<FrameExporter> FrameExporter::Create(int64_t texture_id, int slot_count, int max_edge,
+                                                     std::string* error) {
+    // Square capacity so a rotated screen still fits
+    return Create(SCRAKI_FRAMES_NAME_PREFIX + std::to_string(texture_id), slot_count,
+                  static_cast<size_t>(max_edge) * max_edge * 4, error);
+}
+
+std::unique_ptr<FrameExporter> FrameExporter::Create(const std::string& name, int slot_count, size_t pixel_capacity,
+                                                     std::string* error) {
+    std::unique_ptr<FrameExporter> exporter(new FrameExporter());
+    exporter->name_ = name;
+    exporter->slot_count_ = std::clamp(slot_count, 2, 16);
+    exporter->pixel_capacity_ = pixel_capacity;
+    exporter->slot_size_ = sizeof(scraki_slot_header) + AlignUp(exporter->pixel_capacity_, 64);
+    uint64_t total = sizeof(scraki_ring_header) + static_cast<uint64_t>(exporter->slot_size_) * exporter->slot_count_;
+
+    exporter->mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(total >> 32), static_cast<DWORD>(total),
+                                            exporter->name_.c_str());
+    if (!exporter->mapping_ || GetLastError() == ERROR_ALREADY_EXISTS) {
+        *error = "Failed to create " + exporter->name_ + " (" + std::to_string(GetLastError()) + ")";
+        return nullptr;
+    }
+    exporter->base_ = static_cast<uint8_t*>(MapViewOfFile(exporter->mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (!exporter->base_) {
+        *error = "Failed to map " + exporter->name_;
+        return nullptr;
+    }
+
+    // Fresh mappings are zero filled; the magic goes last so readers never
+    // see a half initialized header
+    auto* header = reinterpret_cast<scraki_ring_header*>(exporter->base_);
+    header->version = SCRAKI_FRAMES_VERSION;
+    header->slot_count = static_cast<uint32_t>(exporter->slot_count_);
+    header->slot_size = static_cast<uint32_t>(exporter->slot_size_);
+    header->header_size = sizeof(scraki_ring_header);
+    header->writer_alive = 1;
+    MemoryBarrier();
+    header->magic = SCRAKI_FRAMES_MAGIC;
+
+    LogTrace("FrameExporter - %s, %d slots of %zu bytes", exporter->name_.c_str(), exporter->slot_count_,
+             exporter->slot_size_);
+    return exporter;
+}
+
+FrameExporter::~FrameExporter() {
+    if (base_) {
+        // Readers still attached see the end of the stream
+        reinterpret_cast<scraki_ring_header*>(base_)->writer_alive = 0;
+        MemoryBarrier();
+        UnmapViewOfFile(base_);
+    }
+    if (mapping_) CloseHandle(mapping_);
+}
+
+void FrameExporter::Write(const uint8_t* rgba, int width, int height, int64_t pts_us) {
+    uint8_t* pixels = BeginWrite(width, height, pts_us);
+    if (!pixels) return;
+    memcpy(pixels, rgba, static_cast<size_t>(width) * height * 4);
+    CommitWrite();
+}
+
+uint8_t* FrameExporter::BeginWrite(int width, int height, int64_t pts_us) {
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (bytes > pixel_capacity_) {
+        frames_skipped_++;
+        return nullptr;
+    }
+
+    auto* header = reinterpret_cast<scraki_ring_header*>(base_);
+    // At most one slot is pinned, so the second candidate is always free
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        int64_t seq = next_seq_++;
+        int64_t index = (seq - 1) % slot_count_;
+        auto* slot = reinterpret_cast<scraki_slot_header*>(base_ + sizeof(scraki_ring_header) +
+                                                           static_cast<size_t>(index) * slot_size_);
+        int64_t lock = slot->lock;
+        // Full barrier between taking the slot and reading the pin; the
+        // pinning side does the opposite, so one of the two sees the other
+        StoreRelease(&slot->lock, lock + 1);
+        int64_t pinned = InterlockedCompareExchange64(reinterpret_cast<volatile LONG64*>(&header->pinned_seq), 0, 0);
+        if (pinned > 0 && (pinned - 1) % slot_count_ == index) {
+            // Contents untouched, so the old lock value stays valid. The
+            // skipped sequence number is never published.
+            StoreRelease(&slot->lock, lock);
+            continue;
+        }
+
+        slot->seq = seq;
+        slot->pts_us = pts_us;
+        slot->width = static_cast<uint32_t>(width);
+        slot->height = static_cast<uint32_t>(height);
+        slot->stride = static_cast<uint32_t>(width) * 4;
+        slot->format = SCRAKI_FORMAT_RGBA;
+        writing_slot_ = slot;
+        writing_seq_ = seq;
+        writing_lock_ = lock;
+        return reinterpret_cast<uint8_t*>(slot + 1);
+    }
+    frames_skipped_++;
+    return nullptr;
+}
+
+int64_t FrameExporter::CommitWrite() {
+    if (!writing_slot_) return 0;
+    auto* header = reinterpret_cast<scraki_ring_header*>(base_);
+    StoreRelease(&writing_slot_->lock, writing_lock_ + 2);
+    StoreRelease(&header->latest_seq, writing_seq_);
+    writing_slot_ = nullptr;
+    frames_written_++;
+    return writing_seq_;
+}
+
+void FrameExporter::AbortWrite() {
+    if (!writing_slot_) return;
+    // Readers only look at the slot of latest_seq, which is not this one
+    StoreRelease(&writing_slot_->lock, writing_lock_ + 2);
+    writing_slot_ = nullptr;
+    frames_skipped_++;
+}
@@ -0,0 +1,65 @@
+#ifndef FRAME_EXPORTER_H_
+#define FRAME_EXPORTER_H_
+
+#include <windows.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Publishes a session's converted RGBA frames into a named shared-memory ring
+// so analysis processes can read them in place (see frame_reader/). The
+// writer never waits for readers: each slot is guarded by a seqlock and
+// readers detect frames overwritten under them. The one exception is the
+// pinned frame (ring header pinned_seq), whose slot is skipped.
+class FrameExporter {
+ public:
+  // max_edge bounds the longer frame edge the slots are sized for.
+  static std::unique_ptr<FrameExporter> Create(int64_t texture_id, int slot_count, int max_edge,
+                                               std::string* error);
+  // Same with a caller chosen mapping name and slot size in bytes.
+  static std::unique_ptr<FrameExporter> Create(const std::string& name, int slot_count, size_t pixel_capacity,
+                                               std::string* error);
+  ~FrameExporter();
+
+  FrameExporter(const FrameExporter&) = delete;
+  FrameExporter& operator=(const FrameExporter&) = delete;
+
+  const std::string& name() const { return name_; }
+  int slot_count() const { return slot_count_; }
+
+  // Decoder thread. Frames larger than a slot are skipped.
+  void Write(const uint8_t* rgba, int width, int height, int64_t pts_us);
+
+  // In-place variant: returns the slot pixels (stride width * 4) to fill
+  // before CommitWrite(), or null when the frame does not fit.
+  uint8_t* BeginWrite(int width, int height, int64_t pts_us);
+  // Publishes the frame and returns its sequence number.
+  int64_t CommitWrite();
+  // Releases the slot unpublished; its old frame is gone either way.
+  void AbortWrite();
+
+  int64_t frames_written() const { return frames_written_; }
+  int64_t frames_skipped() const { return frames_skipped_; }
+
+ private:
+  FrameExporter() = default;
+
+  std::string name_;
+  HANDLE mapping_ = nullptr;
+  uint8_t* base_ = nullptr;
+  int slot_count_ = 0;
+  size_t slot_size_ = 0;
+  size_t pixel_capacity_ = 0;
+
+  // Decoder thread only
+  int64_t next_seq_ = 1;
+  struct scraki_slot_header* writing_slot_ = nullptr;
+  int64_t writing_seq_ = 0;
+  int64_t writing_lock_ = 0;
+  std::atomic<int64_t> frames_written_{0};
+  std::atomic<int64_t> frames_skipped_{0};
+};
+
+#endif  // FRAME_EXPORTER_H_
@@ -0,0 +1,193 @@
+#include "FrameHash.h"
+
+#include "TimerQueue.h"
+
+#include <bitset>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAME_HASH_SSE2 1
+#endif
+
+static const int kColumns = 9;
+static const int kRows = 8;
+static const int kLinesPerCell = 4;
+
+static uint32_t RowSum(const uint8_t* data, int count) {
+    uint32_t sum = 0;
+    int x = 0;
+#ifdef FRAME_HASH_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; x + 16 <= count; x += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + x));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    sum = (uint32_t)_mm_cvtsi128_si32(acc) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+    for (; x < count; ++x) sum += data[x];
+    return sum;
+}
+
+bool FrameHash::Compute(const AVFrame* frame, uint64_t* hash) {
+    if (!frame || !frame->data[0] || frame->linesize[0] <= 0) return false;
+    int format = frame->format;
+    if (format != AV_PIX_FMT_YUV420P && format != AV_PIX_FMT_YUVJ420P && format != AV_PIX_FMT_NV12 &&
+        format != AV_PIX_FMT_GRAY8) {
+        return false;
+    }
+    *hash = Compute(frame->data[0], frame->linesize[0], frame->width, frame->height);
+    return true;
+}
+
+uint64_t FrameHash::Compute(const uint8_t* luma, int linesize, int width, int height) {
+    if (!luma || width < kColumns || height < kRows) return 0;
+
+    int edges[kColumns + 1];
+    for (int c = 0; c <= kColumns; ++c) edges[c] = c * width / kColumns;
+
+    uint64_t hash = 0;
+    for (int r = 0; r < kRows; ++r) {
+        int top = r * height / kRows;
+        int cell_height = (r + 1) * height / kRows - top;
+        uint64_t sums[kColumns] = {};
+        for (int line = 0; line < kLinesPerCell; ++line) {
+            int y = top + (2 * line + 1) * cell_height / (2 * kLinesPerCell);
+            const uint8_t* row = luma + (size_t)y * linesize;
+            for (int c = 0; c < kColumns; ++c) sums[c] += RowSum(row + edges[c], edges[c + 1] - edges[c]);
+        }
+        // Cells of a row differ in width by at most a pixel; compare means
+        for (int c = 0; c + 1 < kColumns; ++c) {
+            uint64_t left = sums[c] * (uint64_t)(edges[c + 2] - edges[c + 1]);
+            uint64_t right = sums[c + 1] * (uint64_t)(edges[c + 1] - edges[c]);
+            hash = (hash << 1) | (right > left ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+int FrameHash::Distance(uint64_t a, uint64_t b) {
+    return (int)std::bitset<64>(a ^ b).count();
+}
+
+std::string FrameHash::ToHex(uint64_t hash) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) text[i] = kDigits[hash & 0xF];
+    return text;
+}
+
+bool FrameHash::FromHex(const std::string& text, uint64_t* hash) {
+    size_t start = text.compare(0, 2, "0x") == 0 ? 2 : 0;
+    if (text.size() == start || text.size() - start > 16) return false;
+    uint64_t value = 0;
+    for (size_t i = start; i < text.size(); ++i) {
+        char ch = text[i];
+        int digit;
+        if (ch >= '0' && ch <= '9') digit = ch - '0';
+        else if (ch >= 'a' && ch <= 'f') digit = ch - 'a' + 10;
+        else if (ch >= 'A' && ch <= 'F') digit = ch - 'A' + 10;
+        else return false;
+        value = (value << 4) | (uint64_t)digit;
+    }
+    *hash = value;
+    return true;
+}
+
+FrameHashWatch::~FrameHashWatch() {
+    CancelAll();
+}
+
+void FrameHashWatch::Update(uint64_t hash, int64_t pts_us) {
+    std::vector<std::pair<Callback, Result>> resolved;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        has_hash_ = true;
+        hash_ = hash;
+        pts_us_ = pts_us;
+        hash_time_ = Clock::now();
+        for (auto it = waiters_.begin(); it != waiters_.end();) {
+            if (FrameHash::Distance(hash, it->reference) > it->max_distance) {
+                ++it;
+                continue;
+            }
+            resolved.emplace_back(std::move(it->done), ResultFor(*it, true));
+            it = waiters_.erase(it);
+        }
+    }
+    for (auto& entry : resolved) entry.first(entry.second);
+}
+
+FrameHashWatch::Result FrameHashWatch::Current() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Result result;
+    result.has_hash = has_hash_;
+    result.hash = hash_;
+    result.pts_us = pts_us_;
+    if (has_hash_) {
+        result.elapsed_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - hash_time_).count();
+    }
+    return result;
+}
+
+void FrameHashWatch::Wait(uint64_t reference, int max_distance, std::chrono::milliseconds timeout, Callback done) {
+    Waiter waiter{0, reference, max_distance, Clock::now(), std::move(done)};
+    uint64_t id = 0;
+    Result result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (has_hash_ && FrameHash::Distance(hash_, reference) <= max_distance) {
+            result = ResultFor(waiter, true);
+        } else {
+            id = waiter.id = next_id_++;
+            waiters_.push_back(std::move(waiter));
+        }
+    }
+    if (id == 0) {
+        waiter.done(result);
+        return;
+    }
+
+    std::weak_ptr<FrameHashWatch> weak = shared_from_this();
+    TimerQueue::GetInstance().Schedule(Clock::now() + timeout, [weak, id]() {
+        if (auto self = weak.lock()) self->Expire(id);
+    });
+}
+
+void FrameHashWatch::CancelAll() {
+    std::vector<std::pair<Callback, Result>> resolved;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& waiter : waiters_) resolved.emplace_back(std::move(waiter.done), ResultFor(waiter, false));
+        waiters_.clear();
+    }
+    for (auto& entry : resolved) entry.first(entry.second);
+}
+
+FrameHashWatch::Result FrameHashWatch::ResultFor(const Waiter& waiter, bool matched) const {
+    Result result;
+    result.matched = matched;
+    result.has_hash = has_hash_;
+    result.hash = hash_;
+    result.distance = has_hash_ ? FrameHash::Distance(hash_, waiter.reference) : 64;
+    result.pts_us = pts_us_;
+    result.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - waiter.start).count();
+    return result;
+}
+
+void FrameHashWatch::Expire(uint64_t id) {
+    Callback done;
+    Result result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = waiters_.begin(); it != waiters_.end(); ++it) {
+            if (it->id != id) continue;
+            result = ResultFor(*it, false);
+            done = std::move(it->done);
+            waiters_.erase(it);
+            break;
+        }
+    }
+    if (done) done(result);
+}
@@ -0,0 +1,88 @@
+#ifndef FRAME_HASH_H_
+#define FRAME_HASH_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// 64-bit difference hash (dHash) of a frame's Y plane: the frame is reduced
+// to 9x8 cell means, and each bit tells whether a cell is brighter than its
+// left neighbour. Robust to scaling and encoder noise, so hashes of the same
+// screen from different devices or runs are a few bits apart. Cells are
+// averaged over four rows each, which keeps the cost at a few microseconds.
+class FrameHash {
+ public:
+  // False for frames without an 8-bit luma plane.
+  static bool Compute(const AVFrame* frame, uint64_t* hash);
+  static uint64_t Compute(const uint8_t* luma, int linesize, int width, int height);
+
+  // Differing bits, 0..64.
+  static int Distance(uint64_t a, uint64_t b);
+
+  // 16 lowercase hex digits, most significant first.
+  static std::string ToHex(uint64_t hash);
+  static bool FromHex(const std::string& text, uint64_t* hash);
+};
+
+// Latest hash of one session and the waits for its screen to match one.
+// Update runs on the decoder thread and resolves matching waits there;
+// unmatched waits resolve on the TimerQueue at their deadline. Callbacks
+// run without the lock held and must be short.
+class FrameHashWatch : public std::enable_shared_from_this<FrameHashWatch> {
+ public:
+  struct Result {
+      bool matched = false;
+      bool has_hash = false; // False when no frame was hashed yet
+      uint64_t hash = 0;
+      int distance = 64;
+      int64_t pts_us = 0;
+      int64_t elapsed_ms = 0; // Time waited, or the hash's age for Current()
+  };
+  using Callback = std::function<void(const Result& result)>;
+
+  ~FrameHashWatch();
+
+  void Update(uint64_t hash, int64_t pts_us);
+
+  Result Current() const;
+
+  // Calls done once: right away when the current hash is within
+  // max_distance of reference, else with the first frame that is, or
+  // unmatched with the last hash after timeout.
+  void Wait(uint64_t reference, int max_distance, std::chrono::milliseconds timeout, Callback done);
+
+  // Resolves every pending wait unmatched (session closing).
+  void CancelAll();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Waiter {
+      uint64_t id;
+      uint64_t reference;
+      int max_distance;
+      Clock::time_point start;
+      Callback done;
+  };
+
+  Result ResultFor(const Waiter& waiter, bool matched) const;
+  void Expire(uint64_t id);
+
+  mutable std::mutex mutex_;
+  bool has_hash_ = false;
+  uint64_t hash_ = 0;
+  int64_t pts_us_ = 0;
+  Clock::time_point hash_time_;
+  std::vector<Waiter> waiters_;
+  uint64_t next_id_ = 1;
+};
+
+#endif  // FRAME_HASH_H_
@@ -0,0 +1,129 @@
+#include "FrameNotifier.h"
+
+#include <windows.h>
+#include <dwmapi.h>
+
+#include <algorithm>
+
+static const double kFallbackRefreshHz = 60.0;
+
+FrameNotifier& FrameNotifier::GetInstance() {
+    static FrameNotifier instance;
+    return instance;
+}
+
+FrameNotifier::FrameNotifier() {
+    timer_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    stats_.refresh_hz = kFallbackRefreshHz;
+    thread_ = std::thread([this]() { Run(); });
+}
+
+FrameNotifier::~FrameNotifier() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (timer_) CloseHandle(timer_);
+}
+
+void FrameNotifier::Request(flutter::TextureRegistrar* registrar, int64_t texture_id) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        window_requests_++;
+        stats_.requests++;
+        wake = pending_.empty();
+        pending_.emplace(texture_id, Pending{registrar, Clock::now()});
+    }
+    if (wake) cv_.notify_one();
+}
+
+void FrameNotifier::Cancel(int64_t texture_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(texture_id);
+}
+
+FrameNotifier::Stats FrameNotifier::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RollWindow(Clock::now());
+    return stats_;
+}
+
+void FrameNotifier::RollWindow(Clock::time_point now) {
+    double seconds = std::chrono::duration<double>(now - window_start_).count();
+    if (seconds < 1.0) return;
+    stats_.requests_per_second = window_requests_ / seconds;
+    stats_.posts_per_second = window_posts_ / seconds;
+    stats_.average_delay_ms = window_posts_ ? window_delay_sum_ms_ / window_posts_ : 0;
+    stats_.max_delay_ms = window_max_delay_ms_;
+    window_start_ = now;
+    window_requests_ = 0;
+    window_posts_ = 0;
+    window_delay_sum_ms_ = 0;
+    window_max_delay_ms_ = 0;
+}
+
+void FrameNotifier::WaitForRefresh() {
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+
+    int64_t wait_ticks = (int64_t)(frequency.QuadPart / kFallbackRefreshHz);
+    DWM_TIMING_INFO timing = {};
+    timing.cbSize = sizeof(timing);
+    if (SUCCEEDED(DwmGetCompositionTimingInfo(nullptr, &timing)) && timing.qpcRefreshPeriod > 0) {
+        int64_t period = (int64_t)timing.qpcRefreshPeriod;
+        int64_t since_vblank = now.QuadPart - (int64_t)timing.qpcVBlank;
+        int64_t target = now.QuadPart + period - ((since_vblank % period) + period) % period;
+        // A timer firing just early must not make a second batch for the
+        // same vblank
+        if (target - last_vblank_ < period / 2) target += period;
+        last_vblank_ = target;
+        wait_ticks = target - now.QuadPart;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.refresh_hz = (double)frequency.QuadPart / period;
+    }
+
+    int64_t wait_100ns = wait_ticks * 10000000 / frequency.QuadPart;
+    if (timer_) {
+        LARGE_INTEGER due;
+        due.QuadPart = -std::max<int64_t>(wait_100ns, 1); // Negative: relative
+        if (SetWaitableTimer(timer_, &due, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(timer_, INFINITE);
+            return;
+        }
+    }
+    // Without a high-resolution timer this rounds to the scheduler tick
+    std::this_thread::sleep_for(std::chrono::microseconds(wait_100ns / 10));
+}
+
+void FrameNotifier::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (active_) {
+        if (pending_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        WaitForRefresh();
+        lock.lock();
+
+        // Marked under the lock so a texture cancelled meanwhile is skipped
+        auto now = Clock::now();
+        for (const auto& entry : pending_) {
+            entry.second.registrar->MarkTextureFrameAvailable(entry.first);
+            double delay_ms = std::chrono::duration<double, std::milli>(now - entry.second.since).count();
+            window_delay_sum_ms_ += delay_ms;
+            window_max_delay_ms_ = std::max(window_max_delay_ms_, delay_ms);
+        }
+        window_posts_ += (int64_t)pending_.size();
+        stats_.posts += (int64_t)pending_.size();
+        pending_.clear();
+        RollWindow(now);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef FRAME_NOTIFIER_H_
+#define FRAME_NOTIFIER_H_
+
+#include <flutter/texture_registrar.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Coalesces texture frame-available marks from every session into at most
+// one per texture per display refresh. Decoder threads only flag their
+// texture as dirty; one thread wakes at each vblank (from DWM composition
+// timing) and issues the marks, so frames superseded before the engine could
+// show them cost no post into the engine. Idle while nothing is dirty.
+class FrameNotifier {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Last complete one-second window.
+  struct Stats {
+      double requests_per_second = 0;
+      double posts_per_second = 0;
+      double average_delay_ms = 0; // From the first request to its mark
+      double max_delay_ms = 0;
+      double refresh_hz = 0;
+      int64_t requests = 0; // Totals since start
+      int64_t posts = 0;
+  };
+
+  static FrameNotifier& GetInstance();
+
+  // Marks texture_id at the next refresh; further requests before then fold
+  // into the same mark. Cheap enough to call under a pixel buffer lock.
+  void Request(flutter::TextureRegistrar* registrar, int64_t texture_id);
+
+  // No mark for texture_id is issued once this returns. Call between
+  // invalidating the texture and unregistering it.
+  void Cancel(int64_t texture_id);
+
+  Stats GetStats();
+
+ private:
+  FrameNotifier();
+  ~FrameNotifier();
+
+  void Run();
+  // Sleeps until the next vblank, or a 60 Hz tick without composition info.
+  void WaitForRefresh();
+  // Caller holds mutex_.
+  void RollWindow(Clock::time_point now);
+
+  struct Pending {
+      flutter::TextureRegistrar* registrar;
+      Clock::time_point since;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unordered_map<int64_t, Pending> pending_;
+  bool active_ = true;
+  void* timer_ = nullptr; // High-resolution waitable timer, when available
+  int64_t last_vblank_ = 0; // QPC time of the last vblank waited for
+  std::thread thread_;
+
+  Stats stats_;
+  Clock::time_point window_start_ = Clock::now();
+  int64_t window_requests_ = 0;
+  int64_t window_posts_ = 0;
+  double window_delay_sum_ms_ = 0;
+  double window_max_delay_ms_ = 0;
+};
+
+#endif  // FRAME_NOTIFIER_H_
@@ -0,0 +1,115 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+static int64_t ToMicroseconds(FramePacer::Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+FramePacer::~FramePacer() {
+    if (sync_group_) sync_group_->Leave(sync_member_);
+}
+
+void FramePacer::SetDelay(int delay_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    delay_ms_ = delay_ms;
+}
+
+int FramePacer::delay_ms() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return delay_ms_;
+}
+
+void FramePacer::SetSyncGroup(std::shared_ptr<SyncGroup> group, int64_t member) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sync_group_) sync_group_->Leave(sync_member_);
+    sync_group_ = std::move(group);
+    sync_member_ = member;
+    if (sync_group_) sync_group_->Join(member);
+}
+
+std::shared_ptr<SyncGroup> FramePacer::sync_group() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sync_group_;
+}
+
+bool FramePacer::IsPassthrough() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (delay_ms_ == 0 && !sync_group_) || !has_offset_;
+}
+
+void FramePacer::OnPacketArrival(int64_t pts_us, Clock::time_point arrival) {
+    int64_t offset = ToMicroseconds(arrival) - pts_us;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // RFC 3550 interarrival jitter
+    if (has_offset_) {
+        double d = std::fabs((double)(offset - last_offset_us_));
+        jitter_us_ += (d - jitter_us_) / 16.0;
+    }
+    last_offset_us_ = offset;
+    has_offset_ = true;
+
+    // Monotonic deque keeps the window minimum at the front
+    uint64_t index = sample_index_++;
+    while (!offset_window_.empty() && offset_window_.back().second >= offset) {
+        offset_window_.pop_back();
+    }
+    offset_window_.emplace_back(index, offset);
+    while (offset_window_.front().first + kOffsetWindow <= index) {
+        offset_window_.pop_front();
+    }
+}
+
+FramePacer::Clock::time_point FramePacer::PresentationTime(int64_t pts_us) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (offset_window_.empty()) return Clock::now();
+    int64_t local_us = CaptureTimeUsLocked(pts_us) + (int64_t)EffectiveDelayMsLocked() * 1000;
+    return Clock::time_point(std::chrono::microseconds(local_us));
+}
+
+void FramePacer::OnFrameReady(int64_t pts_us, Clock::time_point ready) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!sync_group_ || offset_window_.empty()) return;
+    sync_group_->OnFrameReady(sync_member_, (ToMicroseconds(ready) - CaptureTimeUsLocked(pts_us)) / 1000.0);
+}
+
+void FramePacer::OnPresented(int64_t pts_us, Clock::time_point ready, Clock::time_point presented) {
+    double held_us = (double)std::chrono::duration_cast<std::chrono::microseconds>(presented - ready).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_held_++;
+    added_latency_us_ += (std::max(0.0, held_us) - added_latency_us_) / 16.0;
+    if (sync_group_ && !offset_window_.empty()) {
+        int64_t target_us = CaptureTimeUsLocked(pts_us) + (int64_t)EffectiveDelayMsLocked() * 1000;
+        sync_group_->OnPresented(sync_member_, (ToMicroseconds(presented) - target_us) / 1000.0);
+    }
+}
+
+void FramePacer::OnSuperseded() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_superseded_++;
+}
+
+FramePacer::Stats FramePacer::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.jitter_ms = jitter_us_ / 1000.0;
+    stats.added_latency_ms = delay_ms_ == 0 && !sync_group_ ? 0 : added_latency_us_ / 1000.0;
+    stats.effective_delay_ms = EffectiveDelayMsLocked();
+    stats.frames_held = frames_held_;
+    stats.frames_superseded = frames_superseded_;
+    if (sync_group_) stats.sync_error_ms = sync_group_->MemberErrorMs(sync_member_);
+    return stats;
+}
+
+int FramePacer::EffectiveDelayMsLocked() const {
+    if (sync_group_) return (int)std::ceil(sync_group_->delay_ms());
+    if (delay_ms_ != kAdaptiveDelay) return std::max(0, delay_ms_);
+    // Three times the jitter absorbs nearly all late packets on Wi-Fi
+    return std::clamp((int)(3.0 * jitter_us_ / 1000.0), 10, 200);
+}
+
+int64_t FramePacer::CaptureTimeUsLocked(int64_t pts_us) const {
+    return pts_us + offset_window_.front().second;
+}
@@ -0,0 +1,83 @@
+#ifndef FRAME_PACER_H_
+#define FRAME_PACER_H_
+
+#include "SyncGroup.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+// Maps device PTS onto the local steady clock and estimates network jitter,
+// so frames can be released on the cadence they were captured at instead of
+// the bursty cadence they arrive at.
+//
+// delay_ms == 0 is passthrough (present as soon as converted), a positive
+// value holds every frame until mapped PTS + delay, and kAdaptiveDelay derives
+// the delay from the measured jitter. In a SyncGroup the group's delay
+// replaces the session's own.
+class FramePacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int kAdaptiveDelay = -1;
+
+  struct Stats {
+      double jitter_ms = 0;
+      double added_latency_ms = 0; // Average hold time of paced frames
+      int effective_delay_ms = 0;
+      int64_t frames_held = 0;
+      int64_t frames_superseded = 0;
+      double sync_error_ms = 0; // Display time against the sync group target
+  };
+
+  ~FramePacer();
+
+  void SetDelay(int delay_ms);
+  // Null leaves the current group. member identifies the session in it.
+  void SetSyncGroup(std::shared_ptr<SyncGroup> group, int64_t member);
+  std::shared_ptr<SyncGroup> sync_group() const;
+  int delay_ms() const;
+  bool IsPassthrough() const;
+
+  // Called for every frame packet when it is fully received.
+  void OnPacketArrival(int64_t pts_us, Clock::time_point arrival);
+
+  // Local time at which the frame captured at pts_us should be shown.
+  Clock::time_point PresentationTime(int64_t pts_us) const;
+
+  // Called when a paced frame is converted, before it is held.
+  void OnFrameReady(int64_t pts_us, Clock::time_point ready);
+  void OnPresented(int64_t pts_us, Clock::time_point ready, Clock::time_point presented);
+  void OnSuperseded();
+
+  Stats GetStats() const;
+
+ private:
+  int EffectiveDelayMsLocked() const;
+  // Mapped PTS without any delay: the local capture instant.
+  int64_t CaptureTimeUsLocked(int64_t pts_us) const;
+
+  static constexpr size_t kOffsetWindow = 120; // ~2s at 60fps
+
+  mutable std::mutex mutex_;
+  int delay_ms_ = 0;
+
+  // Sliding-window minimum of (arrival - pts): the least delayed packet is
+  // the best estimate of the device-to-local clock offset.
+  std::deque<std::pair<uint64_t, int64_t>> offset_window_;
+  uint64_t sample_index_ = 0;
+  int64_t last_offset_us_ = 0;
+  bool has_offset_ = false;
+  double jitter_us_ = 0;
+
+  double added_latency_us_ = 0;
+  int64_t frames_held_ = 0;
+  int64_t frames_superseded_ = 0;
+
+  std::shared_ptr<SyncGroup> sync_group_;
+  int64_t sync_member_ = 0;
+};
+
+#endif  // FRAME_PACER_H_
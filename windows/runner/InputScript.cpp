@@ -0,0 +1,249 @@
+#include "InputScript.h"
+
+#include "VideoDecoderPlugin.h"
+
+#include <windows.h>
+#include <timeapi.h>
+#include <ws2tcpip.h>
+
+#include <algorithm>
+#include <cmath>
+
+static const uint8_t kMagic[4] = {'S', 'C', 'I', 'S'};
+static const uint8_t kVersion = 1;
+
+// scrcpy inject touch / scroll: type, [action, pointer id,] x, y, w, h, ...
+static const uint8_t kTypeInjectTouch = 2;
+static const uint8_t kTypeInjectScroll = 3;
+static const size_t kTouchPositionOffset = 10;
+static const size_t kScrollPositionOffset = 1;
+
+// Sleeping is only accurate to the scheduler tick; the rest is spun
+static const auto kSpinMargin = std::chrono::microseconds(1500);
+static const auto kStartLead = std::chrono::milliseconds(20);
+
+static void PutVarint(std::vector<uint8_t>* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back((uint8_t)value);
+}
+
+static bool GetVarint(const std::vector<uint8_t>& in, size_t* offset, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *offset < in.size(); shift += 7) {
+        uint8_t byte = in[(*offset)++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t ReadBig(const uint8_t* data, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) value = (value << 8) | data[i];
+    return value;
+}
+
+static void WriteBig(uint8_t* data, int bytes, uint32_t value) {
+    for (int i = bytes - 1; i >= 0; --i, value >>= 8) data[i] = (uint8_t)value;
+}
+
+void InputScript::Append(int64_t timestamp_us, const uint8_t* data, size_t size) {
+    if (messages_.empty()) first_timestamp_us_ = timestamp_us;
+    // Never earlier than the previous message, whatever the caller's clock did
+    int64_t time_us = std::max<int64_t>(timestamp_us - first_timestamp_us_,
+                                        messages_.empty() ? 0 : messages_.back().time_us);
+    messages_.push_back(Message{time_us, std::vector<uint8_t>(data, data + size)});
+}
+
+std::vector<uint8_t> InputScript::Serialize() const {
+    std::vector<uint8_t> out(kMagic, kMagic + 4);
+    out.push_back(kVersion);
+    out.resize(out.size() + 4);
+    WriteBig(&out[5], 2, (uint32_t)width_);
+    WriteBig(&out[7], 2, (uint32_t)height_);
+    PutVarint(&out, messages_.size());
+    int64_t previous = 0;
+    for (const auto& message : messages_) {
+        PutVarint(&out, (uint64_t)(message.time_us - previous));
+        PutVarint(&out, message.data.size());
+        out.insert(out.end(), message.data.begin(), message.data.end());
+        previous = message.time_us;
+    }
+    return out;
+}
+
+std::unique_ptr<InputScript> InputScript::Parse(const std::vector<uint8_t>& bytes, std::string* error) {
+    if (bytes.size() < 9 || !std::equal(kMagic, kMagic + 4, bytes.begin())) {
+        *error = "Not an input script";
+        return nullptr;
+    }
+    if (bytes[4] != kVersion) {
+        *error = "Unsupported input script version " + std::to_string(bytes[4]);
+        return nullptr;
+    }
+    auto script = std::make_unique<InputScript>((int)ReadBig(&bytes[5], 2), (int)ReadBig(&bytes[7], 2));
+    size_t offset = 9;
+    uint64_t count = 0;
+    if (!GetVarint(bytes, &offset, &count) || count > bytes.size()) {
+        *error = "Truncated input script";
+        return nullptr;
+    }
+    script->messages_.reserve((size_t)count);
+    int64_t time_us = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta = 0;
+        uint64_t size = 0;
+        if (!GetVarint(bytes, &offset, &delta) || !GetVarint(bytes, &offset, &size) ||
+            size > bytes.size() - offset) {
+            *error = "Truncated input script at message " + std::to_string(i);
+            return nullptr;
+        }
+        time_us += (int64_t)delta;
+        auto begin = bytes.begin() + offset;
+        script->messages_.push_back(Message{time_us, std::vector<uint8_t>(begin, begin + (size_t)size)});
+        offset += (size_t)size;
+    }
+    return script;
+}
+
+void InputScript::Rescale(std::vector<uint8_t>* message, int width, int height) {
+    if (message->empty() || width <= 0 || height <= 0) return;
+    size_t offset;
+    if ((*message)[0] == kTypeInjectTouch) {
+        offset = kTouchPositionOffset;
+    } else if ((*message)[0] == kTypeInjectScroll) {
+        offset = kScrollPositionOffset;
+    } else {
+        return;
+    }
+    if (message->size() < offset + 12) return;
+
+    uint8_t* position = message->data() + offset;
+    int32_t x = (int32_t)ReadBig(position, 4);
+    int32_t y = (int32_t)ReadBig(position + 4, 4);
+    int from_width = (int)ReadBig(position + 8, 2);
+    int from_height = (int)ReadBig(position + 10, 2);
+    if (from_width <= 0 || from_height <= 0) return;
+
+    x = (int32_t)std::lround((double)x * width / from_width);
+    y = (int32_t)std::lround((double)y * height / from_height);
+    WriteBig(position, 4, (uint32_t)x);
+    WriteBig(position + 4, 4, (uint32_t)y);
+    WriteBig(position + 8, 2, (uint32_t)width);
+    WriteBig(position + 10, 2, (uint32_t)height);
+}
+
+InputReplayer::InputReplayer(std::shared_ptr<const InputScript> script, std::vector<Target> targets, double speed,
+                             Callback done)
+    : script_(std::move(script)), targets_(std::move(targets)), speed_(speed > 0 ? speed : 1.0),
+      done_(std::move(done)) {
+    thread_ = std::thread([this]() { Run(); });
+}
+
+InputReplayer::~InputReplayer() {
+    Cancel();
+    if (thread_.joinable()) thread_.join();
+}
+
+void InputReplayer::Cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+    }
+    cv_.notify_all();
+}
+
+bool InputReplayer::WaitUntil(Clock::time_point due) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (cv_.wait_until(lock, due - kSpinMargin, [this]() { return cancelled_; })) return false;
+    }
+    while (Clock::now() < due) std::this_thread::yield();
+    return true;
+}
+
+void InputReplayer::Run() {
+    // The default 15.6ms scheduler tick would leave most of the wait to the spin
+    timeBeginPeriod(1);
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+    Report report;
+    report.targets = (int)targets_.size();
+    const auto& messages = script_->messages();
+    report.messages = (int64_t)messages.size();
+
+    // Connected targets with their copy of every message, rescaled up front
+    std::vector<SOCKET> sockets;
+    std::vector<std::vector<std::vector<uint8_t>>> payloads;
+    for (const auto& target : targets_) {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((u_short)target.control_port);
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == INVALID_SOCKET) continue;
+        if (connect(sock, (const sockaddr*)&address, sizeof(address)) == SOCKET_ERROR) {
+            LogTrace("InputReplayer - Cannot connect to control port %d: %d", target.control_port,
+                     WSAGetLastError());
+            closesocket(sock);
+            continue;
+        }
+        BOOL nodelay = TRUE;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+        std::vector<std::vector<uint8_t>> rescaled;
+        rescaled.reserve(messages.size());
+        for (const auto& message : messages) {
+            rescaled.push_back(message.data);
+            InputScript::Rescale(&rescaled.back(), target.width, target.height);
+        }
+        sockets.push_back(sock);
+        payloads.push_back(std::move(rescaled));
+    }
+    report.targets_connected = (int)sockets.size();
+
+    std::vector<double> errors;
+    errors.reserve(messages.size());
+    auto start = Clock::now() + kStartLead;
+    for (size_t i = 0; i < messages.size() && !sockets.empty(); ++i) {
+        auto due = start + std::chrono::microseconds((int64_t)(messages[i].time_us / speed_));
+        if (!WaitUntil(due)) {
+            report.cancelled = true;
+            break;
+        }
+        auto sent_at = Clock::now();
+        for (size_t t = 0; t < sockets.size(); ++t) {
+            const auto& payload = payloads[t][i];
+            if (send(sockets[t], (const char*)payload.data(), (int)payload.size(), 0) != (int)payload.size()) {
+                report.send_errors++;
+            }
+        }
+        errors.push_back(std::chrono::duration<double, std::micro>(sent_at - due).count());
+        report.max_fan_out_us = std::max(
+            report.max_fan_out_us, std::chrono::duration<double, std::micro>(Clock::now() - sent_at).count());
+        report.messages_sent++;
+    }
+    report.duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    for (SOCKET sock : sockets) closesocket(sock);
+
+    if (!errors.empty()) {
+        double sum = 0;
+        for (double error : errors) sum += error;
+        report.mean_error_us = sum / errors.size();
+        std::sort(errors.begin(), errors.end());
+        report.p99_error_us = errors[std::min(errors.size() - 1, errors.size() * 99 / 100)];
+        report.max_error_us = errors.back();
+    }
+    timeEndPeriod(1);
+
+    LogTrace("InputReplayer - %lld/%lld messages to %d targets, error mean %.0f us, p99 %.0f us, max %.0f us",
+             report.messages_sent, report.messages, report.targets_connected, report.mean_error_us,
+             report.p99_error_us, report.max_error_us);
+    if (done_) done_(report);
+    finished_ = true;
+}
@@ -0,0 +1,113 @@
+#ifndef INPUT_SCRIPT_H_
+#define INPUT_SCRIPT_H_
+
+#include <winsock2.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Serialized scrcpy control messages with their send times, recorded from one
+// device and replayable on others.
+//
+// Binary layout (integers big-endian, varints LEB128):
+//   "SCIS" u8 version u16 width u16 height varint count
+//   count x { varint delta_us varint size u8[size] }
+// A touch move costs 35 bytes.
+class InputScript {
+ public:
+  struct Message {
+      int64_t time_us; // Since the first message
+      std::vector<uint8_t> data;
+  };
+
+  InputScript(int width, int height) : width_(width), height_(height) {}
+
+  // timestamp_us is on any monotonic clock; only differences are kept.
+  void Append(int64_t timestamp_us, const uint8_t* data, size_t size);
+
+  std::vector<uint8_t> Serialize() const;
+  // Null with *error set on a malformed script.
+  static std::unique_ptr<InputScript> Parse(const std::vector<uint8_t>& bytes, std::string* error);
+
+  // Maps the position of a touch or scroll message from the screen size it
+  // carries to width x height. Other messages are left as they are.
+  static void Rescale(std::vector<uint8_t>* message, int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const std::vector<Message>& messages() const { return messages_; }
+  int64_t duration_us() const { return messages_.empty() ? 0 : messages_.back().time_us; }
+
+ private:
+  int width_;
+  int height_;
+  int64_t first_timestamp_us_ = 0;
+  std::vector<Message> messages_;
+};
+
+// Replays a script into the control channels of one or more devices from a
+// dedicated thread. Each message is due at start + time_us / speed: the
+// thread sleeps until shortly before, then spins, and writes the message to
+// every target back to back. Lateness is measured per message.
+class InputReplayer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Target {
+      int control_port = 0; // Loopback port forwarding to the device
+      int width = 0;        // Screen size to rescale to; 0 keeps positions
+      int height = 0;
+  };
+
+  struct Report {
+      int targets = 0;
+      int targets_connected = 0;
+      int64_t messages = 0;
+      int64_t messages_sent = 0; // Per message, not per target
+      int64_t send_errors = 0;
+      double mean_error_us = 0; // Lateness of each message against its due time
+      double p99_error_us = 0;
+      double max_error_us = 0;
+      double max_fan_out_us = 0; // Writing one message to every target
+      int64_t duration_ms = 0;
+      bool cancelled = false;
+  };
+  using Callback = std::function<void(const Report& report)>;
+
+  // Starts right away; done runs on the replay thread when it ends.
+  InputReplayer(std::shared_ptr<const InputScript> script, std::vector<Target> targets, double speed,
+                Callback done);
+  ~InputReplayer();
+
+  InputReplayer(const InputReplayer&) = delete;
+  InputReplayer& operator=(const InputReplayer&) = delete;
+
+  void Cancel();
+  bool finished() const { return finished_; }
+
+ private:
+  void Run();
+  // False when cancelled first.
+  bool WaitUntil(Clock::time_point due);
+
+  std::shared_ptr<const InputScript> script_;
+  std::vector<Target> targets_;
+  double speed_;
+  Callback done_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool cancelled_ = false;
+  std::atomic<bool> finished_{false};
+  std::thread thread_;
+};
+
+#endif  // INPUT_SCRIPT_H_
@@ -0,0 +1,91 @@
+#include "PlacementBenchmark.h"
+
+#include "CpuTopology.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+PlacementBenchmark::Result PlacementBenchmark::Run(int threads, int width, int height,
+                                                   std::chrono::milliseconds duration,
+                                                   const std::atomic<bool>* cancel) {
+    Result result;
+    result.threads = threads;
+    // Unpinned, pinned, pinned, unpinned: clock or thermal drift over the
+    // run weighs on both modes alike instead of favouring the first one
+    auto first_half = duration / 2;
+    auto second_half = duration - first_half;
+    double unpinned = Measure(false, threads, width, height, first_half, cancel);
+    double pinned = Measure(true, threads, width, height, first_half, cancel);
+    pinned += Measure(true, threads, width, height, second_half, cancel);
+    unpinned += Measure(false, threads, width, height, second_half, cancel);
+    result.unpinned_fps = unpinned / 2;
+    result.pinned_fps = pinned / 2;
+    return result;
+}
+
+double PlacementBenchmark::Measure(bool pinned, int threads, int width, int height,
+                                   std::chrono::milliseconds duration, const std::atomic<bool>* cancel) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<int64_t> frames{0};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            auto& topology = CpuTopology::GetInstance();
+            CpuTopology::Placement placement;
+            GROUP_AFFINITY previous = {};
+            bool is_pinned = false;
+            if (pinned) {
+                placement = topology.Acquire(CpuTopology::Preference::kAny);
+                is_pinned = topology.Pin(placement, &previous);
+            }
+
+            // Buffers are allocated and first touched by the converting
+            // thread, as in a session
+            NodeAllocator<uint8_t> allocator(is_pinned ? placement.node : -1);
+            size_t luma = static_cast<size_t>(width) * height;
+            std::vector<uint8_t, NodeAllocator<uint8_t>> source(luma * 3 / 2, 0, allocator);
+            std::vector<uint8_t, NodeAllocator<uint8_t>> dest(luma * 4, 0, allocator);
+            for (size_t i = 0; i < luma; ++i) source[i] = static_cast<uint8_t>(i * 7);
+            for (size_t i = luma; i < source.size(); ++i) source[i] = static_cast<uint8_t>(128 + (i & 15));
+
+            SwsContext* context = sws_getContext(width, height, AV_PIX_FMT_YUV420P, width, height, AV_PIX_FMT_RGBA,
+                                                 SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+            uint8_t* src_data[4] = { source.data(), source.data() + luma, source.data() + luma + luma / 4, nullptr };
+            int src_linesize[4] = { width, width / 2, width / 2, 0 };
+            uint8_t* dest_data[4] = { dest.data(), nullptr, nullptr, nullptr };
+            int dest_linesize[4] = { width * 4, 0, 0, 0 };
+
+            ready++;
+            while (!go) std::this_thread::yield();
+            int64_t converted = 0;
+            while (go && context) {
+                sws_scale(context, src_data, src_linesize, 0, height, dest_data, dest_linesize);
+                converted++;
+            }
+            frames += converted;
+
+            if (context) sws_freeContext(context);
+            if (is_pinned) SetThreadGroupAffinity(GetCurrentThread(), &previous, nullptr);
+            topology.Release(placement);
+        });
+    }
+
+    while (ready < threads) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    while ((!cancel || !*cancel) && std::chrono::steady_clock::now() - start < duration) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    go = false;
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (auto& worker : workers) worker.join();
+    return elapsed > 0 ? static_cast<double>(frames.load()) / elapsed : 0;
+}
@@ -0,0 +1,27 @@
+#ifndef PLACEMENT_BENCHMARK_H_
+#define PLACEMENT_BENCHMARK_H_
+
+#include <atomic>
+#include <chrono>
+
+// Compares conversion throughput (the YUV to RGBA step every session runs
+// per frame) of threads pinned and fed from node-local buffers, as sessions
+// are with CPU pinning on, against free-running threads using the default
+// heap. Blocks for twice the duration, or until cancel is set.
+class PlacementBenchmark {
+ public:
+  struct Result {
+      int threads = 0;
+      double unpinned_fps = 0; // Frames per second, all threads together
+      double pinned_fps = 0;
+  };
+
+  static Result Run(int threads, int width, int height, std::chrono::milliseconds duration,
+                    const std::atomic<bool>* cancel = nullptr);
+
+ private:
+  static double Measure(bool pinned, int threads, int width, int height, std::chrono::milliseconds duration,
+                        const std::atomic<bool>* cancel);
+};
+
+#endif  // PLACEMENT_BENCHMARK_H_
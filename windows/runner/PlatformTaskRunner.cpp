@@ -0,0 +1,53 @@
+#include "PlatformTaskRunner.h"
+
+PlatformTaskRunner::PlatformTaskRunner(flutter::PluginRegistrarWindows* registrar) : registrar_(registrar) {
+    if (registrar_->GetView()) {
+        window_ = GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
+    }
+    window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+        [this](HWND, UINT message, WPARAM, LPARAM) -> std::optional<LRESULT> {
+            if (message != kRunTasksMessage) return std::nullopt;
+            RunPendingTasks();
+            return 0;
+        });
+}
+
+PlatformTaskRunner::~PlatformTaskRunner() {
+    Shutdown();
+}
+
+void PlatformTaskRunner::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_) return;
+        active_ = false;
+        std::queue<std::function<void()>>().swap(tasks_);
+    }
+    if (window_proc_id_ != -1) {
+        registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+        window_proc_id_ = -1;
+    }
+}
+
+void PlatformTaskRunner::Post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_ || !window_) return;
+        tasks_.push(std::move(task));
+        // One wake-up covers every task queued before it is handled
+        if (tasks_.size() > 1) return;
+    }
+    PostMessage(window_, kRunTasksMessage, 0, 0);
+}
+
+void PlatformTaskRunner::RunPendingTasks() {
+    std::queue<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks.swap(tasks_);
+    }
+    while (!tasks.empty()) {
+        tasks.front()();
+        tasks.pop();
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef PLATFORM_TASK_RUNNER_H_
+#define PLATFORM_TASK_RUNNER_H_
+
+#include <windows.h>
+
+#include <flutter/plugin_registrar_windows.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+// Runs tasks on the platform thread. Method channel results and other engine
+// calls from background work must go through here.
+//
+// Worker threads keep a shared_ptr; after Shutdown() posted tasks are
+// silently dropped.
+class PlatformTaskRunner {
+ public:
+  explicit PlatformTaskRunner(flutter::PluginRegistrarWindows* registrar);
+  ~PlatformTaskRunner();
+
+  PlatformTaskRunner(const PlatformTaskRunner&) = delete;
+  PlatformTaskRunner& operator=(const PlatformTaskRunner&) = delete;
+
+  void Post(std::function<void()> task);
+
+  // Must be called on the platform thread before the registrar goes away.
+  void Shutdown();
+
+ private:
+  void RunPendingTasks();
+
+  static const UINT kRunTasksMessage = WM_APP + 0x51;
+
+  flutter::PluginRegistrarWindows* registrar_;
+  HWND window_ = nullptr;
+  int window_proc_id_ = -1;
+
+  std::mutex mutex_;
+  std::queue<std::function<void()>> tasks_;
+  bool active_ = true;
+};
+
+#endif  // PLATFORM_TASK_RUNNER_H_
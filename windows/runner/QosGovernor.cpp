@@ -0,0 +1,127 @@
+#include "QosGovernor.h"
+
+#include "TimerQueue.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <thread>
+
+static const auto kSampleInterval = std::chrono::milliseconds(500);
+// Restore one step only after this many samples comfortably under budget
+static const int kCalmSamplesToRestore = 4;
+static const double kRestoreThreshold = 0.8;
+
+static uint64_t FileTimeToUInt64(const FILETIME& time) {
+    return ((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime;
+}
+
+QosGovernor& QosGovernor::GetInstance() {
+    // Never destroyed: the sampling task on the TimerQueue may still fire
+    // during static destruction.
+    static QosGovernor* instance = new QosGovernor();
+    return *instance;
+}
+
+QosGovernor::QosGovernor() {
+    processor_count_ = std::max(1u, std::thread::hardware_concurrency());
+    for (auto& level : levels_) level = kFull;
+    ScheduleSample();
+}
+
+bool QosGovernor::ParsePriority(const std::string& name, Priority* priority) {
+    for (int i = 0; i < kPriorityCount; ++i) {
+        if (name == PriorityName(i)) {
+            *priority = (Priority)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* QosGovernor::PriorityName(int priority) {
+    switch (priority) {
+        case kInteractive: return "interactive";
+        case kBackground: return "background";
+        default: return "visible";
+    }
+}
+
+int QosGovernor::ThreadPriorityFor(int priority) {
+    switch (priority) {
+        case kInteractive: return THREAD_PRIORITY_ABOVE_NORMAL;
+        case kBackground: return THREAD_PRIORITY_BELOW_NORMAL;
+        default: return THREAD_PRIORITY_NORMAL;
+    }
+}
+
+void QosGovernor::SetBudget(int percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_percent_ = std::clamp(percent, 0, 100);
+    if (budget_percent_ == 0) {
+        for (auto& level : levels_) level = kFull;
+    }
+}
+
+int QosGovernor::LevelFor(int priority) const {
+    if (priority < 0 || priority >= kPriorityCount) return kFull;
+    return levels_[priority];
+}
+
+QosGovernor::Stats QosGovernor::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.budget_percent = budget_percent_;
+    stats.cpu_percent = cpu_percent_;
+    for (int i = 0; i < kPriorityCount; ++i) stats.levels[i] = levels_[i];
+    stats.adjustments = adjustments_;
+    return stats;
+}
+
+void QosGovernor::ScheduleSample() {
+    TimerQueue::GetInstance().Schedule(TimerQueue::Clock::now() + kSampleInterval, [this]() {
+        Sample();
+        ScheduleSample();
+    });
+}
+
+void QosGovernor::Sample() {
+    FILETIME creation, exit, kernel, user, now;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return;
+    GetSystemTimeAsFileTime(&now);
+    uint64_t cpu_time = FileTimeToUInt64(kernel) + FileTimeToUInt64(user);
+    uint64_t wall_time = FileTimeToUInt64(now);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t cpu_delta = cpu_time - last_cpu_time_;
+    uint64_t wall_delta = wall_time - last_wall_time_;
+    bool first = last_wall_time_ == 0;
+    last_cpu_time_ = cpu_time;
+    last_wall_time_ = wall_time;
+    if (first || wall_delta == 0) return;
+
+    cpu_percent_ = 100.0 * cpu_delta / ((double)wall_delta * processor_count_);
+    if (budget_percent_ == 0) return;
+
+    if (cpu_percent_ > budget_percent_) {
+        // Degrade the lowest class that still has room, one step per sample
+        calm_samples_ = 0;
+        for (int p = kPriorityCount - 1; p >= 0; --p) {
+            if (levels_[p] < kMaxLevel[p]) {
+                levels_[p]++;
+                adjustments_++;
+                break;
+            }
+        }
+    } else if (cpu_percent_ < budget_percent_ * kRestoreThreshold && ++calm_samples_ >= kCalmSamplesToRestore) {
+        // Restore the highest class first
+        calm_samples_ = 0;
+        for (int p = 0; p < kPriorityCount; ++p) {
+            if (levels_[p] > kFull) {
+                levels_[p]--;
+                adjustments_++;
+                break;
+            }
+        }
+    }
+}
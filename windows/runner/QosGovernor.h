@@ -0,0 +1,67 @@
+#ifndef QOS_GOVERNOR_H_
+#define QOS_GOVERNOR_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Keeps the process within a global CPU budget by degrading sessions of the
+// lowest priority class first. Process CPU time is sampled periodically on
+// the shared TimerQueue; sessions read their class's level per frame.
+class QosGovernor {
+ public:
+  enum Priority { kInteractive = 0, kVisible = 1, kBackground = 2, kPriorityCount = 3 };
+
+  // Degradations are cumulative
+  enum Level {
+    kFull = 0,
+    kReducedFps = 1,    // Convert and present at most kReducedFps fps
+    kReducedSize = 2,   // ...and convert at half resolution
+    kKeyframesOnly = 3, // ...and decode keyframes only
+  };
+
+  static constexpr int kReducedFpsValue = 15;
+
+  struct Stats {
+      int budget_percent = 0;
+      double cpu_percent = 0;
+      std::array<int, kPriorityCount> levels{};
+      int64_t adjustments = 0;
+  };
+
+  static QosGovernor& GetInstance();
+
+  static bool ParsePriority(const std::string& name, Priority* priority);
+  static const char* PriorityName(int priority);
+  static int ThreadPriorityFor(int priority);
+
+  // Share of all cores the process may use, 0 disables the governor.
+  void SetBudget(int percent);
+
+  int LevelFor(int priority) const;
+
+  Stats GetStats() const;
+
+ private:
+  QosGovernor();
+
+  void ScheduleSample();
+  void Sample();
+
+  static constexpr int kMaxLevel[kPriorityCount] = { kFull, kReducedSize, kKeyframesOnly };
+
+  mutable std::mutex mutex_;
+  int budget_percent_ = 85;
+  double cpu_percent_ = 0;
+  std::array<std::atomic<int>, kPriorityCount> levels_{};
+  int64_t adjustments_ = 0;
+  int calm_samples_ = 0;
+
+  uint64_t last_cpu_time_ = 0;  // 100ns units
+  uint64_t last_wall_time_ = 0; // 100ns units
+  int processor_count_ = 1;
+};
+
+#endif  // QOS_GOVERNOR_H_
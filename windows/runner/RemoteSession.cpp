@@ -0,0 +1,216 @@
+#include "RemoteSession.h"
+
+#include "FrameNotifier.h"
+#include "VideoDecoderPlugin.h"
+#include "frame_reader/scraki_frames.h"
+
+#include <cstring>
+
+static const int kPinAttempts = 4;
+
+static int64_t LoadShared(const int64_t* value) {
+    return InterlockedCompareExchange64(reinterpret_cast<volatile LONG64*>(const_cast<int64_t*>(value)), 0, 0);
+}
+
+void RemoteSession::Ring::Close() {
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle(mapping);
+    base = nullptr;
+    mapping = nullptr;
+}
+
+std::shared_ptr<RemoteSession> RemoteSession::Create(flutter::TextureRegistrar* registrar, DecoderHost* host,
+                                                     const std::string& address, EventSink sink) {
+    std::shared_ptr<RemoteSession> session(new RemoteSession(registrar, host, std::move(sink)));
+    std::weak_ptr<RemoteSession> weak_session = session;
+
+    session->texture_ = std::make_unique<flutter::TextureVariant>(
+        flutter::PixelBufferTexture([weak_session](size_t, size_t) -> const FlutterDesktopPixelBuffer* {
+            auto s = weak_session.lock();
+            if (!s) return nullptr;
+            return s->CopyPixelBuffer();
+        }));
+
+    session->texture_id_ = registrar->RegisterTexture(session->texture_.get());
+    if (session->texture_id_ == -1) {
+        LogTrace("RemoteSession - Error: failed to register texture");
+        return nullptr;
+    }
+    host->Attach(session->texture_id_, address, session);
+    LogTrace("RemoteSession [%lld] - Started in host for %s", session->texture_id_.load(), address.c_str());
+    return session;
+}
+
+RemoteSession::RemoteSession(flutter::TextureRegistrar* registrar, DecoderHost* host, EventSink sink)
+    : texture_registrar_(registrar), host_(host), sink_(std::move(sink)) {
+    memset(&flutter_pixel_buffer_, 0, sizeof(flutter_pixel_buffer_));
+    flutter_pixel_buffer_.release_callback = &RemoteSession::ReleasePixelBuffer;
+    flutter_pixel_buffer_.release_context = this;
+}
+
+RemoteSession::~RemoteSession() {
+    ring_.Close();
+    next_ring_.Close();
+}
+
+void RemoteSession::Stop() {
+    int64_t tid;
+    {
+        // Waits for an upload in progress; no frame is marked afterwards
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        tid = texture_id_.exchange(-1);
+    }
+    if (tid == -1) return;
+    host_->Detach(tid);
+    FrameNotifier::GetInstance().Cancel(tid);
+    texture_registrar_->UnregisterTexture(tid);
+    LogTrace("RemoteSession [%lld] - Stopped", tid);
+}
+
+RemoteSession::Stats RemoteSession::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        stats.width = width_;
+        stats.height = height_;
+        stats.decode_ms = decode_ms_;
+        stats.handoff_ms = handoff_ms_;
+    }
+    stats.frames_presented = frames_presented_;
+    stats.frames_missed = frames_missed_;
+    return stats;
+}
+
+bool RemoteSession::OpenRing(const std::string& name, Ring* ring) {
+    ring->mapping = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name.c_str());
+    if (!ring->mapping) return false;
+    ring->base = static_cast<uint8_t*>(MapViewOfFile(ring->mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0));
+    auto* header = reinterpret_cast<const scraki_ring_header*>(ring->base);
+    if (!header || header->magic != SCRAKI_FRAMES_MAGIC || header->version != SCRAKI_FRAMES_VERSION ||
+        header->slot_count == 0) {
+        ring->Close();
+        return false;
+    }
+    return true;
+}
+
+void RemoteSession::OnFramesMapping(const std::string& name) {
+    Ring ring;
+    if (!OpenRing(name, &ring)) {
+        LogTrace("RemoteSession [%lld] - Error: cannot open frame ring %s", texture_id_.load(), name.c_str());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pixels_mutex_);
+    next_ring_.Close();
+    next_ring_ = ring;
+}
+
+bool RemoteSession::PinLatest(const Ring& ring) {
+    auto* header = reinterpret_cast<scraki_ring_header*>(ring.base);
+    for (int attempt = 0; attempt < kPinAttempts; ++attempt) {
+        int64_t seq = LoadShared(&header->latest_seq);
+        if (seq <= 0) return false;
+        // Pin first, then check the slot still holds the frame: the host
+        // checks the pin after marking a slot busy, so one of us backs off
+        InterlockedExchange64(reinterpret_cast<volatile LONG64*>(&header->pinned_seq), seq);
+        uint32_t index = static_cast<uint32_t>((seq - 1) % header->slot_count);
+        auto* slot = reinterpret_cast<scraki_slot_header*>(ring.base + header->header_size +
+                                                          static_cast<size_t>(index) * header->slot_size);
+        if ((LoadShared(&slot->lock) & 1) == 0 && slot->seq == seq) {
+            flutter_pixel_buffer_.buffer = reinterpret_cast<const uint8_t*>(slot + 1);
+            flutter_pixel_buffer_.width = slot->width;
+            flutter_pixel_buffer_.height = slot->height;
+            width_ = static_cast<int>(slot->width);
+            height_ = static_cast<int>(slot->height);
+            return true;
+        }
+    }
+    InterlockedExchange64(reinterpret_cast<volatile LONG64*>(&header->pinned_seq), 0);
+    return false;
+}
+
+void RemoteSession::OnFrame(int64_t, int64_t sent_us, int64_t received_us) {
+    {
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        int64_t tid = texture_id_.load();
+        if (tid == -1) return;
+        if (next_ring_.base) {
+            // First frame of a new ring (new size or new host); the old one
+            // is only dropped once the new one has something to show
+            if (!PinLatest(next_ring_)) {
+                frames_missed_++;
+                return;
+            }
+            ring_.Close();
+            ring_ = next_ring_;
+            next_ring_ = Ring();
+        } else if (!ring_.base || !PinLatest(ring_)) {
+            // The previous frame is no longer pinned either
+            has_frame_ = false;
+            frames_missed_++;
+            return;
+        }
+        has_frame_ = true;
+        double handoff_ms = static_cast<double>(HostClockUs() - sent_us) / 1000.0;
+        handoff_ms_ = handoff_ms_ == 0 ? handoff_ms : handoff_ms_ * 0.9 + handoff_ms * 0.1;
+        if (received_us > 0) {
+            // Weighted like StreamHealth's decode_ms of in-process sessions
+            double decode_ms = static_cast<double>(sent_us - received_us) / 1000.0;
+            decode_ms_ = decode_ms_ == 0 ? decode_ms : decode_ms_ + (decode_ms - decode_ms_) / 16.0;
+        }
+        // Requested while holding the lock so Stop() cannot slip in between
+        FrameNotifier::GetInstance().Request(texture_registrar_, tid);
+    }
+    frames_presented_++;
+
+    if (lost_) {
+        lost_ = false;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - lost_at_).count();
+        flutter::EncodableMap event;
+        event[flutter::EncodableValue("type")] = flutter::EncodableValue("reconnected");
+        event[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue(static_cast<int64_t>(elapsed));
+        sink_(texture_id_, std::move(event));
+    }
+}
+
+void RemoteSession::OnConnection(const std::string& type, int64_t elapsed_ms) {
+    int64_t tid = texture_id_;
+    if (tid == -1) return;
+    flutter::EncodableMap event;
+    event[flutter::EncodableValue("type")] = flutter::EncodableValue(type);
+    event[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue(elapsed_ms);
+    sink_(tid, std::move(event));
+}
+
+void RemoteSession::OnHostLost() {
+    int64_t tid = texture_id_;
+    if (tid == -1) return;
+    {
+        // The shown frame stays valid: our handle keeps the mapping alive
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        next_ring_.Close();
+    }
+    if (!lost_) {
+        lost_ = true;
+        lost_at_ = Clock::now();
+    }
+    LogTrace("RemoteSession [%lld] - Host lost, restarting session", tid);
+    flutter::EncodableMap event;
+    event[flutter::EncodableValue("type")] = flutter::EncodableValue("reconnecting");
+    sink_(tid, std::move(event));
+}
+
+const FlutterDesktopPixelBuffer* RemoteSession::CopyPixelBuffer() {
+    if (texture_id_ == -1) return nullptr;
+    pixels_mutex_.lock();
+    if (!has_frame_) {
+        pixels_mutex_.unlock();
+        return nullptr;
+    }
+    return &flutter_pixel_buffer_;
+}
+
+void RemoteSession::ReleasePixelBuffer(void* context) {
+    auto* session = static_cast<RemoteSession*>(context);
+    session->pixels_mutex_.unlock();
+}
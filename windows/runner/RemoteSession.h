@@ -0,0 +1,103 @@
+#ifndef REMOTE_SESSION_H_
+#define REMOTE_SESSION_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/texture_registrar.h>
+
+#include "DecoderHost.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// A session decoded in a DecoderHost process. Frames stay in the host's
+// shared memory ring and the texture points straight at the newest slot.
+// That slot is pinned (the ring's pinned_seq) so the host never writes over
+// pixels the engine may be copying; the pin only moves under pixels_mutex_,
+// which the engine holds from the copy callback until it releases the buffer.
+class RemoteSession : public DecoderHostClient {
+ public:
+  using EventSink = std::function<void(int64_t texture_id, flutter::EncodableMap event)>;
+
+  struct Stats {
+      int width = 0;
+      int height = 0;
+      int64_t frames_presented = 0;
+      int64_t frames_missed = 0;  // Announced but already overwritten
+      double decode_ms = 0;       // Packet received to frame in the ring, in the host (EWMA)
+      double handoff_ms = 0;      // Host decode done to texture marked (EWMA)
+  };
+
+  // Registers the texture and starts the session on host.
+  static std::shared_ptr<RemoteSession> Create(flutter::TextureRegistrar* registrar, DecoderHost* host,
+                                               const std::string& address, EventSink sink);
+  ~RemoteSession() override;
+
+  RemoteSession(const RemoteSession&) = delete;
+  RemoteSession& operator=(const RemoteSession&) = delete;
+
+  int64_t texture_id() const { return texture_id_; }
+  DecoderHost* host() const { return host_; }
+
+  Stats GetStats() const;
+
+  // Stops the session in the host and unregisters the texture. Must be
+  // called on the platform thread.
+  void Stop();
+
+  // DecoderHostClient, on the host's supervisor thread
+  void OnFramesMapping(const std::string& name) override;
+  void OnFrame(int64_t seq, int64_t sent_us, int64_t received_us) override;
+  void OnConnection(const std::string& type, int64_t elapsed_ms) override;
+  void OnHostLost() override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Ring {
+      HANDLE mapping = nullptr;
+      uint8_t* base = nullptr;
+
+      void Close();
+  };
+
+  RemoteSession(flutter::TextureRegistrar* registrar, DecoderHost* host, EventSink sink);
+
+  static bool OpenRing(const std::string& name, Ring* ring);
+  // Pins the ring's newest frame and points the pixel buffer at it.
+  // pixels_mutex_ held.
+  bool PinLatest(const Ring& ring);
+
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer();
+  static void ReleasePixelBuffer(void* context);
+
+  flutter::TextureRegistrar* texture_registrar_;
+  std::unique_ptr<flutter::TextureVariant> texture_;
+  std::atomic<int64_t> texture_id_{-1};
+  DecoderHost* host_;
+  const EventSink sink_;
+
+  // Supervisor thread only
+  Clock::time_point lost_at_;
+  bool lost_ = false;
+
+  // Held from the copy callback until the engine releases the buffer
+  mutable std::mutex pixels_mutex_;
+  Ring ring_;
+  Ring next_ring_;  // Announced, shown from its first frame on
+  bool has_frame_ = false;
+  int width_ = 0;
+  int height_ = 0;
+  double decode_ms_ = 0;
+  double handoff_ms_ = 0;
+  FlutterDesktopPixelBuffer flutter_pixel_buffer_;
+
+  std::atomic<int64_t> frames_presented_{0};
+  std::atomic<int64_t> frames_missed_{0};
+};
+
+#endif  // REMOTE_SESSION_H_
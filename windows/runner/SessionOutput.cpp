@@ -0,0 +1,179 @@
+#include "SessionOutput.h"
+
+#include "FrameNotifier.h"
+#include "VideoDecoderPlugin.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+bool SessionOutput::ParseFormat(const std::string& name, Format* format) {
+    if (name == "rgba") {
+        *format = Format::kRgba;
+        return true;
+    }
+    if (name == "gray") {
+        *format = Format::kGray;
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<SessionOutput> SessionOutput::Create(flutter::TextureRegistrar* registrar, const Config& config) {
+    std::shared_ptr<SessionOutput> output(new SessionOutput(registrar, config));
+    std::weak_ptr<SessionOutput> weak_output = output;
+
+    output->texture_ = std::make_unique<flutter::TextureVariant>(
+        flutter::PixelBufferTexture([weak_output](size_t, size_t) -> const FlutterDesktopPixelBuffer* {
+            auto o = weak_output.lock();
+            if (!o) return nullptr;
+            return o->CopyPixelBuffer();
+        }));
+
+    output->texture_id_ = registrar->RegisterTexture(output->texture_.get());
+    if (output->texture_id_ == -1) {
+        LogTrace("SessionOutput - Error: failed to register texture");
+        return nullptr;
+    }
+    return output;
+}
+
+SessionOutput::SessionOutput(flutter::TextureRegistrar* registrar, const Config& config)
+    : texture_registrar_(registrar), config_(config) {
+    memset(&flutter_pixel_buffer_, 0, sizeof(flutter_pixel_buffer_));
+    flutter_pixel_buffer_.release_callback = &SessionOutput::ReleasePixelBuffer;
+    flutter_pixel_buffer_.release_context = this;
+}
+
+SessionOutput::~SessionOutput() {
+    if (sws_context_) sws_freeContext(sws_context_);
+    g_total_pixels_allocated -= static_cast<int64_t>(width_) * height_ +
+                                static_cast<int64_t>(back_width_) * back_height_;
+}
+
+void SessionOutput::Unregister() {
+    int64_t tid;
+    {
+        // Waits for an upload in progress; no frame is marked afterwards
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        tid = texture_id_.exchange(-1);
+    }
+    if (tid != -1) {
+        FrameNotifier::GetInstance().Cancel(tid);
+        texture_registrar_->UnregisterTexture(tid);
+        LogTrace("SessionOutput [%lld] - Unregistered", tid);
+    }
+}
+
+void SessionOutput::Submit(const AVFrame* frame, Clock::time_point now) {
+    if (texture_id_ == -1) return;
+    if (config_.max_fps > 0 && now - last_submit_ < std::chrono::microseconds(1000000 / config_.max_fps)) {
+        frames_skipped_++;
+        return;
+    }
+    if (converting_.exchange(true)) {
+        frames_skipped_++;
+        return;
+    }
+
+    // A new reference keeps the decoder from reusing the buffers meanwhile
+    AVFrame* ref = av_frame_clone(frame);
+    if (!ref) {
+        converting_ = false;
+        return;
+    }
+    last_submit_ = now;
+
+    auto self = shared_from_this();
+    WorkerPool::GetInstance().Post([self, ref]() {
+        AVFrame* owned = ref;
+        self->Convert(owned);
+        av_frame_free(&owned);
+        self->converting_ = false;
+    });
+}
+
+void SessionOutput::Convert(AVFrame* frame) {
+    if (texture_id_ == -1 || !frame->data[0] || frame->width <= 0 || frame->height <= 0) return;
+
+    double scale = 1.0;
+    if (config_.max_width > 0) scale = std::min(scale, (double)config_.max_width / frame->width);
+    if (config_.max_height > 0) scale = std::min(scale, (double)config_.max_height / frame->height);
+    int width = std::max(2, (int)(frame->width * scale) & ~1);
+    int height = std::max(2, (int)(frame->height * scale) & ~1);
+
+    // Gray reads plane 0 as GRAY8, so only where that plane is 8-bit luma
+    // alone (not packed YUV or high bit depth); others convert in full
+    AVPixelFormat src_format = (AVPixelFormat)frame->format;
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(src_format);
+    if (config_.format == Format::kGray && desc && !(desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL)) &&
+        desc->nb_components > 0 && desc->comp[0].depth == 8 && desc->comp[0].plane == 0 &&
+        desc->comp[0].step == 1) {
+        src_format = AV_PIX_FMT_GRAY8;
+    }
+
+    {
+        std::lock_guard<std::mutex> ffmpeg_lock(g_ffmpeg_init_mutex);
+        sws_context_ = sws_getCachedContext(sws_context_, frame->width, frame->height, src_format, width, height,
+                                            AV_PIX_FMT_RGBA, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+    }
+    if (!sws_context_) return;
+
+    if (back_width_ != width || back_height_ != height) {
+        g_total_pixels_allocated += static_cast<int64_t>(width) * height -
+                                    static_cast<int64_t>(back_width_) * back_height_;
+        back_.assign(static_cast<size_t>(width) * height * 4, 0);
+        back_width_ = width;
+        back_height_ = height;
+    }
+
+    uint8_t* dest[4] = { back_.data(), NULL, NULL, NULL };
+    int dest_linesize[4] = { width * 4, 0, 0, 0 };
+    if (sws_scale(sws_context_, frame->data, frame->linesize, 0, frame->height, dest, dest_linesize) <= 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        int64_t tid = texture_id_.load();
+        if (tid == -1) return;
+        front_.swap(back_);
+        std::swap(width_, back_width_);
+        std::swap(height_, back_height_);
+        flutter_pixel_buffer_.buffer = front_.data();
+        flutter_pixel_buffer_.width = width_;
+        flutter_pixel_buffer_.height = height_;
+        // Requested while holding the lock so Unregister() cannot slip in between
+        FrameNotifier::GetInstance().Request(texture_registrar_, tid);
+    }
+    frames_presented_++;
+}
+
+SessionOutput::Stats SessionOutput::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        stats.width = width_;
+        stats.height = height_;
+    }
+    stats.frames_presented = frames_presented_;
+    stats.frames_skipped = frames_skipped_;
+    return stats;
+}
+
+const FlutterDesktopPixelBuffer* SessionOutput::CopyPixelBuffer() {
+    if (texture_id_ == -1) return nullptr;
+    pixels_mutex_.lock();
+    if (front_.empty()) {
+        pixels_mutex_.unlock();
+        return nullptr;
+    }
+    return &flutter_pixel_buffer_;
+}
+
+void SessionOutput::ReleasePixelBuffer(void* context) {
+    auto* output = static_cast<SessionOutput*>(context);
+    output->pixels_mutex_.unlock();
+}
@@ -0,0 +1,103 @@
+#ifndef SESSION_OUTPUT_H_
+#define SESSION_OUTPUT_H_
+
+#include <flutter/texture_registrar.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+// An extra texture fed from a session's decoded frames at its own size and
+// frame rate, so several views of one device share a single stream and a
+// single decode. Conversion runs on the worker pool; an output still busy
+// with the previous frame skips the next one instead of queueing it.
+// Frames are shown as soon as they are converted (no pacing).
+class SessionOutput : public std::enable_shared_from_this<SessionOutput> {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Format {
+      kRgba,
+      kGray, // Luma only, skips chroma upsampling; for previews
+  };
+
+  struct Config {
+      int max_width = 0;  // 0 = no limit; the aspect ratio is kept
+      int max_height = 0;
+      Format format = Format::kRgba;
+      int max_fps = 0;    // 0 = every decoded frame
+  };
+
+  struct Stats {
+      int width = 0;
+      int height = 0;
+      int64_t frames_presented = 0;
+      int64_t frames_skipped = 0; // Rate cap or still converting
+  };
+
+  static bool ParseFormat(const std::string& name, Format* format);
+
+  static std::shared_ptr<SessionOutput> Create(flutter::TextureRegistrar* registrar, const Config& config);
+  ~SessionOutput();
+
+  SessionOutput(const SessionOutput&) = delete;
+  SessionOutput& operator=(const SessionOutput&) = delete;
+
+  int64_t texture_id() const { return texture_id_; }
+  const Config& config() const { return config_; }
+
+  // Decoder thread. Hands a reference of the frame to the worker pool unless
+  // the rate cap or a conversion in flight skips it.
+  void Submit(const AVFrame* frame, Clock::time_point now);
+
+  Stats GetStats() const;
+
+  // Unregisters the texture; pending conversions are discarded. Must be
+  // called on the platform thread.
+  void Unregister();
+
+ private:
+  SessionOutput(flutter::TextureRegistrar* registrar, const Config& config);
+
+  // Worker pool
+  void Convert(AVFrame* frame);
+
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer();
+  static void ReleasePixelBuffer(void* context);
+
+  flutter::TextureRegistrar* texture_registrar_;
+  std::unique_ptr<flutter::TextureVariant> texture_;
+  std::atomic<int64_t> texture_id_{-1};
+  const Config config_;
+
+  // Decoder thread only
+  Clock::time_point last_submit_;
+
+  // Worker only (one conversion in flight)
+  std::atomic<bool> converting_{false};
+  SwsContext* sws_context_ = nullptr;
+  std::vector<uint8_t> back_;
+  int back_width_ = 0;
+  int back_height_ = 0;
+
+  // Held from the copy callback until the engine releases the buffer
+  mutable std::mutex pixels_mutex_;
+  std::vector<uint8_t> front_;
+  int width_ = 0;
+  int height_ = 0;
+  FlutterDesktopPixelBuffer flutter_pixel_buffer_;
+
+  std::atomic<int64_t> frames_presented_{0};
+  std::atomic<int64_t> frames_skipped_{0};
+};
+
+#endif  // SESSION_OUTPUT_H_
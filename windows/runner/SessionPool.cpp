@@ -0,0 +1,199 @@
+#include "SessionPool.h"
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+SessionPool::DecoderSlot::~DecoderSlot() {
+    if (frame) av_frame_free(&frame);
+    if (packet) av_packet_free(&packet);
+    if (codec_context) avcodec_free_context(&codec_context);
+}
+
+SessionPool& SessionPool::GetInstance() {
+    static SessionPool instance;
+    return instance;
+}
+
+SessionPool::~SessionPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+        jobs_.clear();
+    }
+    worker_cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+std::unique_ptr<SessionPool::DecoderSlot> SessionPool::OpenDecoder(AVCodecID codec_id) {
+    auto slot = std::make_unique<DecoderSlot>();
+    slot->codec = avcodec_find_decoder(codec_id);
+    if (!slot->codec) {
+        LogTrace("SessionPool - Error: decoder %d not found", (int)codec_id);
+        return nullptr;
+    }
+
+    slot->codec_context = avcodec_alloc_context3(slot->codec);
+    if (!slot->codec_context) {
+        LogTrace("SessionPool - Error: codec context alloc failed");
+        return nullptr;
+    }
+    slot->codec_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    slot->codec_context->flags2 |= AV_CODEC_FLAG2_FAST;
+    slot->codec_context->thread_count = 1;
+
+    // For mass concurrency, we still need protection for the sensitive avcodec_open2
+    {
+        std::lock_guard<std::mutex> lock(g_ffmpeg_init_mutex);
+        if (avcodec_open2(slot->codec_context, slot->codec, NULL) < 0) {
+            LogTrace("SessionPool - Error: codec open failed");
+            return nullptr;
+        }
+    }
+
+    slot->packet = av_packet_alloc();
+    slot->frame = av_frame_alloc();
+    if (!slot->packet || !slot->frame) {
+        LogTrace("SessionPool - Error: packet/frame alloc failed");
+        return nullptr;
+    }
+    return slot;
+}
+
+void SessionPool::Configure(int decoders, int workers) {
+    int spawn = 0;
+    bool prewarm = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        target_decoders_ = std::max(0, decoders);
+        target_workers_ = std::max(0, workers);
+        while ((int)decoders_.size() > target_decoders_) decoders_.pop_back();
+        spawn = std::max(0, target_workers_ - (int)workers_.size());
+        if (!prewarming_ && (int)decoders_.size() < target_decoders_) {
+            prewarming_ = true;
+            prewarm = true;
+        }
+        for (int i = 0; i < spawn; ++i) {
+            workers_.emplace_back([this]() { WorkerMain(); });
+        }
+    }
+    LogTrace("SessionPool - Configured %d decoders, %d workers", decoders, workers);
+    if (prewarm) {
+        WorkerPool::GetInstance().Post([this]() { Prewarm(); });
+    }
+}
+
+void SessionPool::Prewarm() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!active_ || (int)decoders_.size() >= target_decoders_) {
+                prewarming_ = false;
+                return;
+            }
+        }
+        auto slot = OpenDecoder(AV_CODEC_ID_HEVC);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!slot) {
+            prewarming_ = false;
+            return;
+        }
+        decoders_.push_back(std::move(slot));
+    }
+}
+
+std::unique_ptr<SessionPool::DecoderSlot> SessionPool::AcquireDecoder(AVCodecID codec_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(decoders_.begin(), decoders_.end(),
+                               [codec_id](const auto& slot) { return slot->codec->id == codec_id; });
+        if (it != decoders_.end()) {
+            auto slot = std::move(*it);
+            decoders_.erase(it);
+            hits_++;
+            if (!prewarming_ && (int)decoders_.size() < target_decoders_) {
+                // Top the pool back up off the hot path
+                prewarming_ = true;
+                WorkerPool::GetInstance().Post([this]() { Prewarm(); });
+            }
+            return slot;
+        }
+        misses_++;
+    }
+    return OpenDecoder(codec_id);
+}
+
+void SessionPool::ReleaseDecoder(std::unique_ptr<DecoderSlot> slot) {
+    if (!slot || !slot->codec_context) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_ || (int)decoders_.size() >= target_decoders_) return; // slot freed on return
+    }
+    // Drop references and buffered frames of the previous stream
+    avcodec_flush_buffers(slot->codec_context);
+    av_frame_unref(slot->frame);
+    av_packet_unref(slot->packet);
+    if (slot->buffers.size() > kMaxBuffersPerSlot) slot->buffers.resize(kMaxBuffersPerSlot);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ((int)decoders_.size() < target_decoders_) decoders_.push_back(std::move(slot));
+}
+
+void SessionPool::RunSession(std::function<void()> loop) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(loop));
+        if (idle_workers_ < (int)jobs_.size()) {
+            // Each session holds its thread for its whole lifetime
+            workers_.emplace_back([this]() { WorkerMain(); });
+        }
+    }
+    worker_cv_.notify_one();
+}
+
+void SessionPool::WorkerMain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        idle_workers_++;
+        worker_cv_.wait(lock, [this]() { return !active_ || !jobs_.empty(); });
+        idle_workers_--;
+        if (!active_) return;
+
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+        try {
+            job();
+        } catch (...) {
+        }
+        // Release the session state before relocking; its destructor
+        // returns the decoder through ReleaseDecoder.
+        job = nullptr;
+        lock.lock();
+    }
+}
+
+void SessionPool::RecordTimeToFirstFrame(double ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttff_ms_.push_back(ms);
+    if (ttff_ms_.size() > kTtffWindow) ttff_ms_.pop_front();
+}
+
+SessionPool::Stats SessionPool::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.idle_decoders = (int)decoders_.size();
+    stats.idle_workers = idle_workers_;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.ttff_samples = (int)ttff_ms_.size();
+    if (!ttff_ms_.empty()) {
+        std::vector<double> sorted(ttff_ms_.begin(), ttff_ms_.end());
+        std::sort(sorted.begin(), sorted.end());
+        stats.ttff_p50_ms = sorted[(sorted.size() - 1) * 50 / 100];
+        stats.ttff_p99_ms = sorted[(sorted.size() - 1) * 99 / 100];
+    }
+    return stats;
+}
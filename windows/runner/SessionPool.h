@@ -0,0 +1,90 @@
+#ifndef SESSION_POOL_H_
+#define SESSION_POOL_H_
+
+#include "VideoDecoderPlugin.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pre-opened decoder contexts, recycled RGBA buffers and parked decoder
+// threads, so StartDecoding does not pay for avcodec_open2 (under the global
+// FFmpeg lock), allocations and thread creation before the first frame.
+// Stopped sessions hand their resources back instead of freeing them.
+class SessionPool {
+ public:
+  using RGBAFrame = VideoDecoderPlugin::VideoSessionState::RGBAFrame;
+
+  struct DecoderSlot {
+      AVCodecContext* codec_context = nullptr;
+      const AVCodec* codec = nullptr;
+      AVPacket* packet = nullptr;
+      AVFrame* frame = nullptr;
+      std::vector<std::shared_ptr<RGBAFrame>> buffers; // Reusable when the size matches
+
+      ~DecoderSlot();
+  };
+
+  struct Stats {
+      int idle_decoders = 0;
+      int idle_workers = 0;
+      int64_t hits = 0;
+      int64_t misses = 0;
+      int ttff_samples = 0;
+      double ttff_p50_ms = 0;
+      double ttff_p99_ms = 0;
+  };
+
+  static SessionPool& GetInstance();
+
+  // Target number of idle decoders and parked threads. Missing decoders are
+  // opened in the background.
+  void Configure(int decoders, int workers);
+
+  // Opened decoder for codec_id, from the pool or freshly opened (nullptr on
+  // failure).
+  std::unique_ptr<DecoderSlot> AcquireDecoder(AVCodecID codec_id);
+  void ReleaseDecoder(std::unique_ptr<DecoderSlot> slot);
+
+  // Runs a session's decoding loop on a parked thread, spawning one if none
+  // is free. Threads park again afterwards and live until shutdown.
+  void RunSession(std::function<void()> loop);
+
+  void RecordTimeToFirstFrame(double ms);
+
+  Stats GetStats();
+
+  static std::unique_ptr<DecoderSlot> OpenDecoder(AVCodecID codec_id);
+
+ private:
+  SessionPool() = default;
+  ~SessionPool();
+
+  void Prewarm();
+  void WorkerMain();
+
+  static constexpr size_t kMaxBuffersPerSlot = 3;
+  static constexpr size_t kTtffWindow = 256;
+
+  std::mutex mutex_;
+  int target_decoders_ = 0;
+  int target_workers_ = 0;
+  bool prewarming_ = false;
+  std::deque<std::unique_ptr<DecoderSlot>> decoders_;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  std::deque<double> ttff_ms_;
+
+  // Parked decoder threads
+  std::condition_variable worker_cv_;
+  std::deque<std::function<void()>> jobs_;
+  std::vector<std::thread> workers_;
+  int idle_workers_ = 0;
+  bool active_ = true;
+};
+
+#endif  // SESSION_POOL_H_
@@ -0,0 +1,89 @@
+#include "StreamHealth.h"
+
+#include "QosGovernor.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Overload / headroom thresholds
+static const double kOverloadDecodeShare = 0.6;  // of the frame interval
+static const double kUnderuseDecodeShare = 0.25;
+static const int64_t kOverloadBacklog = 512 * 1024;
+static const int64_t kUnderuseBacklog = 64 * 1024;
+static const double kOverloadDropRate = 0.25;
+static const double kUnderuseDropRate = 0.05;
+
+// Step sizes of the recommendation
+static const double kDownFactor = 0.6;
+static const double kUpFactor = 1.5;
+static const int kMinFps = 5;
+static const int kMinSize = 360;
+static const int64_t kMinBitRate = 250000;
+
+void StreamHealth::OnPacket(size_t bytes, int64_t socket_backlog) {
+    window_packets_++;
+    window_bytes_ += (int64_t)bytes;
+    socket_backlog_ = socket_backlog;
+}
+
+void StreamHealth::OnDecoded(double decode_ms) {
+    decode_ms_ += (decode_ms - decode_ms_) / 16.0;
+}
+
+void StreamHealth::OnFrameReady(double latency_ms) {
+    frame_latency_ms_ += (latency_ms - frame_latency_ms_) / 16.0;
+}
+
+void StreamHealth::MaybeUpdate(Clock::time_point now, int64_t frames_decoded, int64_t frames_lost, int queue_depth,
+                               int width, int height, int qos_level) {
+    if (window_start_ == Clock::time_point()) {
+        window_start_ = now;
+        last_decoded_ = frames_decoded;
+        last_lost_ = frames_lost;
+        return;
+    }
+    double seconds = std::chrono::duration<double>(now - window_start_).count();
+    if (seconds < std::chrono::duration<double>(kWindow).count()) return;
+
+    Snapshot s;
+    s.input_fps = window_packets_ / seconds;
+    s.input_bit_rate = (int64_t)(window_bytes_ * 8 / seconds);
+    s.decode_ms = decode_ms_;
+    s.frame_latency_ms = frame_latency_ms_;
+    int64_t decoded = frames_decoded - last_decoded_;
+    int64_t lost = frames_lost - last_lost_;
+    s.drop_rate = decoded + lost > 0 ? (double)lost / (double)(decoded + lost) : 0;
+    s.queue_depth = queue_depth;
+    s.socket_backlog = socket_backlog_;
+    s.max_dimension = std::max(width, height);
+
+    double interval_ms = 1000.0 / std::max(1.0, s.input_fps);
+    s.overloaded = s.decode_ms > interval_ms * kOverloadDecodeShare || s.socket_backlog > kOverloadBacklog ||
+                   s.drop_rate > kOverloadDropRate || qos_level >= QosGovernor::kReducedSize;
+    s.underused = !s.overloaded && s.decode_ms < interval_ms * kUnderuseDecodeShare &&
+                  s.socket_backlog < kUnderuseBacklog && s.drop_rate < kUnderuseDropRate &&
+                  qos_level == QosGovernor::kFull;
+
+    // Relative to what the device currently sends; the Dart controller clamps
+    // to the profile and applies hysteresis.
+    double factor = s.overloaded ? kDownFactor : s.underused ? kUpFactor : 1.0;
+    s.recommended_max_fps = std::max(kMinFps, (int)std::lround(s.input_fps * factor));
+    s.recommended_max_size = s.max_dimension > 0 ? std::max(kMinSize, (int)(s.max_dimension * factor) & ~7) : 0;
+    s.recommended_bit_rate = std::max(kMinBitRate, (int64_t)(s.input_bit_rate * factor));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot_ = s;
+    }
+
+    window_start_ = now;
+    window_packets_ = 0;
+    window_bytes_ = 0;
+    last_decoded_ = frames_decoded;
+    last_lost_ = frames_lost;
+}
+
+StreamHealth::Snapshot StreamHealth::GetSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_;
+}
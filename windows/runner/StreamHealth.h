@@ -0,0 +1,63 @@
+#ifndef STREAM_HEALTH_H_
+#define STREAM_HEALTH_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Per-session load signal for closed-loop stream adaptation. The decoder
+// thread feeds it per packet and folds a one-second window into a snapshot
+// with a recommended max_fps / max_size / bit rate for the device encoder.
+class StreamHealth {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Snapshot {
+      double input_fps = 0;
+      int64_t input_bit_rate = 0;
+      double decode_ms = 0;   // Decode + convert time per packet (EWMA)
+      double frame_latency_ms = 0; // Packet received to frame ready for the texture (EWMA)
+      double drop_rate = 0;   // Share of decoded frames never shown
+      int queue_depth = 0;    // Frames waiting for presentation
+      int64_t socket_backlog = 0; // Bytes received by the OS but not read
+      int max_dimension = 0;
+      bool overloaded = false;
+      bool underused = false;
+      int recommended_max_fps = 0;
+      int recommended_max_size = 0;
+      int64_t recommended_bit_rate = 0;
+  };
+
+  // Decoder thread, once per frame packet (decoded or not).
+  void OnPacket(size_t bytes, int64_t socket_backlog);
+  // Decoder thread, after a packet was decoded and its frame converted.
+  void OnDecoded(double decode_ms);
+  // Decoder thread, when a converted frame goes to the texture or its pacing
+  // hold; measured from the latest packet received, as decoder hosts do.
+  void OnFrameReady(double latency_ms);
+
+  // Decoder thread; closes the window when a second has passed. Counters are
+  // session totals.
+  void MaybeUpdate(Clock::time_point now, int64_t frames_decoded, int64_t frames_lost, int queue_depth,
+                   int width, int height, int qos_level);
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  static constexpr auto kWindow = std::chrono::seconds(1);
+
+  // Decoder thread only
+  Clock::time_point window_start_;
+  int64_t window_packets_ = 0;
+  int64_t window_bytes_ = 0;
+  int64_t last_decoded_ = 0;
+  int64_t last_lost_ = 0;
+  double decode_ms_ = 0;
+  double frame_latency_ms_ = 0;
+  int64_t socket_backlog_ = 0;
+
+  mutable std::mutex mutex_;
+  Snapshot snapshot_;
+};
+
+#endif  // STREAM_HEALTH_H_
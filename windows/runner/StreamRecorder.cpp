@@ -0,0 +1,282 @@
+#include "StreamRecorder.h"
+
+#include "VideoDecoderPlugin.h"
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+// scrcpy timestamps are in microseconds
+static const AVRational kMicrosecondTimeBase = {1, 1000000};
+
+StreamRecorder::StreamRecorder(const std::string& path, AVCodecID codec_id)
+    : path_(path), codec_id_(codec_id) {}
+
+StreamRecorder::~StreamRecorder() {
+    Stop();
+}
+
+bool StreamRecorder::Open(std::string* error) {
+    // Container is picked from the extension (.mp4, .mkv, ...)
+    if (avformat_alloc_output_context2(&format_context_, nullptr, nullptr, path_.c_str()) < 0 ||
+        !format_context_) {
+        if (error) *error = "Unsupported container for " + path_;
+        return false;
+    }
+
+    stream_ = avformat_new_stream(format_context_, nullptr);
+    packet_ = av_packet_alloc();
+    if (!stream_ || !packet_) {
+        if (error) *error = "Failed to allocate output stream";
+        return false;
+    }
+
+    if (!(format_context_->oformat->flags & AVFMT_NOFILE)) {
+        if (avio_open(&format_context_->pb, path_.c_str(), AVIO_FLAG_WRITE) < 0) {
+            if (error) *error = "Failed to open " + path_ + " for writing";
+            return false;
+        }
+    }
+
+    writer_thread_ = std::thread([this]() { WriterLoop(); });
+    LogTrace("StreamRecorder [%s] - Opened", path_.c_str());
+    return true;
+}
+
+void StreamRecorder::SetConfig(const std::vector<uint8_t>& config) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (config == config_) return;
+    config_ = config;
+    // Before the file starts the config becomes extradata, afterwards it is
+    // sent in-band in front of the next packet (same as the decoder path).
+    config_changed_ = started_;
+}
+
+void StreamRecorder::PushPacket(const uint8_t* data, size_t size, int64_t pts_us, bool key_frame,
+                                int width, int height) {
+    if (!data || size == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_) return;
+        if (failed_) {
+            packets_dropped_++;
+            return;
+        }
+
+        if (waiting_for_key_frame_) {
+            // A file (or a resumed segment) must start on a decodable frame
+            if (!key_frame || width <= 0 || height <= 0 || (!started_ && config_.empty())) {
+                packets_dropped_++;
+                return;
+            }
+            waiting_for_key_frame_ = false;
+        }
+
+        if (queue_.size() >= kMaxQueuedPackets || queued_bytes_ + size > kMaxQueuedBytes) {
+            // Disk can't keep up: drop the rest of this GOP
+            packets_dropped_++;
+            waiting_for_key_frame_ = true;
+            return;
+        }
+
+        QueuedPacket queued;
+        if (config_changed_) {
+            queued.data.reserve(config_.size() + size);
+            queued.data.insert(queued.data.end(), config_.begin(), config_.end());
+            config_changed_ = false;
+        }
+        queued.data.insert(queued.data.end(), data, data + size);
+        queued.pts_us = pts_us;
+        queued.key_frame = key_frame;
+        queued.width = width;
+        queued.height = height;
+        if (!started_) {
+            queued.extradata = config_;
+            started_ = true;
+        }
+
+        queued_bytes_ += queued.data.size();
+        queue_.push_back(std::move(queued));
+    }
+    queue_cv_.notify_one();
+}
+
+void StreamRecorder::WaitForSpace(size_t size) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    space_cv_.wait(lock, [&] {
+        return stopping_ || queue_.empty() ||
+               (queue_.size() < kMaxQueuedPackets && queued_bytes_ + size <= kMaxQueuedBytes);
+    });
+}
+
+void StreamRecorder::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_one();
+    space_cv_.notify_all();
+
+    if (writer_thread_.joinable()) {
+        // After StopAsync the last reference may go on the writer thread itself
+        if (writer_thread_.get_id() == std::this_thread::get_id()) {
+            writer_thread_.detach();
+        } else {
+            writer_thread_.join();
+        }
+    }
+    // Without a writer thread (never opened) nothing closed the file yet
+    Finalize();
+}
+
+void StreamRecorder::StopAsync(std::shared_ptr<StreamRecorder> recorder,
+                               std::function<void(const Stats& stats)> done) {
+    StreamRecorder* self = recorder.get();
+    if (!self->writer_thread_.joinable()) {
+        // Never opened: there is no file to finish
+        self->Stop();
+        if (done) done(self->GetStats());
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(self->queue_mutex_);
+        self->stopping_ = true;
+        self->stopped_ = [recorder, done]() {
+            if (done) done(recorder->GetStats());
+        };
+    }
+    self->queue_cv_.notify_one();
+    self->space_cv_.notify_all();
+}
+
+void StreamRecorder::Finalize() {
+    if (format_context_) {
+        if (header_written_) {
+            av_write_trailer(format_context_);
+        }
+        if (!(format_context_->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&format_context_->pb);
+        }
+        avformat_free_context(format_context_);
+        format_context_ = nullptr;
+        stream_ = nullptr;
+
+        LogTrace("StreamRecorder [%s] - Closed. Written: %lld, Dropped: %lld, Bytes: %lld", path_.c_str(),
+                 (long long)packets_written_.load(), (long long)packets_dropped_.load(),
+                 (long long)bytes_written_.load());
+    }
+    if (packet_) av_packet_free(&packet_);
+}
+
+StreamRecorder::Stats StreamRecorder::GetStats() const {
+    Stats stats;
+    stats.packets_written = packets_written_.load();
+    stats.packets_dropped = packets_dropped_.load();
+    stats.bytes_written = bytes_written_.load();
+    stats.duration_us = duration_us_.load();
+    stats.failed = failed_.load();
+    return stats;
+}
+
+void StreamRecorder::WriterLoop() {
+    std::function<void()> stopped;
+    while (true) {
+        QueuedPacket queued;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            // Flush whatever is queued before honouring the stop request
+            if (queue_.empty()) {
+                stopped = std::move(stopped_);
+                break;
+            }
+            queued = std::move(queue_.front());
+            queue_.pop_front();
+            queued_bytes_ -= queued.data.size();
+        }
+        space_cv_.notify_all();
+
+        if (!header_written_ && !WriteHeader(queued)) {
+            // The muxer is in an undefined state after a failed header, and
+            // later packets lack the extradata and keyframe to start on
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                failed_ = true;
+                packets_dropped_ += 1 + (int64_t)queue_.size();
+                queue_.clear();
+                queued_bytes_ = 0;
+            }
+            space_cv_.notify_all();
+            continue;
+        }
+        WritePacket(queued);
+    }
+
+    // The trailer is written here, so a stop never waits on the muxer
+    Finalize();
+    // May drop the last reference; nothing of this may be touched after it
+    if (stopped) stopped();
+}
+
+bool StreamRecorder::WriteHeader(const QueuedPacket& first) {
+    AVCodecParameters* par = stream_->codecpar;
+    par->codec_type = AVMEDIA_TYPE_VIDEO;
+    par->codec_id = codec_id_;
+    par->width = first.width;
+    par->height = first.height;
+
+    if (!first.extradata.empty()) {
+        par->extradata = (uint8_t*)av_mallocz(first.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (!par->extradata) return false;
+        memcpy(par->extradata, first.extradata.data(), first.extradata.size());
+        par->extradata_size = (int)first.extradata.size();
+    }
+    stream_->time_base = kMicrosecondTimeBase;
+
+    // Fragmented MP4 keeps the file playable if the app dies mid-recording
+    AVDictionary* options = nullptr;
+    if (strcmp(format_context_->oformat->name, "mp4") == 0 ||
+        strcmp(format_context_->oformat->name, "mov") == 0) {
+        av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+    }
+
+    int ret = avformat_write_header(format_context_, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        LogTrace("StreamRecorder [%s] - Error: write header failed: %d", path_.c_str(), ret);
+        return false;
+    }
+
+    header_written_ = true;
+    first_pts_us_ = first.pts_us;
+    return true;
+}
+
+void StreamRecorder::WritePacket(const QueuedPacket& queued) {
+    // scrcpy encoders emit no B-frames, so DTS == PTS
+    int64_t dts = av_rescale_q(queued.pts_us - first_pts_us_, kMicrosecondTimeBase, stream_->time_base);
+    if (last_dts_ != AV_NOPTS_VALUE && dts <= last_dts_) {
+        dts = last_dts_ + 1;
+    }
+    last_dts_ = dts;
+
+    // Not refcounted: the muxer copies what it needs to keep
+    packet_->data = (uint8_t*)queued.data.data();
+    packet_->size = (int)queued.data.size();
+    packet_->stream_index = stream_->index;
+    packet_->pts = dts;
+    packet_->dts = dts;
+    packet_->flags = queued.key_frame ? AV_PKT_FLAG_KEY : 0;
+
+    int ret = av_write_frame(format_context_, packet_);
+    av_packet_unref(packet_);
+    if (ret < 0) {
+        packets_dropped_++;
+        return;
+    }
+
+    packets_written_++;
+    bytes_written_ += (int64_t)queued.data.size();
+    duration_us_ = queued.pts_us - first_pts_us_;
+}
@@ -0,0 +1,119 @@
+#ifndef STREAM_RECORDER_H_
+#define STREAM_RECORDER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+// Remuxes the compressed packets of one session into an MP4/MKV file.
+// Packets are copied into a bounded queue by the decoder thread and written by
+// a dedicated writer thread, so recording never decodes, re-encodes or blocks
+// the decoding loop.
+class StreamRecorder {
+ public:
+  struct Stats {
+      int64_t packets_written = 0;
+      int64_t packets_dropped = 0;
+      int64_t bytes_written = 0;
+      int64_t duration_us = 0;
+      bool failed = false; // The file could not be started; nothing is written
+  };
+
+  StreamRecorder(const std::string& path, AVCodecID codec_id);
+  ~StreamRecorder();
+
+  StreamRecorder(const StreamRecorder&) = delete;
+  StreamRecorder& operator=(const StreamRecorder&) = delete;
+
+  // Creates the output context and opens the file. Must succeed before any
+  // packet is pushed.
+  bool Open(std::string* error);
+
+  // Codec configuration (VPS/SPS/PPS) used as extradata when the header is
+  // written. A change after the header is written is sent in-band.
+  void SetConfig(const std::vector<uint8_t>& config);
+
+  // Called from the decoder thread. Never blocks on disk I/O: when the queue
+  // is full the packet is dropped and recording resumes on the next key frame.
+  void PushPacket(const uint8_t* data, size_t size, int64_t pts_us, bool key_frame,
+                  int width, int height);
+
+  // Blocks until a packet of size bytes would be queued rather than dropped.
+  // For producers that replay stored packets; the live path never waits.
+  void WaitForSpace(size_t size);
+
+  // Drains the queue, writes the trailer and joins the writer thread.
+  void Stop();
+
+  // Stop() without blocking the caller: the writer thread drains the queue,
+  // writes the trailer and then calls done with the final stats. recorder is
+  // kept alive until then.
+  static void StopAsync(std::shared_ptr<StreamRecorder> recorder,
+                        std::function<void(const Stats& stats)> done = nullptr);
+
+  Stats GetStats() const;
+  const std::string& path() const { return path_; }
+
+ private:
+  struct QueuedPacket {
+      std::vector<uint8_t> data;
+      int64_t pts_us = 0;
+      bool key_frame = false;
+      int width = 0;
+      int height = 0;
+      std::vector<uint8_t> extradata; // Set on the packet that starts the file
+  };
+
+  void WriterLoop();
+  void Finalize();
+  bool WriteHeader(const QueuedPacket& first);
+  void WritePacket(const QueuedPacket& queued);
+
+  static constexpr size_t kMaxQueuedPackets = 512;
+  static constexpr size_t kMaxQueuedBytes = 64 * 1024 * 1024;
+
+  std::string path_;
+  AVCodecID codec_id_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::condition_variable space_cv_;
+  std::deque<QueuedPacket> queue_;
+  size_t queued_bytes_ = 0;
+  bool stopping_ = false;
+  bool waiting_for_key_frame_ = true;
+  bool started_ = false;
+  std::vector<uint8_t> config_;
+  bool config_changed_ = false;
+  std::atomic<bool> failed_{false}; // Header write failed; every packet is dropped
+  std::function<void()> stopped_;   // Run by the writer thread once the file is closed
+
+  // Writer thread only
+  AVFormatContext* format_context_ = nullptr;
+  AVStream* stream_ = nullptr;
+  AVPacket* packet_ = nullptr;
+  bool header_written_ = false;
+  int64_t first_pts_us_ = AV_NOPTS_VALUE;
+  int64_t last_dts_ = AV_NOPTS_VALUE;
+
+  std::atomic<int64_t> packets_written_{0};
+  std::atomic<int64_t> packets_dropped_{0};
+  std::atomic<int64_t> bytes_written_{0};
+  std::atomic<int64_t> duration_us_{0};
+
+  std::thread writer_thread_;
+};
+
+#endif  // STREAM_RECORDER_H_
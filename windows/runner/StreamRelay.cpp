@@ -0,0 +1,249 @@
+#include "StreamRelay.h"
+
+#include "VideoDecoderPlugin.h"
+
+#include <ws2tcpip.h>
+
+#include <algorithm>
+
+// scrcpy packet header flags, above the 62-bit PTS
+static const uint64_t kConfigFlag = 1ULL << 63;
+static const uint64_t kKeyFrameFlag = 1ULL << 62;
+
+std::unique_ptr<StreamRelay> StreamRelay::Start(const std::string& address, int port, std::string* error) {
+    sockaddr_in bind_address = {};
+    bind_address.sin_family = AF_INET;
+    bind_address.sin_port = htons((u_short)port);
+    if (inet_pton(AF_INET, address.c_str(), &bind_address.sin_addr) != 1) {
+        *error = "Invalid relay address: " + address;
+        return nullptr;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        *error = "Socket creation failed: " + std::to_string(WSAGetLastError());
+        return nullptr;
+    }
+    if (bind(sock, (const sockaddr*)&bind_address, sizeof(bind_address)) == SOCKET_ERROR ||
+        listen(sock, SOMAXCONN) == SOCKET_ERROR) {
+        *error = "Cannot listen on " + address + ":" + std::to_string(port) + ": " +
+                 std::to_string(WSAGetLastError());
+        closesocket(sock);
+        return nullptr;
+    }
+
+    sockaddr_in bound = {};
+    int length = sizeof(bound);
+    getsockname(sock, (sockaddr*)&bound, &length);
+    return std::unique_ptr<StreamRelay>(new StreamRelay(sock, ntohs(bound.sin_port)));
+}
+
+StreamRelay::StreamRelay(SOCKET listen_socket, int port) : listen_socket_(listen_socket), port_(port) {
+    accept_thread_ = std::thread([this]() { AcceptLoop(); });
+    LogTrace("StreamRelay [%d] - Listening", port_);
+}
+
+StreamRelay::~StreamRelay() {
+    Stop();
+}
+
+void StreamRelay::Stop() {
+    if (!running_.exchange(false)) return;
+    // Unblocks accept()
+    closesocket(listen_socket_);
+    if (accept_thread_.joinable()) accept_thread_.join();
+
+    std::vector<std::unique_ptr<Viewer>> viewers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        viewers = std::move(viewers_);
+        viewers_.clear();
+    }
+    for (auto& viewer : viewers) {
+        {
+            std::lock_guard<std::mutex> lock(viewer->mutex);
+            viewer->closed = true;
+        }
+        viewer->cv.notify_all();
+        shutdown(viewer->socket, SD_BOTH);
+        if (viewer->thread.joinable()) viewer->thread.join();
+        closesocket(viewer->socket);
+    }
+    LogTrace("StreamRelay [%d] - Stopped", port_);
+}
+
+StreamRelay::Packet StreamRelay::Frame(uint64_t header_pts, const uint8_t* data, size_t size) {
+    auto packet = std::make_shared<std::vector<uint8_t>>(12 + size);
+    uint8_t* header = packet->data();
+    for (int i = 0; i < 8; ++i) header[i] = (uint8_t)(header_pts >> (56 - 8 * i));
+    for (int i = 0; i < 4; ++i) header[8 + i] = (uint8_t)((uint32_t)size >> (24 - 8 * i));
+    std::copy(data, data + size, header + 12);
+    return packet;
+}
+
+void StreamRelay::SetConfig(const std::vector<uint8_t>& config) {
+    if (config.empty()) return;
+    auto packet = Frame(kConfigFlag, config.data(), config.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = packet;
+    // Viewers waiting for a keyframe get the config with it
+    for (auto& viewer : viewers_) {
+        std::lock_guard<std::mutex> viewer_lock(viewer->mutex);
+        if (viewer->closed || viewer->waiting_for_key_frame) continue;
+        viewer->queue.push_back(packet);
+        viewer->queued_bytes += packet->size();
+        viewer->cv.notify_one();
+    }
+}
+
+void StreamRelay::PushPacket(const uint8_t* data, size_t size, int64_t pts_us, bool key_frame) {
+    auto packet = Frame((uint64_t)pts_us | (key_frame ? kKeyFrameFlag : 0), data, size);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (key_frame) {
+            gop_.clear();
+            gop_bytes_ = 0;
+            gop_complete_ = true;
+        }
+        if (gop_complete_) {
+            gop_.push_back(packet);
+            gop_bytes_ += packet->size();
+            if (gop_bytes_ > kMaxGopBytes) {
+                // Late joiners wait for the next keyframe instead
+                gop_.clear();
+                gop_bytes_ = 0;
+                gop_complete_ = false;
+            }
+        }
+        for (auto& viewer : viewers_) Offer(viewer.get(), packet, key_frame);
+    }
+    PruneClosedViewers();
+}
+
+void StreamRelay::Offer(Viewer* viewer, const Packet& packet, bool key_frame) {
+    {
+        std::lock_guard<std::mutex> lock(viewer->mutex);
+        if (viewer->closed) return;
+        if (viewer->queued_bytes + packet->size() > kMaxViewerQueueBytes) {
+            // Too slow: skip to the next GOP rather than lag further behind
+            viewer->queue.clear();
+            viewer->queued_bytes = 0;
+            viewer->waiting_for_key_frame = true;
+            gops_dropped_++;
+        }
+        if (viewer->waiting_for_key_frame) {
+            if (!key_frame) return;
+            viewer->waiting_for_key_frame = false;
+            if (config_) {
+                viewer->queue.push_back(config_);
+                viewer->queued_bytes += config_->size();
+            }
+        }
+        viewer->queue.push_back(packet);
+        viewer->queued_bytes += packet->size();
+    }
+    viewer->cv.notify_one();
+}
+
+void StreamRelay::PruneClosedViewers() {
+    std::vector<std::unique_ptr<Viewer>> closed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = viewers_.begin(); it != viewers_.end();) {
+            bool is_closed;
+            {
+                std::lock_guard<std::mutex> viewer_lock((*it)->mutex);
+                is_closed = (*it)->closed;
+            }
+            if (!is_closed) {
+                ++it;
+                continue;
+            }
+            closed.push_back(std::move(*it));
+            it = viewers_.erase(it);
+        }
+    }
+    // Their threads have returned or are about to
+    for (auto& viewer : closed) {
+        if (viewer->thread.joinable()) viewer->thread.join();
+        closesocket(viewer->socket);
+        LogTrace("StreamRelay [%d] - Viewer left", port_);
+    }
+}
+
+void StreamRelay::AcceptLoop() {
+    while (running_) {
+        SOCKET client = accept(listen_socket_, nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            if (!running_) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        BOOL nodelay = TRUE;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+
+        auto viewer = std::make_unique<Viewer>();
+        viewer->socket = client;
+        Viewer* raw = viewer.get();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Starts decodable: config, then the GOP so far
+            if (config_) {
+                raw->queue.push_back(config_);
+                raw->queued_bytes += config_->size();
+            }
+            if (gop_complete_) {
+                for (const auto& packet : gop_) {
+                    raw->queue.push_back(packet);
+                    raw->queued_bytes += packet->size();
+                }
+            } else {
+                raw->waiting_for_key_frame = true;
+            }
+            raw->thread = std::thread([this, raw]() { SendLoop(raw); });
+            viewers_.push_back(std::move(viewer));
+        }
+        viewers_total_++;
+        LogTrace("StreamRelay [%d] - Viewer joined", port_);
+    }
+}
+
+void StreamRelay::SendLoop(Viewer* viewer) {
+    while (true) {
+        Packet packet;
+        {
+            std::unique_lock<std::mutex> lock(viewer->mutex);
+            viewer->cv.wait(lock, [viewer]() { return viewer->closed || !viewer->queue.empty(); });
+            if (viewer->closed) return;
+            packet = std::move(viewer->queue.front());
+            viewer->queue.pop_front();
+            viewer->queued_bytes -= packet->size();
+        }
+
+        size_t sent = 0;
+        while (sent < packet->size()) {
+            int count = send(viewer->socket, (const char*)packet->data() + sent,
+                             (int)std::min<size_t>(packet->size() - sent, 1 << 20), 0);
+            if (count <= 0) {
+                std::lock_guard<std::mutex> lock(viewer->mutex);
+                viewer->closed = true;
+                return;
+            }
+            sent += (size_t)count;
+        }
+        bytes_sent_ += (int64_t)sent;
+    }
+}
+
+StreamRelay::Stats StreamRelay::GetStats() const {
+    Stats stats;
+    stats.port = port_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.viewers = (int)viewers_.size();
+    }
+    stats.viewers_total = viewers_total_;
+    stats.bytes_sent = bytes_sent_;
+    stats.gops_dropped = gops_dropped_;
+    return stats;
+}
@@ -0,0 +1,100 @@
+#ifndef STREAM_RELAY_H_
+#define STREAM_RELAY_H_
+
+#include <winsock2.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Re-serves the compressed packets of one session on a TCP port, in the
+// framing the session reads (12-byte PTS/flags + size header, then the
+// packet), so other machines can watch a device without another encode on
+// it. Any such client works, including another app opening
+// tcp://<host>:<port> as a session.
+//
+// A viewer gets the cached config packet and the current GOP when it
+// connects, then the live stream. Packets are framed once and shared by
+// every viewer's queue; each viewer has a sender thread, so the decoder
+// thread never blocks. A viewer whose queue outgrows kMaxViewerQueueBytes
+// loses its backlog and resumes at the next keyframe.
+class StreamRelay {
+ public:
+  struct Stats {
+      int port = 0;
+      int viewers = 0;
+      int64_t viewers_total = 0;
+      int64_t bytes_sent = 0;
+      int64_t gops_dropped = 0; // Backlogs dropped for slow viewers
+  };
+
+  // Listens on address:port (port 0 picks a free one). Null with *error set
+  // when the socket cannot be bound.
+  static std::unique_ptr<StreamRelay> Start(const std::string& address, int port, std::string* error);
+
+  ~StreamRelay();
+
+  StreamRelay(const StreamRelay&) = delete;
+  StreamRelay& operator=(const StreamRelay&) = delete;
+
+  // Decoder thread.
+  void SetConfig(const std::vector<uint8_t>& config);
+  void PushPacket(const uint8_t* data, size_t size, int64_t pts_us, bool key_frame);
+
+  // Closes the listening socket and every viewer, joining their threads.
+  void Stop();
+
+  int port() const { return port_; }
+  Stats GetStats() const;
+
+ private:
+  using Packet = std::shared_ptr<const std::vector<uint8_t>>; // Header + payload
+
+  struct Viewer {
+      SOCKET socket = INVALID_SOCKET;
+      std::thread thread;
+      std::mutex mutex;
+      std::condition_variable cv;
+      std::deque<Packet> queue;
+      size_t queued_bytes = 0;
+      bool waiting_for_key_frame = false;
+      bool closed = false;
+  };
+
+  StreamRelay(SOCKET listen_socket, int port);
+
+  static Packet Frame(uint64_t header_pts, const uint8_t* data, size_t size);
+  void AcceptLoop();
+  void SendLoop(Viewer* viewer);
+  // Caller holds mutex_.
+  void Offer(Viewer* viewer, const Packet& packet, bool key_frame);
+  void PruneClosedViewers();
+
+  static constexpr size_t kMaxViewerQueueBytes = 8 * 1024 * 1024;
+  // Below the viewer limit, so a late joiner's initial GOP always fits
+  static constexpr size_t kMaxGopBytes = 4 * 1024 * 1024;
+
+  SOCKET listen_socket_;
+  const int port_;
+  std::atomic<bool> running_{true};
+  std::thread accept_thread_;
+
+  mutable std::mutex mutex_;
+  Packet config_;
+  std::vector<Packet> gop_; // Since the latest keyframe, for late joiners
+  size_t gop_bytes_ = 0;
+  bool gop_complete_ = false;
+  std::vector<std::unique_ptr<Viewer>> viewers_;
+
+  std::atomic<int64_t> viewers_total_{0};
+  std::atomic<int64_t> bytes_sent_{0};
+  std::atomic<int64_t> gops_dropped_{0};
+};
+
+#endif  // STREAM_RELAY_H_
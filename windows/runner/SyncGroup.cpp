@@ -0,0 +1,90 @@
+#include "SyncGroup.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Absorbs timer and vsync granularity on top of the measured latency
+static const double kMarginMs = 4.0;
+// FramePacer holds at most kMaxPresentationHold anyway
+static const double kMaxDelayMs = 400.0;
+
+void SyncGroup::Join(int64_t member) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    members_[member];
+}
+
+void SyncGroup::Leave(int64_t member) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    members_.erase(member);
+    UpdateDelayLocked();
+}
+
+void SyncGroup::OnFrameReady(int64_t member, double latency_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = members_.find(member);
+    if (it == members_.end()) return;
+    Member& m = it->second;
+    if (m.latencies.size() < kLatencyWindow) {
+        m.latencies.push_back(latency_ms);
+    } else {
+        m.latencies[m.next] = latency_ms;
+        m.next = (m.next + 1) % kLatencyWindow;
+    }
+    if (++m.samples_since_update < kUpdateInterval && m.latencies.size() >= kUpdateInterval) return;
+    m.samples_since_update = 0;
+
+    std::vector<double> sorted = m.latencies;
+    size_t rank = sorted.size() * 95 / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    m.p95_ms = sorted[rank];
+    UpdateDelayLocked();
+}
+
+void SyncGroup::OnPresented(int64_t member, double error_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = members_.find(member);
+    if (it == members_.end()) return;
+    Member& m = it->second;
+    m.error_ms = m.has_error ? m.error_ms + (error_ms - m.error_ms) / 16.0 : error_ms;
+    m.has_error = true;
+}
+
+double SyncGroup::delay_ms() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return delay_ms_;
+}
+
+double SyncGroup::MemberErrorMs(int64_t member) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = members_.find(member);
+    return it == members_.end() ? 0 : it->second.error_ms;
+}
+
+SyncGroup::Stats SyncGroup::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.members = (int)members_.size();
+    stats.delay_ms = delay_ms_;
+    double low = 0;
+    double high = 0;
+    bool any = false;
+    for (const auto& entry : members_) {
+        if (!entry.second.has_error) continue;
+        double error = entry.second.error_ms;
+        low = any ? std::min(low, error) : error;
+        high = any ? std::max(high, error) : error;
+        stats.max_error_ms = std::max(stats.max_error_ms, std::fabs(error));
+        any = true;
+    }
+    stats.skew_ms = high - low;
+    return stats;
+}
+
+void SyncGroup::UpdateDelayLocked() {
+    double target = 0;
+    for (const auto& entry : members_) target = std::max(target, entry.second.p95_ms);
+    target = std::min(target + kMarginMs, kMaxDelayMs);
+    // Rise at once so no member falls behind; ease down so every tile does
+    // not jump back at the same time
+    delay_ms_ = target >= delay_ms_ ? target : delay_ms_ + (target - delay_ms_) / 8.0;
+}
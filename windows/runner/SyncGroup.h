@@ -0,0 +1,68 @@
+#ifndef SYNC_GROUP_H_
+#define SYNC_GROUP_H_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Sessions shown side by side on a common clock. Each member's FramePacer
+// maps device PTS to the local capture instant (see FramePacer) and reports
+// how long after it a frame was ready to show; the group delay is the
+// largest member's 95th percentile of that, so every member can hold its
+// frames until capture + delay and all tiles show the same instant.
+//
+// Only variable latency is aligned: the offset estimate folds each device's
+// constant encode and transport latency into its clock offset.
+//
+// Only the members' own textures are synchronized. Atlas tiles and extra
+// outputs are updated as frames are decoded, so atlas-only sessions cannot
+// join a group.
+class SyncGroup {
+ public:
+  struct Stats {
+      int members = 0;
+      double delay_ms = 0;
+      double skew_ms = 0;      // Spread of the members' average display error
+      double max_error_ms = 0; // Largest member average display error
+  };
+
+  explicit SyncGroup(std::string name) : name_(std::move(name)) {}
+
+  const std::string& name() const { return name_; }
+
+  void Join(int64_t member);
+  void Leave(int64_t member);
+
+  // Time from a member frame's capture to it being ready to show.
+  void OnFrameReady(int64_t member, double latency_ms);
+  // Time a member frame was shown after the group's target for it.
+  void OnPresented(int64_t member, double error_ms);
+
+  double delay_ms() const;
+  double MemberErrorMs(int64_t member) const;
+  Stats GetStats() const;
+
+ private:
+  struct Member {
+      std::vector<double> latencies; // Ring of the latest kLatencyWindow
+      size_t next = 0;
+      int samples_since_update = 0;
+      double p95_ms = 0;
+      double error_ms = 0; // Smoothed display error
+      bool has_error = false;
+  };
+
+  void UpdateDelayLocked();
+
+  static constexpr size_t kLatencyWindow = 120;
+  static constexpr int kUpdateInterval = 15; // Samples between percentiles
+
+  const std::string name_;
+  mutable std::mutex mutex_;
+  std::map<int64_t, Member> members_;
+  double delay_ms_ = 0;
+};
+
+#endif  // SYNC_GROUP_H_
@@ -0,0 +1,172 @@
+#include "TextureAtlas.h"
+
+#include "FrameNotifier.h"
+#include "VideoDecoderPlugin.h"
+
+#include <algorithm>
+#include <cstring>
+
+std::shared_ptr<TextureAtlas> TextureAtlas::Create(flutter::TextureRegistrar* registrar, int tile_width,
+                                                   int tile_height, int columns, int rows) {
+    std::shared_ptr<TextureAtlas> atlas(new TextureAtlas(registrar, tile_width, tile_height, columns, rows));
+    std::weak_ptr<TextureAtlas> weak_atlas = atlas;
+
+    atlas->texture_ = std::make_unique<flutter::TextureVariant>(
+        flutter::PixelBufferTexture([weak_atlas](size_t, size_t) -> const FlutterDesktopPixelBuffer* {
+            auto a = weak_atlas.lock();
+            if (!a) return nullptr;
+            return a->CopyPixelBuffer();
+        }));
+
+    atlas->texture_id_ = registrar->RegisterTexture(atlas->texture_.get());
+    if (atlas->texture_id_ == -1) {
+        LogTrace("TextureAtlas - Error: failed to register %dx%d page", atlas->width(), atlas->height());
+        return nullptr;
+    }
+    LogTrace("TextureAtlas [%lld] - Created %dx%d page (%dx%d tiles)", atlas->texture_id_.load(),
+             atlas->width(), atlas->height(), columns, rows);
+    return atlas;
+}
+
+TextureAtlas::TextureAtlas(flutter::TextureRegistrar* registrar, int tile_width, int tile_height, int columns,
+                           int rows)
+    : texture_registrar_(registrar),
+      tile_width_(tile_width),
+      tile_height_(tile_height),
+      columns_(columns),
+      rows_(rows),
+      slot_used_(static_cast<size_t>(columns) * rows, false),
+      slot_generation_(static_cast<size_t>(columns) * rows, 0) {
+    pixels_.assign(static_cast<size_t>(width()) * height() * 4, 0);
+    // Opaque black so empty tiles and letterbox bars render black
+    for (size_t i = 3; i < pixels_.size(); i += 4) pixels_[i] = 0xFF;
+    g_active_buffers++;
+    g_total_pixels_allocated += static_cast<int64_t>(width()) * height();
+
+    memset(&flutter_pixel_buffer_, 0, sizeof(flutter_pixel_buffer_));
+    flutter_pixel_buffer_.buffer = pixels_.data();
+    flutter_pixel_buffer_.width = width();
+    flutter_pixel_buffer_.height = height();
+    flutter_pixel_buffer_.release_callback = &TextureAtlas::ReleasePixelBuffer;
+    flutter_pixel_buffer_.release_context = this;
+}
+
+TextureAtlas::~TextureAtlas() {
+    g_active_buffers--;
+    g_total_pixels_allocated -= static_cast<int64_t>(width()) * height();
+}
+
+void TextureAtlas::Unregister() {
+    int64_t tid;
+    {
+        // No tile update requests a mark afterwards
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        tid = texture_id_.exchange(-1);
+    }
+    if (tid != -1) {
+        FrameNotifier::GetInstance().Cancel(tid);
+        texture_registrar_->UnregisterTexture(tid);
+        LogTrace("TextureAtlas [%lld] - Unregistered", tid);
+    }
+}
+
+int TextureAtlas::AcquireTile(uint64_t* generation) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    for (size_t i = 0; i < slot_used_.size(); ++i) {
+        if (!slot_used_[i]) {
+            slot_used_[i] = true;
+            slot_generation_[i] = ++next_generation_;
+            *generation = slot_generation_[i];
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void TextureAtlas::ReleaseTile(int slot) {
+    {
+        std::lock_guard<std::mutex> lock(slots_mutex_);
+        if (slot < 0 || slot >= (int)slot_used_.size()) return;
+        slot_used_[slot] = false;
+        slot_generation_[slot] = 0;
+    }
+    // Blank the tile so a reused slot never flashes the previous device
+    std::lock_guard<std::mutex> lock(pixels_mutex_);
+    WriteTileLocked(slot, nullptr, 0, 0, 0);
+    MarkDirtyLocked();
+}
+
+bool TextureAtlas::IsEmpty() const {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    return std::none_of(slot_used_.begin(), slot_used_.end(), [](bool used) { return used; });
+}
+
+TextureAtlas::TileRect TextureAtlas::GetTileRect(int slot) const {
+    TileRect rect;
+    rect.x = (slot % columns_) * tile_width_;
+    rect.y = (slot / columns_) * tile_height_;
+    rect.width = tile_width_;
+    rect.height = tile_height_;
+    return rect;
+}
+
+void TextureAtlas::UpdateTile(int slot, uint64_t generation, const uint8_t* rgba, int width, int height,
+                              int stride) {
+    if (slot < 0 || slot >= columns_ * rows_) return;
+    std::lock_guard<std::mutex> lock(pixels_mutex_);
+    // Checked under the pixel lock: ReleaseTile blanks the tile under it
+    // after ending the lease, so a late frame cannot land after that
+    {
+        std::lock_guard<std::mutex> slots_lock(slots_mutex_);
+        if (!slot_used_[slot] || slot_generation_[slot] != generation) return;
+    }
+    WriteTileLocked(slot, rgba, width, height, stride);
+    MarkDirtyLocked();
+}
+
+void TextureAtlas::WriteTileLocked(int slot, const uint8_t* rgba, int width, int height, int stride) {
+    if (slot < 0 || slot >= columns_ * rows_) return;
+    TileRect tile = GetTileRect(slot);
+    width = std::min(width, tile.width);
+    height = std::min(height, tile.height);
+    int offset_x = (tile.width - width) / 2;
+    int offset_y = (tile.height - height) / 2;
+    size_t atlas_stride = static_cast<size_t>(this->width()) * 4;
+
+    auto blank = [](uint8_t* dst, int from, int to) {
+        for (int col = from; col < to; ++col) {
+            dst[col * 4] = dst[col * 4 + 1] = dst[col * 4 + 2] = 0;
+            dst[col * 4 + 3] = 0xFF;
+        }
+    };
+
+    for (int row = 0; row < tile.height; ++row) {
+        uint8_t* dst = pixels_.data() + (tile.y + row) * atlas_stride + static_cast<size_t>(tile.x) * 4;
+        if (!rgba || row < offset_y || row >= offset_y + height) {
+            blank(dst, 0, tile.width);
+            continue;
+        }
+        // Letterbox bars around the content
+        blank(dst, 0, offset_x);
+        memcpy(dst + static_cast<size_t>(offset_x) * 4, rgba + (row - offset_y) * static_cast<size_t>(stride),
+               static_cast<size_t>(width) * 4);
+        blank(dst, offset_x + width, tile.width);
+    }
+}
+
+void TextureAtlas::MarkDirtyLocked() {
+    // Tiles updated before the next refresh share one mark
+    int64_t tid = texture_id_.load();
+    if (tid != -1) FrameNotifier::GetInstance().Request(texture_registrar_, tid);
+}
+
+const FlutterDesktopPixelBuffer* TextureAtlas::CopyPixelBuffer() {
+    if (texture_id_ == -1) return nullptr;
+    pixels_mutex_.lock();
+    return &flutter_pixel_buffer_;
+}
+
+void TextureAtlas::ReleasePixelBuffer(void* context) {
+    auto* atlas = static_cast<TextureAtlas*>(context);
+    atlas->pixels_mutex_.unlock();
+}
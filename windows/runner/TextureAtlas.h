@@ -0,0 +1,82 @@
+#ifndef TEXTURE_ATLAS_H_
+#define TEXTURE_ATLAS_H_
+
+#include <flutter/texture_registrar.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// One shared texture holding a grid of downscaled device frames. Sessions
+// write their tile from the decoder thread; the engine uploads the whole page
+// once per frame instead of once per device.
+class TextureAtlas : public std::enable_shared_from_this<TextureAtlas> {
+ public:
+  struct TileRect {
+      int x = 0;
+      int y = 0;
+      int width = 0;
+      int height = 0;
+  };
+
+  static std::shared_ptr<TextureAtlas> Create(flutter::TextureRegistrar* registrar, int tile_width,
+                                              int tile_height, int columns, int rows);
+  ~TextureAtlas();
+
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  int64_t texture_id() const { return texture_id_; }
+  int width() const { return tile_width_ * columns_; }
+  int height() const { return tile_height_ * rows_; }
+  int tile_width() const { return tile_width_; }
+  int tile_height() const { return tile_height_; }
+
+  // Returns a free tile slot or -1 when the page is full. *generation
+  // identifies this lease of the slot for UpdateTile.
+  int AcquireTile(uint64_t* generation);
+  void ReleaseTile(int slot);
+  bool IsEmpty() const;
+  TileRect GetTileRect(int slot) const;
+
+  // Copies an RGBA image (at most tile size) centered into the tile and
+  // schedules a repaint. Only the written tile is touched. Ignored when the
+  // slot was released (and possibly reassigned) since generation was issued.
+  void UpdateTile(int slot, uint64_t generation, const uint8_t* rgba, int width, int height, int stride);
+
+  // Unregisters the texture. Must be called on the platform thread.
+  void Unregister();
+
+ private:
+  TextureAtlas(flutter::TextureRegistrar* registrar, int tile_width, int tile_height, int columns, int rows);
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer();
+  static void ReleasePixelBuffer(void* context);
+  // Caller holds pixels_mutex_. Null rgba blanks the tile.
+  void WriteTileLocked(int slot, const uint8_t* rgba, int width, int height, int stride);
+  // Caller holds pixels_mutex_, so Unregister cannot slip in between.
+  void MarkDirtyLocked();
+
+  flutter::TextureRegistrar* texture_registrar_;
+  std::unique_ptr<flutter::TextureVariant> texture_;
+  std::atomic<int64_t> texture_id_{-1};
+
+  int tile_width_;
+  int tile_height_;
+  int columns_;
+  int rows_;
+
+  // Held from the copy callback until the engine releases the buffer, so a
+  // tile is never uploaded half written.
+  mutable std::mutex pixels_mutex_;
+  std::vector<uint8_t> pixels_;
+  FlutterDesktopPixelBuffer flutter_pixel_buffer_;
+
+  mutable std::mutex slots_mutex_;
+  std::vector<bool> slot_used_;
+  std::vector<uint64_t> slot_generation_; // Lease of each used slot, 0 when free
+  uint64_t next_generation_ = 0;
+};
+
+#endif  // TEXTURE_ATLAS_H_
@@ -0,0 +1,156 @@
+#include "TimeShiftBuffer.h"
+
+#include "VideoDecoderPlugin.h"
+
+#include <algorithm>
+
+// Gap inserted when the device clock restarts (one frame at 60 fps)
+static constexpr int64_t kReconnectGapUs = 16667;
+
+std::atomic<int64_t> TimeShiftBuffer::total_bytes_{0};
+std::atomic<int64_t> TimeShiftBuffer::global_limit_{0};
+std::atomic<int> TimeShiftBuffer::buffer_count_{0};
+
+TimeShiftBuffer::TimeShiftBuffer(int64_t window_us, size_t max_bytes)
+    : window_us_(window_us), max_bytes_(max_bytes) {
+    buffer_count_++;
+}
+
+TimeShiftBuffer::~TimeShiftBuffer() {
+    total_bytes_ -= (int64_t)bytes_;
+    buffer_count_--;
+}
+
+void TimeShiftBuffer::SetGlobalLimit(int64_t bytes) {
+    global_limit_ = std::max<int64_t>(0, bytes);
+}
+
+void TimeShiftBuffer::SetConfig(const std::vector<uint8_t>& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (config_ && *config_ == config) return;
+    // Applies from the next GOP; the current one was encoded with the old one
+    config_ = std::make_shared<const std::vector<uint8_t>>(config);
+}
+
+void TimeShiftBuffer::PushPacket(const uint8_t* data, size_t size, int64_t pts_us, bool key_frame, int width,
+                                 int height) {
+    if (!data || size == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t pts = pts_us + pts_offset_us_;
+    if (last_pts_us_ >= 0 && pts <= last_pts_us_ && key_frame) {
+        // A reconnected stream restarts the device clock
+        pts_offset_us_ += last_pts_us_ + kReconnectGapUs - pts;
+        pts = last_pts_us_ + kReconnectGapUs;
+    }
+
+    if (key_frame && config_) {
+        auto gop = std::make_shared<Gop>();
+        gop->config = config_;
+        gops_.push_back(std::move(gop));
+        waiting_for_key_frame_ = false;
+    } else if (waiting_for_key_frame_ || gops_.empty()) {
+        return;
+    }
+
+    Gop& gop = *gops_.back();
+    if (width > 0 && height > 0) {
+        // The decoder reports the size only after the first frame of a stream
+        gop.width = width;
+        gop.height = height;
+    }
+    gop.packets.push_back({std::make_shared<const std::vector<uint8_t>>(data, data + size), pts, key_frame});
+    gop.bytes += size;
+    bytes_ += size;
+    total_bytes_ += (int64_t)size;
+    last_pts_us_ = pts;
+    Trim();
+}
+
+size_t TimeShiftBuffer::Budget() const {
+    int64_t limit = global_limit_;
+    if (limit <= 0 || total_bytes_ <= limit) return max_bytes_;
+    int64_t share = limit / std::max(1, buffer_count_.load());
+    return std::min(max_bytes_, (size_t)share);
+}
+
+void TimeShiftBuffer::Trim() {
+    auto pop_front = [this]() {
+        bytes_ -= gops_.front()->bytes;
+        total_bytes_ -= (int64_t)gops_.front()->bytes;
+        gops_.pop_front();
+    };
+
+    // A GOP goes once the next one alone reaches back far enough
+    while (gops_.size() > 1 && gops_[1]->start_pts_us() <= last_pts_us_ - window_us_) pop_front();
+
+    size_t budget = Budget();
+    while (gops_.size() > 1 && bytes_ > budget) pop_front();
+    if (bytes_ > budget && !gops_.empty()) {
+        // The GOP being received does not fit on its own; start over at the
+        // next key frame rather than keep a GOP without its beginning
+        overflows_++;
+        pop_front();
+        waiting_for_key_frame_ = true;
+    }
+}
+
+TimeShiftBuffer::Snapshot TimeShiftBuffer::GetSnapshot(int64_t duration_us) const {
+    Snapshot snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (gops_.empty()) return snapshot;
+
+    size_t first = 0;
+    if (duration_us > 0) {
+        int64_t from = last_pts_us_ - duration_us;
+        for (size_t i = 0; i < gops_.size() && gops_[i]->start_pts_us() <= from; ++i) first = i;
+    }
+    for (size_t i = first; i < gops_.size(); ++i) {
+        if (i + 1 == gops_.size()) {
+            // Still growing: copy the packet list, the payloads are shared
+            snapshot.push_back(std::make_shared<const Gop>(*gops_[i]));
+        } else {
+            snapshot.push_back(gops_[i]);
+        }
+    }
+    return snapshot;
+}
+
+TimeShiftBuffer::Stats TimeShiftBuffer::GetStats() const {
+    Stats stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.bytes = (int64_t)bytes_;
+    stats.gops = (int)gops_.size();
+    stats.overflows = overflows_;
+    if (!gops_.empty()) stats.duration_us = last_pts_us_ - gops_.front()->start_pts_us();
+    return stats;
+}
+
+bool TimeShiftBuffer::Dump(const Snapshot& snapshot, const std::string& path, AVCodecID codec_id,
+                           StreamRecorder::Stats* stats, std::string* error) {
+    if (snapshot.empty()) {
+        *error = "Time-shift window is empty";
+        return false;
+    }
+
+    StreamRecorder recorder(path, codec_id);
+    if (!recorder.Open(error)) return false;
+    for (const auto& gop : snapshot) {
+        // Before the first packet this becomes extradata, later it goes in-band
+        if (gop->config) recorder.SetConfig(*gop->config);
+        for (const auto& packet : gop->packets) {
+            // Unlike a live recording, nothing may be dropped here
+            recorder.WaitForSpace(packet.data->size());
+            recorder.PushPacket(packet.data->data(), packet.data->size(), packet.pts_us, packet.key_frame,
+                                gop->width, gop->height);
+        }
+    }
+    recorder.Stop();
+
+    *stats = recorder.GetStats();
+    if (stats->packets_written == 0) {
+        *error = "Nothing could be written to " + path;
+        return false;
+    }
+    return true;
+}
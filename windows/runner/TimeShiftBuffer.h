@@ -0,0 +1,101 @@
+#ifndef TIME_SHIFT_BUFFER_H_
+#define TIME_SHIFT_BUFFER_H_
+
+#include "StreamRecorder.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// The last N seconds of a session's compressed stream, kept as whole GOPs so
+// every point in the window can be decoded starting at its key frame.
+// Packets are a few percent of the size of the decoded frames, so keeping a
+// window for every device is cheap enough to leave on.
+//
+// Memory is bounded per buffer and across all buffers: over the global limit
+// every buffer trims itself down to its fair share, oldest GOP first.
+class TimeShiftBuffer {
+ public:
+  struct Packet {
+      std::shared_ptr<const std::vector<uint8_t>> data;
+      int64_t pts_us = 0;
+      bool key_frame = false;
+  };
+
+  // Starts with a key frame. Never modified once the next GOP has started.
+  struct Gop {
+      std::shared_ptr<const std::vector<uint8_t>> config; // VPS/SPS/PPS in effect
+      int width = 0;
+      int height = 0;
+      std::vector<Packet> packets;
+      size_t bytes = 0;
+
+      int64_t start_pts_us() const { return packets.front().pts_us; }
+      int64_t end_pts_us() const { return packets.back().pts_us; }
+  };
+
+  // Immutable copy of (part of) the window, oldest GOP first. Holding one
+  // keeps its packets alive after the buffer has evicted them.
+  using Snapshot = std::vector<std::shared_ptr<const Gop>>;
+
+  struct Stats {
+      int64_t bytes = 0;
+      int64_t duration_us = 0;
+      int gops = 0;
+      int64_t overflows = 0; // GOPs discarded for not fitting the budget at all
+  };
+
+  TimeShiftBuffer(int64_t window_us, size_t max_bytes);
+  ~TimeShiftBuffer();
+
+  TimeShiftBuffer(const TimeShiftBuffer&) = delete;
+  TimeShiftBuffer& operator=(const TimeShiftBuffer&) = delete;
+
+  // Decoder thread, same call sites as StreamRecorder.
+  void SetConfig(const std::vector<uint8_t>& config);
+  void PushPacket(const uint8_t* data, size_t size, int64_t pts_us, bool key_frame, int width, int height);
+
+  // GOPs covering the last duration_us (0 = the whole window).
+  Snapshot GetSnapshot(int64_t duration_us) const;
+
+  Stats GetStats() const;
+
+  // Remuxes a snapshot into path through a StreamRecorder. Blocks until the
+  // file is complete; meant for WorkerPool::GetFileInstance().
+  static bool Dump(const Snapshot& snapshot, const std::string& path, AVCodecID codec_id,
+                   StreamRecorder::Stats* stats, std::string* error);
+
+  // Limit shared by all buffers; 0 disables the global bound.
+  static void SetGlobalLimit(int64_t bytes);
+  static int64_t total_bytes() { return total_bytes_; }
+
+ private:
+  size_t Budget() const;
+  void Trim(); // mutex_ held
+
+  const int64_t window_us_;
+  const size_t max_bytes_;
+
+  mutable std::mutex mutex_;
+  std::deque<std::shared_ptr<Gop>> gops_;
+  size_t bytes_ = 0;
+  std::shared_ptr<const std::vector<uint8_t>> config_;
+  bool waiting_for_key_frame_ = true;
+  int64_t last_pts_us_ = -1;
+  int64_t pts_offset_us_ = 0; // Keeps the timeline monotonic across reconnects
+  int64_t overflows_ = 0;
+
+  static std::atomic<int64_t> total_bytes_;
+  static std::atomic<int64_t> global_limit_;
+  static std::atomic<int> buffer_count_;
+};
+
+#endif  // TIME_SHIFT_BUFFER_H_
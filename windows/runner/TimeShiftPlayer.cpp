@@ -0,0 +1,217 @@
+#include "TimeShiftPlayer.h"
+
+#include "FrameNotifier.h"
+#include "VideoDecoderPlugin.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+std::shared_ptr<TimeShiftPlayer> TimeShiftPlayer::Create(flutter::TextureRegistrar* registrar,
+                                                         TimeShiftBuffer::Snapshot snapshot, AVCodecID codec_id,
+                                                         int max_size) {
+    if (snapshot.empty()) return nullptr;
+    std::shared_ptr<TimeShiftPlayer> player(new TimeShiftPlayer(registrar, std::move(snapshot), codec_id, max_size));
+    std::weak_ptr<TimeShiftPlayer> weak_player = player;
+
+    player->texture_ = std::make_unique<flutter::TextureVariant>(
+        flutter::PixelBufferTexture([weak_player](size_t, size_t) -> const FlutterDesktopPixelBuffer* {
+            auto p = weak_player.lock();
+            if (!p) return nullptr;
+            return p->CopyPixelBuffer();
+        }));
+
+    player->texture_id_ = registrar->RegisterTexture(player->texture_.get());
+    if (player->texture_id_ == -1) {
+        LogTrace("TimeShiftPlayer - Error: failed to register texture");
+        return nullptr;
+    }
+    return player;
+}
+
+TimeShiftPlayer::TimeShiftPlayer(flutter::TextureRegistrar* registrar, TimeShiftBuffer::Snapshot snapshot,
+                                 AVCodecID codec_id, int max_size)
+    : texture_registrar_(registrar), snapshot_(std::move(snapshot)), codec_id_(codec_id), max_size_(max_size) {
+    memset(&flutter_pixel_buffer_, 0, sizeof(flutter_pixel_buffer_));
+    flutter_pixel_buffer_.release_callback = &TimeShiftPlayer::ReleasePixelBuffer;
+    flutter_pixel_buffer_.release_context = this;
+}
+
+TimeShiftPlayer::~TimeShiftPlayer() {
+    if (shown_) av_frame_free(&shown_);
+    if (sws_context_) sws_freeContext(sws_context_);
+    if (decoder_) SessionPool::GetInstance().ReleaseDecoder(std::move(decoder_));
+    g_total_pixels_allocated -= static_cast<int64_t>(width_) * height_ +
+                                static_cast<int64_t>(back_width_) * back_height_;
+}
+
+void TimeShiftPlayer::Unregister() {
+    int64_t tid;
+    {
+        std::lock_guard<std::mutex> lock(pixels_mutex_);
+        tid = texture_id_.exchange(-1);
+    }
+    if (tid != -1) {
+        FrameNotifier::GetInstance().Cancel(tid);
+        texture_registrar_->UnregisterTexture(tid);
+        LogTrace("TimeShiftPlayer [%lld] - Unregistered", tid);
+    }
+}
+
+void TimeShiftPlayer::Seek(int64_t pts_us, SeekCallback callback) {
+    SeekCallback superseded;
+    bool start = false;
+    {
+        std::lock_guard<std::mutex> lock(seek_mutex_);
+        superseded = std::move(pending_callback_);
+        pending_pts_us_ = pts_us;
+        pending_callback_ = std::move(callback);
+        start = !seeking_;
+        seeking_ = true;
+    }
+    if (superseded) superseded(-1);
+    if (!start) return;
+
+    auto self = shared_from_this();
+    WorkerPool::GetInstance().Post([self]() { self->RunSeeks(); });
+}
+
+void TimeShiftPlayer::RunSeeks() {
+    while (true) {
+        int64_t target;
+        SeekCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(seek_mutex_);
+            if (!pending_callback_) {
+                seeking_ = false;
+                return;
+            }
+            target = pending_pts_us_;
+            callback = std::move(pending_callback_);
+            pending_callback_ = nullptr;
+        }
+        callback(texture_id_ == -1 ? -1 : DecodeTo(target));
+    }
+}
+
+int64_t TimeShiftPlayer::DecodeTo(int64_t pts_us) {
+    if (!decoder_) {
+        // Not from the prewarmed set, which is there for starting sessions
+        decoder_ = SessionPool::OpenDecoder(codec_id_);
+        if (!decoder_) return -1;
+    }
+    if (!shown_ && !(shown_ = av_frame_alloc())) return -1;
+
+    // Last GOP starting at or before the target, then the last packet at or
+    // before it; earlier targets clamp to the start of the window
+    int gop_index = 0;
+    for (size_t i = 1; i < snapshot_.size() && snapshot_[i]->start_pts_us() <= pts_us; ++i) gop_index = (int)i;
+    const auto& gop = *snapshot_[gop_index];
+    int packet_index = 0;
+    for (size_t i = 1; i < gop.packets.size() && gop.packets[i].pts_us <= pts_us; ++i) packet_index = (int)i;
+
+    if (gop_index == gop_index_ && packet_index == packet_index_) return shown_->pts;
+
+    int from = 0;
+    if (gop_index == gop_index_ && packet_index > packet_index_) {
+        from = packet_index_ + 1;
+    } else {
+        avcodec_flush_buffers(decoder_->codec_context);
+        av_frame_unref(shown_);
+        gop_index_ = gop_index;
+    }
+    for (int i = from; i <= packet_index; ++i) {
+        if (!SendPacket(gop, (size_t)i)) {
+            // Decoder state unknown, the next seek starts from the key frame
+            gop_index_ = -1;
+            packet_index_ = -1;
+            return -1;
+        }
+        packet_index_ = i;
+    }
+    if (!shown_->data[0] || !Present(shown_)) return -1;
+    return shown_->pts;
+}
+
+bool TimeShiftPlayer::SendPacket(const TimeShiftBuffer::Gop& gop, size_t index) {
+    const auto& packet = gop.packets[index];
+    packet_data_.clear();
+    if (index == 0 && gop.config) packet_data_.assign(gop.config->begin(), gop.config->end());
+    packet_data_.insert(packet_data_.end(), packet.data->begin(), packet.data->end());
+    size_t size = packet_data_.size();
+    packet_data_.resize(size + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+
+    AVPacket* av_packet = decoder_->packet;
+    av_packet->data = packet_data_.data();
+    av_packet->size = (int)size;
+    av_packet->pts = packet.pts_us;
+    av_packet->flags = packet.key_frame ? AV_PKT_FLAG_KEY : 0;
+    int ret = avcodec_send_packet(decoder_->codec_context, av_packet);
+    av_packet->data = nullptr;
+    av_packet->size = 0;
+    if (ret < 0 && ret != AVERROR(EAGAIN)) return false;
+
+    // Only the newest frame is kept; frames on the way are never converted
+    while (avcodec_receive_frame(decoder_->codec_context, decoder_->frame) >= 0) {
+        av_frame_unref(shown_);
+        av_frame_move_ref(shown_, decoder_->frame);
+    }
+    return true;
+}
+
+bool TimeShiftPlayer::Present(AVFrame* frame) {
+    if (texture_id_ == -1 || frame->width <= 0 || frame->height <= 0) return false;
+
+    double scale = 1.0;
+    if (max_size_ > 0) scale = std::min(scale, (double)max_size_ / std::max(frame->width, frame->height));
+    int width = std::max(2, (int)(frame->width * scale) & ~1);
+    int height = std::max(2, (int)(frame->height * scale) & ~1);
+
+    {
+        std::lock_guard<std::mutex> ffmpeg_lock(g_ffmpeg_init_mutex);
+        sws_context_ = sws_getCachedContext(sws_context_, frame->width, frame->height, (AVPixelFormat)frame->format,
+                                            width, height, AV_PIX_FMT_RGBA, SWS_BILINEAR, NULL, NULL, NULL);
+    }
+    if (!sws_context_) return false;
+
+    if (back_width_ != width || back_height_ != height) {
+        g_total_pixels_allocated += static_cast<int64_t>(width) * height -
+                                    static_cast<int64_t>(back_width_) * back_height_;
+        back_.assign(static_cast<size_t>(width) * height * 4, 0);
+        back_width_ = width;
+        back_height_ = height;
+    }
+
+    uint8_t* dest[4] = { back_.data(), NULL, NULL, NULL };
+    int dest_linesize[4] = { width * 4, 0, 0, 0 };
+    if (sws_scale(sws_context_, frame->data, frame->linesize, 0, frame->height, dest, dest_linesize) <= 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pixels_mutex_);
+    int64_t tid = texture_id_.load();
+    if (tid == -1) return false;
+    front_.swap(back_);
+    std::swap(width_, back_width_);
+    std::swap(height_, back_height_);
+    flutter_pixel_buffer_.buffer = front_.data();
+    flutter_pixel_buffer_.width = width_;
+    flutter_pixel_buffer_.height = height_;
+    FrameNotifier::GetInstance().Request(texture_registrar_, tid);
+    return true;
+}
+
+const FlutterDesktopPixelBuffer* TimeShiftPlayer::CopyPixelBuffer() {
+    if (texture_id_ == -1) return nullptr;
+    pixels_mutex_.lock();
+    if (front_.empty()) {
+        pixels_mutex_.unlock();
+        return nullptr;
+    }
+    return &flutter_pixel_buffer_;
+}
+
+void TimeShiftPlayer::ReleasePixelBuffer(void* context) {
+    auto* player = static_cast<TimeShiftPlayer*>(context);
+    player->pixels_mutex_.unlock();
+}
@@ -0,0 +1,92 @@
+#ifndef TIME_SHIFT_PLAYER_H_
+#define TIME_SHIFT_PLAYER_H_
+
+#include "SessionPool.h"
+#include "TimeShiftBuffer.h"
+
+#include <flutter/texture_registrar.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+// Decodes a frozen time-shift snapshot into its own texture, with its own
+// decoder, so scrubbing never touches the live session. Seeks run on the
+// worker pool; while one runs only the most recent request is kept.
+// Seeking forward within the current GOP continues from the last decoded
+// frame, anything else decodes again from the GOP's key frame.
+class TimeShiftPlayer : public std::enable_shared_from_this<TimeShiftPlayer> {
+ public:
+  // Called with the PTS actually shown, or -1 when the seek failed or was
+  // superseded by a newer one. Worker pool thread.
+  using SeekCallback = std::function<void(int64_t pts_us)>;
+
+  static std::shared_ptr<TimeShiftPlayer> Create(flutter::TextureRegistrar* registrar,
+                                                 TimeShiftBuffer::Snapshot snapshot, AVCodecID codec_id,
+                                                 int max_size);
+  ~TimeShiftPlayer();
+
+  TimeShiftPlayer(const TimeShiftPlayer&) = delete;
+  TimeShiftPlayer& operator=(const TimeShiftPlayer&) = delete;
+
+  int64_t texture_id() const { return texture_id_; }
+  const TimeShiftBuffer::Snapshot& snapshot() const { return snapshot_; }
+
+  // Shows the last frame at or before pts_us.
+  void Seek(int64_t pts_us, SeekCallback callback);
+
+  // Unregisters the texture. Must be called on the platform thread.
+  void Unregister();
+
+ private:
+  TimeShiftPlayer(flutter::TextureRegistrar* registrar, TimeShiftBuffer::Snapshot snapshot, AVCodecID codec_id,
+                  int max_size);
+
+  void RunSeeks();
+  int64_t DecodeTo(int64_t pts_us);
+  bool SendPacket(const TimeShiftBuffer::Gop& gop, size_t index);
+  bool Present(AVFrame* frame);
+
+  const FlutterDesktopPixelBuffer* CopyPixelBuffer();
+  static void ReleasePixelBuffer(void* context);
+
+  flutter::TextureRegistrar* texture_registrar_;
+  std::unique_ptr<flutter::TextureVariant> texture_;
+  std::atomic<int64_t> texture_id_{-1};
+  const TimeShiftBuffer::Snapshot snapshot_;
+  const AVCodecID codec_id_;
+  const int max_size_;
+
+  // Latest request, picked up by the running seek loop
+  std::mutex seek_mutex_;
+  int64_t pending_pts_us_ = -1;
+  SeekCallback pending_callback_;
+  bool seeking_ = false;
+
+  // Seek loop only
+  std::unique_ptr<SessionPool::DecoderSlot> decoder_; // Opened by the first seek
+  std::vector<uint8_t> packet_data_;
+  AVFrame* shown_ = nullptr;   // Last frame out of the decoder
+  int gop_index_ = -1;         // Decoder position
+  int packet_index_ = -1;
+  SwsContext* sws_context_ = nullptr;
+  std::vector<uint8_t> back_;
+  int back_width_ = 0;
+  int back_height_ = 0;
+
+  // Held from the copy callback until the engine releases the buffer
+  std::mutex pixels_mutex_;
+  std::vector<uint8_t> front_;
+  int width_ = 0;
+  int height_ = 0;
+  FlutterDesktopPixelBuffer flutter_pixel_buffer_;
+};
+
+#endif  // TIME_SHIFT_PLAYER_H_
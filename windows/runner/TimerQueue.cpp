@@ -0,0 +1,64 @@
+#include "TimerQueue.h"
+
+#include <windows.h>
+#include <timeapi.h>
+
+#pragma comment(lib, "winmm.lib")
+
+TimerQueue& TimerQueue::GetInstance() {
+    static TimerQueue instance;
+    return instance;
+}
+
+TimerQueue::TimerQueue() {
+    thread_ = std::thread([this]() { Run(); });
+}
+
+TimerQueue::~TimerQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TimerQueue::Schedule(Clock::time_point when, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push(Entry{when, next_sequence_++, std::move(task)});
+    }
+    cv_.notify_one();
+}
+
+void TimerQueue::Run() {
+    // The default 15.6ms scheduler tick is coarser than a 60fps frame
+    timeBeginPeriod(1);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (active_) {
+        if (entries_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        auto when = entries_.top().when;
+        if (Clock::now() < when) {
+            cv_.wait_until(lock, when);
+            continue;
+        }
+
+        auto task = std::move(const_cast<Entry&>(entries_.top()).task);
+        entries_.pop();
+        lock.unlock();
+        try {
+            task();
+        } catch (...) {
+        }
+        lock.lock();
+    }
+
+    timeEndPeriod(1);
+}
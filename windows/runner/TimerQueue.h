@@ -0,0 +1,47 @@
+#ifndef TIMER_QUEUE_H_
+#define TIMER_QUEUE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Single background thread running callbacks at a given steady_clock time.
+// Shared by every session so deferred work does not cost a thread each.
+// Callbacks must be short; anything heavy should be handed off.
+class TimerQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static TimerQueue& GetInstance();
+
+  void Schedule(Clock::time_point when, std::function<void()> task);
+
+ private:
+  TimerQueue();
+  ~TimerQueue();
+
+  void Run();
+
+  struct Entry {
+      Clock::time_point when;
+      uint64_t sequence; // FIFO among equal deadlines
+      std::function<void()> task;
+      bool operator>(const Entry& other) const {
+          return when != other.when ? when > other.when : sequence > other.sequence;
+      }
+  };
+
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> entries_;
+  uint64_t next_sequence_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool active_ = true;
+  std::thread thread_;
+};
+
+#endif  // TIMER_QUEUE_H_
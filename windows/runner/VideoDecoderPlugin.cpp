@@ -10,16 +10,55 @@
 
 #pragma comment(lib, "ws2_32.lib")
 
+#include <algorithm>
 #include <cstdarg>
 #include <condition_variable>
 #include <queue>
 
-static std::mutex g_ffmpeg_init_mutex;
+#include "DecoderHost.h"
+#include "FrameAnalyzers.h"
+#include "PlacementBenchmark.h"
+#include "RemoteSession.h"
+#include "SessionPool.h"
+#include "TimeShiftPlayer.h"
+#include "TimerQueue.h"
+#include "WorkerPool.h"
+
+// Bounds the added latency when the pacer falls behind or the mapping jumps
+static const size_t kMaxPendingFrames = 4;
+static const auto kMaxPresentationHold = std::chrono::milliseconds(500);
+
+// Decoders and decoder threads kept ready for new sessions by default
+static const int kDefaultPooledDecoders = 4;
+static const int kDefaultPooledWorkers = 4;
+
+// Time-shift memory: per session unless configured, and across all sessions
+static const int kDefaultTimeShiftMegabytes = 32;
+static const int64_t kDefaultTimeShiftBudgetBytes = 1024LL * 1024 * 1024;
+static const int kMaxDecoderHosts = 16;
+static const int kMaxBenchmarkThreads = 256;
+// Source and RGBA buffers of all benchmark threads together
+static const int64_t kMaxBenchmarkBytes = 1024LL * 1024 * 1024;
+
+// Reconnect policy after a socket drop (or a failed first connect)
+static const int kConnectTimeoutMs = 1000;
+static const auto kReconnectInitialBackoff = std::chrono::milliseconds(50);
+static const auto kReconnectMaxBackoff = std::chrono::milliseconds(2000);
+static const auto kReconnectWindow = std::chrono::seconds(15);
+
+// A screen is reported idle after this long without a changed frame
+static const auto kIdleThreshold = std::chrono::milliseconds(1000);
+
+// scrcpy packet limit, and how often a lost stream asks for a keyframe again
+static const uint32_t kMaxPacketSize = 20 * 1024 * 1024;
+static const auto kKeyframeRequestInterval = std::chrono::milliseconds(1000);
+
+std::mutex g_ffmpeg_init_mutex;
 std::atomic<int64_t> g_active_buffers{0};
 std::atomic<int64_t> g_total_pixels_allocated{0};
 std::atomic<int> g_active_sessions{0};
 
-static void LogTrace(const char* format, ...) {
+void LogTrace(const char* format, ...) {
     va_list args;
     va_start(args, format);
     
@@ -53,78 +92,6 @@ static void LogTrace(const char* format, ...) {
     }
 }
 
-// Singleton to manage thread joining in a central worker thread
-class GlobalThreadJoiner {
-public:
-    static GlobalThreadJoiner& GetInstance() {
-        static GlobalThreadJoiner instance;
-        return instance;
-    }
-
-    void AddThread(std::unique_ptr<std::thread> t) {
-        if (!t) return;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            threads_to_join_.push(std::move(t));
-        }
-        cv_.notify_one();
-    }
-
-private:
-    GlobalThreadJoiner() : active_(true) {
-        worker_thread_ = std::thread([this]() {
-            while (active_ || !threads_to_join_.empty()) {
-                std::unique_ptr<std::thread> t;
-                {
-                    std::unique_lock<std::mutex> lock(mutex_);
-                    cv_.wait(lock, [this] { return !active_ || !threads_to_join_.empty(); });
-                    
-                    if (!threads_to_join_.empty()) {
-                        t = std::move(threads_to_join_.front());
-                        threads_to_join_.pop();
-                    } else if (!active_) {
-                        break;
-                    }
-                }
-                
-                if (t && t->joinable()) {
-                    // Actual cleanup happens here on a background thread
-                    t->join();
-                }
-            }
-        });
-    }
-
-    ~GlobalThreadJoiner() {
-        active_ = false;
-        cv_.notify_all(); // Use notify_all for safety
-        if (worker_thread_.joinable()) {
-            worker_thread_.join();
-        }
-        // CRITICAL FIX: Join any remaining threads in the queue
-        // In C++, destroying a joinable std::thread calls std::terminate()!
-        while (!threads_to_join_.empty()) {
-            auto t = std::move(threads_to_join_.front());
-            threads_to_join_.pop();
-            if (t && t->joinable()) {
-                t->join();
-            }
-        }
-    }
-
-    std::queue<std::unique_ptr<std::thread>> threads_to_join_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    std::thread worker_thread_;
-    std::atomic<bool> active_;
-};
-
-// Background thread manager to avoid blocking UI thread during join
-// Now uses GlobalThreadJoiner to avoid spawning 100 extra management threads
-static void SafeThreadJoin(std::unique_ptr<std::thread> t) {
-    GlobalThreadJoiner::GetInstance().AddThread(std::move(t));
-}
-
 static void FFmpegLogCallback(void* ptr, int level, const char* fmt, va_list vl) {
     if (level > av_log_get_level()) return;
     char line[1024];
@@ -156,18 +123,77 @@ static int AvCodecReceiveFrameSafe(AVCodecContext* ctx, AVFrame* frame) {
     }
 }
 
+static const flutter::EncodableValue* FindArgument(const flutter::EncodableMap* arguments, const char* key) {
+    if (!arguments) return nullptr;
+    auto it = arguments->find(flutter::EncodableValue(key));
+    if (it == arguments->end() || it->second.IsNull()) return nullptr;
+    return &it->second;
+}
+
+static std::string StringArgument(const flutter::EncodableMap* arguments, const char* key) {
+    const auto* value = FindArgument(arguments, key);
+    if (!value || !std::holds_alternative<std::string>(*value)) return std::string();
+    return std::get<std::string>(*value);
+}
+
+static int IntArgument(const flutter::EncodableMap* arguments, const char* key, int fallback) {
+    const auto* value = FindArgument(arguments, key);
+    return value ? (int)value->LongValue() : fallback;
+}
+
+using FrameSnapshot = std::shared_ptr<VideoDecoderPlugin::VideoSessionState::RGBAFrame>;
+
+// Worker pool side of a capture. Failures are reported in an "error" entry.
+static flutter::EncodableMap EncodeSnapshot(int64_t texture_id, const FrameSnapshot& snapshot,
+                                            FrameEncoder::Format format, int max_size, int quality,
+                                            const std::string& path) {
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("textureId")] = flutter::EncodableValue(texture_id);
+
+    std::vector<uint8_t> encoded;
+    int width = 0;
+    int height = 0;
+    std::string error;
+    bool ok = FrameEncoder::Encode(snapshot->pixels.data(), snapshot->width, snapshot->height,
+                                   snapshot->width * 4, format, max_size, quality, &encoded, &width, &height,
+                                   &error);
+    if (ok && !path.empty()) ok = FrameEncoder::WriteFile(path, encoded, &error);
+    if (!ok) {
+        LogTrace("Capture [%lld] - Error: %s", texture_id, error.c_str());
+        map[flutter::EncodableValue("error")] = flutter::EncodableValue(error);
+        return map;
+    }
+
+    map[flutter::EncodableValue("width")] = flutter::EncodableValue(width);
+    map[flutter::EncodableValue("height")] = flutter::EncodableValue(height);
+    if (path.empty()) {
+        map[flutter::EncodableValue("bytes")] = flutter::EncodableValue(std::move(encoded));
+    } else {
+        map[flutter::EncodableValue("path")] = flutter::EncodableValue(path);
+    }
+    return map;
+}
 
 
-VideoDecoderPlugin::VideoDecoderPlugin(flutter::TextureRegistrar* texture_registrar)
-    : texture_registrar_(texture_registrar) {
+VideoDecoderPlugin::VideoDecoderPlugin(flutter::TextureRegistrar* texture_registrar,
+                                       std::shared_ptr<PlatformTaskRunner> platform_runner)
+    : texture_registrar_(texture_registrar), platform_runner_(std::move(platform_runner)) {
   LogTrace("Plugin Constructor - Initializing Winsock");
   WSADATA wsaData;
   WSAStartup(MAKEWORD(2, 2), &wsaData);
   av_log_set_callback(FFmpegLogCallback);
   av_log_set_level(AV_LOG_ERROR);
+  SessionPool::GetInstance().Configure(kDefaultPooledDecoders, kDefaultPooledWorkers);
+  TimeShiftBuffer::SetGlobalLimit(kDefaultTimeShiftBudgetBytes);
 }
 
 VideoDecoderPlugin::~VideoDecoderPlugin() {
+  // Pending results are dropped; they die with the channel
+  platform_runner_->Shutdown();
+  // Joins the replay threads; their reports are dropped
+  input_replays_.clear();
+  benchmark_cancelled_ = true;
+  if (benchmark_thread_.joinable()) benchmark_thread_.join();
   StopAllDecoding();
   WSACleanup();
 }
@@ -198,59 +224,1424 @@ void VideoDecoderPlugin::HandleMethodCall(
         }
     }
     result->Success();
-  } else {
-    result->NotImplemented();
-  }
+  } else if (method_call.method_name().compare("startRecording") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    const auto* path = FindArgument(arguments, "path");
+    if (!tid || !path || !std::holds_alternative<std::string>(*path)) {
+        result->Error("INVALID_ARGS", "Missing textureId or path parameter");
+        return;
+    }
+    StartRecording(tid->LongValue(), std::get<std::string>(*path), std::move(result));
+  } else if (method_call.method_name().compare("stopRecording") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    StopRecording(tid->LongValue(), std::move(result));
+  } else if (method_call.method_name().compare("startRelay") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    std::string address = StringArgument(arguments, "address");
+    StartRelay(tid->LongValue(), address.empty() ? "127.0.0.1" : address,
+               std::clamp(IntArgument(arguments, "port", 0), 0, 65535), std::move(result));
+  } else if (method_call.method_name().compare("stopRelay") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    StopRelay(tid->LongValue(), std::move(result));
+  } else if (method_call.method_name().compare("configureAtlas") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tile_width = FindArgument(arguments, "tileWidth");
+    const auto* tile_height = FindArgument(arguments, "tileHeight");
+    const auto* columns = FindArgument(arguments, "columns");
+    const auto* rows = FindArgument(arguments, "rows");
+    // Applies to pages created from now on
+    if (tile_width) atlas_tile_width_ = std::max(16, (int)tile_width->LongValue()) & ~1;
+    if (tile_height) atlas_tile_height_ = std::max(16, (int)tile_height->LongValue()) & ~1;
+    if (columns) atlas_columns_ = std::max(1, (int)columns->LongValue());
+    if (rows) atlas_rows_ = std::max(1, (int)rows->LongValue());
+    // Keep pages within the common 4096px GPU texture limit
+    atlas_columns_ = std::min(atlas_columns_, std::max(1, 4096 / atlas_tile_width_));
+    atlas_rows_ = std::min(atlas_rows_, std::max(1, 4096 / atlas_tile_height_));
+    result->Success();
+  } else if (method_call.method_name().compare("attachToAtlas") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    const auto* atlas_only = FindArgument(arguments, "atlasOnly");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    // Other views of the session may still render its texture
+    bool only = atlas_only && std::holds_alternative<bool>(*atlas_only) && std::get<bool>(*atlas_only);
+    AttachToAtlas(tid->LongValue(), only, std::move(result));
+  } else if (method_call.method_name().compare("detachFromAtlas") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (tid) {
+        auto state = FindSessionState(tid->LongValue());
+        if (state) DetachFromAtlas(state);
+    }
+    result->Success();
+  } else if (method_call.method_name().compare("setPresentationDelay") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    const auto* delay = FindArgument(arguments, "delayMs");
+    if (!tid || !delay) {
+        result->Error("INVALID_ARGS", "Missing textureId or delayMs parameter");
+        return;
+    }
+    auto state = FindSessionState(tid->LongValue());
+    if (!state) {
+        ReportMissingSession(tid->LongValue(), result.get());
+        return;
+    }
+    // Negative selects the adaptive delay
+    int delay_ms = (int)std::min<int64_t>(delay->LongValue(), 1000);
+    state->pacer.SetDelay(delay_ms < 0 ? FramePacer::kAdaptiveDelay : delay_ms);
+    result->Success();
+  } else if (method_call.method_name().compare("setSyncGroup") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    auto state = tid ? FindSessionState(tid->LongValue()) : nullptr;
+    if (!state) {
+        ReportMissingSession(tid ? tid->LongValue() : -1, result.get());
+        return;
+    }
+    std::string name = StringArgument(arguments, "group");
+    bool atlas_only = false;
+    {
+        std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+        atlas_only = state->atlas && state->atlas_only;
+    }
+    // Only the session's texture goes through its pacer
+    if (!name.empty() && atlas_only) {
+        result->Error("NOT_PACED", "Atlas-only sessions cannot join a sync group");
+        return;
+    }
+    std::shared_ptr<SyncGroup> group;
+    if (!name.empty()) {
+        group = sync_groups_[name].lock();
+        if (!group) {
+            group = std::make_shared<SyncGroup>(name);
+            sync_groups_[name] = group;
+        }
+    }
+    state->pacer.SetSyncGroup(group, tid->LongValue());
+    for (auto it = sync_groups_.begin(); it != sync_groups_.end();) {
+        it = it->second.expired() ? sync_groups_.erase(it) : std::next(it);
+    }
+    LogTrace("SetSyncGroup [%lld] - %s", tid->LongValue(), name.empty() ? "none" : name.c_str());
+    result->Success();
+  } else if (method_call.method_name().compare("configureSessionPool") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    SessionPool::GetInstance().Configure(IntArgument(arguments, "decoders", kDefaultPooledDecoders),
+                                         IntArgument(arguments, "workers", kDefaultPooledWorkers));
+    result->Success();
+  } else if (method_call.method_name().compare("setSessionPriority") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    QosGovernor::Priority priority;
+    if (!tid || !QosGovernor::ParsePriority(StringArgument(arguments, "priority"), &priority)) {
+        result->Error("INVALID_ARGS", "Missing textureId or priority (interactive, visible, background)");
+        return;
+    }
+    auto state = FindSessionState(tid->LongValue());
+    if (state) state->priority = priority;
+    result->Success();
+  } else if (method_call.method_name().compare("configureCpuBudget") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    QosGovernor::GetInstance().SetBudget(IntArgument(arguments, "percent", 0));
+    result->Success();
+  } else if (method_call.method_name().compare("configureCpuPinning") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* enabled = FindArgument(arguments, "enabled");
+    // Running sessions move with their next frame
+    CpuTopology::GetInstance().SetPinning(enabled && std::holds_alternative<bool>(*enabled) &&
+                                          std::get<bool>(*enabled));
+    result->Success();
+  } else if (method_call.method_name().compare("runPlacementBenchmark") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    int cores = static_cast<int>(CpuTopology::GetInstance().cores().size());
+    RunPlacementBenchmark(std::clamp(IntArgument(arguments, "threads", cores), 1, kMaxBenchmarkThreads),
+                          std::clamp(IntArgument(arguments, "seconds", 3), 1, 30),
+                          std::clamp(IntArgument(arguments, "width", 1080), 16, 4096) & ~1,
+                          std::clamp(IntArgument(arguments, "height", 1920), 16, 4096) & ~1, std::move(result));
+  } else if (method_call.method_name().compare("addOutput") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    SessionOutput::Config config;
+    std::string format_name = StringArgument(arguments, "format");
+    if (!tid || (!format_name.empty() && !SessionOutput::ParseFormat(format_name, &config.format))) {
+        result->Error("INVALID_ARGS", "Missing textureId or format is not rgba or gray");
+        return;
+    }
+    config.max_width = std::max(0, IntArgument(arguments, "maxWidth", 0));
+    config.max_height = std::max(0, IntArgument(arguments, "maxHeight", 0));
+    config.max_fps = std::clamp(IntArgument(arguments, "maxFps", 0), 0, 240);
+    AddOutput(tid->LongValue(), config, std::move(result));
+  } else if (method_call.method_name().compare("removeOutput") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    const auto* output_tid = FindArgument(arguments, "outputTextureId");
+    if (!tid || !output_tid) {
+        result->Error("INVALID_ARGS", "Missing textureId or outputTextureId parameter");
+        return;
+    }
+    auto state = FindSessionState(tid->LongValue());
+    if (state) RemoveOutput(state, output_tid->LongValue());
+    result->Success();
+  } else if (method_call.method_name().compare("startFrameExport") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    StartFrameExport(tid->LongValue(), IntArgument(arguments, "slots", 3),
+                     std::max(0, IntArgument(arguments, "maxSize", 0)), std::move(result));
+  } else if (method_call.method_name().compare("stopFrameExport") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    auto state = tid ? FindSessionState(tid->LongValue()) : nullptr;
+    if (state) {
+        // Unmapped once the decoder thread drops its reference
+        std::lock_guard<std::mutex> lock(state->exporter_mutex);
+        state->exporter.reset();
+    }
+    result->Success();
+  } else if (method_call.method_name().compare("configureTimeShift") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    ConfigureTimeShift(tid->LongValue(), std::clamp(IntArgument(arguments, "seconds", 30), 0, 600),
+                       std::max(1, IntArgument(arguments, "maxMegabytes", kDefaultTimeShiftMegabytes)),
+                       std::move(result));
+  } else if (method_call.method_name().compare("configureTimeShiftBudget") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    TimeShiftBuffer::SetGlobalLimit((int64_t)std::max(0, IntArgument(arguments, "megabytes", 0)) * 1024 * 1024);
+    result->Success();
+  } else if (method_call.method_name().compare("dumpTimeShift") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    std::string path = StringArgument(arguments, "path");
+    if (!tid || path.empty()) {
+        result->Error("INVALID_ARGS", "Missing textureId or path parameter");
+        return;
+    }
+    DumpTimeShift(tid->LongValue(), path, std::max(0, IntArgument(arguments, "seconds", 0)), std::move(result));
+  } else if (method_call.method_name().compare("openTimeShiftPlayer") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    OpenTimeShiftPlayer(tid->LongValue(), std::max(0, IntArgument(arguments, "seconds", 0)),
+                        std::max(0, IntArgument(arguments, "maxSize", 0)), std::move(result));
+  } else if (method_call.method_name().compare("seekTimeShiftPlayer") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "playerTextureId");
+    const auto* pts = FindArgument(arguments, "ptsUs");
+    if (!tid || !pts) {
+        result->Error("INVALID_ARGS", "Missing playerTextureId or ptsUs parameter");
+        return;
+    }
+    SeekTimeShiftPlayer(tid->LongValue(), pts->LongValue(), std::move(result));
+  } else if (method_call.method_name().compare("closeTimeShiftPlayer") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "playerTextureId");
+    if (tid) CloseTimeShiftPlayer(tid->LongValue());
+    result->Success();
+  } else if (method_call.method_name().compare("configureAnalysis") == 0) {
+    ConfigureAnalysis(std::get_if<flutter::EncodableMap>(method_call.arguments()), std::move(result));
+  } else if (method_call.method_name().compare("getFrameHash") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    GetFrameHash(tid->LongValue(), std::move(result));
+  } else if (method_call.method_name().compare("waitForFrameHash") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* tid = FindArgument(arguments, "textureId");
+    uint64_t reference = 0;
+    if (!tid || !FrameHash::FromHex(StringArgument(arguments, "hash"), &reference)) {
+        result->Error("INVALID_ARGS", "Missing textureId or hash (16 hex digits) parameter");
+        return;
+    }
+    WaitForFrameHash(tid->LongValue(), reference, std::clamp(IntArgument(arguments, "maxDistance", 5), 0, 64),
+                     std::clamp(IntArgument(arguments, "timeoutMs", 5000), 0, 600000), std::move(result));
+  } else if (method_call.method_name().compare("startInputRecording") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    int64_t id = next_input_recording_++;
+    input_recordings_[id] =
+        std::make_unique<InputScript>(IntArgument(arguments, "width", 0), IntArgument(arguments, "height", 0));
+    result->Success(flutter::EncodableValue(id));
+  } else if (method_call.method_name().compare("recordInput") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* id = FindArgument(arguments, "recordingId");
+    const auto* data = FindArgument(arguments, "data");
+    auto it = id ? input_recordings_.find(id->LongValue()) : input_recordings_.end();
+    if (it == input_recordings_.end() || !data || !std::holds_alternative<std::vector<uint8_t>>(*data)) {
+        result->Error("INVALID_ARGS", "Unknown recordingId or missing data");
+        return;
+    }
+    const auto& bytes = std::get<std::vector<uint8_t>>(*data);
+    const auto* timestamp = FindArgument(arguments, "timestampUs");
+    int64_t timestamp_us = timestamp ? timestamp->LongValue()
+                                     : std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now().time_since_epoch()).count();
+    it->second->Append(timestamp_us, bytes.data(), bytes.size());
+    result->Success();
+  } else if (method_call.method_name().compare("stopInputRecording") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    const auto* id = FindArgument(arguments, "recordingId");
+    auto it = id ? input_recordings_.find(id->LongValue()) : input_recordings_.end();
+    if (it == input_recordings_.end()) {
+        result->Success();
+        return;
+    }
+    auto script = it->second->Serialize();
+    LogTrace("Plugin - Input recording %lld: %zu messages, %lld ms, %zu bytes", it->first,
+             it->second->messages().size(), it->second->duration_us() / 1000, script.size());
+    input_recordings_.erase(it);
+    result->Success(flutter::EncodableValue(std::move(script)));
+  } else if (method_call.method_name().compare("replayInputScript") == 0) {
+    ReplayInputScript(std::get_if<flutter::EncodableMap>(method_call.arguments()), std::move(result));
+  } else if (method_call.method_name().compare("cancelInputReplays") == 0) {
+    for (auto& replay : input_replays_) replay->Cancel();
+    result->Success();
+  } else if (method_call.method_name().compare("configureDecoderHosts") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    ConfigureDecoderHosts(std::clamp(IntArgument(arguments, "count", 0), 0, kMaxDecoderHosts), std::move(result));
+  } else if (method_call.method_name().compare("getStats") == 0) {
+    GetStats(std::move(result));
+  } else if (method_call.method_name().compare("captureFrame") == 0 ||
+             method_call.method_name().compare("captureAllFrames") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    FrameEncoder::Format format = FrameEncoder::Format::kPng;
+    std::string format_name = StringArgument(arguments, "format");
+    if (!format_name.empty() && !FrameEncoder::ParseFormat(format_name, &format)) {
+        result->Error("INVALID_ARGS", "format must be png or jpeg");
+        return;
+    }
+    int max_size = std::max(0, IntArgument(arguments, "maxSize", 0));
+    int quality = IntArgument(arguments, "quality", 85);
+
+    if (method_call.method_name().compare("captureAllFrames") == 0) {
+        CaptureAllFrames(format, max_size, quality, StringArgument(arguments, "directory"), std::move(result));
+        return;
+    }
+    const auto* tid = FindArgument(arguments, "textureId");
+    if (!tid) {
+        result->Error("INVALID_ARGS", "Missing textureId parameter");
+        return;
+    }
+    CaptureFrame(tid->LongValue(), format, max_size, quality, StringArgument(arguments, "path"),
+                 std::move(result));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+void VideoDecoderPlugin::StartDecoding(const std::string& url,
+                                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    try {
+        std::string prefix = "tcp://";
+        std::string url_str = url;
+        if (url.find(prefix) == 0) {
+            url_str = url.substr(prefix.length());
+        }
+        
+        size_t colon_pos = url_str.find(':');
+        if (colon_pos == std::string::npos) {
+            result->Error("INVALID_URL", "URL must be in format tcp://host:port");
+            return;
+        }
+
+        std::string host = url_str.substr(0, colon_pos);
+        int port = std::stoi(url_str.substr(colon_pos + 1));
+
+        // Events are delivered on the platform thread; the runner drops them
+        // once the plugin (and the channel) is gone.
+        auto runner = platform_runner_;
+        auto* channel = channel_.get();
+        SessionEventSink sink = [runner, channel](int64_t texture_id, flutter::EncodableMap event) {
+            if (!channel) return;
+            event[flutter::EncodableValue("textureId")] = flutter::EncodableValue(texture_id);
+            runner->Post([channel, event]() {
+                channel->InvokeMethod("onSessionEvent", std::make_unique<flutter::EncodableValue>(event));
+            });
+        };
+
+        if (decoder_hosts_) {
+            auto remote = RemoteSession::Create(texture_registrar_, decoder_hosts_->Pick(),
+                                                host + ":" + std::to_string(port), std::move(sink));
+            if (!remote) {
+                result->Error("TEXTURE_ERROR", "Failed to register texture");
+                return;
+            }
+            int64_t texture_id = remote->texture_id();
+            remote_sessions_[texture_id] = std::move(remote);
+            result->Success(flutter::EncodableValue(texture_id));
+            return;
+        }
+
+        auto session = std::make_unique<VideoSession>(texture_registrar_, host, port, std::move(sink));
+        int64_t texture_id = session->texture_id();
+        
+        if (texture_id == -1) {
+            result->Error("TEXTURE_ERROR", "Failed to register texture");
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            sessions_[texture_id] = std::move(session);
+        }
+
+        result->Success(flutter::EncodableValue(texture_id));
+    } catch (const std::exception& e) {
+        result->Error("START_ERROR", e.what());
+    }
+}
+
+void VideoDecoderPlugin::StopDecoding(int64_t texture_id) {
+    auto remote = remote_sessions_.find(texture_id);
+    if (remote != remote_sessions_.end()) {
+        remote->second->Stop();
+        remote_sessions_.erase(remote);
+        return;
+    }
+
+    auto state = FindSessionState(texture_id);
+    if (state) {
+        DetachFromAtlas(state);
+        RemoveOutput(state, -1);
+    }
+
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    auto it = sessions_.find(texture_id);
+    if (it != sessions_.end()) {
+        sessions_.erase(it);
+    }
+}
+
+void VideoDecoderPlugin::StopAllDecoding() {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (auto& entry : sessions_) {
+        if (entry.second && entry.second->state()) RemoveOutput(entry.second->state(), -1);
+    }
+    sessions_.clear();
+    for (auto& entry : remote_sessions_) entry.second->Stop();
+    remote_sessions_.clear();
+    for (auto& entry : time_shift_players_) entry.second->Unregister();
+    time_shift_players_.clear();
+    for (auto& page : atlas_pages_) page->Unregister();
+    atlas_pages_.clear();
+}
+
+void VideoDecoderPlugin::ReportMissingSession(int64_t texture_id,
+                                              flutter::MethodResult<flutter::EncodableValue>* result) {
+    // Hosted sessions only decode and display; they have no state here
+    if (remote_sessions_.count(texture_id)) {
+        result->Error("HOSTED_SESSION", "Not available for sessions decoded in a decoder host");
+        return;
+    }
+    result->Error("NO_SESSION", "No decoding session for texture");
+}
+
+std::shared_ptr<VideoDecoderPlugin::VideoSessionState> VideoDecoderPlugin::FindSessionState(int64_t texture_id) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    auto it = sessions_.find(texture_id);
+    if (it == sessions_.end() || !it->second) return nullptr;
+    return it->second->state();
+}
+
+void VideoDecoderPlugin::StartRecording(int64_t texture_id, const std::string& path,
+                                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+
+    AVCodecID codec_id = state->codec ? state->codec->id : AV_CODEC_ID_HEVC;
+    auto recorder = std::make_shared<StreamRecorder>(path, codec_id);
+    std::string error;
+    if (!recorder->Open(&error)) {
+        LogTrace("StartRecording [%lld] - Error: %s", texture_id, error.c_str());
+        result->Error("RECORD_ERROR", error);
+        return;
+    }
+
+    std::shared_ptr<StreamRecorder> previous;
+    {
+        std::lock_guard<std::mutex> lock(state->recorder_mutex);
+        // Before the first config packet the stream brings its own
+        if (!state->last_config.empty()) recorder->SetConfig(state->last_config);
+        previous = std::move(state->recorder);
+        state->recorder = recorder;
+    }
+    // The previous file, if any, is finished by its own writer thread
+    if (previous) StreamRecorder::StopAsync(previous);
+
+    LogTrace("StartRecording [%lld] - Recording to %s", texture_id, path.c_str());
+    result->Success(flutter::EncodableValue(true));
+}
+
+void VideoDecoderPlugin::StopRecording(int64_t texture_id,
+                                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    std::shared_ptr<StreamRecorder> recorder;
+    if (state) {
+        std::lock_guard<std::mutex> lock(state->recorder_mutex);
+        recorder = std::move(state->recorder);
+    }
+    if (!recorder) {
+        result->Success();
+        return;
+    }
+
+    // Draining the queue and writing the trailer is disk I/O, done by the
+    // recorder's writer thread
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result(std::move(result));
+    auto runner = platform_runner_;
+    std::string path = recorder->path();
+    StreamRecorder::StopAsync(recorder, [path, runner, shared_result](const StreamRecorder::Stats& stats) {
+        flutter::EncodableMap map;
+        map[flutter::EncodableValue("path")] = flutter::EncodableValue(path);
+        map[flutter::EncodableValue("packetsWritten")] = flutter::EncodableValue(stats.packets_written);
+        map[flutter::EncodableValue("packetsDropped")] = flutter::EncodableValue(stats.packets_dropped);
+        map[flutter::EncodableValue("bytesWritten")] = flutter::EncodableValue(stats.bytes_written);
+        map[flutter::EncodableValue("durationMs")] = flutter::EncodableValue(stats.duration_us / 1000);
+        map[flutter::EncodableValue("failed")] = flutter::EncodableValue(stats.failed);
+        runner->Post([shared_result, map]() { shared_result->Success(flutter::EncodableValue(map)); });
+    });
+}
+
+static flutter::EncodableMap RelayStatsMap(const StreamRelay::Stats& stats) {
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("port")] = flutter::EncodableValue(stats.port);
+    map[flutter::EncodableValue("viewers")] = flutter::EncodableValue(stats.viewers);
+    map[flutter::EncodableValue("viewersTotal")] = flutter::EncodableValue(stats.viewers_total);
+    map[flutter::EncodableValue("bytesSent")] = flutter::EncodableValue(stats.bytes_sent);
+    map[flutter::EncodableValue("gopsDropped")] = flutter::EncodableValue(stats.gops_dropped);
+    return map;
+}
+
+void VideoDecoderPlugin::StartRelay(int64_t texture_id, const std::string& address, int port,
+                                    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+
+    std::string error;
+    std::shared_ptr<StreamRelay> relay = StreamRelay::Start(address, port, &error);
+    if (!relay) {
+        LogTrace("StartRelay [%lld] - Error: %s", texture_id, error.c_str());
+        result->Error("RELAY_ERROR", error);
+        return;
+    }
+
+    std::shared_ptr<StreamRelay> previous;
+    {
+        std::lock_guard<std::mutex> lock(state->recorder_mutex);
+        if (!state->last_config.empty()) relay->SetConfig(state->last_config);
+        previous = std::move(state->relay);
+        state->relay = relay;
+    }
+    if (previous) previous->Stop();
+
+    LogTrace("StartRelay [%lld] - Serving on %s:%d", texture_id, address.c_str(), relay->port());
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("address")] = flutter::EncodableValue(address);
+    map[flutter::EncodableValue("port")] = flutter::EncodableValue(relay->port());
+    result->Success(flutter::EncodableValue(map));
+}
+
+void VideoDecoderPlugin::StopRelay(int64_t texture_id,
+                                   std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    std::shared_ptr<StreamRelay> relay;
+    if (state) {
+        std::lock_guard<std::mutex> lock(state->recorder_mutex);
+        relay = std::move(state->relay);
+    }
+    if (!relay) {
+        result->Success();
+        return;
+    }
+
+    relay->Stop();
+    result->Success(flutter::EncodableValue(RelayStatsMap(relay->GetStats())));
+}
+
+void VideoDecoderPlugin::AttachToAtlas(int64_t texture_id, bool atlas_only,
+                                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+
+    std::shared_ptr<TextureAtlas> atlas;
+    int slot = -1;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+        atlas = state->atlas;
+        slot = state->atlas_slot;
+        generation = state->atlas_generation;
+        state->atlas_only = atlas_only;
+    }
+    // Tiles are not paced, so an atlas-only session would hold the group's
+    // delay without being shown on its clock
+    if (atlas_only) state->pacer.SetSyncGroup(nullptr, texture_id);
+
+    if (!atlas) {
+        for (auto& page : atlas_pages_) {
+            slot = page->AcquireTile(&generation);
+            if (slot != -1) {
+                atlas = page;
+                break;
+            }
+        }
+    }
+    if (!atlas) {
+        atlas = TextureAtlas::Create(texture_registrar_, atlas_tile_width_, atlas_tile_height_, atlas_columns_,
+                                     atlas_rows_);
+        if (!atlas) {
+            result->Error("TEXTURE_ERROR", "Failed to register atlas texture");
+            return;
+        }
+        atlas_pages_.push_back(atlas);
+        slot = atlas->AcquireTile(&generation);
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+        state->atlas = atlas;
+        state->atlas_slot = slot;
+        state->atlas_generation = generation;
+    }
+    // The tile must be filled even if the screen is static
+    state->force_refresh = true;
+
+    auto rect = atlas->GetTileRect(slot);
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("atlasTextureId")] = flutter::EncodableValue(atlas->texture_id());
+    map[flutter::EncodableValue("atlasWidth")] = flutter::EncodableValue(atlas->width());
+    map[flutter::EncodableValue("atlasHeight")] = flutter::EncodableValue(atlas->height());
+    map[flutter::EncodableValue("x")] = flutter::EncodableValue(rect.x);
+    map[flutter::EncodableValue("y")] = flutter::EncodableValue(rect.y);
+    map[flutter::EncodableValue("width")] = flutter::EncodableValue(rect.width);
+    map[flutter::EncodableValue("height")] = flutter::EncodableValue(rect.height);
+    LogTrace("AttachToAtlas [%lld] - Page %lld slot %d", texture_id, atlas->texture_id(), slot);
+    result->Success(flutter::EncodableValue(map));
+}
+
+void VideoDecoderPlugin::DetachFromAtlas(const std::shared_ptr<VideoSessionState>& state) {
+    std::shared_ptr<TextureAtlas> atlas;
+    int slot = -1;
+    {
+        std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+        atlas = std::move(state->atlas);
+        slot = state->atlas_slot;
+        state->atlas_slot = -1;
+        state->atlas_generation = 0;
+        state->atlas_only = false;
+    }
+    if (!atlas) return;
+    // The full-size texture may be stale after atlas-only mode
+    state->force_refresh = true;
+
+    atlas->ReleaseTile(slot);
+    if (atlas->IsEmpty()) {
+        atlas->Unregister();
+        atlas_pages_.erase(std::remove(atlas_pages_.begin(), atlas_pages_.end(), atlas), atlas_pages_.end());
+    }
+}
+
+void VideoDecoderPlugin::AddOutput(int64_t texture_id, const SessionOutput::Config& config,
+                                   std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+
+    auto output = SessionOutput::Create(texture_registrar_, config);
+    if (!output) {
+        result->Error("TEXTURE_ERROR", "Failed to register output texture");
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state->outputs_mutex);
+        state->outputs.push_back(output);
+    }
+    // The new texture must be filled even if the screen is static
+    state->force_refresh = true;
+
+    LogTrace("AddOutput [%lld] - Output %lld, max %dx%d @ %d fps", texture_id, output->texture_id(),
+             config.max_width, config.max_height, config.max_fps);
+    result->Success(flutter::EncodableValue(output->texture_id()));
+}
+
+void VideoDecoderPlugin::RemoveOutput(const std::shared_ptr<VideoSessionState>& state, int64_t output_texture_id) {
+    std::vector<std::shared_ptr<SessionOutput>> removed;
+    {
+        std::lock_guard<std::mutex> lock(state->outputs_mutex);
+        auto split = std::stable_partition(state->outputs.begin(), state->outputs.end(), [&](const auto& output) {
+            return output_texture_id != -1 && output->texture_id() != output_texture_id;
+        });
+        removed.assign(split, state->outputs.end());
+        state->outputs.erase(split, state->outputs.end());
+    }
+    // Decode keeps running; conversions in flight finish into a dead texture
+    for (auto& output : removed) output->Unregister();
+}
+
+void VideoDecoderPlugin::StartFrameExport(int64_t texture_id, int slot_count, int max_edge,
+                                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(state->exporter_mutex);
+    if (state->exporter) {
+        result->Success(flutter::EncodableValue(state->exporter->name()));
+        return;
+    }
+    if (max_edge == 0) {
+        std::lock_guard<std::recursive_mutex> pixel_lock(state->pixel_buffer_mutex);
+        max_edge = std::max(state->width, state->height);
+    }
+    if (max_edge == 0) {
+        result->Error("NO_FRAME", "Stream size unknown yet; pass maxSize");
+        return;
+    }
+
+    std::string error;
+    auto exporter = FrameExporter::Create(texture_id, slot_count, max_edge, &error);
+    if (!exporter) {
+        LogTrace("StartFrameExport [%lld] - Error: %s", texture_id, error.c_str());
+        result->Error("EXPORT_ERROR", error);
+        return;
+    }
+    state->exporter = std::move(exporter);
+    // Readers get the current screen even if it is static
+    state->force_refresh = true;
+    result->Success(flutter::EncodableValue(state->exporter->name()));
+}
+
+void VideoDecoderPlugin::ConfigureTimeShift(int64_t texture_id, int seconds, int max_megabytes,
+                                            std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+
+    // A new window starts empty; it only fills from the next key frame
+    std::shared_ptr<TimeShiftBuffer> buffer;
+    if (seconds > 0) {
+        buffer = std::make_shared<TimeShiftBuffer>((int64_t)seconds * 1000000, (size_t)max_megabytes * 1024 * 1024);
+    }
+    std::shared_ptr<TimeShiftBuffer> previous;
+    {
+        std::lock_guard<std::mutex> lock(state->time_shift_mutex);
+        if (buffer) {
+            std::lock_guard<std::mutex> config_lock(state->recorder_mutex);
+            // An empty config would be stored as the one for the next GOP
+            if (!state->last_config.empty()) buffer->SetConfig(state->last_config);
+        }
+        previous = std::move(state->time_shift);
+        state->time_shift = buffer;
+    }
+    LogTrace("ConfigureTimeShift [%lld] - %d s, %d MB", texture_id, seconds, max_megabytes);
+    result->Success();
+}
+
+static std::shared_ptr<TimeShiftBuffer> GetTimeShift(
+    const std::shared_ptr<VideoDecoderPlugin::VideoSessionState>& state) {
+    std::lock_guard<std::mutex> lock(state->time_shift_mutex);
+    return state->time_shift;
+}
+
+void VideoDecoderPlugin::DumpTimeShift(int64_t texture_id, const std::string& path, int seconds,
+                                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    auto buffer = state ? GetTimeShift(state) : nullptr;
+    if (!buffer) {
+        result->Error("NO_TIME_SHIFT", "Time-shift is not enabled for texture");
+        return;
+    }
+
+    // Taken now: packets arriving while the file is written are not included
+    auto snapshot = std::make_shared<TimeShiftBuffer::Snapshot>(buffer->GetSnapshot((int64_t)seconds * 1000000));
+    AVCodecID codec_id = state->codec ? state->codec->id : AV_CODEC_ID_HEVC;
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result(std::move(result));
+    auto runner = platform_runner_;
+    // Waits on the disk for as long as the window takes to write
+    WorkerPool::GetFileInstance().Post([=]() {
+        StreamRecorder::Stats stats;
+        std::string error;
+        bool ok = TimeShiftBuffer::Dump(*snapshot, path, codec_id, &stats, &error);
+        if (!ok) LogTrace("DumpTimeShift [%lld] - Error: %s", texture_id, error.c_str());
+        runner->Post([=]() {
+            if (!ok) {
+                shared_result->Error("DUMP_ERROR", error);
+                return;
+            }
+            flutter::EncodableMap map;
+            map[flutter::EncodableValue("path")] = flutter::EncodableValue(path);
+            map[flutter::EncodableValue("packetsWritten")] = flutter::EncodableValue(stats.packets_written);
+            map[flutter::EncodableValue("bytesWritten")] = flutter::EncodableValue(stats.bytes_written);
+            map[flutter::EncodableValue("durationMs")] = flutter::EncodableValue(stats.duration_us / 1000);
+            shared_result->Success(flutter::EncodableValue(map));
+        });
+    });
+}
+
+void VideoDecoderPlugin::OpenTimeShiftPlayer(int64_t texture_id, int seconds, int max_size,
+                                             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    auto buffer = state ? GetTimeShift(state) : nullptr;
+    if (!buffer) {
+        result->Error("NO_TIME_SHIFT", "Time-shift is not enabled for texture");
+        return;
+    }
+
+    AVCodecID codec_id = state->codec ? state->codec->id : AV_CODEC_ID_HEVC;
+    auto player = TimeShiftPlayer::Create(texture_registrar_, buffer->GetSnapshot((int64_t)seconds * 1000000),
+                                          codec_id, max_size);
+    if (!player) {
+        result->Error("NO_FRAME", "Time-shift window is empty or the texture could not be registered");
+        return;
+    }
+    time_shift_players_[player->texture_id()] = player;
+
+    const auto& snapshot = player->snapshot();
+    flutter::EncodableList key_frames;
+    for (const auto& gop : snapshot) key_frames.push_back(flutter::EncodableValue(gop->start_pts_us()));
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("playerTextureId")] = flutter::EncodableValue(player->texture_id());
+    map[flutter::EncodableValue("startPtsUs")] = flutter::EncodableValue(snapshot.front()->start_pts_us());
+    map[flutter::EncodableValue("endPtsUs")] = flutter::EncodableValue(snapshot.back()->end_pts_us());
+    map[flutter::EncodableValue("keyFramePtsUs")] = flutter::EncodableValue(key_frames);
+    LogTrace("OpenTimeShiftPlayer [%lld] - Player %lld, %zu GOPs", texture_id, player->texture_id(),
+             snapshot.size());
+    result->Success(flutter::EncodableValue(map));
+}
+
+void VideoDecoderPlugin::SeekTimeShiftPlayer(int64_t player_texture_id, int64_t pts_us,
+                                             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto it = time_shift_players_.find(player_texture_id);
+    if (it == time_shift_players_.end()) {
+        result->Error("NO_PLAYER", "No time-shift player for texture");
+        return;
+    }
+
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result(std::move(result));
+    auto runner = platform_runner_;
+    it->second->Seek(pts_us, [shared_result, runner](int64_t shown_pts_us) {
+        runner->Post([shared_result, shown_pts_us]() {
+            // Null when a newer seek replaced this one before it ran
+            if (shown_pts_us < 0) {
+                shared_result->Success();
+            } else {
+                shared_result->Success(flutter::EncodableValue(shown_pts_us));
+            }
+        });
+    });
+}
+
+void VideoDecoderPlugin::CloseTimeShiftPlayer(int64_t player_texture_id) {
+    auto it = time_shift_players_.find(player_texture_id);
+    if (it == time_shift_players_.end()) return;
+    // A seek in flight keeps the player alive until it finishes
+    it->second->Unregister();
+    time_shift_players_.erase(it);
+}
+
+void VideoDecoderPlugin::ConfigureAnalysis(const flutter::EncodableMap* arguments,
+                                           std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    const auto* tid = FindArgument(arguments, "textureId");
+    auto state = tid ? FindSessionState(tid->LongValue()) : nullptr;
+    if (!state) {
+        ReportMissingSession(tid ? tid->LongValue() : -1, result.get());
+        return;
+    }
+
+    std::vector<std::unique_ptr<FrameAnalyzer>> analyzers;
+    const auto* configs = FindArgument(arguments, "analyzers");
+    if (configs && std::holds_alternative<flutter::EncodableList>(*configs)) {
+        for (const auto& config : std::get<flutter::EncodableList>(*configs)) {
+            const auto* map = std::get_if<flutter::EncodableMap>(&config);
+            std::string error = "Analyzer config must be a map";
+            auto analyzer = map ? CreateFrameAnalyzer(*map, &error) : nullptr;
+            if (!analyzer) {
+                result->Error("INVALID_ARGS", error);
+                return;
+            }
+            analyzers.push_back(std::move(analyzer));
+        }
+    }
+
+    std::shared_ptr<FrameAnalysisHost> host;
+    if (!analyzers.empty()) {
+        int64_t texture_id = state->texture_id;
+        auto sink = state->event_sink;
+        host = std::make_shared<FrameAnalysisHost>(
+            std::move(analyzers), IntArgument(arguments, "intervalMs", 200), IntArgument(arguments, "downsample", 2),
+            [sink, texture_id](flutter::EncodableMap event) {
+                if (sink) sink(texture_id, std::move(event));
+            });
+    }
+
+    std::shared_ptr<FrameAnalysisHost> previous;
+    {
+        std::lock_guard<std::mutex> lock(state->analysis_mutex);
+        previous = std::move(state->analysis);
+        state->analysis = host;
+    }
+    if (previous) previous->Stop();
+    result->Success();
+}
+
+void VideoDecoderPlugin::GetFrameHash(int64_t texture_id,
+                                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+    auto current = state->frame_hash->Current();
+    if (!current.has_hash) {
+        result->Success();
+        return;
+    }
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("hash")] = flutter::EncodableValue(FrameHash::ToHex(current.hash));
+    map[flutter::EncodableValue("ptsUs")] = flutter::EncodableValue(current.pts_us);
+    map[flutter::EncodableValue("ageMs")] = flutter::EncodableValue(current.elapsed_ms);
+    result->Success(flutter::EncodableValue(map));
+}
+
+void VideoDecoderPlugin::WaitForFrameHash(int64_t texture_id, uint64_t reference, int max_distance, int timeout_ms,
+                                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result(std::move(result));
+    auto runner = platform_runner_;
+    state->frame_hash->Wait(reference, max_distance, std::chrono::milliseconds(timeout_ms),
+                            [runner, shared_result](const FrameHashWatch::Result& outcome) {
+        flutter::EncodableMap map;
+        map[flutter::EncodableValue("matched")] = flutter::EncodableValue(outcome.matched);
+        map[flutter::EncodableValue("hash")] = outcome.has_hash
+            ? flutter::EncodableValue(FrameHash::ToHex(outcome.hash)) : flutter::EncodableValue();
+        map[flutter::EncodableValue("distance")] = flutter::EncodableValue(outcome.distance);
+        map[flutter::EncodableValue("ptsUs")] = flutter::EncodableValue(outcome.pts_us);
+        map[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue(outcome.elapsed_ms);
+        runner->Post([shared_result, map]() { shared_result->Success(flutter::EncodableValue(map)); });
+    });
+}
+
+void VideoDecoderPlugin::RunPlacementBenchmark(int threads, int seconds, int width, int height,
+                                               std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    if (benchmark_running_) {
+        result->Error("BUSY", "A placement benchmark is already running");
+        return;
+    }
+    // A finished run's thread has ended or is about to
+    if (benchmark_thread_.joinable()) benchmark_thread_.join();
+
+    // Each thread converts its own I420 frame into its own RGBA buffer
+    int64_t thread_bytes = (int64_t)width * height * 3 / 2 + (int64_t)width * height * 4;
+    threads = (int)std::min<int64_t>(threads, std::max<int64_t>(1, kMaxBenchmarkBytes / thread_bytes));
+
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result(std::move(result));
+    auto runner = platform_runner_;
+    auto* running = &benchmark_running_;
+    auto* cancelled = &benchmark_cancelled_;
+    benchmark_running_ = true;
+    // Not on the worker pool, which it would hold for up to a minute
+    benchmark_thread_ = std::thread([=]() {
+        auto benchmark = PlacementBenchmark::Run(threads, width, height, std::chrono::seconds(seconds), cancelled);
+        LogTrace("PlacementBenchmark - %d threads: %.1f fps unpinned, %.1f fps pinned", benchmark.threads,
+                 benchmark.unpinned_fps, benchmark.pinned_fps);
+        *running = false;
+        runner->Post([=]() {
+            flutter::EncodableMap map;
+            map[flutter::EncodableValue("threads")] = flutter::EncodableValue(benchmark.threads);
+            map[flutter::EncodableValue("unpinnedFps")] = flutter::EncodableValue(benchmark.unpinned_fps);
+            map[flutter::EncodableValue("pinnedFps")] = flutter::EncodableValue(benchmark.pinned_fps);
+            map[flutter::EncodableValue("speedup")] = flutter::EncodableValue(
+                benchmark.unpinned_fps > 0 ? benchmark.pinned_fps / benchmark.unpinned_fps : 0.0);
+            shared_result->Success(flutter::EncodableValue(map));
+        });
+    });
+}
+
+void VideoDecoderPlugin::ConfigureDecoderHosts(
+    int count, std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    if (count == (decoder_hosts_ ? decoder_hosts_->size() : 0)) {
+        result->Success();
+        return;
+    }
+    if (!remote_sessions_.empty()) {
+        result->Error("BUSY", "Stop the sessions running in decoder hosts first");
+        return;
+    }
+    decoder_hosts_.reset();
+    if (count > 0) {
+        // Installed next to the runner executable
+        wchar_t module_path[MAX_PATH];
+        DWORD length = GetModuleFileNameW(nullptr, module_path, MAX_PATH);
+        std::wstring executable(module_path, length);
+        executable = executable.substr(0, executable.find_last_of(L"\\/") + 1) + L"scraki_decoder_host.exe";
+        if (GetFileAttributesW(executable.c_str()) == INVALID_FILE_ATTRIBUTES) {
+            result->Error("NO_HOST", "scraki_decoder_host.exe not found next to the app");
+            return;
+        }
+        decoder_hosts_ = std::make_unique<DecoderHostPool>(executable, count);
+    }
+    LogTrace("Plugin - Decoder hosts: %d", count);
+    result->Success();
 }
 
-void VideoDecoderPlugin::StartDecoding(const std::string& url,
-                                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-    try {
-        std::string prefix = "tcp://";
-        std::string url_str = url;
-        if (url.find(prefix) == 0) {
-            url_str = url.substr(prefix.length());
+void VideoDecoderPlugin::ReplayInputScript(const flutter::EncodableMap* arguments,
+                                           std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    const auto* script_bytes = FindArgument(arguments, "script");
+    const auto* target_list = FindArgument(arguments, "targets");
+    if (!script_bytes || !std::holds_alternative<std::vector<uint8_t>>(*script_bytes) || !target_list ||
+        !std::holds_alternative<flutter::EncodableList>(*target_list)) {
+        result->Error("INVALID_ARGS", "Missing script or targets parameter");
+        return;
+    }
+    std::string error;
+    std::shared_ptr<const InputScript> script =
+        InputScript::Parse(std::get<std::vector<uint8_t>>(*script_bytes), &error);
+    if (!script) {
+        result->Error("INVALID_ARGS", error);
+        return;
+    }
+
+    std::vector<InputReplayer::Target> targets;
+    for (const auto& entry : std::get<flutter::EncodableList>(*target_list)) {
+        const auto* map = std::get_if<flutter::EncodableMap>(&entry);
+        InputReplayer::Target target;
+        target.control_port = IntArgument(map, "controlPort", 0);
+        target.width = IntArgument(map, "width", 0);
+        target.height = IntArgument(map, "height", 0);
+        // Without an explicit size, the session's decoded one
+        const auto* tid = FindArgument(map, "textureId");
+        auto state = tid && target.width <= 0 ? FindSessionState(tid->LongValue()) : nullptr;
+        if (state) {
+            target.width = state->width;
+            target.height = state->height;
         }
-        
-        size_t colon_pos = url_str.find(':');
-        if (colon_pos == std::string::npos) {
-            result->Error("INVALID_URL", "URL must be in format tcp://host:port");
+        if (target.control_port <= 0) {
+            result->Error("INVALID_ARGS", "Every target needs a controlPort");
             return;
         }
+        targets.push_back(target);
+    }
+    const auto* speed_value = FindArgument(arguments, "speed");
+    const double* speed = speed_value ? std::get_if<double>(speed_value) : nullptr;
+
+    input_replays_.erase(std::remove_if(input_replays_.begin(), input_replays_.end(),
+                                        [](const auto& replay) { return replay->finished(); }),
+                         input_replays_.end());
+
+    auto runner = platform_runner_;
+    auto shared_result =
+        std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+    LogTrace("Plugin - Replaying %zu input messages (%lld ms) to %zu targets", script->messages().size(),
+             script->duration_us() / 1000, targets.size());
+    input_replays_.push_back(std::make_unique<InputReplayer>(
+        script, std::move(targets), speed ? *speed : 1.0, [runner, shared_result](const InputReplayer::Report& report) {
+            flutter::EncodableMap map;
+            map[flutter::EncodableValue("targets")] = flutter::EncodableValue(report.targets);
+            map[flutter::EncodableValue("targetsConnected")] = flutter::EncodableValue(report.targets_connected);
+            map[flutter::EncodableValue("messages")] = flutter::EncodableValue(report.messages);
+            map[flutter::EncodableValue("messagesSent")] = flutter::EncodableValue(report.messages_sent);
+            map[flutter::EncodableValue("sendErrors")] = flutter::EncodableValue(report.send_errors);
+            map[flutter::EncodableValue("meanErrorUs")] = flutter::EncodableValue(report.mean_error_us);
+            map[flutter::EncodableValue("p99ErrorUs")] = flutter::EncodableValue(report.p99_error_us);
+            map[flutter::EncodableValue("maxErrorUs")] = flutter::EncodableValue(report.max_error_us);
+            map[flutter::EncodableValue("maxFanOutUs")] = flutter::EncodableValue(report.max_fan_out_us);
+            map[flutter::EncodableValue("durationMs")] = flutter::EncodableValue(report.duration_ms);
+            map[flutter::EncodableValue("cancelled")] = flutter::EncodableValue(report.cancelled);
+            runner->Post([shared_result, map]() { shared_result->Success(flutter::EncodableValue(map)); });
+        }));
+}
 
-        std::string host = url_str.substr(0, colon_pos);
-        int port = std::stoi(url_str.substr(colon_pos + 1));
-
-        auto session = std::make_unique<VideoSession>(texture_registrar_, host, port);
-        int64_t texture_id = session->texture_id();
-        
-        if (texture_id == -1) {
-            result->Error("TEXTURE_ERROR", "Failed to register texture");
-            return;
+void VideoDecoderPlugin::GetStats(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    std::vector<std::shared_ptr<VideoSessionState>> states;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& entry : sessions_) {
+            if (entry.second && entry.second->state()) states.push_back(entry.second->state());
         }
+    }
 
+    flutter::EncodableMap sessions;
+    // Decode cost of in-process and hosted sessions side by side
+    int in_process_count = 0;
+    double in_process_decode_ms = 0;
+    double in_process_latency_ms = 0;
+    for (auto& state : states) {
+        auto pacing = state->pacer.GetStats();
+        flutter::EncodableMap session;
+        session[flutter::EncodableValue("width")] = flutter::EncodableValue(state->width);
+        session[flutter::EncodableValue("height")] = flutter::EncodableValue(state->height);
+        session[flutter::EncodableValue("framesDecoded")] = flutter::EncodableValue(state->frames_decoded.load());
+        session[flutter::EncodableValue("framesPresented")] = flutter::EncodableValue(state->frames_presented.load());
+        session[flutter::EncodableValue("framesDropped")] = flutter::EncodableValue(state->frames_dropped.load());
+        session[flutter::EncodableValue("framesUnchanged")] = flutter::EncodableValue(state->frames_unchanged.load());
+        session[flutter::EncodableValue("idle")] = flutter::EncodableValue(state->screen_idle.load());
+        session[flutter::EncodableValue("priority")] = flutter::EncodableValue(QosGovernor::PriorityName(state->priority));
+        session[flutter::EncodableValue("qosLevel")] = flutter::EncodableValue(state->qos_level.load());
+        session[flutter::EncodableValue("cpuCore")] = flutter::EncodableValue(state->cpu_core.load());
+        session[flutter::EncodableValue("cpuNode")] = flutter::EncodableValue(state->cpu_node.load());
+        session[flutter::EncodableValue("framesThrottled")] = flutter::EncodableValue(state->frames_throttled.load());
+        session[flutter::EncodableValue("framesSkipped")] = flutter::EncodableValue(state->frames_skipped.load());
+        session[flutter::EncodableValue("configChanges")] = flutter::EncodableValue(state->config_changes.load());
+        session[flutter::EncodableValue("recovering")] = flutter::EncodableValue(state->recovering.load());
+        session[flutter::EncodableValue("lossIncidents")] = flutter::EncodableValue(state->loss_incidents.load());
+        session[flutter::EncodableValue("lastRecoveryMs")] = flutter::EncodableValue(state->last_recovery_ms.load());
+        session[flutter::EncodableValue("maxRecoveryMs")] = flutter::EncodableValue(state->max_recovery_ms.load());
+        auto frame_hash = state->frame_hash->Current();
+        if (frame_hash.has_hash) {
+            session[flutter::EncodableValue("frameHash")] = flutter::EncodableValue(FrameHash::ToHex(frame_hash.hash));
+        }
+        auto health = state->health.GetSnapshot();
+        if (health.frame_latency_ms > 0) {
+            in_process_count++;
+            in_process_decode_ms += health.decode_ms;
+            in_process_latency_ms += health.frame_latency_ms;
+        }
+        flutter::EncodableMap health_map;
+        health_map[flutter::EncodableValue("inputFps")] = flutter::EncodableValue(health.input_fps);
+        health_map[flutter::EncodableValue("inputBitRate")] = flutter::EncodableValue(health.input_bit_rate);
+        health_map[flutter::EncodableValue("decodeMs")] = flutter::EncodableValue(health.decode_ms);
+        health_map[flutter::EncodableValue("frameLatencyMs")] = flutter::EncodableValue(health.frame_latency_ms);
+        health_map[flutter::EncodableValue("dropRate")] = flutter::EncodableValue(health.drop_rate);
+        health_map[flutter::EncodableValue("queueDepth")] = flutter::EncodableValue(health.queue_depth);
+        health_map[flutter::EncodableValue("socketBacklog")] = flutter::EncodableValue(health.socket_backlog);
+        health_map[flutter::EncodableValue("overloaded")] = flutter::EncodableValue(health.overloaded);
+        health_map[flutter::EncodableValue("underused")] = flutter::EncodableValue(health.underused);
+        health_map[flutter::EncodableValue("recommendedMaxFps")] = flutter::EncodableValue(health.recommended_max_fps);
+        health_map[flutter::EncodableValue("recommendedMaxSize")] = flutter::EncodableValue(health.recommended_max_size);
+        health_map[flutter::EncodableValue("maxDimension")] = flutter::EncodableValue(health.max_dimension);
+        health_map[flutter::EncodableValue("recommendedBitRate")] = flutter::EncodableValue(health.recommended_bit_rate);
+        session[flutter::EncodableValue("health")] = flutter::EncodableValue(health_map);
+        auto activity = state->activity.GetSnapshot(std::chrono::steady_clock::now());
+        flutter::EncodableMap activity_map;
+        activity_map[flutter::EncodableValue("score")] = flutter::EncodableValue(activity.score);
+        activity_map[flutter::EncodableValue("sizeRatio")] = flutter::EncodableValue(activity.size_ratio);
+        session[flutter::EncodableValue("activity")] = flutter::EncodableValue(activity_map);
+        flutter::EncodableList outputs;
         {
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            sessions_[texture_id] = std::move(session);
+            std::lock_guard<std::mutex> lock(state->outputs_mutex);
+            for (auto& output : state->outputs) {
+                auto output_stats = output->GetStats();
+                flutter::EncodableMap output_map;
+                output_map[flutter::EncodableValue("textureId")] = flutter::EncodableValue(output->texture_id());
+                output_map[flutter::EncodableValue("width")] = flutter::EncodableValue(output_stats.width);
+                output_map[flutter::EncodableValue("height")] = flutter::EncodableValue(output_stats.height);
+                output_map[flutter::EncodableValue("framesPresented")] =
+                    flutter::EncodableValue(output_stats.frames_presented);
+                output_map[flutter::EncodableValue("framesSkipped")] =
+                    flutter::EncodableValue(output_stats.frames_skipped);
+                outputs.push_back(flutter::EncodableValue(output_map));
+            }
+        }
+        session[flutter::EncodableValue("outputs")] = flutter::EncodableValue(outputs);
+        {
+            std::lock_guard<std::mutex> lock(state->analysis_mutex);
+            if (state->analysis) {
+                flutter::EncodableMap analysis_map;
+                analysis_map[flutter::EncodableValue("framesAnalyzed")] =
+                    flutter::EncodableValue(state->analysis->frames_analyzed());
+                analysis_map[flutter::EncodableValue("averageMs")] =
+                    flutter::EncodableValue(state->analysis->average_ms());
+                session[flutter::EncodableValue("analysis")] = flutter::EncodableValue(analysis_map);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->recorder_mutex);
+            if (state->relay) {
+                session[flutter::EncodableValue("relay")] =
+                    flutter::EncodableValue(RelayStatsMap(state->relay->GetStats()));
+            }
         }
+        if (auto time_shift = GetTimeShift(state)) {
+            auto time_shift_stats = time_shift->GetStats();
+            flutter::EncodableMap time_shift_map;
+            time_shift_map[flutter::EncodableValue("bytes")] = flutter::EncodableValue(time_shift_stats.bytes);
+            time_shift_map[flutter::EncodableValue("durationMs")] =
+                flutter::EncodableValue(time_shift_stats.duration_us / 1000);
+            time_shift_map[flutter::EncodableValue("gops")] = flutter::EncodableValue(time_shift_stats.gops);
+            time_shift_map[flutter::EncodableValue("overflows")] = flutter::EncodableValue(time_shift_stats.overflows);
+            session[flutter::EncodableValue("timeShift")] = flutter::EncodableValue(time_shift_map);
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->exporter_mutex);
+            if (state->exporter) {
+                flutter::EncodableMap export_map;
+                export_map[flutter::EncodableValue("name")] = flutter::EncodableValue(state->exporter->name());
+                export_map[flutter::EncodableValue("framesWritten")] =
+                    flutter::EncodableValue(state->exporter->frames_written());
+                export_map[flutter::EncodableValue("framesSkipped")] =
+                    flutter::EncodableValue(state->exporter->frames_skipped());
+                session[flutter::EncodableValue("frameExport")] = flutter::EncodableValue(export_map);
+            }
+        }
+        session[flutter::EncodableValue("connected")] = flutter::EncodableValue(state->connected.load());
+        session[flutter::EncodableValue("reconnects")] = flutter::EncodableValue(state->reconnects.load());
+        session[flutter::EncodableValue("lastReconnectMs")] = flutter::EncodableValue(state->last_reconnect_ms.load());
+        session[flutter::EncodableValue("presentationDelayMs")] = flutter::EncodableValue(pacing.effective_delay_ms);
+        session[flutter::EncodableValue("jitterMs")] = flutter::EncodableValue(pacing.jitter_ms);
+        session[flutter::EncodableValue("addedLatencyMs")] = flutter::EncodableValue(pacing.added_latency_ms);
+        if (auto group = state->pacer.sync_group()) {
+            session[flutter::EncodableValue("syncGroup")] = flutter::EncodableValue(group->name());
+            session[flutter::EncodableValue("syncErrorMs")] = flutter::EncodableValue(pacing.sync_error_ms);
+        }
+        sessions[flutter::EncodableValue(state->texture_id)] = flutter::EncodableValue(session);
+    }
+    int hosted_count = 0;
+    double hosted_decode_ms = 0;
+    double hosted_handoff_ms = 0;
+    for (auto& entry : remote_sessions_) {
+        auto remote_stats = entry.second->GetStats();
+        auto host_stats = entry.second->host()->GetStats();
+        flutter::EncodableMap session;
+        session[flutter::EncodableValue("isolated")] = flutter::EncodableValue(true);
+        session[flutter::EncodableValue("width")] = flutter::EncodableValue(remote_stats.width);
+        session[flutter::EncodableValue("height")] = flutter::EncodableValue(remote_stats.height);
+        session[flutter::EncodableValue("framesPresented")] = flutter::EncodableValue(remote_stats.frames_presented);
+        session[flutter::EncodableValue("framesMissed")] = flutter::EncodableValue(remote_stats.frames_missed);
+        session[flutter::EncodableValue("decodeMs")] = flutter::EncodableValue(remote_stats.decode_ms);
+        session[flutter::EncodableValue("handoffMs")] = flutter::EncodableValue(remote_stats.handoff_ms);
+        if (remote_stats.decode_ms > 0) {
+            hosted_count++;
+            hosted_decode_ms += remote_stats.decode_ms;
+            hosted_handoff_ms += remote_stats.handoff_ms;
+        }
+        session[flutter::EncodableValue("hostPid")] = flutter::EncodableValue(static_cast<int64_t>(host_stats.pid));
+        session[flutter::EncodableValue("hostRestarts")] = flutter::EncodableValue(host_stats.restarts);
+        sessions[flutter::EncodableValue(entry.first)] = flutter::EncodableValue(session);
+    }
+    // frameLatencyMs compares the two: latest packet received to a frame
+    // ready for the texture, before any pacing hold in-process, and including
+    // the hand-off to the app for hosted sessions
+    flutter::EncodableMap in_process_path;
+    in_process_path[flutter::EncodableValue("sessions")] = flutter::EncodableValue(in_process_count);
+    in_process_path[flutter::EncodableValue("decodeMs")] =
+        flutter::EncodableValue(in_process_count ? in_process_decode_ms / in_process_count : 0);
+    in_process_path[flutter::EncodableValue("frameLatencyMs")] =
+        flutter::EncodableValue(in_process_count ? in_process_latency_ms / in_process_count : 0);
+    flutter::EncodableMap hosted_path;
+    hosted_path[flutter::EncodableValue("sessions")] = flutter::EncodableValue(hosted_count);
+    double hosted_decode_mean = hosted_count ? hosted_decode_ms / hosted_count : 0;
+    double hosted_handoff_mean = hosted_count ? hosted_handoff_ms / hosted_count : 0;
+    hosted_path[flutter::EncodableValue("decodeMs")] = flutter::EncodableValue(hosted_decode_mean);
+    hosted_path[flutter::EncodableValue("handoffMs")] = flutter::EncodableValue(hosted_handoff_mean);
+    hosted_path[flutter::EncodableValue("frameLatencyMs")] =
+        flutter::EncodableValue(hosted_decode_mean + hosted_handoff_mean);
+    flutter::EncodableMap decode_paths;
+    decode_paths[flutter::EncodableValue("inProcess")] = flutter::EncodableValue(in_process_path);
+    decode_paths[flutter::EncodableValue("hosted")] = flutter::EncodableValue(hosted_path);
+
+    flutter::EncodableList decoder_hosts;
+    if (decoder_hosts_) {
+        for (auto& host_stats : decoder_hosts_->GetStats()) {
+            flutter::EncodableMap host;
+            host[flutter::EncodableValue("pid")] = flutter::EncodableValue(static_cast<int64_t>(host_stats.pid));
+            host[flutter::EncodableValue("sessions")] = flutter::EncodableValue(host_stats.sessions);
+            host[flutter::EncodableValue("restarts")] = flutter::EncodableValue(host_stats.restarts);
+            decoder_hosts.push_back(flutter::EncodableValue(host));
+        }
+    }
 
-        result->Success(flutter::EncodableValue(texture_id));
-    } catch (const std::exception& e) {
-        result->Error("START_ERROR", e.what());
+    auto pool_stats = SessionPool::GetInstance().GetStats();
+    flutter::EncodableMap pool;
+    pool[flutter::EncodableValue("idleDecoders")] = flutter::EncodableValue(pool_stats.idle_decoders);
+    pool[flutter::EncodableValue("idleWorkers")] = flutter::EncodableValue(pool_stats.idle_workers);
+    pool[flutter::EncodableValue("hits")] = flutter::EncodableValue(pool_stats.hits);
+    pool[flutter::EncodableValue("misses")] = flutter::EncodableValue(pool_stats.misses);
+    pool[flutter::EncodableValue("ttffSamples")] = flutter::EncodableValue(pool_stats.ttff_samples);
+    pool[flutter::EncodableValue("ttffP50Ms")] = flutter::EncodableValue(pool_stats.ttff_p50_ms);
+    pool[flutter::EncodableValue("ttffP99Ms")] = flutter::EncodableValue(pool_stats.ttff_p99_ms);
+
+    auto qos_stats = QosGovernor::GetInstance().GetStats();
+    flutter::EncodableMap levels;
+    for (int p = 0; p < QosGovernor::kPriorityCount; ++p) {
+        levels[flutter::EncodableValue(QosGovernor::PriorityName(p))] = flutter::EncodableValue(qos_stats.levels[p]);
+    }
+    flutter::EncodableMap qos;
+    qos[flutter::EncodableValue("budgetPercent")] = flutter::EncodableValue(qos_stats.budget_percent);
+    qos[flutter::EncodableValue("cpuPercent")] = flutter::EncodableValue(qos_stats.cpu_percent);
+    qos[flutter::EncodableValue("levels")] = flutter::EncodableValue(levels);
+    qos[flutter::EncodableValue("adjustments")] = flutter::EncodableValue(qos_stats.adjustments);
+
+    auto& topology = CpuTopology::GetInstance();
+    flutter::EncodableMap cpu;
+    cpu[flutter::EncodableValue("cores")] = flutter::EncodableValue(static_cast<int>(topology.cores().size()));
+    cpu[flutter::EncodableValue("nodes")] = flutter::EncodableValue(topology.node_count());
+    cpu[flutter::EncodableValue("performanceCores")] = flutter::EncodableValue(topology.performance_cores());
+    cpu[flutter::EncodableValue("hybrid")] = flutter::EncodableValue(topology.hybrid());
+    cpu[flutter::EncodableValue("pinning")] = flutter::EncodableValue(topology.pinning());
+
+    auto notifier_stats = FrameNotifier::GetInstance().GetStats();
+    flutter::EncodableMap notifier;
+    notifier[flutter::EncodableValue("requestsPerSecond")] =
+        flutter::EncodableValue(notifier_stats.requests_per_second);
+    notifier[flutter::EncodableValue("postsPerSecond")] = flutter::EncodableValue(notifier_stats.posts_per_second);
+    notifier[flutter::EncodableValue("averageDelayMs")] = flutter::EncodableValue(notifier_stats.average_delay_ms);
+    notifier[flutter::EncodableValue("maxDelayMs")] = flutter::EncodableValue(notifier_stats.max_delay_ms);
+    notifier[flutter::EncodableValue("refreshHz")] = flutter::EncodableValue(notifier_stats.refresh_hz);
+    notifier[flutter::EncodableValue("requests")] = flutter::EncodableValue(notifier_stats.requests);
+    notifier[flutter::EncodableValue("posts")] = flutter::EncodableValue(notifier_stats.posts);
+
+    flutter::EncodableMap map;
+    map[flutter::EncodableValue("sessions")] = flutter::EncodableValue(sessions);
+    map[flutter::EncodableValue("cpu")] = flutter::EncodableValue(cpu);
+    map[flutter::EncodableValue("frameNotifier")] = flutter::EncodableValue(notifier);
+    map[flutter::EncodableValue("qos")] = flutter::EncodableValue(qos);
+    map[flutter::EncodableValue("pool")] = flutter::EncodableValue(pool);
+    map[flutter::EncodableValue("decoderHosts")] = flutter::EncodableValue(decoder_hosts);
+    map[flutter::EncodableValue("decodePaths")] = flutter::EncodableValue(decode_paths);
+    flutter::EncodableMap sync_groups;
+    for (const auto& entry : sync_groups_) {
+        auto group = entry.second.lock();
+        if (!group) continue;
+        auto group_stats = group->GetStats();
+        flutter::EncodableMap group_map;
+        group_map[flutter::EncodableValue("members")] = flutter::EncodableValue(group_stats.members);
+        group_map[flutter::EncodableValue("delayMs")] = flutter::EncodableValue(group_stats.delay_ms);
+        group_map[flutter::EncodableValue("skewMs")] = flutter::EncodableValue(group_stats.skew_ms);
+        group_map[flutter::EncodableValue("maxErrorMs")] = flutter::EncodableValue(group_stats.max_error_ms);
+        sync_groups[flutter::EncodableValue(entry.first)] = flutter::EncodableValue(group_map);
     }
+    map[flutter::EncodableValue("syncGroups")] = flutter::EncodableValue(sync_groups);
+    map[flutter::EncodableValue("activeSessions")] = flutter::EncodableValue(g_active_sessions.load());
+    map[flutter::EncodableValue("timeShiftBytes")] = flutter::EncodableValue(TimeShiftBuffer::total_bytes());
+    map[flutter::EncodableValue("activeBuffers")] = flutter::EncodableValue(g_active_buffers.load());
+    map[flutter::EncodableValue("totalPixelsAllocated")] = flutter::EncodableValue(g_total_pixels_allocated.load());
+    result->Success(flutter::EncodableValue(map));
 }
 
-void VideoDecoderPlugin::StopDecoding(int64_t texture_id) {
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    auto it = sessions_.find(texture_id);
-    if (it != sessions_.end()) {
-        sessions_.erase(it);
+// Takes a reference to the newest full-size frame. The decoder never reuses
+// a buffer that is still referenced, so no copy and no waiting is needed.
+static FrameSnapshot SnapshotFrontBuffer(const std::shared_ptr<VideoDecoderPlugin::VideoSessionState>& state) {
+    std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+    // Atlas-only sessions stop refreshing their full-size buffer
+    if (state->atlas && state->atlas_only) return nullptr;
+    return state->front_buffer;
+}
+
+void VideoDecoderPlugin::CaptureFrame(int64_t texture_id, FrameEncoder::Format format, int max_size, int quality,
+                                      const std::string& path,
+                                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    auto state = FindSessionState(texture_id);
+    if (!state) {
+        ReportMissingSession(texture_id, result.get());
+        return;
+    }
+    FrameSnapshot snapshot = SnapshotFrontBuffer(state);
+    if (!snapshot) {
+        result->Error("NO_FRAME", "No full-size frame available");
+        return;
     }
+
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result(std::move(result));
+    auto runner = platform_runner_;
+    WorkerPool::GetInstance().Post([=]() {
+        auto map = std::make_shared<flutter::EncodableMap>(
+            EncodeSnapshot(texture_id, snapshot, format, max_size, quality, path));
+        runner->Post([shared_result, map]() {
+            auto error = map->find(flutter::EncodableValue("error"));
+            if (error != map->end()) {
+                shared_result->Error("CAPTURE_ERROR", std::get<std::string>(error->second));
+            } else {
+                shared_result->Success(flutter::EncodableValue(*map));
+            }
+        });
+    });
 }
 
-void VideoDecoderPlugin::StopAllDecoding() {
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    sessions_.clear();
+void VideoDecoderPlugin::CaptureAllFrames(FrameEncoder::Format format, int max_size, int quality,
+                                          const std::string& directory,
+                                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+    std::vector<std::pair<int64_t, FrameSnapshot>> snapshots;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& entry : sessions_) {
+            auto state = entry.second ? entry.second->state() : nullptr;
+            FrameSnapshot snapshot = state ? SnapshotFrontBuffer(state) : nullptr;
+            if (snapshot) snapshots.emplace_back(entry.first, snapshot);
+        }
+    }
+    if (snapshots.empty()) {
+        result->Success(flutter::EncodableValue(flutter::EncodableMap()));
+        return;
+    }
+
+    // Sessions are encoded in parallel; the last one to finish replies
+    struct Batch {
+        std::mutex mutex;
+        flutter::EncodableMap captures;
+        size_t remaining = 0;
+        std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = snapshots.size();
+    batch->result = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+    auto runner = platform_runner_;
+
+    for (auto& entry : snapshots) {
+        int64_t texture_id = entry.first;
+        FrameSnapshot snapshot = entry.second;
+        std::string path;
+        if (!directory.empty()) {
+            path = directory + "\\" + std::to_string(texture_id) + "." + FrameEncoder::Extension(format);
+        }
+        WorkerPool::GetInstance().Post([=]() {
+            auto map = EncodeSnapshot(texture_id, snapshot, format, max_size, quality, path);
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            batch->captures[flutter::EncodableValue(texture_id)] = flutter::EncodableValue(std::move(map));
+            if (--batch->remaining > 0) return;
+            runner->Post([batch]() {
+                batch->result->Success(flutter::EncodableValue(batch->captures));
+            });
+        });
+    }
 }
 
 // VideoSessionState Implementation
@@ -266,22 +1657,33 @@ VideoDecoderPlugin::VideoSessionState::~VideoSessionState() {
     }
 
     if (sws_context) { sws_freeContext(sws_context); sws_context = nullptr; }
-    if (frame) av_frame_free(&frame);
-    if (packet) av_packet_free(&packet);
-    if (codec_context) avcodec_free_context(&codec_context);
-    
-    front_buffer.reset();
-    last_front_buffer.reset();
+    if (atlas_sws_context) { sws_freeContext(atlas_sws_context); atlas_sws_context = nullptr; }
+
+    // Decoder and buffers go back to the pool for the next session (the pool
+    // frees them if it is full)
+    auto slot = std::make_unique<SessionPool::DecoderSlot>();
+    std::swap(slot->codec_context, codec_context);
+    std::swap(slot->packet, packet);
+    std::swap(slot->frame, frame);
+    slot->codec = codec;
+    for (auto* buffer : { &front_buffer, &last_front_buffer }) {
+        if (*buffer) slot->buffers.push_back(std::move(*buffer));
+    }
+    for (auto& buffer : buffer_pool) slot->buffers.push_back(std::move(buffer));
     buffer_pool.clear();
+    pending_frames.clear();
+    SessionPool::GetInstance().ReleaseDecoder(std::move(slot));
     
     LogTrace("VideoSessionState Destructor [%lld] - END", texture_id);
 }
 
 // VideoSession Implementation
-VideoDecoderPlugin::VideoSession::VideoSession(flutter::TextureRegistrar* texture_registrar, const std::string& host, int port) {
+VideoDecoderPlugin::VideoSession::VideoSession(flutter::TextureRegistrar* texture_registrar, const std::string& host, int port,
+                                               SessionEventSink event_sink) {
     int current_sessions = ++g_active_sessions;
     LogTrace("VideoSession Constructor [%d active] - Host: %s Port: %d", current_sessions, host.c_str(), port);
     state_ = std::make_shared<VideoSessionState>(texture_registrar);
+    state_->event_sink = std::move(event_sink);
 
     auto weak_state = std::weak_ptr<VideoSessionState>(state_);
 
@@ -310,7 +1712,7 @@ VideoDecoderPlugin::VideoSession::VideoSession(flutter::TextureRegistrar* textur
         state_->is_decoding = true;
         try {
             LogTrace("Launching Decoder Thread for ID: %lld...", state_->texture_id);
-            decoder_thread_ = std::make_unique<std::thread>([s = state_, h = host, p = port]() {
+            SessionPool::GetInstance().RunSession([s = state_, h = host, p = port]() {
                 unsigned long tid = GetCurrentThreadId();
                 {
                     char buf[256];
@@ -340,13 +1742,19 @@ VideoDecoderPlugin::VideoSession::~VideoSession() {
         state_->is_decoding = false;
         state_->is_alive = false;
         
-        // 2. Break any blocking recv() immediately
-        if (state_->socket != INVALID_SOCKET) {
-            LogTrace("VideoSession Destructor [%lld] - Forcing socket shutdown", tid);
-            shutdown(state_->socket, SD_BOTH);
-            closesocket(state_->socket);
-            state_->socket = INVALID_SOCKET;
+        // 2. Break any blocking recv() or pending connect immediately
+        LogTrace("VideoSession Destructor [%lld] - Forcing socket shutdown", tid);
+        CloseSocket(state_);
+        state_->frame_hash->CancelAll();
+        // Its latency no longer sets the group's delay
+        state_->pacer.SetSyncGroup(nullptr, tid);
+        std::shared_ptr<StreamRelay> relay;
+        {
+            std::lock_guard<std::mutex> lock(state_->recorder_mutex);
+            relay = std::move(state_->relay);
         }
+        // Disconnects viewers now rather than when the decoder thread exits
+        if (relay) relay->Stop();
 
         // 3. Mark texture as gone so engine callbacks return null
         {
@@ -356,84 +1764,142 @@ VideoDecoderPlugin::VideoSession::~VideoSession() {
 
         // 4. Unregister from engine
         if (tid != -1) {
+            FrameNotifier::GetInstance().Cancel(tid);
             state_->texture_registrar->UnregisterTexture(tid);
         }
     }
 
-    // 5. Thread will exit DecodingLoop and destroy its shared_ptr<VideoSessionState>
-    // only then will the actual FFmpeg resources be freed in ~VideoSessionState.
-    if (decoder_thread_) {
-        SafeThreadJoin(std::move(decoder_thread_));
-    }
+    // 5. The pooled thread will exit DecodingLoop and drop its shared_ptr<VideoSessionState>;
+    // only then are the FFmpeg resources released in ~VideoSessionState.
     LogTrace("VideoSession Destructor [%lld] - END", tid);
 }
 
-bool VideoDecoderPlugin::VideoSession::ConnectToServer(std::shared_ptr<VideoSessionState> state, const std::string& host, int port) {
+bool VideoDecoderPlugin::VideoSession::ConnectToServer(std::shared_ptr<VideoSessionState> state, const std::string& host, int port,
+                                                       int timeout_ms) {
     LogTrace("Connecting to server: %s:%d", host.c_str(), port);
-    state->socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (state->socket == INVALID_SOCKET) {
-        int err = WSAGetLastError();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    addrinfo* address = nullptr;
+    int err = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &address);
+    if (err != 0 || !address) {
+        LogTrace("ConnectToServer - Cannot resolve %s. Error: %d", host.c_str(), err);
+        return false;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        err = WSAGetLastError();
         LogTrace("ConnectToServer - Socket creation failed. Error: %d", err);
+        freeaddrinfo(address);
         return false;
     }
+    {
+        // Publish the socket so StopDecoding can abort the connect
+        std::lock_guard<std::mutex> lock(state->socket_mutex);
+        if (!state->is_decoding) {
+            closesocket(sock);
+            freeaddrinfo(address);
+            return false;
+        }
+        state->socket = sock;
+    }
 
     // Optimization for 100 devices: Increase socket receive buffer to 1MB
     int rcvbuf = 1024 * 1024;
-    setsockopt(state->socket, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf));
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf));
     
     // Disable Nagle's algorithm for lower latency if needed
     BOOL nodelay = TRUE;
-    setsockopt(state->socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
-
-    sockaddr_in clientService;
-    clientService.sin_family = AF_INET;
-    clientService.sin_addr.s_addr = inet_addr(host.c_str());
-    clientService.sin_port = htons(port);
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+
+    // Non-blocking connect bounded by timeout_ms
+    u_long non_blocking = 1;
+    ioctlsocket(sock, FIONBIO, &non_blocking);
+    bool connected = connect(sock, address->ai_addr, (int)address->ai_addrlen) != SOCKET_ERROR;
+    err = connected ? 0 : WSAGetLastError();
+    freeaddrinfo(address);
+
+    if (!connected && err == WSAEWOULDBLOCK) {
+        fd_set write_set;
+        fd_set error_set;
+        FD_ZERO(&write_set);
+        FD_ZERO(&error_set);
+        FD_SET(sock, &write_set);
+        FD_SET(sock, &error_set);
+        timeval timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+        int ready = select(0, NULL, &write_set, &error_set, &timeout);
+        if (ready > 0 && FD_ISSET(sock, &write_set)) {
+            int so_error = 0;
+            int len = sizeof(so_error);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&so_error, &len);
+            connected = so_error == 0;
+            err = so_error;
+        } else {
+            err = ready == 0 ? WSAETIMEDOUT : WSAGetLastError();
+        }
+    }
 
-    if (connect(state->socket, (SOCKADDR*)&clientService, sizeof(clientService)) == SOCKET_ERROR) {
-        int err = WSAGetLastError();
+    if (!connected || !state->is_decoding) {
         LogTrace("ConnectToServer - Connection to %s:%d failed. Error: %d", host.c_str(), port, err);
-        closesocket(state->socket);
-        state->socket = INVALID_SOCKET;
+        std::lock_guard<std::mutex> lock(state->socket_mutex);
+        if (state->socket == sock) {
+            closesocket(sock);
+            state->socket = INVALID_SOCKET;
+        }
         return false;
     }
+
+    u_long blocking = 0;
+    ioctlsocket(sock, FIONBIO, &blocking);
     LogTrace("ConnectToServer - Connected to %s:%d successfully", host.c_str(), port);
     return true;
 }
 
-bool VideoDecoderPlugin::VideoSession::InitializeDecoder(std::shared_ptr<VideoSessionState> state) {
-    LogTrace("InitializeDecoder Start");
-    state->codec = avcodec_find_decoder(AV_CODEC_ID_HEVC);
-    if (!state->codec) {
-        LogTrace("HEVC decoder not found");
-        return false;
-    }
+bool VideoDecoderPlugin::VideoSession::ConnectWithRetry(std::shared_ptr<VideoSessionState> state, const std::string& host,
+                                                        int port) {
+    auto deadline = std::chrono::steady_clock::now() + kReconnectWindow;
+    auto backoff = kReconnectInitialBackoff;
+    while (state->is_decoding) {
+        if (ConnectToServer(state, host, port, kConnectTimeoutMs)) return true;
+        if (std::chrono::steady_clock::now() + backoff >= deadline) break;
 
-    state->codec_context = avcodec_alloc_context3(state->codec);
-    if (!state->codec_context) {
-        LogTrace("Codec context alloc failed");
-        return false;
+        // Sleep in slices so a stop request is honoured promptly
+        auto wake = std::chrono::steady_clock::now() + backoff;
+        while (state->is_decoding && std::chrono::steady_clock::now() < wake) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        backoff = std::min(backoff * 2, kReconnectMaxBackoff);
     }
+    return false;
+}
 
-    state->codec_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
-    state->codec_context->flags2 |= AV_CODEC_FLAG2_FAST;
-    state->codec_context->thread_count = 1;
-
-    // For mass concurrency, we still need protection for the sensitive avcodec_open2
-    {
-        std::lock_guard<std::mutex> lock(g_ffmpeg_init_mutex);
-        if (avcodec_open2(state->codec_context, state->codec, NULL) < 0) {
-            LogTrace("InitializeDecoder [%lld] - Codec open failed", state->texture_id);
-            return false;
-        }
+void VideoDecoderPlugin::VideoSession::CloseSocket(const std::shared_ptr<VideoSessionState>& state) {
+    std::lock_guard<std::mutex> lock(state->socket_mutex);
+    if (state->socket != INVALID_SOCKET) {
+        shutdown(state->socket, SD_BOTH);
+        closesocket(state->socket);
+        state->socket = INVALID_SOCKET;
     }
+}
 
-    state->packet = av_packet_alloc();
-    state->frame = av_frame_alloc();
-    if (!state->packet || !state->frame) {
-        LogTrace("InitializeDecoder [%lld] - Packet/Frame alloc failed", state->texture_id);
+bool VideoDecoderPlugin::VideoSession::InitializeDecoder(std::shared_ptr<VideoSessionState> state) {
+    LogTrace("InitializeDecoder Start");
+    // Usually a pre-opened decoder from the pool
+    auto slot = SessionPool::GetInstance().AcquireDecoder(AV_CODEC_ID_HEVC);
+    if (!slot) {
+        LogTrace("InitializeDecoder [%lld] - Decoder open failed", state->texture_id);
         return false;
     }
+
+    std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+    state->codec = slot->codec;
+    std::swap(state->codec_context, slot->codec_context);
+    std::swap(state->packet, slot->packet);
+    std::swap(state->frame, slot->frame);
+    state->buffer_pool = std::move(slot->buffers);
     
     LogTrace("FFmpeg initialized successfully");
     return true;
@@ -442,114 +1908,345 @@ bool VideoDecoderPlugin::VideoSession::InitializeDecoder(std::shared_ptr<VideoSe
 void VideoDecoderPlugin::VideoSession::DecodingLoop(std::shared_ptr<VideoSessionState> state, std::string host, int port) {
     LogTrace("DecodingLoop [%lld] - Starting Connection Steps", state->texture_id);
     try {
-        if (!ConnectToServer(state, host, port)) {
-            LogTrace("DecodingLoop [%lld] - Connection failed", state->texture_id);
-            state->is_decoding = false;
-            return;
-        }
-        
         if (!InitializeDecoder(state)) {
             LogTrace("DecodingLoop [%lld] - Decoder init failed", state->texture_id);
             state->is_decoding = false;
             return;
         }
 
-        LogTrace("DecodingLoop [%lld] - Entering receive loop", state->texture_id);
-
-        std::vector<uint8_t> buffer;
-        buffer.reserve(1024 * 1024);
-        char temp_buf[8192];
-        bool reading_header = true;
-        int needed_bytes = 12;
-        int payload_size = 0;
-        bool is_config_packet = false;
-        std::vector<uint8_t> config_data;
-
+        // The texture, decoder and buffers outlive the socket: on a drop we
+        // reconnect and resume at the next config + keyframe.
+        bool was_connected = false;
         while (state->is_decoding) {
-            int bytes_read = recv(state->socket, temp_buf, sizeof(temp_buf), 0);
-            if (bytes_read <= 0) {
-                LogTrace("Socket recv <= 0, breaking loop. Error: %d", WSAGetLastError());
+            auto reconnect_start = std::chrono::steady_clock::now();
+            if (!ConnectWithRetry(state, host, port)) {
+                LogTrace("DecodingLoop [%lld] - Connection failed", state->texture_id);
                 break;
             }
+            state->connected = true;
+
+            if (was_connected) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - reconnect_start).count();
+                state->reconnects++;
+                state->last_reconnect_ms = elapsed;
+                avcodec_flush_buffers(state->codec_context);
+                LogTrace("DecodingLoop [%lld] - Reconnected in %lld ms", state->texture_id, (int64_t)elapsed);
+                EmitConnectionEvent(state, "reconnected", elapsed);
+            }
+            was_connected = true;
 
-            buffer.insert(buffer.end(), temp_buf, temp_buf + bytes_read);
+            LogTrace("DecodingLoop [%lld] - Entering receive loop", state->texture_id);
+            ReceiveLoop(state);
 
-            // CPU/Network Congestion Protection: Limit buffer size per session
-            if (buffer.size() > 5 * 1024 * 1024) { // 5MB limit
-                LogTrace("DecodingLoop [%lld] - BUFFER OVERFLOW (%zu bytes). Clearing to prevent OOM.", 
-                         state->texture_id, buffer.size());
-                buffer.clear();
-                needed_bytes = 12;
-                reading_header = true;
-                continue;
+            state->connected = false;
+            CloseSocket(state);
+            if (state->is_decoding) {
+                LogTrace("DecodingLoop [%lld] - Connection lost, reconnecting", state->texture_id);
+                EmitConnectionEvent(state, "reconnecting", 0);
             }
+        }
+    } catch (const std::exception& e) {
+        LogTrace("DecodingLoop [%lld] - Standard exception: %s", state->texture_id, e.what());
+    } catch (...) {
+        LogTrace("DecodingLoop [%lld] - Unknown exception", state->texture_id);
+    }
+    LogTrace("DecodingLoop [%lld] - Loop exited, cleaning up", state->texture_id);
+    // The pooled thread outlives the session
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+    ReleaseDecoderThread(state);
+    state->connected = false;
+    if (state->is_decoding.exchange(false)) {
+        // Gave up on our own, not stopped from Dart
+        EmitConnectionEvent(state, "disconnected", 0);
+    }
+}
 
-            while (buffer.size() >= (size_t)needed_bytes) {
-                if (reading_header) {
-                    // (PTS and payload size logic...)
-                    uint64_t pts_raw = 0;
-                    memcpy(&pts_raw, buffer.data(), 8);
-                    uint8_t* p64 = (uint8_t*)&pts_raw;
-                    uint64_t pts = ((uint64_t)p64[0] << 56) | ((uint64_t)p64[1] << 48) |
-                                   ((uint64_t)p64[2] << 40) | ((uint64_t)p64[3] << 32) |
-                                   ((uint64_t)p64[4] << 24) | ((uint64_t)p64[5] << 16) |
-                                   ((uint64_t)p64[6] << 8)  |  (uint64_t)p64[7];
-
-                    uint32_t size_raw = 0;
-                    memcpy(&size_raw, buffer.data() + 8, 4);
-                    uint8_t* p32 = (uint8_t*)&size_raw;
-                    payload_size = (p32[0] << 24) | (p32[1] << 16) | (p32[2] << 8) | p32[3];
-
-                    if (payload_size < 0 || payload_size > 20 * 1024 * 1024) {
-                        LogTrace("Invalid payload size: %d", payload_size);
-                        state->is_decoding = false;
-                        break;
-                    }
+void VideoDecoderPlugin::VideoSession::PlaceDecoderThread(const std::shared_ptr<VideoSessionState>& state,
+                                                         int priority) {
+    auto& topology = CpuTopology::GetInstance();
+    ReleaseDecoderThread(state);
+    if (!topology.pinning()) return;
+
+    CpuTopology::Placement placement = topology.Acquire(CpuTopology::PreferenceFor(priority));
+    if (!topology.Pin(placement, &state->unpinned_affinity)) {
+        topology.Release(placement);
+        return;
+    }
+    state->cpu_placement = placement;
+    state->cpu_pinned = true;
+    state->cpu_core = placement.core;
+    // New buffers come from this node; recycled ones from another node are
+    // left to age out of the pool
+    state->cpu_node = placement.node;
+}
+
+void VideoDecoderPlugin::VideoSession::ReleaseDecoderThread(const std::shared_ptr<VideoSessionState>& state) {
+    if (!state->cpu_pinned) return;
+    SetThreadGroupAffinity(GetCurrentThread(), &state->unpinned_affinity, nullptr);
+    CpuTopology::GetInstance().Release(state->cpu_placement);
+    state->cpu_placement = CpuTopology::Placement();
+    state->cpu_pinned = false;
+    state->cpu_core = -1;
+    state->cpu_node = -1;
+}
+
+void VideoDecoderPlugin::VideoSession::EmitConnectionEvent(const std::shared_ptr<VideoSessionState>& state,
+                                                          const char* type, int64_t elapsed_ms) {
+    if (!state->event_sink) return;
+    flutter::EncodableMap event;
+    event[flutter::EncodableValue("type")] = flutter::EncodableValue(type);
+    event[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue(elapsed_ms);
+    state->event_sink(state->texture_id, std::move(event));
+}
+
+// Whether data holds a scrcpy packet header whose payload starts like one:
+// an Annex B start code or an AV1 temporal delimiter. Needs 16 bytes.
+static bool LooksLikePacketHeader(const uint8_t* data) {
+    if ((data[0] & 0xC0) == 0xC0) return false; // Config and key flags together
+    uint32_t size = ((uint32_t)data[8] << 24) | ((uint32_t)data[9] << 16) | ((uint32_t)data[10] << 8) | data[11];
+    if (size < 4 || size > kMaxPacketSize) return false;
+    const uint8_t* payload = data + 12;
+    bool annex_b = payload[0] == 0 && payload[1] == 0 && (payload[2] == 1 || (payload[2] == 0 && payload[3] == 1));
+    bool av1 = payload[0] == 0x12 && payload[1] == 0x00;
+    return annex_b || av1;
+}
+
+// Finds where framing resumes after lost bytes: the first plausible header
+// that, when the buffer reaches that far, is followed by another one. Sets
+// offset to the bytes to drop; false until such a header has arrived.
+static bool FindPacketHeader(const std::vector<uint8_t>& buffer, size_t* offset) {
+    const uint8_t* data = buffer.data();
+    size_t size = buffer.size();
+    for (size_t i = 0; i + 16 <= size; ++i) {
+        if (!LooksLikePacketHeader(data + i)) continue;
+        size_t payload_size = ((size_t)data[i + 8] << 24) | ((size_t)data[i + 9] << 16) |
+                              ((size_t)data[i + 10] << 8) | data[i + 11];
+        size_t next = i + 12 + payload_size;
+        if (next + 16 <= size && !LooksLikePacketHeader(data + next)) continue;
+        *offset = i;
+        return true;
+    }
+    *offset = size > 15 ? size - 15 : 0;
+    return false;
+}
+
+void VideoDecoderPlugin::VideoSession::ReceiveLoop(std::shared_ptr<VideoSessionState> state) {
+    std::vector<uint8_t> buffer;
+    buffer.reserve(1024 * 1024);
+    char temp_buf[8192];
+    bool reading_header = true;
+    int needed_bytes = 12;
+    int payload_size = 0;
+    bool is_config_packet = false;
+    bool is_key_frame = false;
+    int64_t packet_pts = 0;
+    // Parameter sets go to the decoder with the next decoded frame
+    bool install_config = false;
+    // A new connection may start mid-GOP; wait for config and a keyframe
+    bool awaiting_config = true;
+    bool awaiting_keyframe = true;
+    // Set while keyframes-only degradation skipped frames the decoder needs
+    bool decoder_needs_keyframe = false;
+    int applied_priority = -1;
+    int applied_placement = -1;
+    // Set after lost bytes until a packet boundary is found again
+    bool resyncing = false;
+    auto resync = [&]() {
+        size_t offset = 0;
+        bool found = FindPacketHeader(buffer, &offset);
+        buffer.erase(buffer.begin(), buffer.begin() + offset);
+        if (found) {
+            LogTrace("ReceiveLoop [%lld] - Framing resynchronized", state->texture_id);
+            needed_bytes = 12;
+            reading_header = true;
+        }
+        return !found;
+    };
+
+    while (state->is_decoding) {
+        int bytes_read = recv(state->socket, temp_buf, sizeof(temp_buf), 0);
+        if (bytes_read <= 0) {
+            LogTrace("Socket recv <= 0, breaking loop. Error: %d", WSAGetLastError());
+            return;
+        }
+
+        buffer.insert(buffer.end(), temp_buf, temp_buf + bytes_read);
 
-                    is_config_packet = (pts & 0x8000000000000000) != 0;
-                    buffer.erase(buffer.begin(), buffer.begin() + 12);
-                    needed_bytes = (payload_size > 0) ? payload_size : 12;
-                    reading_header = (payload_size > 0) ? false : true;
-                } else {
-                    if (payload_size > 0) {
-                        std::vector<uint8_t> payload(buffer.begin(), buffer.begin() + payload_size);
-                        buffer.erase(buffer.begin(), buffer.begin() + payload_size);
-
-                        if (is_config_packet) {
-                            config_data = payload;
-                        } else {
-                            if (!config_data.empty()) {
-                                std::vector<uint8_t> merged;
-                                merged.reserve(config_data.size() + payload.size());
-                                merged.insert(merged.end(), config_data.begin(), config_data.end());
-                                merged.insert(merged.end(), payload.begin(), payload.end());
-                                DecodePacket(state, merged);
-                                config_data.clear();
+        // CPU/Network Congestion Protection: Limit buffer size per session
+        if (buffer.size() > 5 * 1024 * 1024) { // 5MB limit
+            LogTrace("DecodingLoop [%lld] - BUFFER OVERFLOW (%zu bytes). Clearing to prevent OOM.", 
+                     state->texture_id, buffer.size());
+            buffer.clear();
+            resyncing = true;
+            OnStreamLoss(state, "overflow");
+            continue;
+        }
+        if (resyncing) resyncing = resync();
+
+        while (!resyncing && buffer.size() >= (size_t)needed_bytes) {
+            if (reading_header) {
+                // (PTS and payload size logic...)
+                uint64_t pts_raw = 0;
+                memcpy(&pts_raw, buffer.data(), 8);
+                uint8_t* p64 = (uint8_t*)&pts_raw;
+                uint64_t pts = ((uint64_t)p64[0] << 56) | ((uint64_t)p64[1] << 48) |
+                               ((uint64_t)p64[2] << 40) | ((uint64_t)p64[3] << 32) |
+                               ((uint64_t)p64[4] << 24) | ((uint64_t)p64[5] << 16) |
+                               ((uint64_t)p64[6] << 8)  |  (uint64_t)p64[7];
+
+                uint32_t size_raw = 0;
+                memcpy(&size_raw, buffer.data() + 8, 4);
+                uint8_t* p32 = (uint8_t*)&size_raw;
+                payload_size = (p32[0] << 24) | (p32[1] << 16) | (p32[2] << 8) | p32[3];
+
+                if (payload_size < 0 || payload_size > (int)kMaxPacketSize) {
+                    LogTrace("Invalid payload size: %d", payload_size);
+                    OnStreamLoss(state, "framing");
+                    buffer.erase(buffer.begin());
+                    resyncing = resync();
+                    continue;
+                }
+
+                is_config_packet = (pts & 0x8000000000000000) != 0;
+                is_key_frame = (pts & 0x4000000000000000) != 0;
+                packet_pts = (int64_t)(pts & 0x3FFFFFFFFFFFFFFF);
+                buffer.erase(buffer.begin(), buffer.begin() + 12);
+                needed_bytes = (payload_size > 0) ? payload_size : 12;
+                reading_header = (payload_size > 0) ? false : true;
+            } else {
+                if (payload_size > 0) {
+                    std::vector<uint8_t> payload(buffer.begin(), buffer.begin() + payload_size);
+                    buffer.erase(buffer.begin(), buffer.begin() + payload_size);
+
+                    // The stream's key flag is a fallback for packets the
+                    // parser cannot classify
+                    auto frame_type = BitstreamParser::FrameType::kUnknown;
+                    if (!is_config_packet) frame_type = state->bitstream.Classify(payload.data(), payload.size());
+                    bool key = frame_type == BitstreamParser::FrameType::kKey ||
+                               (frame_type == BitstreamParser::FrameType::kUnknown && is_key_frame);
+
+                    if (is_config_packet) {
+                        auto codec = BitstreamParser::FromCodecId(state->codec ? state->codec->id : AV_CODEC_ID_HEVC);
+                        if (state->bitstream.codec() != codec) state->bitstream = BitstreamParser(codec);
+                        bool had_config = !state->bitstream.extradata().empty();
+                        bool changed = state->bitstream.SetConfig(payload.data(), payload.size());
+                        if (changed && had_config) {
+                            state->config_changes++;
+                            LogTrace("ReceiveLoop [%lld] - Parameter sets changed", state->texture_id);
+                        }
+                        // Resent unchanged parameter sets are not installed
+                        // again, except on a new connection
+                        if (changed || awaiting_config) install_config = true;
+                        awaiting_config = false;
+                        {
+                            std::lock_guard<std::mutex> lock(state->recorder_mutex);
+                            state->last_config = payload;
+                            if (state->recorder) state->recorder->SetConfig(payload);
+                            if (state->relay) state->relay->SetConfig(payload);
+                        }
+                        std::lock_guard<std::mutex> lock(state->time_shift_mutex);
+                        if (state->time_shift) state->time_shift->SetConfig(payload);
+                    } else if (awaiting_config || ((awaiting_keyframe || state->recovering) && !key)) {
+                        // Undecodable without its references
+                        if (state->recovering) RequestKeyframe(state);
+                    } else {
+                        awaiting_keyframe = false;
+
+                        int priority = state->priority;
+                        if (priority != applied_priority) {
+                            SetThreadPriority(GetCurrentThread(), QosGovernor::ThreadPriorityFor(priority));
+                        }
+                        int placement = CpuTopology::GetInstance().generation();
+                        if (priority != applied_priority || placement != applied_placement) {
+                            PlaceDecoderThread(state, priority);
+                            applied_placement = placement;
+                        }
+                        applied_priority = priority;
+                        int level = QosGovernor::GetInstance().LevelFor(priority);
+                        state->qos_level = level;
+                        bool skip_decode = !key && (level >= QosGovernor::kKeyframesOnly || decoder_needs_keyframe);
+                        decoder_needs_keyframe = skip_decode;
+                        // A reduced frame rate drops frames after decoding
+                        // anyway; ones nothing references need no decode
+                        bool skip_droppable = !skip_decode && frame_type == BitstreamParser::FrameType::kDroppable &&
+                                              level >= QosGovernor::kReducedFps;
+                        if (skip_droppable) state->frames_skipped++;
+
+                        auto arrival = std::chrono::steady_clock::now();
+                        u_long backlog = 0;
+                        ioctlsocket(state->socket, FIONREAD, &backlog);
+                        state->health.OnPacket(payload.size(), (int64_t)backlog);
+                        state->activity.OnPacket(arrival, payload.size(), key);
+
+                        if (!skip_decode && !skip_droppable) {
+                            state->pacer.OnPacketArrival(packet_pts, arrival);
+                            state->packet_arrival = arrival;
+                            const auto& extradata = state->bitstream.extradata();
+                            bool clean;
+                            if (install_config && state->bitstream.config_in_band()) {
+                                std::vector<uint8_t> in_band;
+                                in_band.reserve(extradata.size() + payload.size());
+                                in_band.insert(in_band.end(), extradata.begin(), extradata.end());
+                                in_band.insert(in_band.end(), payload.begin(), payload.end());
+                                clean = DecodePacket(state, in_band, packet_pts);
                             } else {
-                                DecodePacket(state, payload);
+                                clean = DecodePacket(state, payload, packet_pts, install_config ? &extradata : nullptr);
                             }
+                            install_config = false;
+                            if (clean && key && state->recovering) OnStreamRecovered(state);
+                            state->health.OnDecoded(std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - arrival).count());
+                        }
+
+                        int queue_depth = 0;
+                        {
+                            std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+                            queue_depth = (int)state->pending_frames.size();
+                        }
+                        state->health.MaybeUpdate(arrival, state->frames_decoded,
+                                                  state->frames_dropped + state->frames_throttled, queue_depth,
+                                                  state->width, state->height, level);
+
+                        std::shared_ptr<StreamRecorder> recorder;
+                        std::shared_ptr<StreamRelay> relay;
+                        {
+                            std::lock_guard<std::mutex> lock(state->recorder_mutex);
+                            recorder = state->recorder;
+                            relay = state->relay;
+                        }
+                        if (recorder) {
+                            recorder->PushPacket(payload.data(), payload.size(), packet_pts, key,
+                                                 state->width, state->height);
+                        }
+                        if (relay) relay->PushPacket(payload.data(), payload.size(), packet_pts, key);
+                        if (auto time_shift = GetTimeShift(state)) {
+                            time_shift->PushPacket(payload.data(), payload.size(), packet_pts, key,
+                                                   state->width, state->height);
                         }
                     }
-                    needed_bytes = 12;
-                    reading_header = true;
                 }
+                needed_bytes = 12;
+                reading_header = true;
             }
         }
-    } catch (const std::exception& e) {
-        LogTrace("DecodingLoop [%lld] - Standard exception: %s", state->texture_id, e.what());
-    } catch (...) {
-        LogTrace("DecodingLoop [%lld] - Unknown exception", state->texture_id);
     }
-    LogTrace("DecodingLoop [%lld] - Loop exited, cleaning up", state->texture_id);
-    state->is_decoding = false;
 }
 
-void VideoDecoderPlugin::VideoSession::DecodePacket(std::shared_ptr<VideoSessionState> state, const std::vector<uint8_t>& data) {
-    if (!state || !state->is_decoding || !state->is_alive || !state->codec_context) return;
-    if (!state->packet || !state->frame) return; // EXTRA SAFETY
+bool VideoDecoderPlugin::VideoSession::DecodePacket(std::shared_ptr<VideoSessionState> state, const std::vector<uint8_t>& data,
+                                                   int64_t pts, const std::vector<uint8_t>* extradata) {
+    if (!state || !state->is_decoding || !state->is_alive || !state->codec_context) return true;
+    if (!state->packet || !state->frame) return true; // EXTRA SAFETY
 
     state->packet->data = (uint8_t*)data.data();
     state->packet->size = (int)data.size();
+    state->packet->pts = pts; // Carried through to frame->pts for pacing
+    if (extradata && !extradata->empty()) {
+        // The decoder is already open, so new parameter sets arrive as side
+        // data rather than through codec_context->extradata
+        uint8_t* side_data = av_packet_new_side_data(state->packet, AV_PKT_DATA_NEW_EXTRADATA, extradata->size());
+        if (side_data) memcpy(side_data, extradata->data(), extradata->size());
+    }
 
     int ret = AvCodecSendPacketSafe(state->codec_context, state->packet);
     if (ret < 0) {
@@ -557,27 +2254,135 @@ void VideoDecoderPlugin::VideoSession::DecodePacket(std::shared_ptr<VideoSession
         else if (ret != AVERROR(EAGAIN)) {
             LogTrace("DecodePacket [%lld] - send_packet error: %d", state->texture_id, ret);
         }
-        return;
+        av_packet_unref(state->packet);
+        if (ret == AVERROR(EAGAIN)) return true;
+        OnStreamLoss(state, "decode");
+        return false;
     }
 
+    bool clean = true;
     while (state->is_decoding) {
         ret = AvCodecReceiveFrameSafe(state->codec_context, state->frame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
         if (ret < 0) {
             if (ret == -1) LogTrace("CRITICAL [%lld] - Access Violation in avcodec_receive_frame!", state->texture_id);
             else LogTrace("DecodePacket [%lld] - receive_frame error: %d", state->texture_id, ret);
+            OnStreamLoss(state, "decode");
+            clean = false;
             break;
         }
+        // Concealed frames (smeared blocks) are not shown
+        if (state->frame->decode_error_flags || (state->frame->flags & AV_FRAME_FLAG_CORRUPT)) {
+            OnStreamLoss(state, (state->frame->decode_error_flags & FF_DECODE_ERROR_MISSING_REFERENCE) ? "reference"
+                                                                                                     : "corrupt");
+            clean = false;
+            continue;
+        }
         ProcessFrame(state, state->frame);
     }
     av_packet_unref(state->packet);
+    return clean;
+}
+
+void VideoDecoderPlugin::VideoSession::OnStreamLoss(const std::shared_ptr<VideoSessionState>& state,
+                                                   const char* reason) {
+    if (state->recovering) return;
+    state->recovering = true;
+    state->loss_reason = reason;
+    state->loss_time = std::chrono::steady_clock::now();
+    state->keyframe_request_time = std::chrono::steady_clock::time_point();
+    state->loss_incidents++;
+    // References are suspect; decoding restarts from the keyframe
+    if (state->codec_context) avcodec_flush_buffers(state->codec_context);
+    LogTrace("ReceiveLoop [%lld] - Stream loss (%s), waiting for a keyframe", state->texture_id, reason);
+    RequestKeyframe(state);
+}
+
+void VideoDecoderPlugin::VideoSession::RequestKeyframe(const std::shared_ptr<VideoSessionState>& state) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - state->keyframe_request_time < kKeyframeRequestInterval) return;
+    state->keyframe_request_time = now;
+    if (!state->event_sink) return;
+    flutter::EncodableMap event;
+    event[flutter::EncodableValue("type")] = flutter::EncodableValue("keyframeRequested");
+    event[flutter::EncodableValue("reason")] = flutter::EncodableValue(state->loss_reason);
+    state->event_sink(state->texture_id, std::move(event));
+}
+
+void VideoDecoderPlugin::VideoSession::OnStreamRecovered(const std::shared_ptr<VideoSessionState>& state) {
+    state->recovering = false;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - state->loss_time).count();
+    state->last_recovery_ms = elapsed;
+    if (elapsed > state->max_recovery_ms) state->max_recovery_ms = elapsed;
+    LogTrace("ReceiveLoop [%lld] - Recovered from %s in %lld ms", state->texture_id, state->loss_reason,
+             (int64_t)elapsed);
+    if (!state->event_sink) return;
+    flutter::EncodableMap event;
+    event[flutter::EncodableValue("type")] = flutter::EncodableValue("recovered");
+    event[flutter::EncodableValue("reason")] = flutter::EncodableValue(state->loss_reason);
+    event[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue((int64_t)elapsed);
+    state->event_sink(state->texture_id, std::move(event));
 }
 
 void VideoDecoderPlugin::VideoSession::ProcessFrame(std::shared_ptr<VideoSessionState> state, AVFrame* frame) {
     if (!state || !frame) return;
+    auto now = std::chrono::steady_clock::now();
+
+    // Analysis has its own rate and sees every frame, static or throttled
+    std::shared_ptr<FrameAnalysisHost> analysis;
+    {
+        std::lock_guard<std::mutex> lock(state->analysis_mutex);
+        analysis = state->analysis;
+    }
+    if (analysis) analysis->Submit(frame, now);
+    // So is the perceptual hash, at a few microseconds per frame
+    uint64_t hash = 0;
+    if (FrameHash::Compute(frame, &hash)) {
+        state->frame_hash->Update(hash, frame->pts == AV_NOPTS_VALUE ? 0 : frame->pts);
+    }
+
+    // 0. Frame rate cap of a degraded class. Checked before change detection
+    // so the detector always compares against the last converted frame.
+    int level = state->qos_level;
+    if (level >= QosGovernor::kReducedFps &&
+        now - state->last_converted_time < std::chrono::microseconds(1000000 / QosGovernor::kReducedFpsValue)) {
+        state->frames_throttled++;
+        return;
+    }
+
+    // Frames identical to the one on screen are not converted or published
+    if (state->force_refresh.exchange(false)) state->change_detector.Reset();
+    bool changed = state->change_detector.Update(frame);
+    UpdateIdleState(state, changed);
+    if (!changed) {
+        state->frames_unchanged++;
+        return;
+    }
+    state->last_converted_time = now;
+
+    // Extra outputs convert from the same decoded frame on the worker pool
+    std::vector<std::shared_ptr<SessionOutput>> outputs;
+    {
+        std::lock_guard<std::mutex> lock(state->outputs_mutex);
+        outputs = state->outputs;
+    }
+    for (auto& output : outputs) output->Submit(frame, now);
+
+    // Degraded classes convert at half resolution; the texture is stretched
+    int out_width = frame->width;
+    int out_height = frame->height;
+    if (level >= QosGovernor::kReducedSize) {
+        out_width = std::max(2, (frame->width / 2) & ~1);
+        out_height = std::max(2, (frame->height / 2) & ~1);
+    }
 
     // 1. Get a buffer from pool or create new one
     std::shared_ptr<VideoSessionState::RGBAFrame> back_buffer;
+    std::shared_ptr<TextureAtlas> atlas;
+    int atlas_slot = -1;
+    uint64_t atlas_generation = 0;
+    bool atlas_only = false;
     {
         std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
         if (!state->is_decoding || !state->is_alive || state->texture_id == -1) return;
@@ -585,13 +2390,29 @@ void VideoDecoderPlugin::VideoSession::ProcessFrame(std::shared_ptr<VideoSession
         if (state->width != frame->width || state->height != frame->height) {
             LogTrace("ProcessFrame [%lld] - Resolution change: %dx%d -> %dx%d", 
                      state->texture_id, state->width, state->height, frame->width, frame->height);
-            state->buffer_pool.clear();
+            // Keep recycled buffers that already have the right size
+            state->buffer_pool.erase(
+                std::remove_if(state->buffer_pool.begin(), state->buffer_pool.end(),
+                               [frame](const auto& buffer) {
+                                   return buffer->width != frame->width || buffer->height != frame->height;
+                               }),
+                state->buffer_pool.end());
             state->width = frame->width;
             state->height = frame->height;
         }
 
+        atlas = state->atlas;
+        atlas_slot = state->atlas_slot;
+        atlas_generation = state->atlas_generation;
+        atlas_only = state->atlas_only;
+        if (atlas && atlas_only) {
+            // Full-size buffers are not needed while only the atlas is shown
+            state->buffer_pool.clear();
+        }
+
         for (auto it = state->buffer_pool.begin(); it != state->buffer_pool.end(); ++it) {
-            if ((*it).use_count() == 1) {
+            if ((*it).use_count() == 1 && (*it)->width == out_width && (*it)->height == out_height &&
+                (*it)->node == state->cpu_node) {
                 back_buffer = *it;
                 state->buffer_pool.erase(it);
                 break;
@@ -599,8 +2420,16 @@ void VideoDecoderPlugin::VideoSession::ProcessFrame(std::shared_ptr<VideoSession
         }
     }
 
+    if (atlas) {
+        UpdateAtlasTile(state, atlas.get(), atlas_slot, atlas_generation, frame);
+        if (atlas_only) {
+            MarkFirstFrame(state);
+            return;
+        }
+    }
+
     if (!back_buffer) {
-        back_buffer = std::make_shared<VideoSessionState::RGBAFrame>(frame->width, frame->height);
+        back_buffer = std::make_shared<VideoSessionState::RGBAFrame>(out_width, out_height, state->cpu_node);
     }
 
     // 2. Scale frame (No lock needed for pixel data - back_buffer is private here)
@@ -609,14 +2438,19 @@ void VideoDecoderPlugin::VideoSession::ProcessFrame(std::shared_ptr<VideoSession
         std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
         if (!state->is_alive) return;
 
-        if (!state->sws_context || state->width != frame->width || state->height != frame->height) {
+        if (!state->sws_context || state->sws_src_width != frame->width || state->sws_src_height != frame->height ||
+            state->sws_out_width != out_width || state->sws_out_height != out_height) {
             if (state->sws_context) sws_freeContext(state->sws_context);
             std::lock_guard<std::mutex> ffmpeg_lock(g_ffmpeg_init_mutex);
             state->sws_context = sws_getContext(
                 frame->width, frame->height, (AVPixelFormat)frame->format,
-                frame->width, frame->height, AV_PIX_FMT_RGBA,
+                out_width, out_height, AV_PIX_FMT_RGBA,
                 SWS_FAST_BILINEAR, NULL, NULL, NULL
             );
+            state->sws_src_width = frame->width;
+            state->sws_src_height = frame->height;
+            state->sws_out_width = out_width;
+            state->sws_out_height = out_height;
         }
     }
 
@@ -630,8 +2464,86 @@ void VideoDecoderPlugin::VideoSession::ProcessFrame(std::shared_ptr<VideoSession
     // sws_scale runs UNLOCKED - this is where parallelism happens
     int scaled_h = SwsScaleSafe(state->sws_context, frame->data, frame->linesize, 0, frame->height, dest, dest_linesize);
     if (scaled_h <= 0) return;
+    state->frames_decoded++;
+
+    std::shared_ptr<FrameExporter> exporter;
+    {
+        std::lock_guard<std::mutex> lock(state->exporter_mutex);
+        exporter = state->exporter;
+    }
+    if (exporter) {
+        exporter->Write(back_buffer->pixels.data(), back_buffer->width, back_buffer->height,
+                        frame->pts == AV_NOPTS_VALUE ? 0 : frame->pts);
+    }
+
+    state->health.OnFrameReady(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - state->packet_arrival).count());
+
+    // 3. Present now, or hold until the frame's PTS slot
+    if (frame->pts == AV_NOPTS_VALUE || state->pacer.IsPassthrough()) {
+        PublishFrame(state, back_buffer);
+        return;
+    }
+    back_buffer->pts_us = frame->pts;
+    back_buffer->ready_time = std::chrono::steady_clock::now();
+    state->pacer.OnFrameReady(back_buffer->pts_us, back_buffer->ready_time);
+    ScheduleFrame(state, back_buffer);
+}
 
-    // 3. Swap to front and put old front back to pool
+void VideoDecoderPlugin::VideoSession::ScheduleFrame(std::shared_ptr<VideoSessionState> state,
+                                                    std::shared_ptr<VideoSessionState::RGBAFrame> buffer) {
+    auto when = state->pacer.PresentationTime(buffer->pts_us);
+    when = std::max(when, buffer->ready_time);
+    when = std::min(when, buffer->ready_time + kMaxPresentationHold);
+
+    uint64_t seq;
+    {
+        std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+        if (!state->is_alive || state->texture_id == -1) return;
+        // The oldest waiting frame is superseded rather than growing the delay
+        while (state->pending_frames.size() >= kMaxPendingFrames) {
+            state->buffer_pool.push_back(state->pending_frames.front());
+            state->pending_frames.pop_front();
+            state->frames_dropped++;
+            state->pacer.OnSuperseded();
+        }
+        // A sequence number, not the buffer address: a superseded buffer goes
+        // back to the pool and may be queued again before its timer fires
+        seq = ++state->next_schedule_seq;
+        buffer->schedule_seq = seq;
+        state->pending_frames.push_back(buffer);
+    }
+
+    std::weak_ptr<VideoSessionState> weak_state = state;
+    TimerQueue::GetInstance().Schedule(when, [weak_state, seq]() {
+        auto s = weak_state.lock();
+        if (s) PresentScheduledFrame(s, seq);
+    });
+}
+
+void VideoDecoderPlugin::VideoSession::PresentScheduledFrame(std::shared_ptr<VideoSessionState> state, uint64_t seq) {
+    std::shared_ptr<VideoSessionState::RGBAFrame> buffer;
+    {
+        std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
+        auto it = std::find_if(state->pending_frames.begin(), state->pending_frames.end(),
+                               [seq](const auto& pending) { return pending->schedule_seq == seq; });
+        // Already superseded
+        if (it == state->pending_frames.end()) return;
+        buffer = *it;
+        // Anything queued ahead of it missed its slot
+        for (auto older = state->pending_frames.begin(); older != it; ++older) {
+            state->buffer_pool.push_back(*older);
+            state->frames_dropped++;
+        }
+        state->pending_frames.erase(state->pending_frames.begin(), it + 1);
+    }
+    state->pacer.OnPresented(buffer->pts_us, buffer->ready_time, std::chrono::steady_clock::now());
+    PublishFrame(state, buffer);
+}
+
+void VideoDecoderPlugin::VideoSession::PublishFrame(std::shared_ptr<VideoSessionState> state,
+                                                   std::shared_ptr<VideoSessionState::RGBAFrame> back_buffer) {
+    // Swap to front and put old front back to pool
     {
         std::lock_guard<std::recursive_mutex> lock(state->pixel_buffer_mutex);
         if (!state->is_alive || state->texture_id == -1) return;
@@ -646,8 +2558,65 @@ void VideoDecoderPlugin::VideoSession::ProcessFrame(std::shared_ptr<VideoSession
             state->buffer_pool.erase(state->buffer_pool.begin());
         }
 
-        state->texture_registrar->MarkTextureFrameAvailable(state->texture_id);
+        FrameNotifier::GetInstance().Request(state->texture_registrar, state->texture_id);
+    }
+    state->frames_presented++;
+    MarkFirstFrame(state);
+}
+
+void VideoDecoderPlugin::VideoSession::MarkFirstFrame(const std::shared_ptr<VideoSessionState>& state) {
+    if (state->first_frame_shown.exchange(true)) return;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state->start_time).count();
+    LogTrace("ProcessFrame [%lld] - First frame after %.1f ms", state->texture_id, ms);
+    SessionPool::GetInstance().RecordTimeToFirstFrame(ms);
+}
+
+void VideoDecoderPlugin::VideoSession::UpdateIdleState(const std::shared_ptr<VideoSessionState>& state, bool changed) {
+    auto now = std::chrono::steady_clock::now();
+    bool idle = state->screen_idle;
+    if (changed) {
+        state->last_change_time = now;
+        if (!idle) return;
+    } else if (idle || now - state->last_change_time < kIdleThreshold) {
+        return;
+    }
+
+    state->screen_idle = !idle;
+    if (state->event_sink) {
+        flutter::EncodableMap event;
+        event[flutter::EncodableValue("type")] = flutter::EncodableValue("idle");
+        event[flutter::EncodableValue("idle")] = flutter::EncodableValue(!idle);
+        state->event_sink(state->texture_id, std::move(event));
+    }
+}
+
+void VideoDecoderPlugin::VideoSession::UpdateAtlasTile(std::shared_ptr<VideoSessionState> state,
+                                                      TextureAtlas* atlas, int slot, uint64_t generation,
+                                                      AVFrame* frame) {
+    if (!frame->data[0] || frame->width <= 0 || frame->height <= 0) return;
+
+    // Fit inside the tile keeping the aspect ratio; the atlas letterboxes
+    double scale = std::min((double)atlas->tile_width() / frame->width,
+                            (double)atlas->tile_height() / frame->height);
+    int width = std::max(2, (int)(frame->width * scale) & ~1);
+    int height = std::max(2, (int)(frame->height * scale) & ~1);
+
+    {
+        std::lock_guard<std::mutex> ffmpeg_lock(g_ffmpeg_init_mutex);
+        state->atlas_sws_context = sws_getCachedContext(
+            state->atlas_sws_context, frame->width, frame->height, (AVPixelFormat)frame->format,
+            width, height, AV_PIX_FMT_RGBA, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+    }
+    if (!state->atlas_sws_context) return;
+
+    state->atlas_pixels.resize(static_cast<size_t>(width) * height * 4);
+    uint8_t* dest[4] = { state->atlas_pixels.data(), NULL, NULL, NULL };
+    int dest_linesize[4] = { width * 4, 0, 0, 0 };
+    if (SwsScaleSafe(state->atlas_sws_context, frame->data, frame->linesize, 0, frame->height, dest,
+                     dest_linesize) <= 0) {
+        return;
     }
+    atlas->UpdateTile(slot, generation, state->atlas_pixels.data(), width, height, width * 4);
 }
 
 void VideoDecoderPlugin::RegisterWithRegistrar(FlutterDesktopPluginRegistrarRef registrar_ref) {
@@ -659,18 +2628,21 @@ void VideoDecoderPlugin::RegisterWithRegistrar(FlutterDesktopPluginRegistrarRef
         registrar->messenger(), "scraki/video_decoder",
         &flutter::StandardMethodCodec::GetInstance());
 
-    auto plugin = std::make_unique<VideoDecoderPlugin>(registrar->texture_registrar());
+    auto plugin = std::make_unique<VideoDecoderPlugin>(registrar->texture_registrar(),
+                                                       std::make_shared<PlatformTaskRunner>(registrar));
 
     channel->SetMethodCallHandler(
         [plugin_pointer = plugin.get()](const auto& call, auto result) {
             plugin_pointer->HandleMethodCall(call, std::move(result));
         });
+    plugin->channel_ = std::move(channel);
 
     registrar->AddPlugin(std::move(plugin));
     LogTrace("RegisterWithRegistrar End");
 }
 
-VideoDecoderPlugin::VideoSessionState::RGBAFrame::RGBAFrame(int w, int h) : width(w), height(h) {
+VideoDecoderPlugin::VideoSessionState::RGBAFrame::RGBAFrame(int w, int h, int numa_node)
+    : pixels(NodeAllocator<uint8_t>(numa_node)), width(w), height(h), node(numa_node) {
     size_t size = static_cast<size_t>(w) * h * 4;
     pixels.assign(size, 0);
     g_active_buffers++;
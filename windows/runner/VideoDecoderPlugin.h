@@ -11,11 +11,14 @@
 #include <flutter/texture_registrar.h>
 
 #include <memory>
+#include <functional>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <vector>
 #include <map>
+#include <deque>
+#include <chrono>
 #include <string>
 #include <stdexcept>
 #include <iostream>
@@ -23,6 +26,10 @@
 
 extern std::atomic<int64_t> g_active_buffers;
 extern std::atomic<int64_t> g_total_pixels_allocated;
+extern std::mutex g_ffmpeg_init_mutex; // Guards avcodec_open2 and sws context creation
+
+// Shared with the other runner translation units
+void LogTrace(const char* format, ...);
 
 // FFmpeg
 extern "C" {
@@ -32,11 +39,36 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+#include "ActivityMeter.h"
+#include "BitstreamParser.h"
+#include "CpuTopology.h"
+#include "FrameAnalyzer.h"
+#include "FrameChangeDetector.h"
+#include "FrameEncoder.h"
+#include "FrameExporter.h"
+#include "FrameHash.h"
+#include "FrameNotifier.h"
+#include "FramePacer.h"
+#include "InputScript.h"
+#include "PlatformTaskRunner.h"
+#include "QosGovernor.h"
+#include "SessionOutput.h"
+#include "StreamHealth.h"
+#include "StreamRecorder.h"
+#include "StreamRelay.h"
+#include "TextureAtlas.h"
+#include "TimeShiftBuffer.h"
+
+class DecoderHostPool;
+class RemoteSession;
+class TimeShiftPlayer;
+
 class VideoDecoderPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(FlutterDesktopPluginRegistrarRef registrar);
 
-  VideoDecoderPlugin(flutter::TextureRegistrar* texture_registrar);
+  VideoDecoderPlugin(flutter::TextureRegistrar* texture_registrar,
+                     std::shared_ptr<PlatformTaskRunner> platform_runner);
 
   virtual ~VideoDecoderPlugin();
 
@@ -44,16 +76,24 @@ class VideoDecoderPlugin : public flutter::Plugin {
   VideoDecoderPlugin(const VideoDecoderPlugin&) = delete;
   VideoDecoderPlugin& operator=(const VideoDecoderPlugin&) = delete;
 
+  // Posts an event for one session to Dart (onSessionEvent). Callable from
+  // any thread.
+  using SessionEventSink = std::function<void(int64_t texture_id, flutter::EncodableMap event)>;
+
   struct VideoSessionState {
       flutter::TextureRegistrar* texture_registrar;
       int64_t texture_id = -1;
       std::unique_ptr<flutter::TextureVariant> texture;
       
       struct RGBAFrame {
-          std::vector<uint8_t> pixels;
+          std::vector<uint8_t, NodeAllocator<uint8_t>> pixels;
           int width = 0;
           int height = 0;
-          RGBAFrame(int w, int h);
+          int node = -1;  // NUMA node of pixels, -1 for the default heap
+          int64_t pts_us = 0;
+          std::chrono::steady_clock::time_point ready_time; // Conversion finished
+          uint64_t schedule_seq = 0; // Set when queued; pooled buffers are reused
+          RGBAFrame(int w, int h, int numa_node = -1);
           ~RGBAFrame();
       };
 
@@ -61,6 +101,8 @@ class VideoDecoderPlugin : public flutter::Plugin {
       std::shared_ptr<RGBAFrame> front_buffer;
       std::shared_ptr<RGBAFrame> last_front_buffer;
       std::vector<std::shared_ptr<RGBAFrame>> buffer_pool;
+      std::deque<std::shared_ptr<RGBAFrame>> pending_frames; // Converted, waiting for their PTS slot
+      uint64_t next_schedule_seq = 0;
       
       int width = 0; // Current decoder width
       int height = 0; // Current decoder height
@@ -68,7 +110,11 @@ class VideoDecoderPlugin : public flutter::Plugin {
       
       std::atomic<bool> is_alive{true};
       std::atomic<bool> is_decoding{false};
+      std::mutex socket_mutex; // Guards replacing/closing socket across threads
       SOCKET socket = INVALID_SOCKET;
+      std::atomic<bool> connected{false};
+      std::atomic<int64_t> reconnects{0};
+      std::atomic<int64_t> last_reconnect_ms{-1};
 
       // FFmpeg
       AVCodecContext* codec_context = nullptr;
@@ -76,6 +122,96 @@ class VideoDecoderPlugin : public flutter::Plugin {
       AVPacket* packet = nullptr;
       AVFrame* frame = nullptr;
       SwsContext* sws_context = nullptr;
+      int sws_src_width = 0; // Geometry sws_context was created for
+      int sws_src_height = 0;
+      int sws_out_width = 0;
+      int sws_out_height = 0;
+
+      // Compressed stream taps (decoder thread pushes, platform thread swaps)
+      std::mutex recorder_mutex;
+      std::shared_ptr<StreamRecorder> recorder;
+      std::shared_ptr<StreamRelay> relay;
+      std::vector<uint8_t> last_config;
+
+      // Config and frame headers of the received stream (decoder thread only)
+      BitstreamParser bitstream;
+      std::atomic<int64_t> config_changes{0};
+      std::mutex time_shift_mutex;
+      std::shared_ptr<TimeShiftBuffer> time_shift;
+
+      // Grid mode: downscaled copy into a shared atlas page. With atlas_only
+      // the session's own full-size texture is not updated at all.
+      std::shared_ptr<TextureAtlas> atlas;
+      int atlas_slot = -1;
+      uint64_t atlas_generation = 0; // Lease of atlas_slot, see TextureAtlas::UpdateTile
+      bool atlas_only = false;
+      SwsContext* atlas_sws_context = nullptr; // Decoder thread only
+      std::vector<uint8_t> atlas_pixels;
+
+      // Extra textures at other sizes/rates fed from the same decode
+      std::mutex outputs_mutex;
+      std::vector<std::shared_ptr<SessionOutput>> outputs;
+
+      // Opt-in shared-memory copy of every converted frame
+      std::mutex exporter_mutex;
+      std::shared_ptr<FrameExporter> exporter;
+
+      // Automation checks on the Y plane, independent of display QoS
+      std::mutex analysis_mutex;
+      std::shared_ptr<FrameAnalysisHost> analysis;
+      // Perceptual hash of every decoded frame and waits on it
+      std::shared_ptr<FrameHashWatch> frame_hash = std::make_shared<FrameHashWatch>();
+
+      // Presentation scheduling (passthrough unless a delay is set)
+      FramePacer pacer;
+      std::atomic<int64_t> frames_decoded{0};
+      std::atomic<int64_t> frames_presented{0};
+      std::atomic<int64_t> frames_dropped{0};
+
+      // Static screen detection: unchanged frames skip conversion and upload
+      FrameChangeDetector change_detector; // Decoder thread only
+      std::atomic<bool> force_refresh{false};
+      std::atomic<bool> screen_idle{false};
+      std::chrono::steady_clock::time_point last_change_time;
+      std::atomic<int64_t> frames_unchanged{0};
+
+      SessionEventSink event_sink;
+
+      // QoS class set from Dart; the governor maps it to a degradation level
+      std::atomic<int> priority{QosGovernor::kVisible};
+      std::atomic<int> qos_level{QosGovernor::kFull};
+
+      // Decoder thread placement while CPU pinning is on (decoder thread
+      // only; core and node mirrored for stats)
+      CpuTopology::Placement cpu_placement;
+      bool cpu_pinned = false;
+      GROUP_AFFINITY unpinned_affinity = {};
+      std::atomic<int> cpu_core{-1};
+      std::atomic<int> cpu_node{-1};
+      std::atomic<int64_t> frames_throttled{0};
+      std::atomic<int64_t> frames_skipped{0}; // Droppable frames never decoded
+
+      // Loss recovery: after lost framing, decode errors or missing
+      // references nothing is decoded until the next keyframe, which Dart
+      // asks the device for (decoder thread only; counters for stats)
+      std::atomic<bool> recovering{false};
+      const char* loss_reason = "";
+      std::chrono::steady_clock::time_point loss_time;
+      std::chrono::steady_clock::time_point keyframe_request_time;
+      std::atomic<int64_t> loss_incidents{0};
+      std::atomic<int64_t> last_recovery_ms{-1};
+      std::atomic<int64_t> max_recovery_ms{0};
+      std::chrono::steady_clock::time_point last_converted_time; // Decoder thread only
+      std::chrono::steady_clock::time_point packet_arrival; // Of the packet being decoded; decoder thread only
+
+      // Load signal for stream adaptation
+      StreamHealth health;
+      // Screen activity for sorting tiles
+      ActivityMeter activity;
+
+      // Time-to-first-frame measurement
+      std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+      std::atomic<bool> first_frame_shown{false};
 
       VideoSessionState(flutter::TextureRegistrar* registrar) : texture_registrar(registrar), texture_id(-1) {
           memset(&flutter_pixel_buffer, 0, sizeof(flutter_pixel_buffer));
@@ -86,20 +222,51 @@ class VideoDecoderPlugin : public flutter::Plugin {
 
   class VideoSession {
    public:
-    VideoSession(flutter::TextureRegistrar* texture_registrar, const std::string& host, int port);
+    VideoSession(flutter::TextureRegistrar* texture_registrar, const std::string& host, int port,
+                 SessionEventSink event_sink);
     ~VideoSession();
 
     int64_t texture_id() const { return state_ ? state_->texture_id : -1; }
+    std::shared_ptr<VideoSessionState> state() const { return state_; }
 
    private:
     static void DecodingLoop(std::shared_ptr<VideoSessionState> state, std::string host, int port);
-    static bool ConnectToServer(std::shared_ptr<VideoSessionState> state, const std::string& host, int port);
+    static bool ConnectToServer(std::shared_ptr<VideoSessionState> state, const std::string& host, int port,
+                                int timeout_ms);
+    static bool ConnectWithRetry(std::shared_ptr<VideoSessionState> state, const std::string& host, int port);
+    static void CloseSocket(const std::shared_ptr<VideoSessionState>& state);
+    static void ReceiveLoop(std::shared_ptr<VideoSessionState> state);
+    // Moves the decoder thread to a core suiting priority, or back to any
+    // core once pinning is off. Decoder thread only.
+    static void PlaceDecoderThread(const std::shared_ptr<VideoSessionState>& state, int priority);
+    static void ReleaseDecoderThread(const std::shared_ptr<VideoSessionState>& state);
+    static void EmitConnectionEvent(const std::shared_ptr<VideoSessionState>& state, const char* type,
+                                    int64_t elapsed_ms);
     static bool InitializeDecoder(std::shared_ptr<VideoSessionState> state);
-    static void DecodePacket(std::shared_ptr<VideoSessionState> state, const std::vector<uint8_t>& data);
+    // extradata, when set, replaces the decoder's parameter sets from this
+    // packet on. Returns false, after reporting a stream loss, when the
+    // decoder failed or produced a damaged frame.
+    static bool DecodePacket(std::shared_ptr<VideoSessionState> state, const std::vector<uint8_t>& data,
+                             int64_t pts, const std::vector<uint8_t>* extradata = nullptr);
+    // Starts a loss incident (or extends the current one) and asks for a
+    // keyframe; RequestKeyframe repeats the request while none arrives.
+    // Decoder thread only.
+    static void OnStreamLoss(const std::shared_ptr<VideoSessionState>& state, const char* reason);
+    static void RequestKeyframe(const std::shared_ptr<VideoSessionState>& state);
+    static void OnStreamRecovered(const std::shared_ptr<VideoSessionState>& state);
     static void ProcessFrame(std::shared_ptr<VideoSessionState> state, AVFrame* frame);
+    static void ScheduleFrame(std::shared_ptr<VideoSessionState> state,
+                              std::shared_ptr<VideoSessionState::RGBAFrame> buffer);
+    // seq identifies the queued frame; see RGBAFrame::schedule_seq
+    static void PresentScheduledFrame(std::shared_ptr<VideoSessionState> state, uint64_t seq);
+    static void PublishFrame(std::shared_ptr<VideoSessionState> state,
+                             std::shared_ptr<VideoSessionState::RGBAFrame> buffer);
+    static void MarkFirstFrame(const std::shared_ptr<VideoSessionState>& state);
+    static void UpdateIdleState(const std::shared_ptr<VideoSessionState>& state, bool changed);
+    static void UpdateAtlasTile(std::shared_ptr<VideoSessionState> state, TextureAtlas* atlas, int slot,
+                                uint64_t generation, AVFrame* frame);
 
     std::shared_ptr<VideoSessionState> state_;
-    std::unique_ptr<std::thread> decoder_thread_;
   };
 
  private:
@@ -112,10 +279,97 @@ class VideoDecoderPlugin : public flutter::Plugin {
                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void StopDecoding(int64_t texture_id);
   void StopAllDecoding();
+  std::shared_ptr<VideoSessionState> FindSessionState(int64_t texture_id);
+  // Platform thread, for a texture FindSessionState does not know
+  void ReportMissingSession(int64_t texture_id, flutter::MethodResult<flutter::EncodableValue>* result);
+
+  void StartRecording(int64_t texture_id, const std::string& path,
+                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StopRecording(int64_t texture_id,
+                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StartRelay(int64_t texture_id, const std::string& address, int port,
+                  std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StopRelay(int64_t texture_id,
+                 std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void AttachToAtlas(int64_t texture_id, bool atlas_only,
+                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void DetachFromAtlas(const std::shared_ptr<VideoSessionState>& state);
+
+  void AddOutput(int64_t texture_id, const SessionOutput::Config& config,
+                 std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // output_texture_id -1 removes every output of the session.
+  void RemoveOutput(const std::shared_ptr<VideoSessionState>& state, int64_t output_texture_id);
+
+  void StartFrameExport(int64_t texture_id, int slot_count, int max_edge,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void ConfigureTimeShift(int64_t texture_id, int seconds, int max_megabytes,
+                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void DumpTimeShift(int64_t texture_id, const std::string& path, int seconds,
+                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Players scrub a snapshot of the window in their own texture and outlive
+  // the session they were opened from.
+  void OpenTimeShiftPlayer(int64_t texture_id, int seconds, int max_size,
+                           std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SeekTimeShiftPlayer(int64_t player_texture_id, int64_t pts_us,
+                           std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void CloseTimeShiftPlayer(int64_t player_texture_id);
+
+  void ConfigureAnalysis(const flutter::EncodableMap* arguments,
+                         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void GetFrameHash(int64_t texture_id, std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Answers on the platform thread once the hash matches or at timeout.
+  void WaitForFrameHash(int64_t texture_id, uint64_t reference, int max_distance, int timeout_ms,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Answers with the timing report once the replay ends or is cancelled.
+  void ReplayInputScript(const flutter::EncodableMap* arguments,
+                         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Runs for 2 * seconds on its own thread, one at a time; see
+  // PlacementBenchmark.
+  void RunPlacementBenchmark(int threads, int seconds, int width, int height,
+                             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // count 0 decodes in this process. Hosts can only change while none of
+  // their sessions run.
+  void ConfigureDecoderHosts(int count, std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  void GetStats(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Snapshots hold a reference to the current front buffer and are encoded on
+  // the worker pool; results come back through platform_runner_.
+  void CaptureFrame(int64_t texture_id, FrameEncoder::Format format, int max_size, int quality,
+                    const std::string& path, std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void CaptureAllFrames(FrameEncoder::Format format, int max_size, int quality, const std::string& directory,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
   flutter::TextureRegistrar* texture_registrar_;
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+  std::shared_ptr<PlatformTaskRunner> platform_runner_;
   std::map<int64_t, std::unique_ptr<VideoSession>> sessions_;
   std::mutex sessions_mutex_;
+
+  // Atlas pages are created and released on the platform thread only
+  int atlas_tile_width_ = 270;
+  int atlas_tile_height_ = 480;
+  int atlas_columns_ = 8;
+  int atlas_rows_ = 4;
+  std::vector<std::shared_ptr<TextureAtlas>> atlas_pages_;
+
+  // Platform thread only
+  std::map<int64_t, std::shared_ptr<TimeShiftPlayer>> time_shift_players_;
+  std::map<std::string, std::weak_ptr<SyncGroup>> sync_groups_; // Owned by member pacers
+  std::unique_ptr<DecoderHostPool> decoder_hosts_;
+  std::map<int64_t, std::shared_ptr<RemoteSession>> remote_sessions_;
+  std::map<int64_t, std::unique_ptr<InputScript>> input_recordings_;
+  int64_t next_input_recording_ = 1;
+  std::vector<std::unique_ptr<InputReplayer>> input_replays_; // Finished ones pruned lazily
+  std::thread benchmark_thread_;
+  std::atomic<bool> benchmark_running_{false};
+  std::atomic<bool> benchmark_cancelled_{false};
 };
 
 #endif  // VIDEO_DECODER_PLUGIN_H_
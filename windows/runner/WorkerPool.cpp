@@ -0,0 +1,56 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool& WorkerPool::GetInstance() {
+    // Leave most cores to the decoder threads
+    static WorkerPool instance(std::clamp(std::thread::hardware_concurrency() / 4, 2u, 4u));
+    return instance;
+}
+
+WorkerPool& WorkerPool::GetFileInstance() {
+    static WorkerPool instance(1);
+    return instance;
+}
+
+WorkerPool::WorkerPool(unsigned int count) {
+    for (unsigned int i = 0; i < count; ++i) {
+        threads_.emplace_back([this]() { Run(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void WorkerPool::Post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void WorkerPool::Run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !active_ || !tasks_.empty(); });
+            if (!active_) return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        try {
+            task();
+        } catch (...) {
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Small fixed pool for CPU work that must stay off both the decoder threads
+// and the platform thread (snapshot encoding and similar one-shot jobs).
+class WorkerPool {
+ public:
+  static WorkerPool& GetInstance();
+  // One thread for jobs that block on file I/O for long (time-shift dumps),
+  // so they never hold up the short tasks of the pool above.
+  static WorkerPool& GetFileInstance();
+
+  void Post(std::function<void()> task);
+
+  size_t thread_count() const { return threads_.size(); }
+
+ private:
+  explicit WorkerPool(unsigned int count);
+  ~WorkerPool();
+
+  void Run();
+
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool active_ = true;
+  std::vector<std::thread> threads_;
+};
+
+#endif  // WORKER_POOL_H_